@@ -11,7 +11,7 @@ DEFINE_TU_LOGGER("Backend.Ctx");
 #define LOG_TU_LOGGER() ThisLogger()
 
 bool VkBackendCtx::init(std::span<const char *const> platformExtensions,
-                        bool enableValidation) {
+                        bool enableValidation, bool headless) {
   shutdown();
 
   if (!m_instance.init(platformExtensions, enableValidation)) {
@@ -20,7 +20,7 @@ bool VkBackendCtx::init(std::span<const char *const> platformExtensions,
     return false;
   }
 
-  if (!m_device.init(m_instance.instance())) {
+  if (!m_device.init(m_instance.instance(), /*presentation=*/!headless)) {
     LOGE("Failed to initialize VkDevice");
     shutdown();
     return false;
@@ -66,11 +66,15 @@ public:
    * @param enableValidation
    *   Whether to enable validation layers / debug utilities.
    *
+   * @param headless
+   *   No surface will be presented to, VK_KHR_swapchain is not required.
+   *   platformExtensions may then be empty.
+   *
    * @return true if fully initialized, false on any failure. On the failure,
    * the object is returned to a cleans shutdown state.
    */
   bool init(std::span<const char *const> platformExtensions,
-            bool enableValidation);
+            bool enableValidation, bool headless = false);
 
   /**
    * @brief Destroys all owned Vulkan resources and resets handles to null.
@@ -102,6 +106,16 @@ public:
   [[nodiscard]] VkQueue graphicsQueue() const noexcept {
     return m_device.queues().graphics;
   }
+  [[nodiscard]] const VkPhysicalDeviceFeatures &
+  enabledFeatures() const noexcept {
+    return m_device.enabledFeatures();
+  }
+  [[nodiscard]] bool synchronization2Enabled() const noexcept {
+    return m_device.synchronization2Enabled();
+  }
+  [[nodiscard]] bool calibratedTimestampsEnabled() const noexcept {
+    return m_device.calibratedTimestampsEnabled();
+  }
 
 private:
   /**
@@ -2,10 +2,12 @@
 
 #include "engine/logging/log.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -14,16 +16,17 @@ DEFINE_TU_LOGGER("Backend.Device");
 
 namespace {
 
+// VK_KHR_swapchain is only required when presenting to a surface
+std::vector<const char *> requiredDeviceExtensions(bool presentation) {
+  std::vector<const char *> extensions;
+  if (presentation) {
+    extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+  }
 #ifdef __APPLE__
-constexpr std::array<const char *, 2> kDeviceExtensions = {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-    "VK_KHR_portability_subset",
-};
-#else
-constexpr std::array<const char *, 1> kDeviceExtensions = {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-};
+  extensions.push_back("VK_KHR_portability_subset");
 #endif
+  return extensions;
+}
 
 void logPhysicalDeviceInfo(VkPhysicalDevice physicalDevice) {
   VkPhysicalDeviceProperties props{};
@@ -36,9 +39,9 @@ void logPhysicalDeviceInfo(VkPhysicalDevice physicalDevice) {
        props.vendorID, props.deviceID);
 }
 
-void logEnabledDeviceExtensions() {
-  LOGD("Enabled device extensions ({}):", kDeviceExtensions.size());
-  for (const char *ext : kDeviceExtensions) {
+void logEnabledDeviceExtensions(const std::vector<const char *> &extensions) {
+  LOGD("Enabled device extensions ({}):", extensions.size());
+  for (const char *ext : extensions) {
     LOGI("  {}", ext);
   }
 }
@@ -102,7 +105,8 @@ QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) {
   return indices;
 }
 
-bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
+bool checkDeviceExtensionSupport(
+    VkPhysicalDevice device, const std::vector<const char *> &extensions) {
   uint32_t extensionCount = 0;
   vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount,
                                        nullptr);
@@ -111,8 +115,8 @@ bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
   vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount,
                                        availableExtensions.data());
 
-  std::set<std::string> requiredExtensions(kDeviceExtensions.begin(),
-                                           kDeviceExtensions.end());
+  std::set<std::string> requiredExtensions(extensions.begin(),
+                                           extensions.end());
 
   for (const auto &ext : availableExtensions) {
     requiredExtensions.erase(ext.extensionName);
@@ -129,6 +133,18 @@ bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
   return true;
 }
 
+bool hasDeviceExtension(VkPhysicalDevice device, std::string_view name) {
+  uint32_t count = 0;
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+  std::vector<VkExtensionProperties> available(count);
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &count,
+                                       available.data());
+
+  return std::ranges::any_of(available, [name](const auto &ext) {
+    return name == ext.extensionName;
+  });
+}
+
 bool supportsTimestamps(VkPhysicalDevice device, uint32_t graphicsFamily) {
   VkPhysicalDeviceProperties props{};
   vkGetPhysicalDeviceProperties(device, &props);
@@ -168,9 +184,28 @@ bool supportsDynamicRendering(VkPhysicalDevice device) {
   return dyn.dynamicRendering == VK_TRUE;
 }
 
+bool supportsSynchronization2(VkPhysicalDevice device) {
+  // Core entry points such as vkCmdPipelineBarrier2 need a 1.3 device
+  if (!supportsVulkan13(device)) {
+    return false;
+  }
+
+  VkPhysicalDeviceSynchronization2Features sync2{};
+  sync2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+
+  VkPhysicalDeviceFeatures2 feats2{};
+  feats2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  feats2.pNext = &sync2;
+
+  vkGetPhysicalDeviceFeatures2(device, &feats2);
+  return sync2.synchronization2 == VK_TRUE;
+}
+
 } // namespace
 
-bool VkDeviceCtx::init(VkInstance instance) {
+bool VkDeviceCtx::init(VkInstance instance, bool presentation) {
+  m_extensions = requiredDeviceExtensions(presentation);
+
   if (!pickPhysicalDevice(instance)) {
     LOGE("Failed to find a suitable physical device (GPU)");
     return false;
@@ -193,6 +228,10 @@ void VkDeviceCtx::shutdown() noexcept {
 
   m_physicalDevice = VK_NULL_HANDLE;
   m_queues = {};
+  m_enabledFeatures = {};
+  m_synchronization2 = false;
+  m_calibratedTimestamps = false;
+  m_extensions.clear();
 }
 
 bool VkDeviceCtx::pickPhysicalDevice(VkInstance instance) {
@@ -219,7 +258,8 @@ bool VkDeviceCtx::pickPhysicalDevice(VkInstance instance) {
     }
 
     QueueFamilyIndices indices = findQueueFamilies(device);
-    bool extensionsSupported = checkDeviceExtensionSupport(device);
+    bool extensionsSupported =
+        checkDeviceExtensionSupport(device, m_extensions);
     // TODO: Use scoring function to pick best graphics (i.e discrete >
     // integrated)
 
@@ -237,7 +277,7 @@ bool VkDeviceCtx::pickPhysicalDevice(VkInstance instance) {
       logPhysicalDeviceInfo(device);
       logQueueFamilyProps(device, graphicsFamily);
 
-      logEnabledDeviceExtensions();
+      logEnabledDeviceExtensions(m_extensions);
 
       return true;
     }
@@ -267,10 +307,30 @@ bool VkDeviceCtx::createLogicalDevice() {
   queueCreateInfo.queueCount = 1;
   queueCreateInfo.pQueuePriorities = &queuePriority;
 
+  // Optional features, enabled when the device has them
+  VkPhysicalDeviceFeatures supported{};
+  vkGetPhysicalDeviceFeatures(m_physicalDevice, &supported);
+
   VkPhysicalDeviceFeatures deviceFeatures{};
+  deviceFeatures.samplerAnisotropy = supported.samplerAnisotropy;
+  deviceFeatures.textureCompressionBC = supported.textureCompressionBC;
+  deviceFeatures.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+
+  // Lets GPU timestamps be placed on the CPU timeline
+  const bool calibratedTimestamps = hasDeviceExtension(
+      m_physicalDevice, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+  if (calibratedTimestamps) {
+    m_extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+  }
+
+  VkPhysicalDeviceSynchronization2Features sync2{};
+  sync2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+  sync2.synchronization2 = VK_TRUE;
+  const bool synchronization2 = supportsSynchronization2(m_physicalDevice);
 
   VkPhysicalDeviceDynamicRenderingFeatures dyn{};
   dyn.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+  dyn.pNext = synchronization2 ? &sync2 : nullptr;
   dyn.dynamicRendering = VK_TRUE;
 
   VkDeviceCreateInfo createInfo{};
@@ -281,8 +341,8 @@ bool VkDeviceCtx::createLogicalDevice() {
   createInfo.pEnabledFeatures = &deviceFeatures;
 
   createInfo.enabledExtensionCount =
-      static_cast<uint32_t>(kDeviceExtensions.size());
-  createInfo.ppEnabledExtensionNames = kDeviceExtensions.data();
+      static_cast<uint32_t>(m_extensions.size());
+  createInfo.ppEnabledExtensionNames = m_extensions.data();
 
   VkResult res =
       vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device);
@@ -295,6 +355,17 @@ bool VkDeviceCtx::createLogicalDevice() {
   vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0,
                    &m_queues.graphics);
   m_queues.graphicsFamily = indices.graphicsFamily.value();
+  m_enabledFeatures = deviceFeatures;
+  m_synchronization2 = synchronization2;
+  m_calibratedTimestamps = calibratedTimestamps;
+
+  LOGI("Optional features: samplerAnisotropy={} textureCompressionBC={} "
+       "pipelineStatisticsQuery={} synchronization2={} "
+       "calibratedTimestamps={}",
+       deviceFeatures.samplerAnisotropy == VK_TRUE,
+       deviceFeatures.textureCompressionBC == VK_TRUE,
+       deviceFeatures.pipelineStatisticsQuery == VK_TRUE, m_synchronization2,
+       m_calibratedTimestamps);
 
   return true;
 }
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 /**
@@ -31,7 +32,7 @@ struct VkQueues {
  *   - Create VkDevice and retrieve VkQueue handles
  *
  * Requirements:
- * - VK_KHR_swapchain on all devices
+ * - VK_KHR_swapchain unless created for headless rendering
  * - VK_KHR_portability_subset on Apple/MoltenVK
  * - A graphics-capable queue family
  *
@@ -58,6 +59,12 @@ public:
     m_physicalDevice = std::exchange(other.m_physicalDevice, VK_NULL_HANDLE);
     m_device = std::exchange(other.m_device, VK_NULL_HANDLE);
     m_queues = std::exchange(other.m_queues, VkQueues{});
+    m_enabledFeatures =
+        std::exchange(other.m_enabledFeatures, VkPhysicalDeviceFeatures{});
+    m_synchronization2 = std::exchange(other.m_synchronization2, false);
+    m_calibratedTimestamps =
+        std::exchange(other.m_calibratedTimestamps, false);
+    m_extensions = std::exchange(other.m_extensions, {});
     return *this;
   }
 
@@ -65,10 +72,12 @@ public:
    * @brief Selects a VkPhysicalDevice and creates a VkDevice + queues.
    *
    * @param instance: A valid VkInstance used to enumerate physical devices.
+   * @param presentation: Require and enable VK_KHR_swapchain. Headless
+   * devices skip it, so offscreen-only ICDs qualify.
    * @return true on success. On failure, this object remains in a shutdown-safe
    * state.
    */
-  bool init(VkInstance instance);
+  bool init(VkInstance instance, bool presentation = true);
 
   /**
    * @brief Destroys the logical device and clears stored handles.
@@ -82,6 +91,28 @@ public:
   }
   [[nodiscard]] VkDevice device() const { return m_device; }
   [[nodiscard]] const VkQueues &queues() const { return m_queues; }
+  /**
+   * @brief Core features enabled on the logical device. Optional features
+   * (samplerAnisotropy, textureCompressionBC, pipelineStatisticsQuery) are
+   * only set when the device supports them.
+   */
+  [[nodiscard]] const VkPhysicalDeviceFeatures &enabledFeatures() const {
+    return m_enabledFeatures;
+  }
+  /**
+   * @brief True when the device is 1.3 and synchronization2 is enabled, so
+   * vkCmdPipelineBarrier2 may be recorded.
+   */
+  [[nodiscard]] bool synchronization2Enabled() const {
+    return m_synchronization2;
+  }
+  /**
+   * @brief True when VK_EXT_calibrated_timestamps is enabled, so GPU
+   * timestamps can be correlated with a host clock.
+   */
+  [[nodiscard]] bool calibratedTimestampsEnabled() const {
+    return m_calibratedTimestamps;
+  }
 
 private:
   /**
@@ -110,4 +141,8 @@ private:
   VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
   VkDevice m_device = VK_NULL_HANDLE;
   VkQueues m_queues{};
+  VkPhysicalDeviceFeatures m_enabledFeatures{};
+  bool m_synchronization2 = false;
+  bool m_calibratedTimestamps = false;
+  std::vector<const char *> m_extensions; // enabled device extensions
 };
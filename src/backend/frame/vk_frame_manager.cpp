@@ -39,6 +39,8 @@ void VkFrameManager::shutdown() noexcept {
   m_framesInFlight = 0;
   m_swapchainImageCount = 0;
   m_currentFrame = 0;
+  m_headlessImage = 0;
+  m_headless = false;
 }
 
 bool VkFrameManager::createSyncObjects() {
@@ -119,10 +121,6 @@ VkFrameManager::FrameStatus VkFrameManager::beginFrame(VkSwapchainKHR swapchain,
     return FrameStatus::Error;
   }
 
-  if (swapchain == VK_NULL_HANDLE) {
-    return FrameStatus::Error;
-  }
-
   VkFence frameFence = m_inFlightFences[m_currentFrame];
 
   // Wait for CPU-frame fence
@@ -140,8 +138,13 @@ VkFrameManager::FrameStatus VkFrameManager::beginFrame(VkSwapchainKHR swapchain,
     return FrameStatus::Error;
   }
 
+  // Headless: no acquire, offscreen images are used round-robin
+  m_headless = swapchain == VK_NULL_HANDLE;
   VkResult acq = VK_SUCCESS;
-  if (profiler != nullptr) {
+  if (m_headless) {
+    outImageIndex = m_headlessImage;
+    m_headlessImage = (m_headlessImage + 1) % m_swapchainImageCount;
+  } else if (profiler != nullptr) {
     CpuProfiler::Scope s(*profiler, CpuProfiler::Stat::Acquire);
     acq = vkAcquireNextImageKHR(m_device, swapchain, timeout,
                                 m_imageAvailable[m_currentFrame],
@@ -204,14 +207,17 @@ VkFrameManager::submit(VkQueue queue, uint32_t imageIndex, VkCommandBuffer cmd,
   VkSemaphore signalSem = m_renderFinished[imageIndex];
   VkFence frameFence = m_inFlightFences[m_currentFrame];
 
+  // Nothing was acquired and nothing will be presented when headless
+  const uint32_t semaphoreCount = m_headless ? 0U : 1U;
+
   VkSubmitInfo submit{};
   submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submit.waitSemaphoreCount = 1;
+  submit.waitSemaphoreCount = semaphoreCount;
   submit.pWaitSemaphores = &waitSem;
   submit.pWaitDstStageMask = &waitStage;
   submit.commandBufferCount = 1;
   submit.pCommandBuffers = &cmd;
-  submit.signalSemaphoreCount = 1;
+  submit.signalSemaphoreCount = semaphoreCount;
   submit.pSignalSemaphores = &signalSem;
 
   VkResult res = VK_SUCCESS;
@@ -238,6 +244,11 @@ VkFrameManager::FrameStatus VkFrameManager::present(VkQueue queue,
     return FrameStatus::Error;
   }
 
+  if (swapchain == VK_NULL_HANDLE) {
+    m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+    return FrameStatus::Ok;
+  }
+
   VkSemaphore signalSem = m_renderFinished[imageIndex];
 
   VkPresentInfoKHR present{};
@@ -299,6 +310,7 @@ bool VkFrameManager::onSwapchainRecreated(uint32_t newSwapchainImageCount) {
   semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
   m_swapchainImageCount = newSwapchainImageCount;
+  m_headlessImage = 0;
   m_renderFinished.assign(m_swapchainImageCount, VK_NULL_HANDLE);
   m_imagesInFlight.assign(m_swapchainImageCount, VK_NULL_HANDLE);
 
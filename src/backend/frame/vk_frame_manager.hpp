@@ -30,6 +30,8 @@ public:
     m_framesInFlight = std::exchange(other.m_framesInFlight, 0U);
     m_swapchainImageCount = std::exchange(other.m_swapchainImageCount, 0U);
     m_currentFrame = std::exchange(other.m_currentFrame, 0U);
+    m_headlessImage = std::exchange(other.m_headlessImage, 0U);
+    m_headless = std::exchange(other.m_headless, false);
 
     m_imageAvailable = std::exchange(other.m_imageAvailable, {});
     m_inFlightFences = std::exchange(other.m_inFlightFences, {});
@@ -47,6 +49,8 @@ public:
 
   bool resizeSwapchainImages(uint32_t swapchainImageCount);
 
+  // A null swapchain selects headless frames: no acquire, no semaphores and
+  // present() only advances the frame
   FrameStatus beginFrame(VkSwapchainKHR swapchain, uint32_t &outImageIndex,
                          uint64_t timeout = UINT64_MAX,
                          CpuProfiler *profiler = nullptr);
@@ -72,6 +76,8 @@ private:
   uint32_t m_framesInFlight = 0;
   uint32_t m_swapchainImageCount = 0;
   uint32_t m_currentFrame = 0;
+  uint32_t m_headlessImage = 0; // next offscreen image when headless
+  bool m_headless = false;      // set by beginFrame()
 
   // Per-frame sync
   std::vector<VkSemaphore> m_imageAvailable; // size = framesInFlight
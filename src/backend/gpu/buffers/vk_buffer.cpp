@@ -1,5 +1,7 @@
 #include "backend/gpu/buffers/vk_buffer.hpp"
 
+#include "backend/profiling/memory_tracker.hpp"
+
 #include <cstddef>
 #include <cstring>
 #include <iostream>
@@ -20,7 +22,7 @@ static VmaMemoryUsage toVmaUsage(VkBufferObj::MemUsage usage) {
 
 bool VkBufferObj::init(VmaAllocator allocator, VkDeviceSize size,
                        VkBufferUsageFlags usage, MemUsage memUsage,
-                       bool mapped) {
+                       bool mapped, profiling::MemoryTag tag) {
   if (allocator == nullptr || size == 0) {
     std::cerr << "[Buffer] init invalid args\n";
     return false;
@@ -49,8 +51,9 @@ bool VkBufferObj::init(VmaAllocator allocator, VkDeviceSize size,
     allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
   }
 
+  VmaAllocationInfo info{};
   VkResult res = vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo,
-                                 &m_buffer, &m_allocation, nullptr);
+                                 &m_buffer, &m_allocation, &info);
   if (res != VK_SUCCESS) {
     std::cerr << "[Buffer] vmaCreateBuffer failed: " << res << "\n";
     shutdown();
@@ -58,6 +61,7 @@ bool VkBufferObj::init(VmaAllocator allocator, VkDeviceSize size,
   }
 
   m_size = size;
+  m_tracked = profiling::TrackedBytes(tag, info.size);
   return true;
 }
 
@@ -98,4 +102,5 @@ void VkBufferObj::shutdown() noexcept {
   m_allocation = nullptr;
   m_allocator = nullptr;
   m_size = 0;
+  m_tracked.reset();
 }
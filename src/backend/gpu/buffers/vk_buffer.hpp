@@ -1,5 +1,7 @@
 #pragma once
 
+#include "backend/profiling/memory_tracker.hpp"
+
 #include <cstdint>
 #include <utility>
 #include <vk_mem_alloc.h>
@@ -25,6 +27,7 @@ public:
     m_buffer = std::exchange(other.m_buffer, VK_NULL_HANDLE);
     m_allocation = std::exchange(other.m_allocation, nullptr);
     m_size = std::exchange(other.m_size, 0);
+    m_tracked = std::move(other.m_tracked);
 
     return *this;
   }
@@ -32,7 +35,8 @@ public:
   enum class MemUsage : std::uint8_t { GpuOnly, CpuToGpu, GpuToCpu };
 
   bool init(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage,
-            MemUsage memUsage, bool mapped = false);
+            MemUsage memUsage, bool mapped = false,
+            profiling::MemoryTag tag = profiling::MemoryTag::Other);
   void shutdown() noexcept;
 
   bool upload(const void *data, VkDeviceSize size, VkDeviceSize offset = 0);
@@ -52,4 +56,5 @@ private:
   VkDeviceMemory m_memory = VK_NULL_HANDLE; // owning
   VmaAllocation m_allocation = nullptr;
   VkDeviceSize m_size = 0;
+  profiling::TrackedBytes m_tracked; // allocation size, not m_size
 };
@@ -1,5 +1,7 @@
 #include "vk_per_frame_uniform_buffers.hpp"
 
+#include "backend/profiling/memory_tracker.hpp"
+
 #include <cstdint>
 #include <iostream>
 #include <vk_mem_alloc.h>
@@ -22,7 +24,8 @@ bool VkPerFrameUniformBuffers::init(VmaAllocator allocator,
   m_bufs.resize(framesInFlight);
   for (uint32_t i = 0; i < framesInFlight; ++i) {
     if (!m_bufs[i].init(allocator, m_stride, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                        VkBufferObj::MemUsage::CpuToGpu, /*mapped=*/true)) {
+                        VkBufferObj::MemUsage::CpuToGpu, /*mapped=*/true,
+                        profiling::MemoryTag::Uniform)) {
       std::cerr << "[PerFrameUBOBufs] Failed to create UBO\n";
       shutdown();
       return false;
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <iostream>
+#include <utility>
 #include <vulkan/vulkan_core.h>
 
 bool VkMaterialSets::init(VkDevice device, VkDescriptorSetLayout layout,
@@ -19,13 +20,18 @@ bool VkMaterialSets::init(VkDevice device, VkDescriptorSetLayout layout,
   m_device = device;
   m_layout = layout;
 
+  // Extra room for sets replaced by replaceTexture that are still waiting
+  // on in-flight frames before they can be released
+  const uint32_t maxSets = maxMaterials * 2U;
+
   VkDescriptorPoolSize poolSize{};
   poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  poolSize.descriptorCount = maxMaterials;
+  poolSize.descriptorCount = maxSets;
 
   VkDescriptorPoolCreateInfo poolInfo{};
   poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-  poolInfo.maxSets = maxMaterials;
+  poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+  poolInfo.maxSets = maxSets;
   poolInfo.poolSizeCount = 1;
   poolInfo.pPoolSizes = &poolSize;
 
@@ -54,16 +60,16 @@ void VkMaterialSets::shutdown() noexcept {
   m_device = VK_NULL_HANDLE;
 }
 
-uint32_t VkMaterialSets::allocateForTexture(const VkTexture2D &tex) {
+VkDescriptorSet VkMaterialSets::allocateSet(const VkTexture2D &tex) {
   if (m_device == VK_NULL_HANDLE || m_pool == VK_NULL_HANDLE ||
       m_layout == VK_NULL_HANDLE) {
     std::cerr << "[MaterialSets] Not initialized\n";
-    return UINT32_MAX;
+    return VK_NULL_HANDLE;
   }
 
   if (!tex.valid()) {
     std::cerr << "[MaterialSets] Invalid texture\n";
-    return UINT32_MAX;
+    return VK_NULL_HANDLE;
   }
 
   VkDescriptorSet set = VK_NULL_HANDLE;
@@ -77,7 +83,7 @@ uint32_t VkMaterialSets::allocateForTexture(const VkTexture2D &tex) {
   if (res != VK_SUCCESS) {
     std::cerr << "[MaterialSets] vkAllocateDescriptorSets failed: " << res
               << "\n";
-    return UINT32_MAX;
+    return VK_NULL_HANDLE;
   }
 
   VkDescriptorImageInfo imgInfo{};
@@ -95,12 +101,39 @@ uint32_t VkMaterialSets::allocateForTexture(const VkTexture2D &tex) {
 
   vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
 
+  return set;
+}
+
+uint32_t VkMaterialSets::allocateForTexture(const VkTexture2D &tex) {
+  VkDescriptorSet set = allocateSet(tex);
+  if (set == VK_NULL_HANDLE) {
+    return UINT32_MAX;
+  }
+
   const uint32_t idx = static_cast<uint32_t>(m_sets.size());
   m_sets.push_back(set);
 
   return idx;
 }
 
+VkDescriptorSet VkMaterialSets::exchange(uint32_t materialIndex,
+                                         VkDescriptorSet set) noexcept {
+  if (materialIndex >= m_sets.size()) {
+    return VK_NULL_HANDLE;
+  }
+
+  return std::exchange(m_sets[materialIndex], set);
+}
+
+void VkMaterialSets::release(VkDescriptorSet set) noexcept {
+  if (m_device == VK_NULL_HANDLE || m_pool == VK_NULL_HANDLE ||
+      set == VK_NULL_HANDLE) {
+    return;
+  }
+
+  vkFreeDescriptorSets(m_device, m_pool, 1, &set);
+}
+
 void VkMaterialSets::bind(VkCommandBuffer cmd, VkPipelineLayout pipelineLayout,
                           uint32_t setIndex, uint32_t materialIndex) const {
   if (materialIndex >= m_sets.size()) {
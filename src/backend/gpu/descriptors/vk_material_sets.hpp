@@ -39,6 +39,14 @@ public:
   // allocatePbrMaterial
   uint32_t allocateForTexture(const VkTexture2D &tex);
 
+  // Sets bound by in-flight command buffers cannot be rewritten, so a
+  // material is repointed by allocating a new set and exchanging it in.
+  // The returned set must be passed to release() once no frame uses it.
+  VkDescriptorSet allocateSet(const VkTexture2D &tex);
+  VkDescriptorSet exchange(uint32_t materialIndex,
+                           VkDescriptorSet set) noexcept;
+  void release(VkDescriptorSet set) noexcept;
+
   void bind(VkCommandBuffer cmd, VkPipelineLayout pipelineLayout,
             uint32_t setIndex, uint32_t materialIndex) const;
 
@@ -1,6 +1,7 @@
 #include "backend/gpu/images/vk_depth_image.hpp"
 
 #include "backend/gpu/images/vk_image.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 
 #include <array>
 #include <iostream>
@@ -57,7 +58,8 @@ bool VkDepthImage::init(VmaAllocator allocator, VkPhysicalDevice physicalDevice,
 
   if (!m_image.init2D(m_allocator, extent.width, extent.height, m_format,
                       VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                      VK_IMAGE_TILING_OPTIMAL)) {
+                      VK_IMAGE_TILING_OPTIMAL, /*mipLevels=*/1,
+                      profiling::MemoryTag::RenderTarget)) {
     std::cerr << "[Depth] Failed to create depth image\n";
     shutdown();
     return false;
@@ -1,5 +1,7 @@
 #include "backend/gpu/images/vk_image.hpp"
 
+#include "backend/profiling/memory_tracker.hpp"
+
 #include <cstdint>
 #include <iostream>
 #include <vk_mem_alloc.h>
@@ -7,8 +9,9 @@
 
 bool VkImageObj::init2D(VmaAllocator allocator, uint32_t width, uint32_t height,
                         VkFormat format, VkImageUsageFlags usage,
-                        VkImageTiling tiling) {
-  if (allocator == nullptr || width == 0 || height == 0 ||
+                        VkImageTiling tiling, uint32_t mipLevels,
+                        profiling::MemoryTag tag) {
+  if (allocator == nullptr || width == 0 || height == 0 || mipLevels == 0 ||
       format == VK_FORMAT_UNDEFINED) {
     std::cerr << "[Image] init2D invalid args\n";
     return false;
@@ -20,12 +23,13 @@ bool VkImageObj::init2D(VmaAllocator allocator, uint32_t width, uint32_t height,
   m_format = format;
   m_width = width;
   m_height = height;
+  m_mipLevels = mipLevels;
 
   VkImageCreateInfo imageInfo{};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
   imageInfo.imageType = VK_IMAGE_TYPE_2D;
   imageInfo.extent = VkExtent3D{width, height, 1U};
-  imageInfo.mipLevels = 1; // Todo: add mipmap
+  imageInfo.mipLevels = mipLevels;
   imageInfo.arrayLayers = 1;
   imageInfo.format = format;
   imageInfo.tiling = tiling;
@@ -37,14 +41,17 @@ bool VkImageObj::init2D(VmaAllocator allocator, uint32_t width, uint32_t height,
   VmaAllocationCreateInfo allocInfo{};
   allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE; // GPU only intent
 
+  VmaAllocationInfo info{};
   VkResult res = vmaCreateImage(m_allocator, &imageInfo, &allocInfo, &m_image,
-                                &m_allocation, nullptr);
+                                &m_allocation, &info);
   if (res != VK_SUCCESS) {
     std::cerr << "[Image] vkCreateImage failed: " << res << "\n";
     shutdown();
     return false;
   }
 
+  m_tracked = profiling::TrackedBytes(tag, info.size);
+
   return true;
 }
 
@@ -60,4 +67,6 @@ void VkImageObj::shutdown() noexcept {
   m_format = VK_FORMAT_UNDEFINED;
   m_width = 0;
   m_height = 0;
+  m_mipLevels = 0;
+  m_tracked.reset();
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "backend/profiling/memory_tracker.hpp"
+
 #include <utility>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan_core.h>
@@ -26,13 +28,17 @@ public:
     m_format = std::exchange(other.m_format, VK_FORMAT_UNDEFINED);
     m_width = std::exchange(other.m_width, 0U);
     m_height = std::exchange(other.m_height, 0U);
+    m_mipLevels = std::exchange(other.m_mipLevels, 0U);
+    m_tracked = std::move(other.m_tracked);
 
     return *this;
   }
 
   bool init2D(VmaAllocator allocator, uint32_t width, uint32_t height,
               VkFormat format, VkImageUsageFlags usage,
-              VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL);
+              VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL,
+              uint32_t mipLevels = 1,
+              profiling::MemoryTag tag = profiling::MemoryTag::Other);
   void shutdown() noexcept;
 
   [[nodiscard]] bool valid() const noexcept {
@@ -42,6 +48,7 @@ public:
   [[nodiscard]] VkFormat format() const noexcept { return m_format; }
   [[nodiscard]] uint32_t width() const noexcept { return m_width; }
   [[nodiscard]] uint32_t height() const noexcept { return m_height; }
+  [[nodiscard]] uint32_t mipLevels() const noexcept { return m_mipLevels; }
 
 private:
   VmaAllocator m_allocator = nullptr;   // non-owning
@@ -50,4 +57,6 @@ private:
   VkFormat m_format = VK_FORMAT_UNDEFINED;
   uint32_t m_width = 0;
   uint32_t m_height = 0;
+  uint32_t m_mipLevels = 0;
+  profiling::TrackedBytes m_tracked;
 };
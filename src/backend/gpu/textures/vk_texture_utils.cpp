@@ -1,10 +1,12 @@
 #include "backend/gpu/textures/vk_texture_utils.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <vulkan/vulkan_core.h>
 
 bool vkCreateTextureView(VkDevice device, VkImage image, VkFormat format,
-                         VkImageView &outView) {
+                         VkImageView &outView, uint32_t levelCount) {
   outView = VK_NULL_HANDLE;
 
   VkImageViewCreateInfo imageViewInfo{};
@@ -14,7 +16,7 @@ bool vkCreateTextureView(VkDevice device, VkImage image, VkFormat format,
   imageViewInfo.format = format;
   imageViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
   imageViewInfo.subresourceRange.baseMipLevel = 0;
-  imageViewInfo.subresourceRange.levelCount = 1;
+  imageViewInfo.subresourceRange.levelCount = levelCount;
   imageViewInfo.subresourceRange.baseArrayLayer = 0;
   imageViewInfo.subresourceRange.layerCount = 1;
 
@@ -29,7 +31,8 @@ bool vkCreateTextureView(VkDevice device, VkImage image, VkFormat format,
   return true;
 }
 
-bool vkCreateTextureSampler(VkDevice device, VkSampler &outSampler) {
+bool vkCreateTextureSampler(VkDevice device, VkSampler &outSampler,
+                            float maxLod, float maxAnisotropy) {
   outSampler = VK_NULL_HANDLE;
 
   VkSamplerCreateInfo samplerInfo{};
@@ -39,13 +42,13 @@ bool vkCreateTextureSampler(VkDevice device, VkSampler &outSampler) {
   samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
   samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
   samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-  samplerInfo.anisotropyEnable = VK_FALSE;
-  samplerInfo.maxAnisotropy = 1.0F;
+  samplerInfo.anisotropyEnable = maxAnisotropy > 1.0F ? VK_TRUE : VK_FALSE;
+  samplerInfo.maxAnisotropy = std::max(maxAnisotropy, 1.0F);
   samplerInfo.compareEnable = VK_FALSE;
   samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-  samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
   samplerInfo.minLod = 0.0F;
-  samplerInfo.maxLod = 0.0F;
+  samplerInfo.maxLod = maxLod;
   samplerInfo.mipLodBias = 0.0F;
   samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
   samplerInfo.unnormalizedCoordinates = VK_FALSE;
@@ -60,3 +63,73 @@ bool vkCreateTextureSampler(VkDevice device, VkSampler &outSampler) {
 
   return true;
 }
+
+uint32_t textureMipCount(uint32_t width, uint32_t height) noexcept {
+  uint32_t dim = std::max(width, height);
+  uint32_t levels = 1;
+
+  while (dim > 1) {
+    dim >>= 1U;
+    ++levels;
+  }
+
+  return levels;
+}
+
+uint32_t textureFormatBlockBytes(VkFormat format) noexcept {
+  switch (format) {
+  case VK_FORMAT_R8G8B8A8_UNORM:
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    return 4;
+  case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+  case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+  case VK_FORMAT_BC4_UNORM_BLOCK:
+    return 8;
+  case VK_FORMAT_BC3_UNORM_BLOCK:
+  case VK_FORMAT_BC3_SRGB_BLOCK:
+  case VK_FORMAT_BC5_UNORM_BLOCK:
+  case VK_FORMAT_BC7_UNORM_BLOCK:
+  case VK_FORMAT_BC7_SRGB_BLOCK:
+    return 16;
+  default:
+    return 0;
+  }
+}
+
+uint32_t textureFormatBlockDim(VkFormat format) noexcept {
+  switch (format) {
+  case VK_FORMAT_R8G8B8A8_UNORM:
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    return 1;
+  default:
+    return textureFormatBlockBytes(format) != 0 ? 4 : 1;
+  }
+}
+
+VkDeviceSize textureLevelBytes(VkFormat format, uint32_t width,
+                               uint32_t height) noexcept {
+  const uint32_t dim = textureFormatBlockDim(format);
+  const VkDeviceSize blocksX = (VkDeviceSize(width) + dim - 1) / dim;
+  const VkDeviceSize blocksY = (VkDeviceSize(height) + dim - 1) / dim;
+
+  return blocksX * blocksY * textureFormatBlockBytes(format);
+}
+
+bool vkSupportsSampledFormat(VkPhysicalDevice physicalDevice,
+                             VkFormat format) {
+  if (physicalDevice == VK_NULL_HANDLE) {
+    return false;
+  }
+
+  VkFormatProperties props{};
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+
+  const VkFormatFeatureFlags required =
+      VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+      VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+
+  return (props.optimalTilingFeatures & required) == required;
+}
@@ -1,7 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <vulkan/vulkan_core.h>
 
 bool vkCreateTextureView(VkDevice device, VkImage image, VkFormat format,
-                         VkImageView &outView);
-bool vkCreateTextureSampler(VkDevice device, VkSampler &outSampler);
+                         VkImageView &outView, uint32_t levelCount = 1);
+
+// maxLod = 0 samples only the view's base level. maxAnisotropy > 1 requires
+// the samplerAnisotropy device feature.
+bool vkCreateTextureSampler(VkDevice device, VkSampler &outSampler,
+                            float maxLod = 0.0F, float maxAnisotropy = 1.0F);
+
+// Levels in a full chain down to 1x1
+uint32_t textureMipCount(uint32_t width, uint32_t height) noexcept;
+
+// Bytes per texel block and block edge in texels (1 for uncompressed).
+// 0 bytes for formats textures do not use.
+uint32_t textureFormatBlockBytes(VkFormat format) noexcept;
+uint32_t textureFormatBlockDim(VkFormat format) noexcept;
+// Tightly packed byte size of one width x height level
+VkDeviceSize textureLevelBytes(VkFormat format, uint32_t width,
+                               uint32_t height) noexcept;
+
+// Sampled with linear filtering and writable by transfers in optimal tiling.
+// BC formats also need the textureCompressionBC device feature.
+bool vkSupportsSampledFormat(VkPhysicalDevice physicalDevice,
+                             VkFormat format);
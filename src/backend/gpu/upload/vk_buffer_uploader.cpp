@@ -1,18 +1,24 @@
 #include "vk_buffer_uploader.hpp"
 
 #include "backend/gpu/upload/vk_upload_context.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/logging/log.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <iostream>
+#include <vector>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Backend.Upload.Buffer");
+#define LOG_TU_LOGGER() ThisLogger()
+
 bool VkBufferUploader::init(VmaAllocator allocator, VkUploadContext *upload,
                             UploadProfiler *profiler) {
   if (allocator == nullptr || upload == nullptr) {
-    std::cerr << "[Uploader] Invalid init args\n";
+    LOGE("Invalid init args");
     return false;
   }
 
@@ -32,21 +38,30 @@ void VkBufferUploader::shutdown() noexcept {
 bool VkBufferUploader::uploadToDeviceLocalBuffer(const void *data,
                                                  VkDeviceSize size,
                                                  VkBufferUsageFlags finalUsage,
-                                                 VkBufferObj &outBuffer) {
+                                                 VkBufferObj &outBuffer,
+                                                 VkStreamHandle *outStream) {
   if (m_allocator == nullptr || m_upload == nullptr) {
-    std::cerr << "[Uploader] Not initialized\n";
+    LOGE("Not initialized");
     return false;
   }
 
   if (data == nullptr || size == 0) {
-    std::cerr << "[Uploader] Invalid data or size\n";
+    LOGE("Invalid data or size");
     return false;
   }
 
+  if (outStream != nullptr) {
+    *outStream = {};
+  }
+
   VkStagingAlloc stageAlloc = m_upload->allocStaging(size);
   if (!stageAlloc) {
-    std::cerr << "[Uploader] Out of staging space (increase per-frame budget "
-                 "or flush earlier)\n";
+    if (outStream != nullptr) {
+      return streamToDeviceLocalBuffer(data, size, finalUsage, outBuffer,
+                                       *outStream);
+    }
+
+    LOGE("Out of staging space (increase per-frame budget or flush earlier)");
     return false;
   }
 
@@ -61,8 +76,9 @@ bool VkBufferUploader::uploadToDeviceLocalBuffer(const void *data,
   outBuffer.shutdown();
   if (!outBuffer.init(m_allocator, size,
                       finalUsage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                      VkBufferObj::MemUsage::GpuOnly)) {
-    std::cerr << "[Uploader] Failed to create device-local buffer\n";
+                      VkBufferObj::MemUsage::GpuOnly, /*mapped=*/false,
+                      profiling::MemoryTag::Mesh)) {
+    LOGE("Failed to create device-local buffer");
     return false;
   }
 
@@ -80,3 +96,34 @@ bool VkBufferUploader::uploadToDeviceLocalBuffer(const void *data,
 
   return true;
 }
+
+bool VkBufferUploader::streamToDeviceLocalBuffer(const void *data,
+                                                 VkDeviceSize size,
+                                                 VkBufferUsageFlags finalUsage,
+                                                 VkBufferObj &outBuffer,
+                                                 VkStreamHandle &outStream) {
+  outBuffer.shutdown();
+  if (!outBuffer.init(m_allocator, size,
+                      finalUsage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                      VkBufferObj::MemUsage::GpuOnly, /*mapped=*/false,
+                      profiling::MemoryTag::Mesh)) {
+    LOGE("Failed to create device-local buffer");
+    return false;
+  }
+
+  if (m_profiler != nullptr) {
+    profilerAdd(m_profiler, UploadProfiler::Stat::BufferAllocatedBytes, size);
+  }
+
+  // The caller's data may not outlive this call, the stream keeps a copy
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  outStream = m_upload->streamToBuffer(
+      outBuffer.handle(), /*dstOffset=*/0,
+      std::vector<uint8_t>(bytes, bytes + static_cast<size_t>(size)));
+  if (outStream.id == UINT32_MAX) {
+    outBuffer.shutdown();
+    return false;
+  }
+
+  return true;
+}
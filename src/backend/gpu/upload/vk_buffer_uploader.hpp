@@ -15,11 +15,29 @@ public:
             UploadProfiler *profiler);
   void shutdown() noexcept;
 
+  // With outStream set, data that does not fit the current staging slice
+  // is streamed over the next frames instead of failing: outBuffer is
+  // created right away but must not be used before streamDone(*outStream).
+  // outStream is left invalid when the copy was recorded directly.
   bool uploadToDeviceLocalBuffer(const void *data, VkDeviceSize size,
                                  VkBufferUsageFlags finalUsage,
-                                 VkBufferObj &outBuffer);
+                                 VkBufferObj &outBuffer,
+                                 VkStreamHandle *outStream = nullptr);
+  [[nodiscard]] bool streamDone(VkStreamHandle stream) const noexcept {
+    return m_upload != nullptr && m_upload->streamDone(stream);
+  }
+  void cancelStream(VkStreamHandle stream) noexcept {
+    if (m_upload != nullptr) {
+      m_upload->cancelStream(stream);
+    }
+  }
 
 private:
+  bool streamToDeviceLocalBuffer(const void *data, VkDeviceSize size,
+                                 VkBufferUsageFlags finalUsage,
+                                 VkBufferObj &outBuffer,
+                                 VkStreamHandle &outStream);
+
   VmaAllocator m_allocator = nullptr;   // non-owning
   VkUploadContext *m_upload = nullptr;  // non-owning
   UploadProfiler *m_profiler = nullptr; // non-owning
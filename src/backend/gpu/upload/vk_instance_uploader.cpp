@@ -1,11 +1,14 @@
 #include "backend/gpu/upload/vk_instance_uploader.hpp"
 
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/logging/log.hpp"
 
 #include <glm/ext/matrix_float4x4.hpp>
-#include <iostream>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Backend.Upload.Instance");
+#define LOG_TU_LOGGER() ThisLogger()
+
 InstanceUploadResult VkInstanceUploader::uploadMat4Instances(
     VkBuffer instanceBuffer, VkDeviceSize frameBaseBytes,
     VkDeviceSize frameStrideBytes, uint32_t maxInstancesPerFrame,
@@ -22,7 +25,7 @@ InstanceUploadResult VkInstanceUploader::uploadMat4Instances(
   const uint32_t count = static_cast<uint32_t>(models.size());
   if (cursorInstances + count > maxInstancesPerFrame) {
     // TODO: split batch
-    std::cerr << "[InstanceUploader] Instance budget exceeded for frame\n";
+    LOGE("Instance budget exceeded for frame");
     return out;
   }
 
@@ -31,13 +34,13 @@ InstanceUploadResult VkInstanceUploader::uploadMat4Instances(
   const VkDeviceSize endBytes =
       VkDeviceSize(cursorInstances + count) * sizeof(glm::mat4);
   if (endBytes > frameStrideBytes) {
-    std::cerr << "[InstanceUploader] exceeds SSBO descriptor range\n";
+    LOGE("Instances exceed SSBO descriptor range");
     return out;
   }
 
   VkStagingAlloc stageAlloc = m_upload->allocStaging(bytes, /*alignment*/ 16);
   if (!stageAlloc) {
-    std::cerr << "[InstanceUploader] allocStaging failed for instances\n";
+    LOGE("allocStaging failed for instances");
     return out;
   }
 
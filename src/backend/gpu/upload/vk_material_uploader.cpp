@@ -3,12 +3,15 @@
 #include "backend/gpu/upload/vk_upload_context.hpp"
 #include "backend/profiling/upload_profiler.hpp"
 #include "render/resources/material_gpu.hpp"
+#include "engine/logging/log.hpp"
 
 #include <cstdint>
 #include <cstring>
-#include <iostream>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Backend.Upload.Material");
+#define LOG_TU_LOGGER() ThisLogger()
+
 bool VkMaterialUploader::uploadOne(VkBuffer materialBuffer,
                                    VkDeviceSize dstOffsetBytes,
                                    const MaterialGPU &material) {
@@ -20,7 +23,7 @@ bool VkMaterialUploader::uploadOne(VkBuffer materialBuffer,
 
   VkStagingAlloc stage = m_upload->allocStaging(bytes, /*alignment=*/16);
   if (!stage) {
-    std::cerr << "[MaterialUploader] allocStaging failed\n";
+    LOGE("allocStaging failed");
     return false;
   }
 
@@ -3,22 +3,28 @@
 #include "backend/gpu/textures/vk_texture.hpp"
 #include "backend/gpu/textures/vk_texture_utils.hpp"
 #include "backend/gpu/upload/vk_upload_context.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/logging/log.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <iostream>
+#include <span>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Backend.Upload.Texture");
+#define LOG_TU_LOGGER() ThisLogger()
+
 // TODO take in backend ctx
 bool VkTextureUploader::init(VmaAllocator allocator, VkDevice device,
                              VkUploadContext *upload,
                              UploadProfiler *profiler) {
   if (allocator == nullptr || device == VK_NULL_HANDLE ||
       upload == VK_NULL_HANDLE) {
-    std::cerr << "[TextureUpload] Invalid init args\n";
+    LOGE("Invalid init args");
     return false;
   }
 
@@ -31,79 +37,231 @@ bool VkTextureUploader::init(VmaAllocator allocator, VkDevice device,
 }
 
 void VkTextureUploader::shutdown() noexcept {
+  m_maxAnisotropy = 1.0F;
   m_allocator = nullptr;
   m_device = VK_NULL_HANDLE;
   m_upload = nullptr;
   m_profiler = nullptr;
 }
 
-bool VkTextureUploader::uploadRGBA8(const void *rgbaPixels, uint32_t width,
-                                    uint32_t height, VkTexture2D &out) {
-  if (m_allocator == nullptr || m_upload == nullptr) {
-    std::cerr << "[TextureUpload] Not initialized\n";
+bool VkTextureUploader::create(uint32_t width, uint32_t height,
+                               uint32_t mipLevels, VkFormat format,
+                               VkTexture2D &out) {
+  if (m_allocator == nullptr || m_device == VK_NULL_HANDLE) {
+    LOGE("Not initialized");
     return false;
   }
 
-  if (rgbaPixels == nullptr || width == 0 || height == 0) {
-    std::cerr << "[TextureUpload] Invalid pixels/size\n";
+  if (width == 0 || height == 0 || mipLevels == 0) {
+    LOGE("Invalid size/mip levels");
     return false;
   }
 
-  const VkDeviceSize size = static_cast<VkDeviceSize>(width) *
-                            static_cast<VkDeviceSize>(height) * 4ULL;
-
-  VkStagingAlloc stageAlloc = m_upload->allocStaging(size, /*alignment=*/16);
-  if (!stageAlloc) {
-    std::cerr
-        << "[TextureUpload] Out of staging space (increase per-frame budget "
-           "or flush earlier)\n";
+  if (textureFormatBlockBytes(format) == 0) {
+    LOGE("Unsupported texture format {}", static_cast<int>(format));
     return false;
   }
 
-  std::memcpy(stageAlloc.ptr, rgbaPixels, static_cast<size_t>(size));
-
-  if (m_profiler != nullptr) {
-    profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyCount, 1);
-    profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyBytes, size);
-  }
-
   out.shutdown();
 
-  // TODO: check for VK_FORMAT_R8G8B8A8_UNORM
   // TODO: move to images/
-  if (!out.image.init2D(m_allocator, width, height, VK_FORMAT_R8G8B8A8_SRGB,
+  // TRANSFER_SRC so resident mips can be copied when residency changes
+  if (!out.image.init2D(m_allocator, width, height, format,
                         VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                            VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
                             VK_IMAGE_USAGE_SAMPLED_BIT,
-                        VK_IMAGE_TILING_OPTIMAL)) {
-    std::cerr << "[TextureUpload] Failed to create device-local image\n";
+                        VK_IMAGE_TILING_OPTIMAL, mipLevels,
+                        profiling::MemoryTag::Texture)) {
+    LOGE("Failed to create device-local image");
     return false;
   }
 
   if (m_profiler != nullptr) {
-    profilerAdd(m_profiler, UploadProfiler::Stat::TextureAllocatedBytes, size);
+    VkDeviceSize bytes = 0;
+    for (uint32_t mip = 0; mip < mipLevels; ++mip) {
+      bytes += textureLevelBytes(format, std::max(1U, width >> mip),
+                                 std::max(1U, height >> mip));
+    }
+
+    profilerAdd(m_profiler, UploadProfiler::Stat::TextureAllocatedBytes, bytes);
+  }
+
+  out.device = m_device;
+
+  if (!vkCreateTextureView(m_device, out.image.handle(), format, out.view,
+                           mipLevels)) {
+    out.shutdown();
+    return false;
+  }
+
+  if (!vkCreateTextureSampler(m_device, out.sampler,
+                              static_cast<float>(mipLevels),
+                              m_maxAnisotropy)) {
+    out.shutdown();
+    return false;
+  }
+
+  return true;
+}
+
+bool VkTextureUploader::uploadMips(std::span<const uint8_t *const> levels,
+                                   uint32_t baseMip, VkTexture2D &tex) {
+  if (m_upload == nullptr) {
+    LOGE("Not initialized");
+    return false;
+  }
+
+  const auto mipCount = static_cast<uint32_t>(levels.size());
+  if (!tex.image.valid() || mipCount == 0 ||
+      baseMip + mipCount > tex.image.mipLevels() ||
+      std::ranges::find(levels, nullptr) != levels.end()) {
+    LOGE("Invalid data/mip range");
+    return false;
+  }
+
+  const VkFormat format = tex.image.format();
+  const uint32_t width = tex.image.width();
+  const uint32_t height = tex.image.height();
+
+  VkDeviceSize size = 0;
+  for (uint32_t mip = baseMip; mip < baseMip + mipCount; ++mip) {
+    size += textureLevelBytes(format, std::max(1U, width >> mip),
+                              std::max(1U, height >> mip));
+  }
+
+  VkStagingAlloc stageAlloc = m_upload->allocStaging(size, /*alignment=*/16);
+  if (!stageAlloc) {
+    LOGE("Out of staging space (increase per-frame budget or flush earlier)");
+    return false;
+  }
+
+  // Sources may be a file mapping, levels go straight into staging
+  auto *dst = static_cast<uint8_t *>(stageAlloc.ptr);
+  for (uint32_t i = 0; i < mipCount; ++i) {
+    const uint32_t mip = baseMip + i;
+    const VkDeviceSize bytes = textureLevelBytes(
+        format, std::max(1U, width >> mip), std::max(1U, height >> mip));
+    std::memcpy(dst, levels[i], static_cast<size_t>(bytes));
+    dst += bytes;
+  }
+
+  if (m_profiler != nullptr) {
+    profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyCount,
+                mipCount);
+    profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyBytes, size);
   }
 
-  m_upload->cmdUploadRGBA8ToImage(out.image.handle(), width, height,
-                                  stageAlloc.offset,
-                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  m_upload->cmdUploadMipsToImage(tex.image.handle(), format, width, height,
+                                 baseMip, mipCount, stageAlloc.offset,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
   if (m_profiler != nullptr) {
     profilerAdd(m_profiler, UploadProfiler::Stat::TextureUploadCount, 1);
     profilerAdd(m_profiler, UploadProfiler::Stat::TextureUploadBytes, size);
   }
 
-  out.device = m_device;
+  return true;
+}
 
-  if (!vkCreateTextureView(m_device, out.image.handle(),
-                           VK_FORMAT_R8G8B8A8_SRGB, out.view)) {
-    out.shutdown();
+VkStreamHandle
+VkTextureUploader::streamMips(std::span<const uint8_t *const> levels,
+                              uint32_t baseMip, VkTexture2D &tex) {
+  if (m_upload == nullptr) {
+    LOGE("Not initialized");
+    return {};
+  }
+
+  if (!tex.image.valid() ||
+      baseMip + levels.size() > tex.image.mipLevels()) {
+    LOGE("Invalid stream mip range");
+    return {};
+  }
+
+  return m_upload->streamToImage(tex.image.handle(), tex.image.format(),
+                                 tex.image.width(), tex.image.height(),
+                                 baseMip, levels);
+}
+
+bool VkTextureUploader::streamDone(VkStreamHandle stream) const noexcept {
+  return m_upload != nullptr && m_upload->streamDone(stream);
+}
+
+void VkTextureUploader::cancelStream(VkStreamHandle stream) noexcept {
+  if (m_upload != nullptr) {
+    m_upload->cancelStream(stream);
+  }
+}
+
+void VkTextureUploader::copyMips(const VkTexture2D &src, uint32_t srcBaseMip,
+                                 VkTexture2D &dst, uint32_t dstBaseMip,
+                                 uint32_t mipCount) {
+  if (m_upload == nullptr || !src.image.valid() || !dst.image.valid()) {
+    return;
+  }
+
+  m_upload->cmdCopyImageMips(src.image.handle(), srcBaseMip, dst.image.handle(),
+                             dstBaseMip, mipCount, dst.image.width(),
+                             dst.image.height());
+}
+
+bool VkTextureUploader::uploadRGBA8(const void *rgbaPixels, uint32_t width,
+                                    uint32_t height, VkTexture2D &out,
+                                    bool generateMips) {
+  if (m_upload == nullptr) {
+    LOGE("Not initialized");
     return false;
   }
 
-  if (!vkCreateTextureSampler(m_device, out.sampler)) {
-    out.shutdown();
+  if (rgbaPixels == nullptr || width == 0 || height == 0) {
+    LOGE("Invalid pixels/size");
     return false;
   }
 
+  uint32_t mipLevels = 1;
+  if (generateMips) {
+    if (m_upload->supportsLinearBlit(VK_FORMAT_R8G8B8A8_SRGB)) {
+      mipLevels = textureMipCount(width, height);
+    } else {
+      LOGW("Linear blit unsupported, uploading without mips");
+    }
+  }
+
+  const VkDeviceSize size = static_cast<VkDeviceSize>(width) *
+                            static_cast<VkDeviceSize>(height) * 4ULL;
+
+  VkStagingAlloc stageAlloc = m_upload->allocStaging(size, /*alignment=*/16);
+  if (!stageAlloc) {
+    LOGE("Out of staging space (increase per-frame budget or flush earlier)");
+    return false;
+  }
+
+  std::memcpy(stageAlloc.ptr, rgbaPixels, static_cast<size_t>(size));
+
+  if (m_profiler != nullptr) {
+    profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyCount, 1);
+    profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyBytes, size);
+  }
+
+  if (!create(width, height, mipLevels, VK_FORMAT_R8G8B8A8_SRGB, out)) {
+    return false;
+  }
+
+  if (mipLevels > 1) {
+    m_upload->cmdUploadMipsToImage(out.image.handle(), VK_FORMAT_R8G8B8A8_SRGB,
+                                   width, height, 0, 1, stageAlloc.offset,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    m_upload->cmdGenerateMipsBlit(out.image.handle(), width, height,
+                                  mipLevels);
+  } else {
+    m_upload->cmdUploadMipsToImage(out.image.handle(), VK_FORMAT_R8G8B8A8_SRGB,
+                                   width, height, 0, 1, stageAlloc.offset,
+                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+
+  if (m_profiler != nullptr) {
+    profilerAdd(m_profiler, UploadProfiler::Stat::TextureUploadCount, 1);
+    profilerAdd(m_profiler, UploadProfiler::Stat::TextureUploadBytes, size);
+  }
+
   return true;
 }
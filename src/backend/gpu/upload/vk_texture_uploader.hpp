@@ -1,12 +1,13 @@
 #pragma once
 
 #include "backend/gpu/textures/vk_texture.hpp"
+#include "backend/gpu/upload/vk_upload_context.hpp"
 
-class VkUploadContext;
 class VkCommands;
 class UploadProfiler;
 
 #include <cstdint>
+#include <span>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan_core.h>
 
@@ -16,8 +17,35 @@ public:
             UploadProfiler *profiler);
   void shutdown() noexcept;
 
+  // generateMips builds the chain on the GPU with blits when the format
+  // supports it; prefer uploadMips with a CPU-built chain
   bool uploadRGBA8(const void *rgbaPixels, uint32_t width, uint32_t height,
-                   VkTexture2D &out);
+                   VkTexture2D &out, bool generateMips = false);
+
+  // Create an empty sampled texture with mipLevels levels of format. Levels
+  // must be filled by uploadMips/copyMips before the texture is sampled.
+  // Check format support with vkSupportsSampledFormat first.
+  bool create(uint32_t width, uint32_t height, uint32_t mipLevels,
+              VkFormat format, VkTexture2D &out);
+  // levels[i] holds mip baseMip + i in the texture's format. Sources need
+  // not be contiguous, each level is copied directly into staging.
+  bool uploadMips(std::span<const uint8_t *const> levels, uint32_t baseMip,
+                  VkTexture2D &tex);
+  // uploadMips for levels that do not fit one staging slice: they are
+  // copied over the next frames and tex must not be sampled before
+  // streamDone(). The level data must stay alive until then.
+  VkStreamHandle streamMips(std::span<const uint8_t *const> levels,
+                            uint32_t baseMip, VkTexture2D &tex);
+  [[nodiscard]] bool streamDone(VkStreamHandle stream) const noexcept;
+  void cancelStream(VkStreamHandle stream) noexcept;
+
+  void copyMips(const VkTexture2D &src, uint32_t srcBaseMip, VkTexture2D &dst,
+                uint32_t dstBaseMip, uint32_t mipCount);
+
+  // Applies to textures created afterwards; 1 disables anisotropy
+  void setMaxAnisotropy(float maxAnisotropy) noexcept {
+    m_maxAnisotropy = maxAnisotropy;
+  }
 
 private:
   VmaAllocator m_allocator = nullptr; // non-owning
@@ -26,4 +54,6 @@ private:
   VkUploadContext *m_upload = nullptr;  // non-owning
   VkCommands *m_commands = nullptr;     // non-owning
   UploadProfiler *m_profiler = nullptr; // non-owning
+
+  float m_maxAnisotropy = 1.0F;
 };
@@ -2,14 +2,34 @@
 
 #include "backend/core/vk_backend_ctx.hpp"
 #include "backend/gpu/buffers/vk_buffer.hpp"
+#include "backend/gpu/textures/vk_texture_utils.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/logging/log.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
-#include <iostream>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Backend.Upload.Context");
+#define LOG_TU_LOGGER() ThisLogger()
+
+// Streams do not take slivers off a nearly full slice
+static constexpr VkDeviceSize kMinStreamChunkBytes = 64ULL * 1024ULL;
+
+// Reserved at init so the first frames record without allocating. Past
+// these the containers grow once and keep the capacity.
+static constexpr size_t kReservedCopyTargets = 16;
+static constexpr size_t kReservedRegions = 64; // per copy target
+static constexpr size_t kReservedBarriers = 16;
+
 template <typename T> static inline void freeArray(T *&p) noexcept {
   std::free(static_cast<void *>(p));
   p = nullptr;
@@ -27,7 +47,7 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
                            VkDeviceSize perFrameBytes,
                            UploadProfiler *profiler) {
   if (perFrameBytes == 0) {
-    std::cerr << "[UploadCtx] Invalid init args\n";
+    LOGE("Invalid init args");
     return false;
   }
 
@@ -37,6 +57,18 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
   m_framesInFlight = framesInflight;
   m_perFrameBytes = perFrameBytes;
   m_profiler = profiler;
+  m_sync2 = ctx.synchronization2Enabled();
+
+  m_pendingCopies.resize(kReservedCopyTargets);
+  for (PendingCopies &copies : m_pendingCopies) {
+    copies.regions.reserve(kReservedRegions);
+  }
+  m_pendingBarriers.reserve(kReservedBarriers);
+  if (m_sync2) {
+    m_barriers2.reserve(kReservedBarriers);
+  } else {
+    m_barriers.reserve(kReservedBarriers);
+  }
 
   // Query device limits for alignment
   VkPhysicalDeviceProperties props{};
@@ -57,8 +89,9 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
 
   if (!m_staging.init(m_ctx->allocator(), totalBytes,
                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                      VkBufferObj::MemUsage::CpuToGpu, /*mapped*/ true)) {
-    std::cerr << "[UploadCtx] Failed to create staging buffer\n";
+                      VkBufferObj::MemUsage::CpuToGpu, /*mapped*/ true,
+                      profiling::MemoryTag::Staging)) {
+    LOGE("Failed to create staging buffer");
     shutdown();
     return false;
   }
@@ -74,7 +107,7 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
     VkResult res =
         vmaMapMemory(m_ctx->allocator(), m_staging.allocation(), &mapped);
     if (res != VK_SUCCESS || mapped == nullptr) {
-      std::cerr << "[UploadCtx] vmaMapMemory staging failed: " << res << "\n";
+      LOGE("vmaMapMemory staging failed: {}", static_cast<int>(res));
       shutdown();
       return false;
     }
@@ -91,7 +124,7 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
     VkResult res = vkCreateCommandPool(m_ctx->device(), &cmdPoolInfo, nullptr,
                                        &m_pools[i]);
     if (res != VK_SUCCESS) {
-      std::cerr << "[UploadCtx] vkCreateComandPool failed: " << res << "\n";
+      LOGE("vkCreateComandPool failed: {}", static_cast<int>(res));
       shutdown();
       return false;
     }
@@ -104,8 +137,7 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
 
     res = vkAllocateCommandBuffers(m_ctx->device(), &cmdAllocInfo, &m_cmds[i]);
     if (res != VK_SUCCESS) {
-      std::cerr << "[UploadCtx] vkAllocateCommandBuffers failed: " << res
-                << "\n";
+      LOGE("vkAllocateCommandBuffers failed: {}", static_cast<int>(res));
       shutdown();
       return false;
     }
@@ -116,7 +148,7 @@ bool VkUploadContext::init(VkBackendCtx &ctx, uint32_t framesInflight,
 
     res = vkCreateFence(m_ctx->device(), &fenceInfo, nullptr, &m_fences[i]);
     if (res != VK_SUCCESS) {
-      std::cerr << "[UploadCtx] vkCreateFence failed: " << res << "\n";
+      LOGE("vkCreateFence failed: {}", static_cast<int>(res));
       shutdown();
       return false;
     }
@@ -191,6 +223,16 @@ void VkUploadContext::shutdown() noexcept {
   m_sliceBase = 0;
   m_sliceHead = 0;
   m_recording = false;
+
+  m_streams.clear();
+  m_nextStream = 0;
+
+  m_pendingCopies.clear();
+  m_activeCopies = 0;
+  m_pendingBarriers.clear();
+  m_barriers2.clear();
+  m_barriers.clear();
+  m_sync2 = false;
 }
 
 bool VkUploadContext::beginCmd() {
@@ -201,7 +243,7 @@ bool VkUploadContext::beginCmd() {
 
   VkResult res = vkBeginCommandBuffer(m_cmd, &bufBeginInfo);
   if (res != VK_SUCCESS) {
-    std::cerr << "[UploadCtx] vkBeginCommandBuffer failed: " << res << "\n";
+    LOGE("vkBeginCommandBuffer failed: {}", static_cast<int>(res));
     return false;
   }
 
@@ -211,7 +253,7 @@ bool VkUploadContext::beginCmd() {
 bool VkUploadContext::endCmd() {
   VkResult res = vkEndCommandBuffer(m_cmd);
   if (res != VK_SUCCESS) {
-    std::cerr << "[UploadCtx] vkEndCommandBuffer failed: " << res << "\n";
+    LOGE("vkEndCommandBuffer failed: {}", static_cast<int>(res));
     return false;
   }
 
@@ -220,12 +262,12 @@ bool VkUploadContext::endCmd() {
 
 bool VkUploadContext::beginFrame(uint32_t frameIndex) {
   if (m_ctx == nullptr || m_pools == VK_NULL_HANDLE || m_fences == nullptr) {
-    std::cerr << "[UploadCtx] beginFrame invalid state\n";
+    LOGE("beginFrame invalid state");
     return false;
   }
 
   if (frameIndex >= m_framesInFlight) {
-    std::cerr << "[UploadCtx] beginFrame frameIndex out of range\n";
+    LOGE("beginFrame frameIndex out of range");
     return false;
   }
 
@@ -239,7 +281,7 @@ bool VkUploadContext::beginFrame(uint32_t frameIndex) {
   VkResult res =
       vkWaitForFences(m_ctx->device(), 1, &fence, VK_TRUE, UINT64_MAX);
   if (res != VK_SUCCESS) {
-    std::cerr << "[UploadCtx] vkWaitForFences failed: " << res << "\n";
+    LOGE("vkWaitForFences failed: {}", static_cast<int>(res));
     return false;
   }
 
@@ -296,18 +338,161 @@ void VkUploadContext::cmdCopyToBuffer(VkBuffer dst, VkDeviceSize dstOffset,
 
   m_hadWork = true;
 
+  PendingCopies *copies = nullptr;
+  for (size_t i = 0; i < m_activeCopies; ++i) {
+    if (m_pendingCopies[i].dst == dst) {
+      copies = &m_pendingCopies[i];
+      break;
+    }
+  }
+  if (copies == nullptr) {
+    copies = &pushCopyTarget(dst);
+  }
+
+  // Regions of one vkCmdCopyBuffer must not overlap, a rewrite of a range
+  // already queued this frame goes after the earlier copies
+  const bool overlaps =
+      std::ranges::any_of(copies->regions, [&](const VkBufferCopy &region) {
+        return dstOffset < region.dstOffset + region.size &&
+               region.dstOffset < dstOffset + size;
+      });
+  if (overlaps) {
+    recordPendingCopies();
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(m_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+
+    copies = &pushCopyTarget(dst);
+  }
+
+  // Back to back uploads, such as instance batches, become one region
+  if (!copies->regions.empty()) {
+    VkBufferCopy &last = copies->regions.back();
+    if (last.srcOffset + last.size == srcOffset &&
+        last.dstOffset + last.size == dstOffset) {
+      last.size += size;
+      return;
+    }
+  }
+
   VkBufferCopy copy{};
   copy.srcOffset = srcOffset;
   copy.dstOffset = dstOffset;
   copy.size = size;
-  vkCmdCopyBuffer(m_cmd, m_staging.handle(), dst, 1, &copy);
+  copies->regions.push_back(copy);
+}
+
+VkUploadContext::PendingCopies &VkUploadContext::pushCopyTarget(VkBuffer dst) {
+  // Entries past m_activeCopies are kept with their region capacity, so
+  // steady state frames queue copies without touching the heap
+  if (m_activeCopies == m_pendingCopies.size()) {
+    m_pendingCopies.emplace_back().regions.reserve(kReservedRegions);
+  }
+
+  PendingCopies &copies = m_pendingCopies[m_activeCopies++];
+  copies.dst = dst;
+  copies.regions.clear();
+  return copies;
+}
+
+void VkUploadContext::recordPendingCopies() {
+  for (size_t i = 0; i < m_activeCopies; ++i) {
+    const PendingCopies &copies = m_pendingCopies[i];
+    vkCmdCopyBuffer(m_cmd, m_staging.handle(), copies.dst,
+                    static_cast<uint32_t>(copies.regions.size()),
+                    copies.regions.data());
+  }
+
+  m_activeCopies = 0;
+}
+
+void VkUploadContext::queueBufferBarrier(VkBuffer buffer, VkDeviceSize offset,
+                                         VkDeviceSize size,
+                                         VkPipelineStageFlags2 dstStage) {
+  const VkDeviceSize end =
+      size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : offset + size;
+
+  for (PendingBarrier &barrier : m_pendingBarriers) {
+    if (barrier.buffer == buffer && barrier.dstStage == dstStage) {
+      barrier.begin = std::min(barrier.begin, offset);
+      barrier.end = std::max(barrier.end, end);
+      return;
+    }
+  }
+
+  m_pendingBarriers.push_back(PendingBarrier{
+      .buffer = buffer, .dstStage = dstStage, .begin = offset, .end = end});
+}
+
+void VkUploadContext::recordPendingBarriers() {
+  if (m_pendingBarriers.empty()) {
+    return;
+  }
+
+  const auto count = static_cast<uint32_t>(m_pendingBarriers.size());
+
+  if (m_sync2) {
+    m_barriers2.assign(count, VkBufferMemoryBarrier2{});
+    for (uint32_t i = 0; i < count; ++i) {
+      const PendingBarrier &pending = m_pendingBarriers[i];
+      VkBufferMemoryBarrier2 &barrier = m_barriers2[i];
+      barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+      barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+      barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+      barrier.dstStageMask = pending.dstStage;
+      barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.buffer = pending.buffer;
+      barrier.offset = pending.begin;
+      barrier.size = pending.end == VK_WHOLE_SIZE
+                         ? VK_WHOLE_SIZE
+                         : pending.end - pending.begin;
+    }
+
+    VkDependencyInfo dependency{};
+    dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.bufferMemoryBarrierCount = count;
+    dependency.pBufferMemoryBarriers = m_barriers2.data();
+    vkCmdPipelineBarrier2(m_cmd, &dependency);
+  } else {
+    // Still one call, with the union of the destination stages
+    m_barriers.assign(count, VkBufferMemoryBarrier{});
+    VkPipelineStageFlags dstStages = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      const PendingBarrier &pending = m_pendingBarriers[i];
+      VkBufferMemoryBarrier &barrier = m_barriers[i];
+      barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.buffer = pending.buffer;
+      barrier.offset = pending.begin;
+      barrier.size = pending.end == VK_WHOLE_SIZE
+                         ? VK_WHOLE_SIZE
+                         : pending.end - pending.begin;
+
+      // Shader stage bits match between the two flag types
+      dstStages |= static_cast<VkPipelineStageFlags>(pending.dstStage);
+    }
+
+    vkCmdPipelineBarrier(m_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0,
+                         0, nullptr, count, m_barriers.data(), 0, nullptr);
+  }
+
+  m_pendingBarriers.clear();
 }
 
-static VkImageMemoryBarrier makeImageBarrier(VkImage image,
-                                             VkImageLayout oldLayout,
-                                             VkImageLayout newLayout,
-                                             VkAccessFlags srcAccess,
-                                             VkAccessFlags dstAccess) {
+static VkImageMemoryBarrier
+makeImageBarrier(VkImage image, uint32_t baseMip, uint32_t levelCount,
+                 VkImageLayout oldLayout, VkImageLayout newLayout,
+                 VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
   VkImageMemoryBarrier imageBarrier{};
   imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
   imageBarrier.oldLayout = oldLayout;
@@ -316,8 +501,8 @@ static VkImageMemoryBarrier makeImageBarrier(VkImage image,
   imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   imageBarrier.image = image;
   imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  imageBarrier.subresourceRange.baseMipLevel = 0;
-  imageBarrier.subresourceRange.levelCount = 1;
+  imageBarrier.subresourceRange.baseMipLevel = baseMip;
+  imageBarrier.subresourceRange.levelCount = levelCount;
   imageBarrier.subresourceRange.baseArrayLayer = 0;
   imageBarrier.subresourceRange.layerCount = 1;
   imageBarrier.srcAccessMask = srcAccess;
@@ -326,27 +511,14 @@ static VkImageMemoryBarrier makeImageBarrier(VkImage image,
   return imageBarrier;
 }
 
-// TODO: generalize to include frag and vertex to cut down on copy
-// code
 void VkUploadContext::cmdBarrierBufferTransferToVertexShader(
     VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size) {
   if (!m_recording) {
     return;
   }
 
-  VkBufferMemoryBarrier bufBarrier{};
-  bufBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-  bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  bufBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  bufBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  bufBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  bufBarrier.buffer = buffer;
-  bufBarrier.offset = offset;
-  bufBarrier.size = size;
-
-  vkCmdPipelineBarrier(m_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 0, nullptr, 1,
-                       &bufBarrier, 0, nullptr);
+  queueBufferBarrier(buffer, offset, size,
+                     VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
 }
 
 void VkUploadContext::cmdBarrierBufferTransferToFragmentShader(
@@ -355,22 +527,13 @@ void VkUploadContext::cmdBarrierBufferTransferToFragmentShader(
     return;
   }
 
-  VkBufferMemoryBarrier bufBarrier{};
-  bufBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-  bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  bufBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  bufBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  bufBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  bufBarrier.buffer = buffer;
-  bufBarrier.offset = offset;
-  bufBarrier.size = size;
-
-  vkCmdPipelineBarrier(m_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 1,
-                       &bufBarrier, 0, nullptr);
+  queueBufferBarrier(buffer, offset, size,
+                     VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
 }
 
-void VkUploadContext::transitionImage(VkImage image, VkImageLayout oldLayout,
+void VkUploadContext::transitionImage(VkImage image, uint32_t baseMip,
+                                      uint32_t levelCount,
+                                      VkImageLayout oldLayout,
                                       VkImageLayout newLayout) {
   VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
   VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
@@ -389,44 +552,394 @@ void VkUploadContext::transitionImage(VkImage image, VkImageLayout oldLayout,
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     srcAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
     dstAccess = VK_ACCESS_SHADER_READ_BIT;
+  } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
+             newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+    srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    srcAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+    dstAccess = VK_ACCESS_TRANSFER_READ_BIT;
+  } else if (oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
+             newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+    // Previously submitted frames may still be sampling it
+    srcStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    srcAccess = 0;
+    dstAccess = VK_ACCESS_TRANSFER_READ_BIT;
+  } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL &&
+             newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+    srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    srcAccess = 0;
+    dstAccess = VK_ACCESS_SHADER_READ_BIT;
   } else {
-    std::cerr << "[UploadCtx] Unsupported layout transition " << oldLayout
-              << " -> " << newLayout << "\n";
+    LOGE("Unsupported layout transition {} -> {}", static_cast<int>(oldLayout),
+         static_cast<int>(newLayout));
     return;
   }
 
-  VkImageMemoryBarrier barrier =
-      makeImageBarrier(image, oldLayout, newLayout, srcAccess, dstAccess);
+  VkImageMemoryBarrier barrier = makeImageBarrier(
+      image, baseMip, levelCount, oldLayout, newLayout, srcAccess, dstAccess);
   vkCmdPipelineBarrier(m_cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1,
                        &barrier);
 }
 
-void VkUploadContext::cmdUploadRGBA8ToImage(VkImage image, uint32_t width,
-                                            uint32_t height,
-                                            VkDeviceSize srcOffset,
-                                            VkImageLayout finalLayout) {
-  if (!m_recording) {
+void VkUploadContext::cmdUploadMipsToImage(VkImage image, VkFormat format,
+                                           uint32_t width, uint32_t height,
+                                           uint32_t baseMip, uint32_t mipCount,
+                                           VkDeviceSize srcOffset,
+                                           VkImageLayout finalLayout) {
+  if (!m_recording || mipCount == 0) {
     return;
   }
 
-  transitionImage(image, VK_IMAGE_LAYOUT_UNDEFINED,
-                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+  if (mipCount > kMaxMipLevels) {
+    LOGE("Too many mip levels in one upload: {}", mipCount);
+    return;
+  }
+
+  m_hadWork = true;
+
+  std::array<VkBufferImageCopy, kMaxMipLevels> regions{};
+  VkDeviceSize offset = srcOffset;
+  for (uint32_t i = 0; i < mipCount; ++i) {
+    const uint32_t mip = baseMip + i;
+    const uint32_t mipWidth = std::max(1U, width >> mip);
+    const uint32_t mipHeight = std::max(1U, height >> mip);
+
+    VkBufferImageCopy &region = regions[i];
+    region.bufferOffset = offset;
+    region.bufferRowLength = 0;   // tightly packed
+    region.bufferImageHeight = 0; // tightly packed
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = mip;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = VkOffset3D{0, 0, 0};
+    region.imageExtent = VkExtent3D{mipWidth, mipHeight, 1U};
+
+    offset += textureLevelBytes(format, mipWidth, mipHeight);
+  }
 
-  VkBufferImageCopy region{};
-  region.bufferOffset = srcOffset;
-  region.bufferRowLength = 0;   // tightly packed
-  region.bufferImageHeight = 0; // tightly packed
-  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = 1;
-  region.imageOffset = VkOffset3D{0, 0, 0};
-  region.imageExtent = VkExtent3D{width, height, 1U};
+  transitionImage(image, baseMip, mipCount, VK_IMAGE_LAYOUT_UNDEFINED,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
   vkCmdCopyBufferToImage(m_cmd, m_staging.handle(), image,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipCount,
+                         regions.data());
 
-  transitionImage(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout);
+  if (finalLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+    transitionImage(image, baseMip, mipCount,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout);
+  }
+}
+
+bool VkUploadContext::supportsLinearBlit(VkFormat format) const {
+  if (m_ctx == nullptr) {
+    return false;
+  }
+
+  VkFormatProperties props{};
+  vkGetPhysicalDeviceFormatProperties(m_ctx->physicalDevice(), format, &props);
+
+  const VkFormatFeatureFlags required =
+      VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+  return (props.optimalTilingFeatures & required) == required;
+}
+
+void VkUploadContext::cmdGenerateMipsBlit(VkImage image, uint32_t width,
+                                          uint32_t height,
+                                          uint32_t mipLevels) {
+  if (!m_recording || mipLevels == 0) {
+    return;
+  }
+
+  m_hadWork = true;
+
+  if (mipLevels > 1) {
+    transitionImage(image, 1, mipLevels - 1, VK_IMAGE_LAYOUT_UNDEFINED,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+  }
+
+  for (uint32_t mip = 1; mip < mipLevels; ++mip) {
+    const int32_t srcW =
+        static_cast<int32_t>(std::max(1U, width >> (mip - 1)));
+    const int32_t srcH =
+        static_cast<int32_t>(std::max(1U, height >> (mip - 1)));
+    const int32_t dstW = static_cast<int32_t>(std::max(1U, width >> mip));
+    const int32_t dstH = static_cast<int32_t>(std::max(1U, height >> mip));
+
+    transitionImage(image, mip - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    VkImageBlit blit{};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.mipLevel = mip - 1;
+    blit.srcSubresource.baseArrayLayer = 0;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[0] = VkOffset3D{0, 0, 0};
+    blit.srcOffsets[1] = VkOffset3D{srcW, srcH, 1};
+    blit.dstSubresource = blit.srcSubresource;
+    blit.dstSubresource.mipLevel = mip;
+    blit.dstOffsets[0] = VkOffset3D{0, 0, 0};
+    blit.dstOffsets[1] = VkOffset3D{dstW, dstH, 1};
+
+    vkCmdBlitImage(m_cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                   VK_FILTER_LINEAR);
+
+    transitionImage(image, mip - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+
+  transitionImage(image, mipLevels - 1, 1,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void VkUploadContext::cmdCopyImageMips(VkImage src, uint32_t srcBaseMip,
+                                       VkImage dst, uint32_t dstBaseMip,
+                                       uint32_t mipCount, uint32_t dstWidth,
+                                       uint32_t dstHeight) {
+  if (!m_recording || mipCount == 0) {
+    return;
+  }
+
+  m_hadWork = true;
+
+  transitionImage(src, srcBaseMip, mipCount,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+  transitionImage(dst, dstBaseMip, mipCount, VK_IMAGE_LAYOUT_UNDEFINED,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+  for (uint32_t i = 0; i < mipCount; ++i) {
+    const uint32_t dstMip = dstBaseMip + i;
+
+    VkImageCopy region{};
+    region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.srcSubresource.mipLevel = srcBaseMip + i;
+    region.srcSubresource.baseArrayLayer = 0;
+    region.srcSubresource.layerCount = 1;
+    region.dstSubresource = region.srcSubresource;
+    region.dstSubresource.mipLevel = dstMip;
+    region.extent = VkExtent3D{std::max(1U, dstWidth >> dstMip),
+                               std::max(1U, dstHeight >> dstMip), 1U};
+
+    vkCmdCopyImage(m_cmd, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+  }
+
+  transitionImage(src, srcBaseMip, mipCount,
+                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  transitionImage(dst, dstBaseMip, mipCount,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+VkDeviceSize
+VkUploadContext::stagingLeft(VkDeviceSize alignment) const noexcept {
+  const VkDeviceSize head =
+      alignUp(m_sliceHead, std::max(alignment, m_bufCopyAlign));
+  return head < m_perFrameBytes ? m_perFrameBytes - head : 0;
+}
+
+VkStreamHandle VkUploadContext::streamToBuffer(VkBuffer dst,
+                                               VkDeviceSize dstOffset,
+                                               std::vector<uint8_t> &&bytes) {
+  if (dst == VK_NULL_HANDLE || bytes.empty()) {
+    LOGE("streamToBuffer invalid args");
+    return {};
+  }
+
+  StreamJob job{};
+  job.id = m_nextStream++;
+  job.buffer = dst;
+  job.dstOffset = dstOffset;
+  job.bytes = std::move(bytes);
+  m_streams.push_back(std::move(job));
+
+  return VkStreamHandle{m_streams.back().id};
+}
+
+VkStreamHandle
+VkUploadContext::streamToImage(VkImage image, VkFormat format, uint32_t width,
+                               uint32_t height, uint32_t baseMip,
+                               std::span<const uint8_t *const> levels) {
+  if (image == VK_NULL_HANDLE || levels.empty() ||
+      levels.size() > kMaxMipLevels ||
+      std::ranges::find(levels, nullptr) != levels.end()) {
+    LOGE("streamToImage invalid args");
+    return {};
+  }
+
+  // A chunk is at least one block row of the largest level
+  const uint32_t blockDim = textureFormatBlockDim(format);
+  const uint32_t mipWidth = std::max(1U, width >> baseMip);
+  const VkDeviceSize rowBytes =
+      VkDeviceSize((mipWidth + blockDim - 1) / blockDim) *
+      textureFormatBlockBytes(format);
+  if (rowBytes > m_perFrameBytes) {
+    LOGE("streamToImage row larger than the slice");
+    return {};
+  }
+
+  StreamJob job{};
+  job.id = m_nextStream++;
+  job.image = image;
+  job.format = format;
+  job.width = width;
+  job.height = height;
+  job.baseMip = baseMip;
+  job.levelCount = static_cast<uint32_t>(levels.size());
+  std::ranges::copy(levels, job.levels.begin());
+  m_streams.push_back(std::move(job));
+
+  return VkStreamHandle{m_streams.back().id};
+}
+
+bool VkUploadContext::streamDone(VkStreamHandle stream) const noexcept {
+  if (stream.id >= m_nextStream) {
+    return false;
+  }
+
+  return std::ranges::none_of(
+      m_streams, [&](const StreamJob &job) { return job.id == stream.id; });
+}
+
+void VkUploadContext::cancelStream(VkStreamHandle stream) noexcept {
+  std::erase_if(m_streams,
+                [&](const StreamJob &job) { return job.id == stream.id; });
+}
+
+void VkUploadContext::pumpStreams() {
+  // Oldest first, so each resource completes as early as possible
+  while (!m_streams.empty()) {
+    StreamJob &job = m_streams.front();
+    const bool finished =
+        job.image != VK_NULL_HANDLE ? pumpImage(job) : pumpBuffer(job);
+    if (!finished) {
+      return; // slice is full
+    }
+
+    m_streams.pop_front();
+  }
+}
+
+bool VkUploadContext::pumpBuffer(StreamJob &job) {
+  const VkDeviceSize total = job.bytes.size();
+
+  while (job.cursor < total) {
+    const VkDeviceSize left = total - job.cursor;
+    const VkDeviceSize chunk = std::min(left, stagingLeft(16));
+    if (chunk < std::min(left, kMinStreamChunkBytes)) {
+      return false;
+    }
+
+    VkStagingAlloc stageAlloc = allocStaging(chunk);
+    if (!stageAlloc) {
+      return false;
+    }
+
+    std::memcpy(stageAlloc.ptr, job.bytes.data() + job.cursor,
+                static_cast<size_t>(chunk));
+    cmdCopyToBuffer(job.buffer, job.dstOffset + job.cursor, stageAlloc.offset,
+                    chunk);
+    job.cursor += chunk;
+
+    if (m_profiler != nullptr) {
+      profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyCount, 1);
+      profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyBytes, chunk);
+      profilerAdd(m_profiler, UploadProfiler::Stat::BufferUploadBytes, chunk);
+    }
+  }
+
+  if (m_profiler != nullptr) {
+    profilerAdd(m_profiler, UploadProfiler::Stat::BufferUploadCount, 1);
+  }
+
+  return true;
+}
+
+bool VkUploadContext::pumpImage(StreamJob &job) {
+  const uint32_t blockDim = textureFormatBlockDim(job.format);
+  const VkDeviceSize blockBytes = textureFormatBlockBytes(job.format);
+
+  if (!job.started) {
+    // Levels stay in TRANSFER_DST_OPTIMAL between frames
+    m_hadWork = true;
+    transitionImage(job.image, job.baseMip, job.levelCount,
+                    VK_IMAGE_LAYOUT_UNDEFINED,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    job.started = true;
+  }
+
+  for (; job.level < job.levelCount; ++job.level, job.cursor = 0) {
+    const uint32_t mip = job.baseMip + job.level;
+    const uint32_t mipWidth = std::max(1U, job.width >> mip);
+    const uint32_t mipHeight = std::max(1U, job.height >> mip);
+    const VkDeviceSize rows = (mipHeight + blockDim - 1) / blockDim;
+    const VkDeviceSize rowBytes =
+        VkDeviceSize((mipWidth + blockDim - 1) / blockDim) * blockBytes;
+
+    while (job.cursor < rows) {
+      const VkDeviceSize fit =
+          std::min(rows - job.cursor, stagingLeft(16) / rowBytes);
+      if (fit == 0 || (fit * rowBytes < kMinStreamChunkBytes &&
+                       fit < rows - job.cursor)) {
+        return false;
+      }
+
+      const VkDeviceSize chunk = fit * rowBytes;
+      VkStagingAlloc stageAlloc = allocStaging(chunk, /*alignment=*/16);
+      if (!stageAlloc) {
+        return false;
+      }
+
+      std::memcpy(stageAlloc.ptr, job.levels[job.level] + job.cursor * rowBytes,
+                  static_cast<size_t>(chunk));
+
+      // Block rows are whole, the last one may run past the level edge
+      const auto y = static_cast<uint32_t>(job.cursor * blockDim);
+      const auto height = static_cast<uint32_t>(
+          std::min<VkDeviceSize>(fit * blockDim, mipHeight - y));
+
+      VkBufferImageCopy region{};
+      region.bufferOffset = stageAlloc.offset;
+      region.bufferRowLength = 0;   // tightly packed
+      region.bufferImageHeight = 0; // tightly packed
+      region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      region.imageSubresource.mipLevel = mip;
+      region.imageSubresource.baseArrayLayer = 0;
+      region.imageSubresource.layerCount = 1;
+      region.imageOffset = VkOffset3D{0, static_cast<int32_t>(y), 0};
+      region.imageExtent = VkExtent3D{mipWidth, height, 1U};
+
+      vkCmdCopyBufferToImage(m_cmd, m_staging.handle(), job.image,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+      job.cursor += fit;
+
+      if (m_profiler != nullptr) {
+        profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyCount, 1);
+        profilerAdd(m_profiler, UploadProfiler::Stat::UploadMemcpyBytes,
+                    chunk);
+        profilerAdd(m_profiler, UploadProfiler::Stat::TextureUploadBytes,
+                    chunk);
+      }
+    }
+  }
+
+  transitionImage(job.image, job.baseMip, job.levelCount,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+  if (m_profiler != nullptr) {
+    profilerAdd(m_profiler, UploadProfiler::Stat::TextureUploadCount, 1);
+  }
+
+  return true;
 }
 
 bool VkUploadContext::flush(bool wait) {
@@ -434,6 +947,11 @@ bool VkUploadContext::flush(bool wait) {
     return true;
   }
 
+  // Streams take what is left of this frame's slice
+  pumpStreams();
+  recordPendingCopies();
+  recordPendingBarriers();
+
   // End the recording scope if no work done
   if (!m_hadWork) {
     if (!endCmd()) {
@@ -453,7 +971,7 @@ bool VkUploadContext::flush(bool wait) {
   VkFence fence = m_fences[m_frameIndex];
   VkResult res = vkResetFences(m_ctx->device(), 1, &fence);
   if (res != VK_SUCCESS) {
-    std::cerr << "[UploadCtx] vkResetFences failed: " << res << "\n";
+    LOGE("vkResetFences failed: {}", static_cast<int>(res));
     return false;
   }
 
@@ -465,7 +983,7 @@ bool VkUploadContext::flush(bool wait) {
 
   res = vkQueueSubmit(m_ctx->graphicsQueue(), 1, &submitInfo, fence);
   if (res != VK_SUCCESS) {
-    std::cerr << "[UploadCtx] vkQueueSubmit failed: " << res << "\n";
+    LOGE("vkQueueSubmit failed: {}", static_cast<int>(res));
     return false;
   }
 
@@ -476,7 +994,7 @@ bool VkUploadContext::flush(bool wait) {
   if (wait) {
     vkWaitForFences(m_ctx->device(), 1, &fence, VK_TRUE, UINT64_MAX);
     if (res != VK_SUCCESS) {
-      std::cerr << "[UploadCtx] vkWaitForFences(wait) failed: " << res << "\n";
+      LOGE("vkWaitForFences(wait) failed: {}", static_cast<int>(res));
       return false;
     }
   }
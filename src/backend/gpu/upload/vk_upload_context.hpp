@@ -4,8 +4,13 @@
 #include "backend/gpu/buffers/vk_buffer.hpp"
 #include "backend/profiling/upload_profiler.hpp"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <span>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 struct VkStagingAlloc {
@@ -15,6 +20,10 @@ struct VkStagingAlloc {
   explicit operator bool() const noexcept { return ptr != nullptr; }
 };
 
+struct VkStreamHandle {
+  uint32_t id = UINT32_MAX;
+};
+
 // TODO: check for transfer queue in queue family and use it
 // TODO: use timeline semaphore values to know when upload is complete
 // instead of offloading submits to a different command buffer
@@ -61,6 +70,16 @@ public:
     m_sliceHead = std::exchange(other.m_sliceHead, 0);
     m_recording = std::exchange(other.m_recording, false);
 
+    m_streams = std::move(other.m_streams);
+    m_nextStream = std::exchange(other.m_nextStream, 0);
+
+    m_pendingCopies = std::move(other.m_pendingCopies);
+    m_activeCopies = std::exchange(other.m_activeCopies, 0U);
+    m_pendingBarriers = std::move(other.m_pendingBarriers);
+    m_barriers2 = std::move(other.m_barriers2);
+    m_barriers = std::move(other.m_barriers);
+    m_sync2 = std::exchange(other.m_sync2, false);
+
     return *this;
   }
 
@@ -76,15 +95,39 @@ public:
   // Allocate space in the staging slice for the current frame.
   VkStagingAlloc allocStaging(VkDeviceSize size, VkDeviceSize alignment = 16);
 
-  // Record a copy from staging -> buffer.
+  // Queue a copy from staging -> buffer. Copies are recorded at flush(), one
+  // vkCmdCopyBuffer per destination with contiguous ranges merged.
   void cmdCopyToBuffer(VkBuffer dst, VkDeviceSize dstOffset,
                        VkDeviceSize srcOffset, VkDeviceSize size);
 
-  // Record a buffer -> image upload for RGBA8 with layout transition:
-  // UNDEFINED -> TRANSFER_DST_OPTIMAL -> finalLayout
-  void cmdUploadRGBA8ToImage(VkImage image, uint32_t width, uint32_t height,
-                             VkDeviceSize srcOffset, VkImageLayout finalLayout);
-
+  // Record one buffer -> image copy of mipCount levels starting at baseMip,
+  // with a single pair of barriers: UNDEFINED -> TRANSFER_DST_OPTIMAL ->
+  // finalLayout. The source holds the levels of format tightly packed back
+  // to back from srcOffset, which must be aligned to the format block size.
+  // width/height are the extent of mip 0. finalLayout = TRANSFER_DST_OPTIMAL
+  // leaves the levels ready for cmdGenerateMipsBlit.
+  void cmdUploadMipsToImage(VkImage image, VkFormat format, uint32_t width,
+                            uint32_t height, uint32_t baseMip,
+                            uint32_t mipCount, VkDeviceSize srcOffset,
+                            VkImageLayout finalLayout);
+
+  // GPU fallback when no CPU chain exists. Mip 0 must be in
+  // TRANSFER_DST_OPTIMAL with every other level UNDEFINED, all levels end in
+  // SHADER_READ_ONLY_OPTIMAL. Check supportsLinearBlit() first.
+  void cmdGenerateMipsBlit(VkImage image, uint32_t width, uint32_t height,
+                           uint32_t mipLevels);
+  [[nodiscard]] bool supportsLinearBlit(VkFormat format) const;
+
+  // Record an image -> image copy of mipCount levels. src must be in
+  // SHADER_READ_ONLY_OPTIMAL and is returned to it, dst goes from UNDEFINED
+  // to SHADER_READ_ONLY_OPTIMAL. dstWidth/dstHeight are the extent of dst
+  // mip 0.
+  void cmdCopyImageMips(VkImage src, uint32_t srcBaseMip, VkImage dst,
+                        uint32_t dstBaseMip, uint32_t mipCount,
+                        uint32_t dstWidth, uint32_t dstHeight);
+
+  // Queued like the copies. At flush() the ranges of each buffer and stage
+  // are merged and every barrier goes out in one vkCmdPipelineBarrier2.
   void cmdBarrierBufferTransferToVertexShader(VkBuffer buffer,
                                               VkDeviceSize offset,
                                               VkDeviceSize size);
@@ -93,7 +136,28 @@ public:
                                                 VkDeviceSize offset,
                                                 VkDeviceSize size);
 
-  // If wait=true, wait for completion.
+  // Streaming uploads for data larger than the staging slice. Copies are
+  // split into byte ranges or block rows and recorded at flush() from
+  // whatever the slice has left, over as many frames as needed. The target
+  // must not be used before streamDone(); it is then safe for any work
+  // submitted after that frame's flush.
+  VkStreamHandle streamToBuffer(VkBuffer dst, VkDeviceSize dstOffset,
+                                std::vector<uint8_t> &&bytes);
+  // Same level layout as cmdUploadMipsToImage, levels[i] is mip baseMip + i
+  // and must stay alive until streamDone(). The levels end in
+  // SHADER_READ_ONLY_OPTIMAL.
+  VkStreamHandle streamToImage(VkImage image, VkFormat format, uint32_t width,
+                               uint32_t height, uint32_t baseMip,
+                               std::span<const uint8_t *const> levels);
+  [[nodiscard]] bool streamDone(VkStreamHandle stream) const noexcept;
+  // Drops the remaining chunks, the target is left partially written
+  void cancelStream(VkStreamHandle stream) noexcept;
+  [[nodiscard]] uint32_t streamsPending() const noexcept {
+    return static_cast<uint32_t>(m_streams.size());
+  }
+
+  // Records pending stream chunks, copies and barriers, then submits. If
+  // wait=true, wait for completion.
   bool flush(bool wait);
 
   [[nodiscard]] VkCommandBuffer cmd() const noexcept {
@@ -111,11 +175,58 @@ public:
     return m_framesInFlight;
   }
 
+  // 32k textures have 16 levels
+  static constexpr uint32_t kMaxMipLevels = 16;
+
 private:
+  struct PendingCopies {
+    VkBuffer dst = VK_NULL_HANDLE;
+    std::vector<VkBufferCopy> regions;
+  };
+
+  struct PendingBarrier {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkPipelineStageFlags2 dstStage = 0;
+    VkDeviceSize begin = 0;
+    VkDeviceSize end = 0; // VK_WHOLE_SIZE reaches the end of the buffer
+  };
+
+  struct StreamJob {
+    uint32_t id = 0;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize dstOffset = 0;
+    std::vector<uint8_t> bytes;
+
+    VkImage image = VK_NULL_HANDLE;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t baseMip = 0;
+    uint32_t levelCount = 0;
+    std::array<const uint8_t *, kMaxMipLevels> levels{};
+
+    uint32_t level = 0;      // image level being copied
+    VkDeviceSize cursor = 0; // bytes, or block rows of the current level
+    bool started = false;
+  };
+
   static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize a) noexcept;
 
-  void transitionImage(VkImage image, VkImageLayout oldLayout,
-                       VkImageLayout newLayout);
+  void queueBufferBarrier(VkBuffer buffer, VkDeviceSize offset,
+                          VkDeviceSize size, VkPipelineStageFlags2 dstStage);
+  // Cleared entry for dst, valid until the next call
+  PendingCopies &pushCopyTarget(VkBuffer dst);
+  void recordPendingCopies();
+  void recordPendingBarriers();
+
+  [[nodiscard]] VkDeviceSize stagingLeft(VkDeviceSize alignment) const noexcept;
+  void pumpStreams();
+  bool pumpBuffer(StreamJob &job);
+  bool pumpImage(StreamJob &job);
+
+  void transitionImage(VkImage image, uint32_t baseMip, uint32_t levelCount,
+                       VkImageLayout oldLayout, VkImageLayout newLayout);
 
   bool beginCmd();
   bool endCmd();
@@ -145,4 +256,17 @@ private:
   VkDeviceSize m_sliceHead = 0;
   bool m_recording = false;
   bool m_hadWork = false;
+
+  std::deque<StreamJob> m_streams; // oldest first
+  uint32_t m_nextStream = 0;
+
+  std::vector<PendingCopies> m_pendingCopies;    // one per destination
+  std::vector<PendingBarrier> m_pendingBarriers; // one per buffer and stage
+  // Entries of m_pendingCopies queued since the last record, the rest keep
+  // their region storage for later frames
+  size_t m_activeCopies = 0;
+  // Rebuilt from m_pendingBarriers on every flush, only one is used
+  std::vector<VkBufferMemoryBarrier2> m_barriers2; // synchronization2
+  std::vector<VkBufferMemoryBarrier> m_barriers;
+  bool m_sync2 = false;
 };
@@ -1,6 +1,7 @@
 #include "vk_pipeline.hpp"
 
 #include "backend/gpu/vk_vertex_layout.hpp"
+#include "backend/profiling/profiling_logger.hpp"
 #include "backend/shaders/vk_shader.hpp"
 #include "engine/logging/log.hpp"
 
@@ -19,7 +20,8 @@ bool VkGraphicsPipeline::init(VkDevice device, VkFormat colorFormat,
                               VkFormat depthFormat,
                               VkPipelineLayout pipelineLayout,
                               const std::string &vertSpvPath,
-                              const std::string &fragSpvPath) {
+                              const std::string &fragSpvPath,
+                              VkPipelineCache cache) {
   if (depthFormat == VK_FORMAT_UNDEFINED) {
     LOGE("depthFormat is undefeind");
     return false;
@@ -52,34 +54,41 @@ bool VkGraphicsPipeline::init(VkDevice device, VkFormat colorFormat,
     return false;
   }
 
+  GraphicsPipelineDesc desc{};
+  desc.colorFormat = colorFormat;
+  desc.depthFormat = depthFormat;
+  desc.layout = pipelineLayout;
+  desc.vert = vertModule.m_handle;
+  desc.frag = fragModule.m_handle;
+
+  m_graphicsPipeline = createGraphicsPipeline(m_device, desc, cache);
+  if (m_graphicsPipeline == VK_NULL_HANDLE) {
+    shutdown();
+    return false;
+  }
+
+  std::cout << "[Pipeline] Graphics pipeline created\n";
+  return true;
+}
+
+VkPipeline createGraphicsPipeline(VkDevice device,
+                                  const GraphicsPipelineDesc &desc,
+                                  VkPipelineCache cache) {
   VkPipelineShaderStageCreateInfo vertStage{};
   vertStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   vertStage.stage = VK_SHADER_STAGE_VERTEX_BIT;
-  vertStage.module = vertModule.m_handle;
+  vertStage.module = desc.vert;
   vertStage.pName = "main";
 
   VkPipelineShaderStageCreateInfo fragStage{};
   fragStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   fragStage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-  fragStage.module = fragModule.m_handle;
+  fragStage.module = desc.frag;
   fragStage.pName = "main";
+  fragStage.pSpecializationInfo = desc.fragSpecialization;
 
-  const std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{vertStage,
-                                                                    fragStage};
-  if (!createGraphicsPipeline(colorFormat, depthFormat, pipelineLayout,
-                              shaderStages.data(),
-                              static_cast<uint32_t>(shaderStages.size()))) {
-    shutdown();
-    return false;
-  }
-
-  std::cout << "[Pipeline] Graphics pipeline created\n";
-  return true;
-}
-
-bool VkGraphicsPipeline::createGraphicsPipeline(
-    VkFormat colorFormat, VkFormat depthFormat, VkPipelineLayout pipelineLayout,
-    const VkPipelineShaderStageCreateInfo *stages, uint32_t stageCount) {
+  const std::array<VkPipelineShaderStageCreateInfo, 2> stages{vertStage,
+                                                              fragStage};
 
   VkVertexInputBindingDescription binding =
       vk_vertex_layout::bindingDescription();
@@ -124,7 +133,7 @@ bool VkGraphicsPipeline::createGraphicsPipeline(
   rasterizer.rasterizerDiscardEnable = VK_FALSE;
   rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
   rasterizer.lineWidth = 1.0F;
-  rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+  rasterizer.cullMode = desc.cullMode;
   rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
   rasterizer.depthBiasEnable = VK_FALSE;
 
@@ -161,16 +170,16 @@ bool VkGraphicsPipeline::createGraphicsPipeline(
   VkPipelineRenderingCreateInfo rendering{};
   rendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
   rendering.colorAttachmentCount = 1;
-  rendering.pColorAttachmentFormats = &colorFormat;
-  rendering.depthAttachmentFormat = depthFormat;
+  rendering.pColorAttachmentFormats = &desc.colorFormat;
+  rendering.depthAttachmentFormat = desc.depthFormat;
   rendering.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
 
   // Graphics pipeline
   VkGraphicsPipelineCreateInfo pipelineInfo{};
   pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
   pipelineInfo.pNext = &rendering;
-  pipelineInfo.stageCount = stageCount;
-  pipelineInfo.pStages = stages;
+  pipelineInfo.stageCount = static_cast<uint32_t>(stages.size());
+  pipelineInfo.pStages = stages.data();
   pipelineInfo.pVertexInputState = &vertexInput;
   pipelineInfo.pInputAssemblyState = &inputAssembly;
   pipelineInfo.pViewportState = &viewportState;
@@ -180,21 +189,23 @@ bool VkGraphicsPipeline::createGraphicsPipeline(
   pipelineInfo.pColorBlendState = &colorBlending;
   pipelineInfo.pDynamicState = &dynamicState;
   pipelineInfo.renderPass = VK_NULL_HANDLE; // dynamic rendering
-  pipelineInfo.layout = pipelineLayout;
+  pipelineInfo.layout = desc.layout;
   pipelineInfo.subpass = 0;
   pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
   pipelineInfo.basePipelineIndex = -1;
 
-  const VkResult res = vkCreateGraphicsPipelines(
-      m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline);
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  profiling::EventScope scope(profiling::Event::PipelineCreate);
+  const VkResult res = vkCreateGraphicsPipelines(device, cache, 1,
+                                                 &pipelineInfo, nullptr,
+                                                 &pipeline);
   if (res != VK_SUCCESS) {
     std::cerr << "[Pipeline] vkCreateGraphicsPipelines() failed: " << res
               << "\n";
-    m_graphicsPipeline = VK_NULL_HANDLE;
-    return false;
+    return VK_NULL_HANDLE;
   }
 
-  return true;
+  return pipeline;
 }
 
 void VkGraphicsPipeline::shutdown() noexcept {
@@ -5,6 +5,23 @@
 #include <utility>
 #include <vulkan/vulkan_core.h>
 
+// Fixed-function and shader state of one scene pipeline
+struct GraphicsPipelineDesc {
+  VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+  VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  VkShaderModule vert = VK_NULL_HANDLE;
+  VkShaderModule frag = VK_NULL_HANDLE;
+  const VkSpecializationInfo *fragSpecialization = nullptr;
+  VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+};
+
+// VK_NULL_HANDLE on failure. Safe to call from several threads at once,
+// including with a shared cache.
+[[nodiscard]] VkPipeline
+createGraphicsPipeline(VkDevice device, const GraphicsPipelineDesc &desc,
+                       VkPipelineCache cache);
+
 class VkGraphicsPipeline {
 public:
   VkGraphicsPipeline() = default;
@@ -32,7 +49,8 @@ public:
 
   bool init(VkDevice device, VkFormat colorFormat, VkFormat depthFormat,
             VkPipelineLayout pipelineLayout, const std::string &vertSpvPath,
-            const std::string &fragSpvPath);
+            const std::string &fragSpvPath,
+            VkPipelineCache cache = VK_NULL_HANDLE);
   void shutdown() noexcept;
 
   [[nodiscard]] VkPipeline pipeline() const noexcept {
@@ -43,12 +61,6 @@ public:
   }
 
 private:
-  [[nodiscard]] bool
-  createGraphicsPipeline(VkFormat colorFormat, VkFormat depthFormat,
-                         VkPipelineLayout pipelineLayout,
-                         const VkPipelineShaderStageCreateInfo *stages,
-                         uint32_t stageCount);
-
   VkDevice m_device = VK_NULL_HANDLE;             // non-owning
   VkPipeline m_graphicsPipeline = VK_NULL_HANDLE; // owning
 };
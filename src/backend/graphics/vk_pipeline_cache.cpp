@@ -0,0 +1,194 @@
+#include "backend/graphics/vk_pipeline_cache.hpp"
+
+#include "backend/profiling/profiling_logger.hpp"
+#include "engine/logging/log.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <system_error>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+DEFINE_TU_LOGGER("Backend.Graphics.PipelineCache");
+#define LOG_TU_LOGGER() ThisLogger()
+
+namespace {
+
+bool readFile(const std::filesystem::path &path, std::vector<uint8_t> &out) {
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  const std::streamsize size = file.tellg();
+  if (size <= 0) {
+    return false;
+  }
+
+  out.resize(static_cast<size_t>(size));
+  file.seekg(0, std::ios::beg);
+  if (!file.read(reinterpret_cast<char *>(out.data()), size)) {
+    out.clear();
+    return false;
+  }
+
+  return true;
+}
+
+// Header fields are tightly packed uint32s, read them one by one
+bool headerMatches(const std::vector<uint8_t> &data,
+                   const VkPhysicalDeviceProperties &props) {
+  constexpr size_t kHeaderBytes = 16 + VK_UUID_SIZE;
+  if (data.size() < kHeaderBytes) {
+    return false;
+  }
+
+  const auto u32At = [&data](size_t offset) {
+    uint32_t v = 0;
+    std::memcpy(&v, data.data() + offset, sizeof(v));
+    return v;
+  };
+
+  return u32At(0) >= kHeaderBytes &&
+         u32At(4) == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         u32At(8) == props.vendorID && u32At(12) == props.deviceID &&
+         std::memcmp(data.data() + 16, props.pipelineCacheUUID,
+                     VK_UUID_SIZE) == 0;
+}
+
+} // namespace
+
+bool VkPipelineCacheStore::init(VkDevice device,
+                                VkPhysicalDevice physicalDevice,
+                                std::filesystem::path path) {
+  shutdown();
+
+  if (device == VK_NULL_HANDLE || physicalDevice == VK_NULL_HANDLE) {
+    LOGE("init() called with null device");
+    return false;
+  }
+
+  m_device = device;
+  m_path = path.empty() ? defaultPath() : std::move(path);
+
+  std::vector<uint8_t> data;
+  {
+    profiling::EventScope load(profiling::Event::PipelineCacheLoad);
+
+    if (!m_path.empty() && readFile(m_path, data)) {
+      VkPhysicalDeviceProperties props{};
+      vkGetPhysicalDeviceProperties(physicalDevice, &props);
+      if (!headerMatches(data, props)) {
+        LOGI("Discarding stale pipeline cache '{}'", m_path.string());
+        data.clear();
+      }
+    }
+
+    VkPipelineCacheCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = data.size();
+    info.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(m_device, &info, nullptr, &m_cache) !=
+        VK_SUCCESS) {
+      LOGE("vkCreatePipelineCache() failed");
+      m_cache = VK_NULL_HANDLE;
+      m_device = VK_NULL_HANDLE;
+      return false;
+    }
+  }
+
+  LOGI("Pipeline cache '{}' loaded: {} bytes", m_path.string(), data.size());
+  return true;
+}
+
+void VkPipelineCacheStore::shutdown() noexcept {
+  if (m_device != VK_NULL_HANDLE && m_cache != VK_NULL_HANDLE) {
+    // Allocation and filesystem errors must not escape a noexcept shutdown
+    try {
+      (void)save();
+    } catch (const std::exception &e) {
+      LOGE("Pipeline cache save failed: {}", e.what());
+    } catch (...) {
+      LOGE("Pipeline cache save failed");
+    }
+    vkDestroyPipelineCache(m_device, m_cache, nullptr);
+  }
+
+  m_cache = VK_NULL_HANDLE;
+  m_device = VK_NULL_HANDLE;
+  m_path.clear();
+}
+
+bool VkPipelineCacheStore::save() const {
+  if (m_cache == VK_NULL_HANDLE || m_path.empty()) {
+    return false;
+  }
+
+  profiling::EventScope scope(profiling::Event::PipelineCacheSave);
+
+  size_t size = 0;
+  if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) !=
+          VK_SUCCESS ||
+      size == 0) {
+    return false;
+  }
+
+  std::vector<uint8_t> data(size);
+  if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) !=
+      VK_SUCCESS) {
+    LOGE("vkGetPipelineCacheData() failed");
+    return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(m_path.parent_path(), ec);
+
+  // A crash mid-write leaves the previous cache intact
+  std::filesystem::path tmp = m_path;
+  tmp += ".tmp";
+  {
+    std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char *>(data.data()),
+                    static_cast<std::streamsize>(size))) {
+      LOGE("Failed to write '{}'", tmp.string());
+      std::filesystem::remove(tmp, ec);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(tmp, m_path, ec);
+  if (ec) {
+    LOGE("Failed to replace '{}': {}", m_path.string(), ec.message());
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+
+  return true;
+}
+
+std::filesystem::path VkPipelineCacheStore::defaultPath() {
+  std::filesystem::path dir;
+#ifdef _WIN32
+  if (const char *local = std::getenv("LOCALAPPDATA")) {
+    dir = local;
+  }
+#else
+  if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+    dir = xdg;
+  } else if (const char *home = std::getenv("HOME")) {
+    dir = std::filesystem::path(home) / ".cache";
+  }
+#endif
+
+  if (dir.empty()) {
+    return {};
+  }
+
+  return dir / "quark" / "pipeline_cache.bin";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <filesystem>
+#include <utility>
+#include <vulkan/vulkan_core.h>
+
+// VkPipelineCache persisted between runs. The blob is only reused when its
+// header matches the current vendor, device and pipelineCacheUUID.
+class VkPipelineCacheStore {
+public:
+  VkPipelineCacheStore() = default;
+  ~VkPipelineCacheStore() noexcept { shutdown(); }
+
+  VkPipelineCacheStore(const VkPipelineCacheStore &) = delete;
+  VkPipelineCacheStore &operator=(const VkPipelineCacheStore &) = delete;
+
+  VkPipelineCacheStore(VkPipelineCacheStore &&other) noexcept {
+    *this = std::move(other);
+  }
+  VkPipelineCacheStore &operator=(VkPipelineCacheStore &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    shutdown();
+
+    m_device = std::exchange(other.m_device, VK_NULL_HANDLE);
+    m_cache = std::exchange(other.m_cache, VK_NULL_HANDLE);
+    m_path = std::exchange(other.m_path, {});
+
+    return *this;
+  }
+
+  // Empty path selects defaultPath(). A missing or stale file is not an
+  // error, the cache just starts empty.
+  bool init(VkDevice device, VkPhysicalDevice physicalDevice,
+            std::filesystem::path path = {});
+  // Saves, then destroys the cache
+  void shutdown() noexcept;
+
+  // Writes to a temporary file and renames it over the old one
+  bool save() const;
+
+  [[nodiscard]] VkPipelineCache cache() const noexcept { return m_cache; }
+
+  // <user cache dir>/quark/pipeline_cache.bin
+  [[nodiscard]] static std::filesystem::path defaultPath();
+
+private:
+  VkDevice m_device = VK_NULL_HANDLE;       // non-owning
+  VkPipelineCache m_cache = VK_NULL_HANDLE; // owning
+  std::filesystem::path m_path;
+};
@@ -0,0 +1,261 @@
+#include "backend/graphics/vk_pipeline_library.hpp"
+
+#include "backend/graphics/vk_pipeline.hpp"
+#include "backend/shaders/vk_shader.hpp"
+#include "engine/jobs/job_system.hpp"
+#include "engine/logging/log.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+DEFINE_TU_LOGGER("Backend.Graphics.PipelineLibrary");
+#define LOG_TU_LOGGER() ThisLogger()
+
+bool VkPipelineLibrary::init(VkDevice device, VkPipelineLayout layout,
+                             const std::string &vertSpvPath,
+                             const std::string &fragSpvPath,
+                             engine::jobs::JobSystem &jobs,
+                             VkPipelineCache cache) {
+  shutdown();
+
+  if (device == VK_NULL_HANDLE || layout == VK_NULL_HANDLE) {
+    LOGE("init() called with null device or layout");
+    return false;
+  }
+
+  VulkanShaderModule vertModule;
+  VulkanShaderModule fragModule;
+  if (!createShaderModuleFromFile(device, vertSpvPath, vertModule) ||
+      !createShaderModuleFromFile(device, fragSpvPath, fragModule)) {
+    LOGE("Failed to load shaders '{}' / '{}'", vertSpvPath, fragSpvPath);
+    return false;
+  }
+
+  m_jobs = &jobs;
+  m_shared = std::make_unique<Shared>();
+  m_shared->device = device;
+  m_shared->layout = layout;
+  m_shared->cache = cache;
+  m_shared->vert = std::exchange(vertModule.m_handle, VK_NULL_HANDLE);
+  m_shared->frag = std::exchange(fragModule.m_handle, VK_NULL_HANDLE);
+
+  // The fallback always owns id 0
+  m_keys.push_back(PipelineKey{});
+  m_pipelines.push_back(VK_NULL_HANDLE);
+  m_idByFeatures.emplace(0U, kFallback);
+
+  return true;
+}
+
+void VkPipelineLibrary::shutdown() noexcept {
+  if (m_shared) {
+    // Queued compiles are dropped, their jobs find nothing to do
+    {
+      std::lock_guard lock(m_shared->mutex);
+      m_shared->jobs.clear();
+    }
+    m_jobs->wait(m_shared->compiles);
+
+    for (const Result &result : m_shared->results) {
+      if (result.pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(m_shared->device, result.pipeline, nullptr);
+      }
+    }
+
+    destroyPipelines();
+
+    if (m_shared->vert != VK_NULL_HANDLE) {
+      vkDestroyShaderModule(m_shared->device, m_shared->vert, nullptr);
+    }
+    if (m_shared->frag != VK_NULL_HANDLE) {
+      vkDestroyShaderModule(m_shared->device, m_shared->frag, nullptr);
+    }
+    m_shared.reset();
+  }
+
+  m_jobs = nullptr;
+  m_keys.clear();
+  m_pipelines.clear();
+  m_idByFeatures.clear();
+  m_colorFormat = VK_FORMAT_UNDEFINED;
+  m_depthFormat = VK_FORMAT_UNDEFINED;
+  m_generation = 0;
+  m_compiling = 0;
+}
+
+bool VkPipelineLibrary::setTargetFormats(VkFormat colorFormat,
+                                         VkFormat depthFormat) {
+  if (!m_shared) {
+    LOGE("setTargetFormats() before init()");
+    return false;
+  }
+
+  if (colorFormat == VK_FORMAT_UNDEFINED ||
+      depthFormat == VK_FORMAT_UNDEFINED) {
+    LOGE("Undefined target format");
+    return false;
+  }
+
+  destroyPipelines();
+  ++m_generation;
+  m_colorFormat = colorFormat;
+  m_depthFormat = depthFormat;
+
+  // Queued jobs still carry the old formats. The ones already running come
+  // back stale from collect().
+  {
+    std::lock_guard lock(m_shared->mutex);
+    m_compiling -= static_cast<uint32_t>(m_shared->jobs.size());
+    m_shared->jobs.clear();
+  }
+
+  const Job fallback{.id = kFallback,
+                     .generation = m_generation,
+                     .key = m_keys[kFallback],
+                     .colorFormat = colorFormat,
+                     .depthFormat = depthFormat};
+  m_pipelines[kFallback] = compile(*m_shared, fallback);
+  if (m_pipelines[kFallback] == VK_NULL_HANDLE) {
+    LOGE("Failed to compile the fallback pipeline");
+    return false;
+  }
+
+  for (uint32_t id = kFallback + 1; id < m_keys.size(); ++id) {
+    enqueue(id);
+  }
+
+  return true;
+}
+
+uint32_t VkPipelineLibrary::request(PipelineKey key) {
+  if (auto it = m_idByFeatures.find(key.features);
+      it != m_idByFeatures.end()) {
+    return it->second;
+  }
+
+  if (!m_shared) {
+    return kFallback;
+  }
+
+  const auto id = static_cast<uint32_t>(m_keys.size());
+  m_keys.push_back(key);
+  m_pipelines.push_back(VK_NULL_HANDLE);
+  m_idByFeatures.emplace(key.features, id);
+
+  if (m_colorFormat != VK_FORMAT_UNDEFINED) {
+    enqueue(id);
+  }
+
+  return id;
+}
+
+void VkPipelineLibrary::collect() {
+  if (!m_shared || m_compiling == 0) {
+    return;
+  }
+
+  std::vector<Result> results;
+  {
+    std::lock_guard lock(m_shared->mutex);
+    results.swap(m_shared->results);
+  }
+
+  for (const Result &result : results) {
+    --m_compiling;
+
+    if (result.generation != m_generation) {
+      if (result.pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(m_shared->device, result.pipeline, nullptr);
+      }
+      continue;
+    }
+
+    if (result.pipeline == VK_NULL_HANDLE) {
+      LOGE("Pipeline variant {} failed, keeps using the fallback", result.id);
+      continue;
+    }
+
+    m_pipelines[result.id] = result.pipeline;
+  }
+}
+
+void VkPipelineLibrary::enqueue(uint32_t id) {
+  ++m_compiling;
+
+  {
+    std::lock_guard lock(m_shared->mutex);
+    m_shared->jobs.push_back(Job{.id = id,
+                                 .generation = m_generation,
+                                 .key = m_keys[id],
+                                 .colorFormat = m_colorFormat,
+                                 .depthFormat = m_depthFormat});
+  }
+
+  Shared *shared = m_shared.get();
+  m_jobs->run(
+      "CompilePipeline", [shared] { compileNext(*shared); },
+      &m_shared->compiles);
+}
+
+void VkPipelineLibrary::destroyPipelines() noexcept {
+  for (VkPipeline &pipeline : m_pipelines) {
+    if (pipeline != VK_NULL_HANDLE) {
+      vkDestroyPipeline(m_shared->device, pipeline, nullptr);
+      pipeline = VK_NULL_HANDLE;
+    }
+  }
+}
+
+VkPipeline VkPipelineLibrary::compile(const Shared &shared, const Job &job) {
+  // Shader variants are specialization constants of the one module pair
+  const VkBool32 alphaTest =
+      (job.key.features & PipelineKey::kAlphaTest) != 0 ? VK_TRUE : VK_FALSE;
+
+  VkSpecializationMapEntry entry{};
+  entry.constantID = 0;
+  entry.offset = 0;
+  entry.size = sizeof(VkBool32);
+
+  VkSpecializationInfo specialization{};
+  specialization.mapEntryCount = 1;
+  specialization.pMapEntries = &entry;
+  specialization.dataSize = sizeof(alphaTest);
+  specialization.pData = &alphaTest;
+
+  GraphicsPipelineDesc desc{};
+  desc.colorFormat = job.colorFormat;
+  desc.depthFormat = job.depthFormat;
+  desc.layout = shared.layout;
+  desc.vert = shared.vert;
+  desc.frag = shared.frag;
+  desc.fragSpecialization = &specialization;
+  desc.cullMode = (job.key.features & PipelineKey::kDoubleSided) != 0
+                      ? VK_CULL_MODE_NONE
+                      : VK_CULL_MODE_BACK_BIT;
+
+  return createGraphicsPipeline(shared.device, desc, shared.cache);
+}
+
+void VkPipelineLibrary::compileNext(Shared &shared) {
+  Job job;
+  {
+    std::lock_guard lock(shared.mutex);
+    if (shared.jobs.empty()) {
+      return; // dropped by setTargetFormats() or shutdown()
+    }
+    job = shared.jobs.front();
+    shared.jobs.pop_front();
+  }
+
+  const Result result{.id = job.id,
+                      .generation = job.generation,
+                      .pipeline = compile(shared, job)};
+
+  std::lock_guard lock(shared.mutex);
+  shared.results.push_back(result);
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "engine/jobs/job_system.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+// Compact permutation key, one pipeline per distinct value
+struct PipelineKey {
+  static constexpr uint32_t kAlphaTest = 1U << 0;   // frag constant_id 0
+  static constexpr uint32_t kDoubleSided = 1U << 1; // culling off
+
+  uint32_t features = 0;
+
+  bool operator==(const PipelineKey &) const = default;
+};
+
+// Scene pipeline permutations built from one vertex/fragment shader pair.
+// Variants compile as JobSystem jobs, the base variant (id 0, no features)
+// compiles up front and stands in for any variant that is not ready yet.
+class VkPipelineLibrary {
+public:
+  static constexpr uint32_t kFallback = 0;
+
+  VkPipelineLibrary() = default;
+  ~VkPipelineLibrary() noexcept { shutdown(); }
+
+  VkPipelineLibrary(const VkPipelineLibrary &) = delete;
+  VkPipelineLibrary &operator=(const VkPipelineLibrary &) = delete;
+
+  VkPipelineLibrary(VkPipelineLibrary &&other) noexcept {
+    *this = std::move(other);
+  }
+  VkPipelineLibrary &operator=(VkPipelineLibrary &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    shutdown();
+
+    m_jobs = std::exchange(other.m_jobs, nullptr);
+    m_shared = std::move(other.m_shared);
+    m_keys = std::move(other.m_keys);
+    m_pipelines = std::move(other.m_pipelines);
+    m_idByFeatures = std::move(other.m_idByFeatures);
+    m_colorFormat = std::exchange(other.m_colorFormat, VK_FORMAT_UNDEFINED);
+    m_depthFormat = std::exchange(other.m_depthFormat, VK_FORMAT_UNDEFINED);
+    m_generation = std::exchange(other.m_generation, 0);
+    m_compiling = std::exchange(other.m_compiling, 0U);
+
+    return *this;
+  }
+
+  // Loads both shader modules. No pipeline exists until setTargetFormats().
+  // jobs must outlive the library, or at least its shutdown().
+  bool init(VkDevice device, VkPipelineLayout layout,
+            const std::string &vertSpvPath, const std::string &fragSpvPath,
+            engine::jobs::JobSystem &jobs,
+            VkPipelineCache cache = VK_NULL_HANDLE);
+  // Waits for running compiles and destroys every pipeline
+  void shutdown() noexcept;
+
+  // Destroys all variants, so the GPU must be idle. The fallback compiles
+  // before returning, every other known variant is queued again.
+  bool setTargetFormats(VkFormat colorFormat, VkFormat depthFormat);
+
+  // Stable id of key, queues its compilation the first time it is seen
+  uint32_t request(PipelineKey key);
+  // Id of a requested key, kFallback for keys never requested. Does not
+  // allocate, so it is safe while recording.
+  [[nodiscard]] uint32_t find(PipelineKey key) const noexcept {
+    const auto it = m_idByFeatures.find(key.features);
+    return it != m_idByFeatures.end() ? it->second : kFallback;
+  }
+  // Publishes finished compiles, call once per frame on the render thread
+  void collect();
+
+  // The variant if compiled, otherwise the fallback
+  [[nodiscard]] VkPipeline pipeline(uint32_t id) const noexcept {
+    if (id < m_pipelines.size() && m_pipelines[id] != VK_NULL_HANDLE) {
+      return m_pipelines[id];
+    }
+    return fallback();
+  }
+  [[nodiscard]] VkPipeline fallback() const noexcept {
+    return m_pipelines.empty() ? VK_NULL_HANDLE : m_pipelines[kFallback];
+  }
+  [[nodiscard]] bool ready(uint32_t id) const noexcept {
+    return id < m_pipelines.size() && m_pipelines[id] != VK_NULL_HANDLE;
+  }
+  [[nodiscard]] uint32_t compiling() const noexcept { return m_compiling; }
+
+private:
+  struct Job {
+    uint32_t id = 0;
+    uint64_t generation = 0;
+    PipelineKey key;
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+  };
+
+  struct Result {
+    uint32_t id = 0;
+    uint64_t generation = 0;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+  };
+
+  // Heap allocated so jobs keep a stable address across moves. Handles are
+  // set before the first compile is queued and stay fixed until compiles
+  // has been waited on.
+  struct Shared {
+    VkDevice device = VK_NULL_HANDLE;         // non-owning
+    VkPipelineLayout layout = VK_NULL_HANDLE; // non-owning
+    VkPipelineCache cache = VK_NULL_HANDLE;   // non-owning
+    VkShaderModule vert = VK_NULL_HANDLE;     // owning
+    VkShaderModule frag = VK_NULL_HANDLE;     // owning
+
+    engine::jobs::JobCounter compiles;
+
+    std::mutex mutex;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+  };
+
+  [[nodiscard]] static VkPipeline compile(const Shared &shared,
+                                          const Job &job);
+  // Job body, takes the oldest queued compile
+  static void compileNext(Shared &shared);
+
+  void enqueue(uint32_t id);
+  void destroyPipelines() noexcept;
+
+  engine::jobs::JobSystem *m_jobs = nullptr; // non-owning
+  std::unique_ptr<Shared> m_shared;
+
+  std::vector<PipelineKey> m_keys;     // per id
+  std::vector<VkPipeline> m_pipelines; // per id, owning
+  std::unordered_map<uint32_t, uint32_t> m_idByFeatures;
+
+  VkFormat m_colorFormat = VK_FORMAT_UNDEFINED;
+  VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
+  uint64_t m_generation = 0; // bumped on format change, stale results die
+  uint32_t m_compiling = 0;
+};
@@ -1,6 +1,7 @@
 #include "vk_presenter.hpp"
 
 #include "backend/core/vk_backend_ctx.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "platform/window/glfw_window.hpp"
 
 #include <cstdint>
@@ -45,6 +46,57 @@ bool VkPresenter::init(VkBackendCtx &ctx, GlfwWindow *window, uint32_t width,
   return true;
 }
 
+bool VkPresenter::initHeadless(VkBackendCtx &ctx, uint32_t width,
+                               uint32_t height, uint32_t imageCount,
+                               VkFormat format) {
+  if (width == 0 || height == 0 || imageCount == 0) {
+    std::cerr << "[Presenter] headless size or image count is 0\n";
+    return false;
+  }
+
+  shutdown();
+
+  m_ctx = &ctx;
+  m_headless = true;
+  m_offscreenExtent = VkExtent2D{width, height};
+
+  m_offscreen.resize(imageCount);
+  m_offscreenImages.assign(imageCount, VK_NULL_HANDLE);
+  m_offscreenViews.assign(imageCount, VK_NULL_HANDLE);
+
+  for (uint32_t i = 0; i < imageCount; ++i) {
+    if (!m_offscreen[i].init2D(ctx.allocator(), width, height, format,
+                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                               VK_IMAGE_TILING_OPTIMAL, /*mipLevels=*/1,
+                               profiling::MemoryTag::RenderTarget)) {
+      std::cerr << "[Presenter] offscreen image init failed\n";
+      shutdown();
+      return false;
+    }
+    m_offscreenImages[i] = m_offscreen[i].handle();
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_offscreenImages[i];
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(ctx.device(), &viewInfo, nullptr,
+                          &m_offscreenViews[i]) != VK_SUCCESS) {
+      std::cerr << "[Presenter] offscreen image view creation failed\n";
+      m_offscreenViews[i] = VK_NULL_HANDLE;
+      shutdown();
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void VkPresenter::shutdown() noexcept {
   if (m_ctx == nullptr) {
     m_surface = VK_NULL_HANDLE;
@@ -57,7 +109,18 @@ void VkPresenter::shutdown() noexcept {
 
   if (device != VK_NULL_HANDLE) {
     m_swapchain.shutdown(device);
+
+    for (VkImageView view : m_offscreenViews) {
+      if (view != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, view, nullptr);
+      }
+    }
   }
+  m_offscreenViews.clear();
+  m_offscreenImages.clear();
+  m_offscreen.clear();
+  m_offscreenExtent = {};
+  m_headless = false;
 
   if (instance != VK_NULL_HANDLE && m_surface != VK_NULL_HANDLE) {
     vkDestroySurfaceKHR(instance, m_surface, nullptr);
@@ -69,6 +132,11 @@ void VkPresenter::shutdown() noexcept {
 }
 
 bool VkPresenter::recreateSwapchain() {
+  // Offscreen targets never go out of date
+  if (m_headless) {
+    return true;
+  }
+
   if (!isInitialized() || m_ctx == nullptr || m_window == nullptr) {
     return false;
   }
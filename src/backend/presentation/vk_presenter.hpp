@@ -1,6 +1,7 @@
 #pragma once
 
 #include "backend/core/vk_backend_ctx.hpp"
+#include "backend/gpu/images/vk_image.hpp"
 #include "platform/window/glfw_window.hpp"
 #include "vk_swapchain.hpp"
 
@@ -9,7 +10,9 @@
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
-// Owns VulkanSwapchain and VkSurfaceKHR
+// Owns VulkanSwapchain and VkSurfaceKHR, or offscreen color images when
+// headless. Headless presenters have no swapchain, frames render into the
+// images round-robin and are left in TRANSFER_SRC_OPTIMAL for readback.
 class VkPresenter {
 public:
   VkPresenter() = default;
@@ -30,39 +33,59 @@ public:
     m_window = std::exchange(other.m_window, nullptr);
     m_surface = std::exchange(other.m_surface, VK_NULL_HANDLE);
     m_swapchain = std::move(other.m_swapchain);
+    m_offscreen = std::move(other.m_offscreen);
+    m_offscreenImages = std::exchange(other.m_offscreenImages, {});
+    m_offscreenViews = std::exchange(other.m_offscreenViews, {});
+    m_offscreenExtent = std::exchange(other.m_offscreenExtent, VkExtent2D{});
+    m_headless = std::exchange(other.m_headless, false);
 
     return *this;
   }
 
   bool init(VkBackendCtx &ctx, GlfwWindow *window, uint32_t width,
             uint32_t height);
+  bool initHeadless(VkBackendCtx &ctx, uint32_t width, uint32_t height,
+                    uint32_t imageCount = 2,
+                    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
   void shutdown() noexcept;
 
   [[nodiscard]] bool recreateSwapchain();
 
   [[nodiscard]] VkFormat colorFormat() const {
+    if (m_headless) {
+      return m_offscreen.empty() ? VK_FORMAT_UNDEFINED
+                                 : m_offscreen[0].format();
+    }
     return m_swapchain.swapchainImageFormat();
   }
   [[nodiscard]] const std::vector<VkImage> &colorImages() const {
-    return m_swapchain.swapchainImages();
+    return m_headless ? m_offscreenImages : m_swapchain.swapchainImages();
   }
   [[nodiscard]] const std::vector<VkImageView> &colorViews() const {
-    return m_swapchain.swapchainImageViews();
+    return m_headless ? m_offscreenViews : m_swapchain.swapchainImageViews();
   }
   [[nodiscard]] VkExtent2D swapchainExtent() const {
-    return m_swapchain.swapchainExtent();
+    return m_headless ? m_offscreenExtent : m_swapchain.swapchainExtent();
   }
+  // VK_NULL_HANDLE when headless
   [[nodiscard]] VkSwapchainKHR swapchain() const {
     return m_swapchain.swapchain();
   }
   [[nodiscard]] VkSurfaceKHR surface() const { return m_surface; }
 
+  [[nodiscard]] bool headless() const { return m_headless; }
+  // Layout color images are left in at the end of a frame
+  [[nodiscard]] VkImageLayout presentLayout() const {
+    return m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                      : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  }
+
   [[nodiscard]] bool isInitialized() const {
-    return m_surface != VK_NULL_HANDLE;
+    return m_surface != VK_NULL_HANDLE || m_headless;
   }
 
   [[nodiscard]] uint32_t imageCount() const {
-    return static_cast<uint32_t>(m_swapchain.swapchainImageViews().size());
+    return static_cast<uint32_t>(colorViews().size());
   }
 
 private:
@@ -71,4 +94,11 @@ private:
 
   VkSurfaceKHR m_surface = VK_NULL_HANDLE;
   VkSwapchain m_swapchain;
+
+  // Headless targets, replace the swapchain images
+  std::vector<VkImageObj> m_offscreen;
+  std::vector<VkImage> m_offscreenImages;    // parallel to m_offscreen
+  std::vector<VkImageView> m_offscreenViews; // owning
+  VkExtent2D m_offscreenExtent{};
+  bool m_headless = false;
 };
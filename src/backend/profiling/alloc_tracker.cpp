@@ -0,0 +1,239 @@
+#include "backend/profiling/alloc_tracker.hpp"
+
+#if defined(QUARK_ALLOC_TRACKING)
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+namespace profiling {
+
+namespace {
+
+// Plain counters so the hooks never need a constructor or a lock
+struct ThreadState {
+  uint64_t allocations;
+  uint64_t bytes;
+  uint64_t frees;
+  uint32_t noAllocDepth;
+  bool reporting; // inside printStack, which may allocate itself
+};
+
+constinit thread_local ThreadState t_state{};
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_bytes{0};
+std::atomic<uint64_t> g_frees{0};
+
+std::atomic<bool> g_captureStacks{false};
+std::atomic<bool> g_failOnAlloc{false};
+std::atomic<uint32_t> g_stackReports{0};
+
+void printStack(std::size_t size) noexcept {
+  if (g_stackReports.fetch_add(1, std::memory_order_relaxed) >=
+      AllocTracker::kMaxStackReports) {
+    return;
+  }
+
+  std::fprintf(stderr, "[Alloc] %zu byte allocation in a no-alloc scope\n",
+               size);
+#if defined(__GLIBC__)
+  void *frames[32];
+  const int n = backtrace(frames, 32);
+  // Writes straight to the fd, no malloc
+  backtrace_symbols_fd(frames, n, STDERR_FILENO);
+#endif
+}
+
+void onAlloc(std::size_t size) noexcept {
+  ThreadState &s = t_state;
+  ++s.allocations;
+  s.bytes += size;
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+
+  if (s.noAllocDepth != 0 && !s.reporting &&
+      g_captureStacks.load(std::memory_order_relaxed)) {
+    s.reporting = true;
+    printStack(size);
+    s.reporting = false;
+  }
+}
+
+void onFree(void *p) noexcept {
+  if (p != nullptr) {
+    ++t_state.frees;
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void *tryAllocate(std::size_t size, std::size_t align) noexcept {
+  if (size == 0) {
+    size = 1;
+  }
+
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    return std::malloc(size);
+  }
+
+  // aligned_alloc wants a multiple of the alignment
+  const std::size_t rounded = (size + align - 1) & ~(align - 1);
+#if defined(_WIN32)
+  return _aligned_malloc(rounded, align);
+#else
+  return std::aligned_alloc(align, rounded);
+#endif
+}
+
+void release(void *p, std::size_t align) noexcept {
+  onFree(p);
+#if defined(_WIN32)
+  if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    _aligned_free(p);
+    return;
+  }
+#else
+  (void)align;
+#endif
+  std::free(p);
+}
+
+void *allocate(std::size_t size, std::size_t align) {
+  for (;;) {
+    if (void *p = tryAllocate(size, align)) {
+      onAlloc(size);
+      return p;
+    }
+
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void *allocateNoThrow(std::size_t size, std::size_t align) noexcept {
+  try {
+    return allocate(size, align);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+constexpr std::size_t kDefaultAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+} // namespace
+
+AllocCounts AllocTracker::thread() noexcept {
+  const ThreadState &s = t_state;
+  return AllocCounts{s.allocations, s.bytes, s.frees};
+}
+
+AllocCounts AllocTracker::process() noexcept {
+  return AllocCounts{g_allocations.load(std::memory_order_relaxed),
+                     g_bytes.load(std::memory_order_relaxed),
+                     g_frees.load(std::memory_order_relaxed)};
+}
+
+void AllocTracker::setCaptureStacks(bool on) noexcept {
+  g_captureStacks.store(on, std::memory_order_relaxed);
+}
+
+void AllocTracker::setFailOnAlloc(bool on) noexcept {
+  g_failOnAlloc.store(on, std::memory_order_relaxed);
+}
+
+void AllocTracker::enterNoAlloc() noexcept { ++t_state.noAllocDepth; }
+
+void AllocTracker::leaveNoAlloc(const char *name, uint64_t before) noexcept {
+  ThreadState &s = t_state;
+  --s.noAllocDepth;
+
+  const uint64_t count = s.allocations - before;
+  if (count != 0 && g_failOnAlloc.load(std::memory_order_relaxed)) {
+    std::fprintf(stderr, "[Alloc] %llu allocations in no-alloc scope '%s'\n",
+                 static_cast<unsigned long long>(count), name);
+    std::abort();
+  }
+}
+
+} // namespace profiling
+
+// Replaceable global allocation functions, every form since C++17
+
+void *operator new(std::size_t size) {
+  return profiling::allocate(size, profiling::kDefaultAlign);
+}
+void *operator new[](std::size_t size) {
+  return profiling::allocate(size, profiling::kDefaultAlign);
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return profiling::allocateNoThrow(size, profiling::kDefaultAlign);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return profiling::allocateNoThrow(size, profiling::kDefaultAlign);
+}
+void *operator new(std::size_t size, std::align_val_t align) {
+  return profiling::allocate(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align) {
+  return profiling::allocate(size, static_cast<std::size_t>(align));
+}
+void *operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t &) noexcept {
+  return profiling::allocateNoThrow(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t &) noexcept {
+  return profiling::allocateNoThrow(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *p) noexcept {
+  profiling::release(p, profiling::kDefaultAlign);
+}
+void operator delete[](void *p) noexcept {
+  profiling::release(p, profiling::kDefaultAlign);
+}
+void operator delete(void *p, std::size_t) noexcept {
+  profiling::release(p, profiling::kDefaultAlign);
+}
+void operator delete[](void *p, std::size_t) noexcept {
+  profiling::release(p, profiling::kDefaultAlign);
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  profiling::release(p, profiling::kDefaultAlign);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  profiling::release(p, profiling::kDefaultAlign);
+}
+void operator delete(void *p, std::align_val_t align) noexcept {
+  profiling::release(p, static_cast<std::size_t>(align));
+}
+void operator delete[](void *p, std::align_val_t align) noexcept {
+  profiling::release(p, static_cast<std::size_t>(align));
+}
+void operator delete(void *p, std::size_t, std::align_val_t align) noexcept {
+  profiling::release(p, static_cast<std::size_t>(align));
+}
+void operator delete[](void *p, std::size_t, std::align_val_t align) noexcept {
+  profiling::release(p, static_cast<std::size_t>(align));
+}
+void operator delete(void *p, std::align_val_t align,
+                     const std::nothrow_t &) noexcept {
+  profiling::release(p, static_cast<std::size_t>(align));
+}
+void operator delete[](void *p, std::align_val_t align,
+                       const std::nothrow_t &) noexcept {
+  profiling::release(p, static_cast<std::size_t>(align));
+}
+
+#endif // QUARK_ALLOC_TRACKING
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation counting through replaced global operator new/delete.
+// Opt-in with the QUARK_ALLOC_TRACKING CMake option, without it every
+// counter reads zero and the scopes compile to nothing.
+
+namespace profiling {
+
+struct AllocCounts {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0; // requested, not including allocator overhead
+  uint64_t frees = 0;
+};
+
+class AllocTracker {
+public:
+#if defined(QUARK_ALLOC_TRACKING)
+  static constexpr bool kCompiledIn = true;
+
+  // Calling thread since it started, never reset
+  [[nodiscard]] static AllocCounts thread() noexcept;
+  // All threads since process start
+  [[nodiscard]] static AllocCounts process() noexcept;
+
+  // Print a stack for allocations inside a NoAllocScope, capped at
+  // kMaxStackReports for the process
+  static void setCaptureStacks(bool on) noexcept;
+  // Debug builds abort when a NoAllocScope saw an allocation
+  static void setFailOnAlloc(bool on) noexcept;
+#else
+  static constexpr bool kCompiledIn = false;
+
+  [[nodiscard]] static AllocCounts thread() noexcept { return {}; }
+  [[nodiscard]] static AllocCounts process() noexcept { return {}; }
+  static void setCaptureStacks(bool) noexcept {}
+  static void setFailOnAlloc(bool) noexcept {}
+#endif
+
+  static constexpr uint32_t kMaxStackReports = 16;
+
+private:
+  friend class NoAllocScope;
+
+#if defined(QUARK_ALLOC_TRACKING)
+  static void enterNoAlloc() noexcept;
+  static void leaveNoAlloc(const char *name, uint64_t before) noexcept;
+#endif
+};
+
+// Marks a region of the calling thread that must not touch the heap.
+// Checked in debug builds with tracking compiled in, free otherwise.
+class NoAllocScope {
+public:
+#if defined(QUARK_ALLOC_TRACKING) && !defined(NDEBUG)
+  explicit NoAllocScope(const char *name) noexcept
+      : m_name(name), m_before(AllocTracker::thread().allocations) {
+    AllocTracker::enterNoAlloc();
+  }
+  ~NoAllocScope() noexcept { AllocTracker::leaveNoAlloc(m_name, m_before); }
+#else
+  explicit NoAllocScope(const char *) noexcept {}
+#endif
+
+  NoAllocScope(const NoAllocScope &) = delete;
+  NoAllocScope &operator=(const NoAllocScope &) = delete;
+  NoAllocScope(NoAllocScope &&) = delete;
+  NoAllocScope &operator=(NoAllocScope &&) = delete;
+
+#if defined(QUARK_ALLOC_TRACKING) && !defined(NDEBUG)
+private:
+  const char *m_name;
+  uint64_t m_before;
+#endif
+};
+
+} // namespace profiling
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "backend/profiling/alloc_tracker.hpp"
+#include "backend/profiling/trace_recorder.hpp"
+
 #include <algorithm>
 #include <array>
 #include <chrono>
@@ -7,6 +10,7 @@
 #include <cstdint>
 #include <ctime>
 #include <string_view>
+#include <utility>
 
 class CpuProfiler {
 public:
@@ -26,17 +30,31 @@ public:
 
   struct FrameStats {
     std::array<double, static_cast<size_t>(Stat::Count)> ms{};
+    // Heap allocations made by the scope's thread, zero unless built with
+    // QUARK_ALLOC_TRACKING
+    std::array<uint32_t, static_cast<size_t>(Stat::Count)> allocations{};
+    std::array<uint64_t, static_cast<size_t>(Stat::Count)> allocatedBytes{};
     uint32_t drawCalls = 0;
     uint64_t triangles = 0;
     uint32_t pipelineBinds = 0;
     uint32_t descriptorBinds = 0;
     uint32_t instances = 0;
+    // Frame arena bytes used this frame and the largest frame so far
+    uint64_t arenaBytes = 0;
+    uint64_t arenaHighWater = 0;
   };
 
   class Scope {
   public:
+    // Also a trace scope while the TraceRecorder runs
     Scope(CpuProfiler &profiler, Stat stat) noexcept
-        : m_profiler(&profiler), m_stat(stat), m_t0(clock::now()) {}
+        : m_profiler(&profiler), m_stat(stat), m_t0(clock::now()),
+          m_allocs0(profiling::AllocTracker::thread()) {
+      if (profiling::TraceRecorder::enabled()) {
+        profiling::TraceRecorder::instance().begin(name(stat));
+        m_traced = true;
+      }
+    }
     ~Scope() noexcept { end(); }
 
     Scope(const Scope &) = delete;
@@ -53,6 +71,8 @@ public:
       m_profiler = other.m_profiler;
       m_stat = other.m_stat;
       m_t0 = other.m_t0;
+      m_allocs0 = other.m_allocs0;
+      m_traced = std::exchange(other.m_traced, false);
       other.m_profiler = nullptr;
 
       return *this;
@@ -71,12 +91,25 @@ public:
           std::chrono::duration<double, std::milli>(t1 - m_t0).count();
 
       m_profiler->add(m_stat, ms);
+      if constexpr (profiling::AllocTracker::kCompiledIn) {
+        const profiling::AllocCounts a1 = profiling::AllocTracker::thread();
+        m_profiler->addAllocations(m_stat,
+                                   a1.allocations - m_allocs0.allocations,
+                                   a1.bytes - m_allocs0.bytes);
+      }
       m_profiler = nullptr;
+
+      if (m_traced) {
+        profiling::TraceRecorder::instance().end();
+        m_traced = false;
+      }
     }
 
     CpuProfiler *m_profiler = nullptr;
     Stat m_stat{};
     clock::time_point m_t0;
+    profiling::AllocCounts m_allocs0;
+    bool m_traced = false;
   };
 
   void endFrame() noexcept {
@@ -105,6 +138,10 @@ public:
     m_cur.descriptorBinds += n;
   }
   void addInstances(uint32_t n) noexcept { m_cur.instances += n; }
+  void setFrameArena(uint64_t used, uint64_t highWater) noexcept {
+    m_cur.arenaBytes = used;
+    m_cur.arenaHighWater = highWater;
+  }
 
   [[nodiscard]] const FrameStats &last() const noexcept { return m_last; }
 
@@ -127,6 +164,8 @@ public:
       return "QueuePresent";
     case Stat::SwapchainRecreate:
       return "SwapchainRecreate";
+    case Stat::WaitIdle:
+      return "WaitIdle";
     case Stat::Other:
       return "Other";
     default:
@@ -140,6 +179,10 @@ private:
   void add(Stat stat, double ms) noexcept {
     m_cur.ms[static_cast<size_t>(stat)] += ms;
   }
+  void addAllocations(Stat stat, uint64_t count, uint64_t bytes) noexcept {
+    m_cur.allocations[static_cast<size_t>(stat)] += uint32_t(count);
+    m_cur.allocatedBytes[static_cast<size_t>(stat)] += bytes;
+  }
 
   void resetCurrent() noexcept { m_cur = FrameStats{}; }
 
@@ -0,0 +1,142 @@
+#include "backend/profiling/frame_statistics.hpp"
+
+#include "backend/profiling/cpu_profiler.hpp"
+#include "backend/profiling/upload_profiler.hpp"
+#include "backend/profiling/vk_gpu_profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace profiling {
+
+size_t LogHistogram::bucketOf(double v) noexcept {
+  if (!(v > 0.0)) {
+    return 0;
+  }
+
+  // v = m * 2^e with m in [0.5, 1), so v lies in [2^(e-1), 2^e)
+  int e = 0;
+  const double m = std::frexp(v, &e);
+  const int exp = e - 1;
+  if (exp < kMinExp) {
+    return 0;
+  }
+  if (exp >= kMaxExp) {
+    return kBucketCount - 1;
+  }
+
+  const auto sub = static_cast<int>((m * 2.0 - 1.0) * kSubBuckets);
+  return (size_t(exp - kMinExp) * kSubBuckets) +
+         size_t(std::min(sub, kSubBuckets - 1));
+}
+
+double LogHistogram::upperEdge(size_t bucket) noexcept {
+  const int exp = static_cast<int>(bucket / kSubBuckets) + kMinExp;
+  const auto sub = static_cast<double>(bucket % kSubBuckets);
+  return std::ldexp(1.0 + ((sub + 1.0) / kSubBuckets), exp);
+}
+
+void LogHistogram::add(double v) noexcept {
+  ++m_buckets[bucketOf(v)];
+  ++m_count;
+  m_max = std::max(m_max, v);
+}
+
+double LogHistogram::percentile(double p) const noexcept {
+  if (m_count == 0) {
+    return 0.0;
+  }
+
+  const auto rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) *
+                                         static_cast<double>(m_count))));
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += m_buckets[i];
+    if (seen >= rank) {
+      return std::min(upperEdge(i), m_max);
+    }
+  }
+  return m_max;
+}
+
+void RollingStat::add(double v) noexcept {
+  m_ring[m_next] = v;
+  m_next = (m_next + 1) % kWindow;
+  m_size = std::min(m_size + 1, kWindow);
+  m_lifetime.add(v);
+}
+
+StatSummary RollingStat::window() const noexcept {
+  StatSummary out{};
+  if (m_size == 0) {
+    return out;
+  }
+
+  std::array<double, kWindow> sorted{};
+  std::copy_n(m_ring.begin(), m_size, sorted.begin());
+  const auto end = sorted.begin() + m_size;
+  std::sort(sorted.begin(), end);
+
+  // Nearest rank
+  const auto at = [&](double p) {
+    const auto rank = static_cast<uint32_t>(std::ceil(p * m_size));
+    return sorted[std::max<uint32_t>(rank, 1) - 1];
+  };
+
+  double sum = 0.0;
+  for (auto it = sorted.begin(); it != end; ++it) {
+    sum += *it;
+  }
+
+  out.count = m_size;
+  out.min = sorted.front();
+  out.avg = sum / m_size;
+  out.p50 = at(0.50);
+  out.p95 = at(0.95);
+  out.p99 = at(0.99);
+  out.max = sorted[m_size - 1];
+  return out;
+}
+
+uint32_t RollingStat::windowCountAbove(double threshold) const noexcept {
+  const auto end = m_ring.begin() + m_size;
+  return static_cast<uint32_t>(std::count_if(
+      m_ring.begin(), end, [threshold](double v) { return v > threshold; }));
+}
+
+void FrameStatistics::record(const CpuProfiler &cpu, const VkGpuProfiler &gpu,
+                             const UploadProfiler &upload) noexcept {
+  const CpuProfiler::FrameStats &cst = cpu.last();
+  for (size_t i = 0; i < m_cpu.size(); ++i) {
+    m_cpu[i].add(cst.ms[i]);
+  }
+
+  const double frameMs =
+      cst.ms[static_cast<size_t>(CpuProfiler::Stat::FrameTotal)];
+  ++m_frames;
+  m_over60 += frameMs > kBudget60Ms ? 1 : 0;
+  m_over30 += frameMs > kBudget30Ms ? 1 : 0;
+
+  // last() holds the previous result while queries are not ready, skip
+  // repeats so a stalled readback doesn't skew the distribution
+  const VkGpuProfiler::GpuFrameStats &gst = gpu.last();
+  if (gst.valid && gst.sequence != m_lastGpuSequence) {
+    m_lastGpuSequence = gst.sequence;
+    m_gpu[size_t(Gpu::Frame)].add(gst.frameMs);
+    m_gpu[size_t(Gpu::MainPass)].add(gst.mainPassMs);
+    m_gpu[size_t(Gpu::IdleGap)].add(gst.idleGapMs);
+  }
+
+  const UploadProfiler::Stats &ust = upload.last();
+  m_upload[size_t(Upload::MemcpyBytes)].add(static_cast<double>(
+      ust.v[size_t(UploadProfiler::Stat::UploadMemcpyBytes)]));
+  m_upload[size_t(Upload::StagingUsedBytes)].add(static_cast<double>(
+      ust.v[size_t(UploadProfiler::Stat::StagingUsedBytes)]));
+}
+
+} // namespace profiling
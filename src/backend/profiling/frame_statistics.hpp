@@ -0,0 +1,112 @@
+#pragma once
+
+#include "backend/profiling/cpu_profiler.hpp"
+#include "backend/profiling/upload_profiler.hpp"
+#include "backend/profiling/vk_gpu_profiler.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace profiling {
+
+struct StatSummary {
+  uint32_t count = 0;
+  double min = 0.0;
+  double avg = 0.0;
+  double p50 = 0.0;
+  double p95 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+};
+
+// HDR-style histogram: 16 linear sub-buckets per power of two, so any
+// percentile is within ~6% of the true value. Fixed size, never allocates.
+class LogHistogram {
+public:
+  void add(double v) noexcept;
+  void reset() noexcept { *this = LogHistogram{}; }
+
+  [[nodiscard]] uint64_t count() const noexcept { return m_count; }
+  [[nodiscard]] double max() const noexcept { return m_max; }
+  // Upper edge of the bucket holding the p-th percentile, p in [0, 1]
+  [[nodiscard]] double percentile(double p) const noexcept;
+
+private:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kMinExp = -16; // 2^-16 ms is ~15 ns
+  static constexpr int kMaxExp = 40;  // 1 TiB when counting bytes
+  static constexpr size_t kBucketCount =
+      size_t(kMaxExp - kMinExp) * kSubBuckets;
+
+  static size_t bucketOf(double v) noexcept;
+  static double upperEdge(size_t bucket) noexcept;
+
+  std::array<uint32_t, kBucketCount> m_buckets{};
+  uint64_t m_count = 0;
+  double m_max = 0.0;
+};
+
+// Last kWindow samples for exact windowed percentiles, plus a lifetime
+// histogram
+class RollingStat {
+public:
+  static constexpr uint32_t kWindow = 240;
+
+  void add(double v) noexcept;
+
+  [[nodiscard]] StatSummary window() const noexcept;
+  [[nodiscard]] uint32_t windowCountAbove(double threshold) const noexcept;
+  [[nodiscard]] const LogHistogram &lifetime() const noexcept {
+    return m_lifetime;
+  }
+
+private:
+  std::array<double, kWindow> m_ring{};
+  uint32_t m_next = 0;
+  uint32_t m_size = 0;
+  LogHistogram m_lifetime;
+};
+
+// Distributions over the profilers, fed once per frame. FrameLogger
+// prints them.
+class FrameStatistics {
+public:
+  static constexpr double kBudget60Ms = 1000.0 / 60.0;
+  static constexpr double kBudget30Ms = 1000.0 / 30.0;
+
+  enum class Gpu : uint8_t { Frame = 0, MainPass, IdleGap, Count };
+  enum class Upload : uint8_t { MemcpyBytes = 0, StagingUsedBytes, Count };
+
+  void record(const CpuProfiler &cpu, const VkGpuProfiler &gpu,
+              const UploadProfiler &upload) noexcept;
+
+  [[nodiscard]] const RollingStat &
+  cpu(CpuProfiler::Stat stat) const noexcept {
+    return m_cpu[static_cast<size_t>(stat)];
+  }
+  [[nodiscard]] const RollingStat &gpu(Gpu stat) const noexcept {
+    return m_gpu[static_cast<size_t>(stat)];
+  }
+  [[nodiscard]] const RollingStat &upload(Upload stat) const noexcept {
+    return m_upload[static_cast<size_t>(stat)];
+  }
+
+  // Lifetime frame count and frames over each budget
+  [[nodiscard]] uint64_t frames() const noexcept { return m_frames; }
+  [[nodiscard]] uint64_t over60() const noexcept { return m_over60; }
+  [[nodiscard]] uint64_t over30() const noexcept { return m_over30; }
+
+private:
+  std::array<RollingStat, size_t(CpuProfiler::Stat::Count)> m_cpu{};
+  std::array<RollingStat, size_t(Gpu::Count)> m_gpu{};
+  std::array<RollingStat, size_t(Upload::Count)> m_upload{};
+  uint64_t m_lastGpuSequence = 0; // GpuFrameStats::sequence recorded last
+
+  uint64_t m_frames = 0;
+  uint64_t m_over60 = 0;
+  uint64_t m_over30 = 0;
+};
+
+} // namespace profiling
@@ -0,0 +1,111 @@
+#include "backend/profiling/memory_tracker.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <vector>
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan_core.h>
+
+namespace profiling {
+
+namespace {
+
+void raisePeak(std::atomic<uint64_t> &peak, uint64_t live) noexcept {
+  uint64_t seen = peak.load(std::memory_order_relaxed);
+  while (live > seen &&
+         !peak.compare_exchange_weak(seen, live, std::memory_order_relaxed)) {
+  }
+}
+
+} // namespace
+
+MemoryTracker &MemoryTracker::instance() noexcept {
+  // Leaked on purpose: static destructors may still free tracked memory
+  static MemoryTracker *tracker = new MemoryTracker();
+  return *tracker;
+}
+
+void MemoryTracker::onAlloc(MemoryTag tag, uint64_t bytes) noexcept {
+  Counters &c = m_tags[static_cast<size_t>(tag)];
+  c.allocs.fetch_add(1, std::memory_order_relaxed);
+  raisePeak(c.peak, c.live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+
+  m_total.allocs.fetch_add(1, std::memory_order_relaxed);
+  raisePeak(m_total.peak,
+            m_total.live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryTracker::onFree(MemoryTag tag, uint64_t bytes) noexcept {
+  Counters &c = m_tags[static_cast<size_t>(tag)];
+  c.frees.fetch_add(1, std::memory_order_relaxed);
+  c.live.fetch_sub(bytes, std::memory_order_relaxed);
+
+  m_total.frees.fetch_add(1, std::memory_order_relaxed);
+  m_total.live.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemorySnapshot MemoryTracker::snapshot() const noexcept {
+  MemorySnapshot out{};
+  for (size_t i = 0; i < m_tags.size(); ++i) {
+    MemoryCategoryStats &s = out.categories[i];
+    s.liveBytes = m_tags[i].live.load(std::memory_order_relaxed);
+    s.peakBytes = m_tags[i].peak.load(std::memory_order_relaxed);
+    s.allocCount = m_tags[i].allocs.load(std::memory_order_relaxed);
+    s.freeCount = m_tags[i].frees.load(std::memory_order_relaxed);
+  }
+
+  out.liveBytes = m_total.live.load(std::memory_order_relaxed);
+  out.peakBytes = m_total.peak.load(std::memory_order_relaxed);
+  return out;
+}
+
+std::vector<MemoryDiff> diff(const MemorySnapshot &before,
+                             const MemorySnapshot &after) {
+  std::vector<MemoryDiff> out;
+  for (size_t i = 0; i < after.categories.size(); ++i) {
+    const MemoryCategoryStats &b = before.categories[i];
+    const MemoryCategoryStats &a = after.categories[i];
+
+    MemoryDiff d{};
+    d.tag = static_cast<MemoryTag>(i);
+    d.liveBytes = static_cast<int64_t>(a.liveBytes - b.liveBytes);
+    d.liveCount = static_cast<int64_t>((a.allocCount - a.freeCount) -
+                                       (b.allocCount - b.freeCount));
+    if (d.liveBytes != 0 || d.liveCount != 0) {
+      out.push_back(d);
+    }
+  }
+
+  return out;
+}
+
+bool writeVmaStatsJson(VmaAllocator allocator,
+                       const std::filesystem::path &path) {
+  if (allocator == nullptr) {
+    std::cerr << "[Memory] writeVmaStatsJson without an allocator\n";
+    return false;
+  }
+
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "[Memory] Failed to open '" << path.string() << "'\n";
+    return false;
+  }
+
+  char *json = nullptr;
+  vmaBuildStatsString(allocator, &json, /*detailedMap=*/VK_TRUE);
+  if (json == nullptr) {
+    return false;
+  }
+
+  file << json << '\n';
+  vmaFreeStatsString(allocator, json);
+  return static_cast<bool>(file);
+}
+
+} // namespace profiling
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <vk_mem_alloc.h>
+
+namespace profiling {
+
+enum class MemoryTag : uint8_t {
+  Mesh = 0,
+  Texture,
+  Instance,
+  Material,
+  Staging,
+  Uniform,
+  RenderTarget,
+  CpuAsset, // decoded asset data kept in system memory
+  Other,
+  Count
+};
+
+constexpr std::string_view name(MemoryTag tag) noexcept {
+  switch (tag) {
+  case MemoryTag::Mesh:
+    return "Mesh";
+  case MemoryTag::Texture:
+    return "Texture";
+  case MemoryTag::Instance:
+    return "Instance";
+  case MemoryTag::Material:
+    return "Material";
+  case MemoryTag::Staging:
+    return "Staging";
+  case MemoryTag::Uniform:
+    return "Uniform";
+  case MemoryTag::RenderTarget:
+    return "RenderTarget";
+  case MemoryTag::CpuAsset:
+    return "CpuAsset";
+  case MemoryTag::Other:
+    return "Other";
+  default:
+    return "Unknown";
+  }
+}
+
+struct MemoryCategoryStats {
+  uint64_t liveBytes = 0;
+  uint64_t peakBytes = 0;
+  uint64_t allocCount = 0;
+  uint64_t freeCount = 0;
+};
+
+struct MemorySnapshot {
+  std::array<MemoryCategoryStats, static_cast<size_t>(MemoryTag::Count)>
+      categories{};
+  uint64_t liveBytes = 0; // all tags
+  uint64_t peakBytes = 0;
+
+  [[nodiscard]] const MemoryCategoryStats &
+  operator[](MemoryTag tag) const noexcept {
+    return categories[static_cast<size_t>(tag)];
+  }
+};
+
+struct MemoryDiff {
+  MemoryTag tag = MemoryTag::Other;
+  int64_t liveBytes = 0;
+  int64_t liveCount = 0; // allocations minus frees
+};
+
+// Live and peak bytes per tag for the whole process. Counters are atomics,
+// any thread may report.
+class MemoryTracker {
+public:
+  [[nodiscard]] static MemoryTracker &instance() noexcept;
+
+  void onAlloc(MemoryTag tag, uint64_t bytes) noexcept;
+  void onFree(MemoryTag tag, uint64_t bytes) noexcept;
+
+  [[nodiscard]] MemorySnapshot snapshot() const noexcept;
+
+private:
+  struct Counters {
+    std::atomic<uint64_t> live{0};
+    std::atomic<uint64_t> peak{0};
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+  };
+
+  MemoryTracker() = default;
+
+  std::array<Counters, static_cast<size_t>(MemoryTag::Count)> m_tags{};
+  Counters m_total{};
+};
+
+// Tags whose live bytes or live allocation count changed between two
+// snapshots. Snapshots around a level load and unload should diff empty.
+[[nodiscard]] std::vector<MemoryDiff> diff(const MemorySnapshot &before,
+                                           const MemorySnapshot &after);
+
+// Reports bytes to the tracker for as long as it lives
+class TrackedBytes {
+public:
+  TrackedBytes() = default;
+  TrackedBytes(MemoryTag tag, uint64_t bytes) noexcept
+      : m_tag(tag), m_bytes(bytes) {
+    if (m_bytes != 0) {
+      MemoryTracker::instance().onAlloc(m_tag, m_bytes);
+    }
+  }
+  ~TrackedBytes() noexcept { reset(); }
+
+  TrackedBytes(const TrackedBytes &) = delete;
+  TrackedBytes &operator=(const TrackedBytes &) = delete;
+
+  TrackedBytes(TrackedBytes &&other) noexcept { *this = std::move(other); }
+  TrackedBytes &operator=(TrackedBytes &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    reset();
+
+    m_tag = other.m_tag;
+    m_bytes = std::exchange(other.m_bytes, 0ULL);
+
+    return *this;
+  }
+
+  void reset() noexcept {
+    if (m_bytes != 0) {
+      MemoryTracker::instance().onFree(m_tag, m_bytes);
+      m_bytes = 0;
+    }
+  }
+
+  [[nodiscard]] uint64_t bytes() const noexcept { return m_bytes; }
+
+private:
+  MemoryTag m_tag = MemoryTag::Other;
+  uint64_t m_bytes = 0;
+};
+
+// VMA's detailed per-heap and per-allocation JSON (vmaBuildStatsString)
+bool writeVmaStatsJson(VmaAllocator allocator,
+                       const std::filesystem::path &path);
+
+} // namespace profiling
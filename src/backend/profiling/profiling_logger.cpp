@@ -1,14 +1,19 @@
 #include "backend/profiling/profiling_logger.hpp"
 
+#include "backend/profiling/alloc_tracker.hpp"
 #include "backend/profiling/cpu_profiler.hpp"
+#include "backend/profiling/frame_statistics.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "backend/profiling/upload_profiler.hpp"
 #include "backend/profiling/vk_gpu_profiler.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <iostream>
+#include <string_view>
 
 namespace profiling {
 
@@ -48,11 +53,6 @@ bool FrameLogger::shouldLog() noexcept {
   return (m_frameCounter % m_period) == 0ULL;
 }
 
-static inline double msAt(const CpuProfiler::FrameStats &st,
-                          CpuProfiler::Stat stat) noexcept {
-  return st.ms[static_cast<size_t>(stat)];
-}
-
 static inline void formatMs(char *out, size_t outSize, double ms) noexcept {
   if (ms >= 10.0) {
     ignore_snprintf(std::snprintf(out, outSize, "%6.2f", ms));
@@ -67,68 +67,154 @@ static inline void formatMs(char *out, size_t outSize, double ms) noexcept {
   }
 }
 
-static void logCpu(const CpuProfiler &cpu) noexcept {
-  const auto &st = cpu.last();
+static void formatRow(char *out, size_t outSize, std::string_view label,
+                      const RollingStat &stat) noexcept {
+  const StatSummary w = stat.window();
 
-  std::array<char, 512> line1{};
-  std::array<char, 256> line2{};
-
-  std::array<char, 16> frame{};
-  std::array<char, 16> acq{};
-  std::array<char, 16> fence{};
-  std::array<char, 16> ubo{};
-  std::array<char, 16> rec{};
-  std::array<char, 16> sub{};
-  std::array<char, 16> pres{};
-  std::array<char, 16> other{};
-
-  formatMs(frame.data(), frame.size(), msAt(st, CpuProfiler::Stat::FrameTotal));
-  formatMs(acq.data(), acq.size(), msAt(st, CpuProfiler::Stat::Acquire));
-  formatMs(fence.data(), fence.size(),
-           msAt(st, CpuProfiler::Stat::WaitForFence));
-  formatMs(ubo.data(), ubo.size(),
-           msAt(st, CpuProfiler::Stat::UpdatePerFrameUBO));
-  formatMs(rec.data(), rec.size(), msAt(st, CpuProfiler::Stat::RecordCmd));
-  formatMs(sub.data(), sub.size(), msAt(st, CpuProfiler::Stat::QueueSubmit));
-  formatMs(pres.data(), pres.size(), msAt(st, CpuProfiler::Stat::QueuePresent));
-  formatMs(other.data(), other.size(), msAt(st, CpuProfiler::Stat::Other));
+  std::array<std::array<char, 16>, 7> col{};
+  formatMs(col[0].data(), col[0].size(), w.min);
+  formatMs(col[1].data(), col[1].size(), w.avg);
+  formatMs(col[2].data(), col[2].size(), w.p50);
+  formatMs(col[3].data(), col[3].size(), w.p95);
+  formatMs(col[4].data(), col[4].size(), w.p99);
+  formatMs(col[5].data(), col[5].size(), w.max);
+  formatMs(col[6].data(), col[6].size(), stat.lifetime().percentile(0.99));
+
+  ignore_snprintf(std::snprintf(
+      out, outSize, "  %-18.*s %s %s %s %s %s %s   %s",
+      static_cast<int>(label.size()), label.data(), col[0].data(),
+      col[1].data(), col[2].data(), col[3].data(), col[4].data(),
+      col[5].data(), col[6].data()));
+}
 
+static void logHeader(const char *title, uint32_t window) noexcept {
+  std::array<char, 160> line{};
   ignore_snprintf(std::snprintf(
-      line1.data(), line1.size(),
-      "CPU  ms: frame %s  acq %s  fence %s  ubo %s  rec %s  sub %s  "
-      "pres %s  other %s",
-      frame.data(), acq.data(), fence.data(), ubo.data(), rec.data(),
-      sub.data(), pres.data(), other.data()));
+      line.data(), line.size(),
+      "%-4s ms, last %-4u %-8s %6s %6s %6s %6s %6s %6s   %6s", title, window,
+      "", "min", "avg", "p50", "p95", "p99", "max", "lifeP99"));
+  std::cerr << line.data() << "\n";
+}
+
+static void logCpu(const CpuProfiler &cpu,
+                   const FrameStatistics &stats) noexcept {
+  const RollingStat &frame = stats.cpu(CpuProfiler::Stat::FrameTotal);
+  const uint32_t window = frame.window().count;
+
+  std::cerr << "\n[Profiler]\n";
+  logHeader("CPU", window);
+
+  std::array<char, 256> row{};
+  for (size_t i = 0; i < static_cast<size_t>(CpuProfiler::Stat::Count); ++i) {
+    const auto stat = static_cast<CpuProfiler::Stat>(i);
+    const RollingStat &rs = stats.cpu(stat);
+    // Rare stats like SwapchainRecreate stay out of the table until they hit
+    if (stat != CpuProfiler::Stat::FrameTotal && rs.window().max <= 0.0) {
+      continue;
+    }
+
+    formatRow(row.data(), row.size(), CpuProfiler::name(stat), rs);
+    std::cerr << row.data() << "\n";
+  }
 
+  // Tail latency is what shows up as stutter
+  std::array<char, 256> budget{};
   ignore_snprintf(std::snprintf(
-      line2.data(), line2.size(),
+      budget.data(), budget.size(),
+      "CPU over budget: >%.1fms %u/%u (life %llu/%llu)  "
+      ">%.1fms %u/%u (life %llu/%llu)",
+      FrameStatistics::kBudget60Ms,
+      frame.windowCountAbove(FrameStatistics::kBudget60Ms), window,
+      static_cast<unsigned long long>(stats.over60()),
+      static_cast<unsigned long long>(stats.frames()),
+      FrameStatistics::kBudget30Ms,
+      frame.windowCountAbove(FrameStatistics::kBudget30Ms), window,
+      static_cast<unsigned long long>(stats.over30()),
+      static_cast<unsigned long long>(stats.frames())));
+
+  const auto &st = cpu.last();
+  std::array<char, 256> counters{};
+  ignore_snprintf(std::snprintf(
+      counters.data(), counters.size(),
       "CPU cnt: draws %-6u inst %-6u tris %-8llu pipe %-4u desc %-4u",
       st.drawCalls, st.instances, static_cast<unsigned long long>(st.triangles),
       st.pipelineBinds, st.descriptorBinds));
 
-  std::cerr << "\n[Profiler]\n" << line1.data() << "\n" << line2.data() << "\n";
+  std::array<char, 32> arena{};
+  std::array<char, 32> arenaPeak{};
+  formatBytes(arena.data(), arena.size(), st.arenaBytes);
+  formatBytes(arenaPeak.data(), arenaPeak.size(), st.arenaHighWater);
+
+  std::cerr << budget.data() << "\n"
+            << counters.data() << " arena " << arena.data() << " (peak "
+            << arenaPeak.data() << ")\n";
+
+  if constexpr (AllocTracker::kCompiledIn) {
+    // Last frame, per scope on the render thread
+    std::cerr << "CPU alloc:";
+    for (size_t i = 0; i < st.allocations.size(); ++i) {
+      if (st.allocations[i] == 0) {
+        continue;
+      }
+
+      std::array<char, 32> bytes{};
+      formatBytes(bytes.data(), bytes.size(), st.allocatedBytes[i]);
+      std::cerr << ' ' << CpuProfiler::name(static_cast<CpuProfiler::Stat>(i))
+                << ' ' << st.allocations[i] << " (" << bytes.data() << ')';
+    }
+    std::cerr << "\n";
+  }
 }
 
-static void logGpu(const VkGpuProfiler &gpu) noexcept {
-  const auto &gst = gpu.last();
-  if (!gst.valid) {
-    return;
+static void logGpuScopes(const VkGpuProfiler &gpu) noexcept {
+  std::array<char, 256> line{};
+  for (const VkGpuProfiler::GpuScopeStats &s : gpu.lastScopes()) {
+    std::array<char, 16> ms{};
+    formatMs(ms.data(), ms.size(), s.ms);
+
+    const int indent = 2 + (2 * static_cast<int>(s.depth));
+    const int n = std::snprintf(
+        line.data(), line.size(), "%*s%-*.*s %s", indent, "",
+        std::max(1, 20 - indent), static_cast<int>(s.name.length),
+        s.name.chars.data(), ms.data());
+
+    if (s.hasPipelineStats && n > 0 && size_t(n) < line.size()) {
+      const VkGpuProfiler::GpuPipelineStats &p = s.pipeline;
+      ignore_snprintf(std::snprintf(
+          line.data() + n, line.size() - size_t(n),
+          "  prims %llu  vs %llu  clip %llu/%llu  fs %llu",
+          static_cast<unsigned long long>(p.primitives),
+          static_cast<unsigned long long>(p.vertexInvocations),
+          static_cast<unsigned long long>(p.clippingInvocations),
+          static_cast<unsigned long long>(p.clippingPrimitives),
+          static_cast<unsigned long long>(p.fragmentInvocations)));
+    }
+
+    std::cerr << line.data() << "\n";
   }
+}
 
-  std::array<char, 16> frame{};
-  std::array<char, 16> main{};
-  std::array<char, 16> idle{};
-
-  formatMs(frame.data(), frame.size(), gst.frameMs);
-  formatMs(main.data(), main.size(), gst.mainPassMs);
-  formatMs(idle.data(), idle.size(), gst.idleGapMs);
-
-  std::array<char, 256> line{};
-  ignore_snprintf(std::snprintf(line.data(), line.size(),
-                                "GPU  ms: frame %s  main %s  idle %s",
-                                frame.data(), main.data(), idle.data()));
+static void logGpu(const VkGpuProfiler &gpu,
+                   const FrameStatistics &stats) noexcept {
+  using Gpu = FrameStatistics::Gpu;
+
+  const uint32_t window = stats.gpu(Gpu::Frame).window().count;
+  if (window != 0) {
+    logHeader("GPU", window);
+
+    std::array<char, 256> row{};
+    formatRow(row.data(), row.size(), "Frame", stats.gpu(Gpu::Frame));
+    std::cerr << row.data() << "\n";
+    formatRow(row.data(), row.size(), "MainPass", stats.gpu(Gpu::MainPass));
+    std::cerr << row.data() << "\n";
+    formatRow(row.data(), row.size(), "IdleGap", stats.gpu(Gpu::IdleGap));
+    std::cerr << row.data() << "\n";
+  }
 
-  std::cerr << line.data() << "\n";
+  if (!gpu.lastScopes().empty()) {
+    std::cerr << "GPU scopes, ms:\n";
+    logGpuScopes(gpu);
+  }
 }
 
 static void logUpload(const UploadProfiler &upload) noexcept {
@@ -237,16 +323,66 @@ static void logUpload(const UploadProfiler &upload) noexcept {
   std::cerr << line.data() << "\n";
 }
 
+static void logUploadWindow(const FrameStatistics &stats) noexcept {
+  using Upload = FrameStatistics::Upload;
+
+  const StatSummary memcpyW = stats.upload(Upload::MemcpyBytes).window();
+  const StatSummary stagingW =
+      stats.upload(Upload::StagingUsedBytes).window();
+
+  std::array<std::array<char, 32>, 6> col{};
+  const auto bytes = [](std::array<char, 32> &out, double v) {
+    formatBytes(out.data(), out.size(), static_cast<std::uint64_t>(v));
+  };
+  bytes(col[0], memcpyW.p50);
+  bytes(col[1], memcpyW.p95);
+  bytes(col[2], memcpyW.max);
+  bytes(col[3], stagingW.p50);
+  bytes(col[4], stagingW.p95);
+  bytes(col[5], stagingW.max);
+
+  std::array<char, 256> line{};
+  ignore_snprintf(std::snprintf(
+      line.data(), line.size(),
+      "UPL per frame: memcpy p50 %s p95 %s max %s  "
+      "staging p50 %s p95 %s max %s",
+      col[0].data(), col[1].data(), col[2].data(), col[3].data(),
+      col[4].data(), col[5].data()));
+
+  std::cerr << line.data() << "\n";
+}
+
+static void logMemory(const MemorySnapshot &mem) noexcept {
+  std::array<char, 512> line{};
+  size_t used = 0;
+  const auto append = [&line, &used](const char *label, std::uint64_t b) {
+    std::array<char, 32> str{};
+    formatBytes(str.data(), str.size(), b);
+    const int n = std::snprintf(line.data() + used, line.size() - used,
+                                " %s %s", label, str.data());
+    used = std::min(used + size_t(std::max(n, 0)), line.size() - 1);
+  };
+
+  for (size_t i = 0; i < mem.categories.size(); ++i) {
+    if (mem.categories[i].liveBytes != 0) {
+      append(name(static_cast<MemoryTag>(i)).data(),
+             mem.categories[i].liveBytes);
+    }
+  }
+  append("| total", mem.liveBytes);
+  append("peak", mem.peakBytes);
+
+  std::cerr << "MEM live:" << line.data() << "\n";
+}
+
 void FrameLogger::logPerFrame(const CpuProfiler &cpu, const VkGpuProfiler &gpu,
                               const UploadProfiler &upload) noexcept {
+  m_stats.record(cpu, gpu, upload);
 
   if (!shouldLog()) {
     return;
   }
 
-  // TODO: add rolling average over N frames and print that on N frame instead
-  // of just N frame data
-
   // NOTE: if queueSubmit is large its likely artifical wait time
   // for vsync from FIFO present mode in swapchain
 
@@ -256,10 +392,12 @@ void FrameLogger::logPerFrame(const CpuProfiler &cpu, const VkGpuProfiler &gpu,
   // call submit immediate so I would have to pass profiler a lot. But it
   // doesn't matter since eventually submit Immediate will be removed and
   // we won't have blocking anymore
-  logCpu(cpu);
+  logCpu(cpu, m_stats);
 
   logUpload(upload);
-  logGpu(gpu);
+  logUploadWindow(m_stats);
+  logGpu(gpu, m_stats);
+  logMemory(MemoryTracker::instance().snapshot());
 
   std::cout << "\n";
 }
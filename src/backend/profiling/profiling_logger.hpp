@@ -1,6 +1,8 @@
 #pragma once
 
 #include "backend/profiling/cpu_profiler.hpp"
+#include "backend/profiling/frame_statistics.hpp"
+#include "backend/profiling/trace_recorder.hpp"
 #include "backend/profiling/upload_profiler.hpp"
 #include "backend/profiling/vk_gpu_profiler.hpp"
 
@@ -13,16 +15,21 @@ namespace profiling {
 
 inline void ignore_snprintf(int rc) noexcept { (void)rc; }
 
-// Per-frame logging
+// Records every frame, prints windowed distributions every m_period frames
 class FrameLogger {
 public:
   void setPeriod(uint64_t n) noexcept { m_period = n; }
   void logPerFrame(const CpuProfiler &cpu, const VkGpuProfiler &gpu,
                    const UploadProfiler &upload) noexcept;
 
+  [[nodiscard]] const FrameStatistics &statistics() const noexcept {
+    return m_stats;
+  }
+
 private:
   bool shouldLog() noexcept;
 
+  FrameStatistics m_stats;
   uint64_t m_frameCounter = 0;
   uint64_t m_period = 120;
 };
@@ -31,6 +38,9 @@ private:
 enum class Event : std::uint8_t {
   DeviceWaitIdle = 0,
   SwapchainRecreate,
+  PipelineCacheLoad,
+  PipelineCacheSave,
+  PipelineCreate,
   Count
 };
 
@@ -40,6 +50,12 @@ static constexpr std::string_view name(Event e) noexcept {
     return "vkDeviceWaitIdle";
   case Event::SwapchainRecreate:
     return "SwapchainRecreate";
+  case Event::PipelineCacheLoad:
+    return "PipelineCacheLoad";
+  case Event::PipelineCacheSave:
+    return "PipelineCacheSave";
+  case Event::PipelineCreate:
+    return "vkCreateGraphicsPipelines";
   default:
     return "Unknown";
   }
@@ -51,7 +67,8 @@ void emit(Event e, double ms) noexcept;
 
 class EventScope {
 public:
-  EventScope(Event e) noexcept : m_event(e), m_t0(clock::now()) {}
+  EventScope(Event e) noexcept
+      : m_event(e), m_t0(clock::now()), m_trace(name(e)) {}
   ~EventScope() noexcept { end(); }
 
   EventScope(const EventScope &) = delete;
@@ -71,6 +88,7 @@ private:
 
   Event m_event{};
   clock::time_point m_t0;
+  TraceScope m_trace;
 };
 
 #else
@@ -78,9 +96,13 @@ private:
 // Release build
 inline void emit(Event, double) noexcept {}
 
+// Still shows up in traces
 class EventScope {
 public:
-  explicit EventScope(Event) noexcept {}
+  explicit EventScope(Event e) noexcept : m_trace(name(e)) {}
+
+private:
+  TraceScope m_trace;
 };
 
 #endif
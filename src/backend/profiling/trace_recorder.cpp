@@ -0,0 +1,316 @@
+#include "backend/profiling/trace_recorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace profiling {
+
+namespace {
+
+int64_t nowNs() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void writeEscaped(std::ostream &os, std::string_view s) {
+  for (const char c : s) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+        os << buf;
+      } else {
+        os << c;
+      }
+    }
+  }
+}
+
+} // namespace
+
+TraceRecorder::ThreadBuffer::~ThreadBuffer() {
+  // head is owned by the unique_ptr, the rest of the chain by raw pointers
+  Chunk *chunk = head->next.load(std::memory_order_relaxed);
+  while (chunk != nullptr) {
+    Chunk *next = chunk->next.load(std::memory_order_relaxed);
+    delete chunk;
+    chunk = next;
+  }
+}
+
+TraceRecorder &TraceRecorder::instance() noexcept {
+  // Leaked on purpose: worker threads may still trace during static
+  // destruction
+  static TraceRecorder *recorder = new TraceRecorder();
+  return *recorder;
+}
+
+void TraceRecorder::start() {
+  m_epochNs.store(nowNs(), std::memory_order_relaxed);
+  m_frame.store(0, std::memory_order_relaxed);
+  // Threads see the new generation and rewind their buffers on next push
+  m_generation.fetch_add(1, std::memory_order_release);
+  s_enabled.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::stop() noexcept {
+  s_enabled.store(false, std::memory_order_release);
+}
+
+void TraceRecorder::begin(std::string_view name) noexcept {
+  if (enabled()) {
+    push(threadBuffer(), Phase::Begin, name, nowNs());
+  }
+}
+
+void TraceRecorder::end() noexcept {
+  if (enabled()) {
+    push(threadBuffer(), Phase::End, {}, nowNs());
+  }
+}
+
+void TraceRecorder::instant(std::string_view name) noexcept {
+  if (enabled()) {
+    push(threadBuffer(), Phase::Instant, name, nowNs());
+  }
+}
+
+void TraceRecorder::gpuBegin(std::string_view name, int64_t steadyNs) noexcept {
+  if (enabled()) {
+    push(gpuBuffer(), Phase::Begin, name, steadyNs);
+  }
+}
+
+void TraceRecorder::gpuEnd(int64_t steadyNs) noexcept {
+  if (enabled()) {
+    push(gpuBuffer(), Phase::End, {}, steadyNs);
+  }
+}
+
+void TraceRecorder::markFrame() noexcept {
+  if (!enabled()) {
+    return;
+  }
+
+  const uint64_t frame = m_frame.fetch_add(1, std::memory_order_relaxed);
+  char name[32];
+  const int n = std::snprintf(name, sizeof(name), "Frame %llu",
+                              static_cast<unsigned long long>(frame));
+  push(threadBuffer(), Phase::GlobalInstant,
+       std::string_view(name, size_t(std::max(n, 0))), nowNs());
+}
+
+void TraceRecorder::setThreadName(std::string_view name) {
+  ThreadBuffer *buffer = threadBuffer();
+  if (buffer == nullptr) {
+    return;
+  }
+
+  std::lock_guard lock(m_mutex);
+  buffer->name = name;
+}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::threadBuffer() noexcept {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (buffer != nullptr) {
+    return buffer;
+  }
+
+  try {
+    auto owned = std::make_unique<ThreadBuffer>();
+
+    std::lock_guard lock(m_mutex);
+    owned->tid = static_cast<uint32_t>(m_threads.size()) + 1;
+    buffer = owned.get();
+    m_threads.push_back(std::move(owned));
+  } catch (...) {
+    return nullptr;
+  }
+
+  return buffer;
+}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::gpuBuffer() noexcept {
+  if (ThreadBuffer *buffer = m_gpu.load(std::memory_order_acquire)) {
+    return buffer;
+  }
+
+  std::lock_guard lock(m_mutex);
+  if (ThreadBuffer *buffer = m_gpu.load(std::memory_order_relaxed)) {
+    return buffer;
+  }
+
+  try {
+    auto owned = std::make_unique<ThreadBuffer>();
+    owned->tid = static_cast<uint32_t>(m_threads.size()) + 1;
+    owned->name = "GPU";
+    m_threads.push_back(std::move(owned));
+  } catch (...) {
+    return nullptr;
+  }
+
+  ThreadBuffer *buffer = m_threads.back().get();
+  m_gpu.store(buffer, std::memory_order_release);
+  return buffer;
+}
+
+void TraceRecorder::push(ThreadBuffer *buffer, Phase phase,
+                         std::string_view name, int64_t steadyNs) noexcept {
+  if (buffer == nullptr) {
+    return;
+  }
+
+  // First event since start(): rewind, keeping the chunks for reuse
+  const uint64_t generation = m_generation.load(std::memory_order_acquire);
+  if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+    for (Chunk *c = buffer->head.get(); c != nullptr;
+         c = c->next.load(std::memory_order_relaxed)) {
+      c->count.store(0, std::memory_order_release);
+    }
+    buffer->tail = buffer->head.get();
+    buffer->generation.store(generation, std::memory_order_relaxed);
+    buffer->dropped.store(0, std::memory_order_relaxed);
+  }
+
+  Chunk *chunk = buffer->tail;
+  uint32_t n = chunk->count.load(std::memory_order_relaxed);
+  if (n == kChunkEvents) {
+    Chunk *next = chunk->next.load(std::memory_order_relaxed);
+    if (next == nullptr) {
+      if (buffer->chunkCount == kMaxChunksPerThread) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      next = new (std::nothrow) Chunk();
+      if (next == nullptr) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      ++buffer->chunkCount;
+      chunk->next.store(next, std::memory_order_release);
+    }
+
+    buffer->tail = chunk = next;
+    n = 0;
+  }
+
+  Event &e = chunk->events[n];
+  const int64_t sinceStart =
+      steadyNs - m_epochNs.load(std::memory_order_relaxed);
+  e.ns = static_cast<uint64_t>(std::max<int64_t>(0, sinceStart));
+  e.phase = phase;
+  e.nameLength = static_cast<uint8_t>(std::min(name.size(), kMaxNameLength));
+  if (e.nameLength != 0) {
+    std::memcpy(e.name.data(), name.data(), e.nameLength);
+  }
+
+  chunk->count.store(n + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::writeChromeJson(const std::filesystem::path &path) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "[Trace] Failed to open '" << path.string() << "'\n";
+    return false;
+  }
+
+  const uint64_t generation = m_generation.load(std::memory_order_acquire);
+
+  std::lock_guard lock(m_mutex);
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  const auto separator = [&file, &first] {
+    file << (first ? "" : ",\n");
+    first = false;
+  };
+
+  uint64_t dropped = 0;
+  for (const std::unique_ptr<ThreadBuffer> &buffer : m_threads) {
+    if (!buffer->name.empty()) {
+      separator();
+      file << R"({"ph":"M","name":"thread_name","pid":1,"tid":)"
+           << buffer->tid << R"(,"args":{"name":")";
+      writeEscaped(file, buffer->name);
+      file << "\"}}";
+    }
+
+    // Threads that have not traced since start() hold stale events
+    if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+      continue;
+    }
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+    for (const Chunk *chunk = buffer->head.get(); chunk != nullptr;
+         chunk = chunk->next.load(std::memory_order_acquire)) {
+      const uint32_t count = chunk->count.load(std::memory_order_acquire);
+      for (uint32_t i = 0; i < count; ++i) {
+        const Event &e = chunk->events[i];
+        const std::string_view name(e.name.data(), e.nameLength);
+
+        separator();
+        char ts[32];
+        std::snprintf(ts, sizeof(ts), "%.3f", double(e.ns) / 1000.0);
+        file << R"({"pid":1,"tid":)" << buffer->tid << R"(,"ts":)" << ts;
+
+        switch (e.phase) {
+        case Phase::Begin:
+          file << R"(,"ph":"B","name":")";
+          writeEscaped(file, name);
+          file << "\"}";
+          break;
+        case Phase::End:
+          file << R"(,"ph":"E"})";
+          break;
+        case Phase::Instant:
+        case Phase::GlobalInstant:
+          file << R"(,"ph":"i","s":")"
+               << (e.phase == Phase::GlobalInstant ? 'g' : 't')
+               << R"(","name":")";
+          writeEscaped(file, name);
+          file << "\"}";
+          break;
+        }
+      }
+
+      if (count < kChunkEvents) {
+        break;
+      }
+    }
+  }
+
+  file << "\n]}\n";
+
+  if (dropped != 0) {
+    std::cerr << "[Trace] " << dropped
+              << " events dropped, per-thread buffers were full\n";
+  }
+
+  return static_cast<bool>(file);
+}
+
+} // namespace profiling
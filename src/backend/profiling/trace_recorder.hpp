@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace profiling {
+
+// Timeline of nested scopes per thread, exported as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev). Stopped by default; a scope on a
+// stopped recorder costs one relaxed load. Each thread appends to its own
+// chunked buffer without locks, the mutex only guards thread registration
+// and export.
+class TraceRecorder {
+public:
+  static constexpr size_t kMaxNameLength = 46;
+
+  [[nodiscard]] static TraceRecorder &instance() noexcept;
+
+  [[nodiscard]] static bool enabled() noexcept {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  // Drops everything recorded so far
+  void start();
+  void stop() noexcept;
+
+  // Names are copied and truncated to kMaxNameLength bytes, so temporaries
+  // are fine
+  void begin(std::string_view name) noexcept;
+  void end() noexcept;
+  void instant(std::string_view name) noexcept;
+  // Global "Frame N" marker, N counts from start()
+  void markFrame() noexcept;
+
+  // Label for the calling thread in exports, may be called while stopped
+  void setThreadName(std::string_view name);
+
+  // Separate "GPU" track fed by one thread. Timestamps are steady_clock
+  // nanoseconds already calibrated by the caller, spans must nest and arrive
+  // in begin order.
+  void gpuBegin(std::string_view name, int64_t steadyNs) noexcept;
+  void gpuEnd(int64_t steadyNs) noexcept;
+
+  // Only consistent after stop()
+  bool writeChromeJson(const std::filesystem::path &path) const;
+
+private:
+  static constexpr uint32_t kChunkEvents = 4096;
+  static constexpr uint32_t kMaxChunksPerThread = 256; // 64 MiB
+
+  enum class Phase : uint8_t { Begin, End, Instant, GlobalInstant };
+
+  struct Event {
+    uint64_t ns = 0; // since start()
+    Phase phase = Phase::Begin;
+    uint8_t nameLength = 0;
+    std::array<char, kMaxNameLength> name{};
+  };
+
+  // Written by the owning thread only. count publishes events to export.
+  struct Chunk {
+    std::array<Event, kChunkEvents> events;
+    std::atomic<uint32_t> count{0};
+    std::atomic<Chunk *> next{nullptr};
+  };
+
+  struct ThreadBuffer {
+    uint32_t tid = 0;
+    std::string name; // guarded by m_mutex
+    std::unique_ptr<Chunk> head = std::make_unique<Chunk>();
+    Chunk *tail = head.get();
+    uint32_t chunkCount = 1;
+    std::atomic<uint64_t> generation{0};
+    std::atomic<uint64_t> dropped{0};
+
+    ~ThreadBuffer();
+  };
+
+  TraceRecorder() = default;
+
+  ThreadBuffer *threadBuffer() noexcept;
+  ThreadBuffer *gpuBuffer() noexcept;
+  void push(ThreadBuffer *buffer, Phase phase, std::string_view name,
+            int64_t steadyNs) noexcept;
+
+  static inline std::atomic<bool> s_enabled{false};
+
+  std::atomic<uint64_t> m_generation{0};
+  std::atomic<int64_t> m_epochNs{0};
+  std::atomic<uint64_t> m_frame{0};
+
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+  std::atomic<ThreadBuffer *> m_gpu{nullptr}; // owned by m_threads
+};
+
+// Begin/end pair on the calling thread's timeline
+class TraceScope {
+public:
+  explicit TraceScope(std::string_view name) noexcept
+      : m_active(TraceRecorder::enabled()) {
+    if (m_active) {
+      TraceRecorder::instance().begin(name);
+    }
+  }
+  ~TraceScope() noexcept {
+    if (m_active) {
+      TraceRecorder::instance().end();
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+  TraceScope(TraceScope &&) = delete;
+  TraceScope &operator=(TraceScope &&) = delete;
+
+private:
+  bool m_active;
+};
+
+} // namespace profiling
@@ -63,14 +63,14 @@ public:
     case Stat::StagingUsedBytes:
       return "StagingUsedBytes";
     case Stat::StagingAllocatedBytes:
-      return "StatingAllocatedBytes";
+      return "StagingAllocatedBytes";
 
     case Stat::BufferUploadCount:
       return "BufferUploadCount";
     case Stat::BufferUploadBytes:
       return "BufferUploadBytes";
     case Stat::BufferAllocatedBytes:
-      return "StatingAllocatedBytes";
+      return "BufferAllocatedBytes";
 
     case Stat::TextureUploadCount:
       return "TextureUploadCount";
@@ -1,16 +1,80 @@
 #include "backend/profiling/vk_gpu_profiler.hpp"
 
 #include "backend/core/vk_backend_ctx.hpp"
+#include "backend/profiling/trace_recorder.hpp"
+#include "engine/logging/log.hpp"
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
-#include <iostream>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Backend.GpuProfiler");
+#define LOG_TU_LOGGER() ThisLogger()
+
+namespace {
+
+// Results come back in bit order, matching GpuPipelineStats
+constexpr VkQueryPipelineStatisticFlags kPipelineStatisticFlags =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+constexpr size_t kPipelineStatisticCount = 5;
+
+constexpr size_t kU64sPerTimestamp = 2;                          // value, avail
+constexpr size_t kU64sPerStatistics = kPipelineStatisticCount + 1; // + avail
+
+constexpr uint32_t kMaxTraceDepth = 32;
+
+// steady_clock is CLOCK_MONOTONIC on Linux, elsewhere GPU scopes stay out
+// of traces
+bool hostTimeDomain(VkPhysicalDevice physicalDevice, VkInstance instance,
+                    VkTimeDomainEXT &out) {
+#if defined(__linux__)
+  auto getDomains =
+      reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+          vkGetInstanceProcAddr(
+              instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+  if (getDomains == nullptr) {
+    return false;
+  }
+
+  uint32_t count = 0;
+  getDomains(physicalDevice, &count, nullptr);
+  std::vector<VkTimeDomainEXT> domains(count);
+  getDomains(physicalDevice, &count, domains.data());
+
+  const auto has = [&domains](VkTimeDomainEXT d) {
+    return std::ranges::find(domains, d) != domains.end();
+  };
+  if (!has(VK_TIME_DOMAIN_DEVICE_EXT) ||
+      !has(VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT)) {
+    return false;
+  }
+
+  out = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+  return true;
+#else
+  (void)physicalDevice;
+  (void)instance;
+  (void)out;
+  return false;
+#endif
+}
+
+} // namespace
+
 bool VkGpuProfiler::init(const VkBackendCtx &ctx, uint32_t framesInFlight) {
   if (framesInFlight == 0) {
-    std::cerr << "[GpuProfiler] framesInFlight equals 0\n";
+    LOGE("framesInFlight equals 0");
     return false;
   }
 
@@ -23,13 +87,13 @@ bool VkGpuProfiler::init(const VkBackendCtx &ctx, uint32_t framesInFlight) {
   vkGetPhysicalDeviceProperties(physicalDevice, &props);
 
   if (props.limits.timestampPeriod <= 0.0F) {
-    std::cerr << "[GpuProfiler] timestampPeriod is invalid\n";
+    LOGE("timestampPeriod is invalid");
     return false;
   }
 
   // If timestampComputeAndGraphics is false, grahics timestamps may be invalid.
   if (props.limits.timestampComputeAndGraphics == VK_FALSE) {
-    std::cerr << "[GpuProfiler] timestampComputeAndGraphics is false\n";
+    LOGE("timestampComputeAndGraphics is false");
     return false;
   }
 
@@ -48,17 +112,43 @@ bool VkGpuProfiler::init(const VkBackendCtx &ctx, uint32_t framesInFlight) {
 
   if (vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &m_pool) !=
       VK_SUCCESS) {
-    std::cerr << "[GpuProfiler] Failed to create VkQueryPool\n";
+    LOGE("Failed to create VkQueryPool");
     shutdown();
     return false;
   }
 
+  m_pipelineStatistics =
+      ctx.enabledFeatures().pipelineStatisticsQuery == VK_TRUE;
+  m_scopeSlots.resize(m_framesInFlight);
+  for (ScopeSlot &slot : m_scopeSlots) {
+    if (!createScopeSlot(slot, kInitialScopeCapacity)) {
+      shutdown();
+      return false;
+    }
+  }
+
+  if (ctx.calibratedTimestampsEnabled() &&
+      hostTimeDomain(physicalDevice, ctx.instance(), m_hostTimeDomain)) {
+    m_getCalibratedTimestamps =
+        reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+            vkGetDeviceProcAddr(m_device, "vkGetCalibratedTimestampsEXT"));
+  }
+
   m_submittedFrames = 0;
-  m_last = {};
+  // Sequences keep counting so consumers never see one twice
+  m_last = GpuFrameStats{.sequence = m_last.sequence};
   return true;
 }
 
 void VkGpuProfiler::shutdown() noexcept {
+  for (ScopeSlot &slot : m_scopeSlots) {
+    destroyScopeSlot(slot);
+  }
+  m_scopeSlots.clear();
+  m_lastScopes.clear();
+  m_pipelineStatistics = false;
+  m_getCalibratedTimestamps = nullptr;
+
   if (m_device != VK_NULL_HANDLE && m_pool != VK_NULL_HANDLE) {
     vkDestroyQueryPool(m_device, m_pool, nullptr);
   }
@@ -70,7 +160,7 @@ void VkGpuProfiler::shutdown() noexcept {
   m_submittedFrames = 0;
   m_lastFrameEndTs = 0;
   m_haveLastFrameEndTs = false;
-  m_last = {};
+  m_last = GpuFrameStats{.sequence = m_last.sequence};
 }
 
 void VkGpuProfiler::writeTs(VkCommandBuffer cmd, uint32_t frameIndex,
@@ -93,6 +183,282 @@ void VkGpuProfiler::beginFrameCmd(VkCommandBuffer cmd,
   const uint32_t b = base(frameIndex);
   // Requires VK 1.2
   vkCmdResetQueryPool(cmd, m_pool, b, markersPerFrame());
+
+  if (frameIndex >= m_scopeSlots.size()) {
+    return;
+  }
+
+  // The slot's fence was waited on, so its previous scopes have landed
+  ScopeSlot &slot = m_scopeSlots[frameIndex];
+  collectScopes(slot);
+
+  if (slot.requested > slot.capacity) {
+    ScopeSlot grown;
+    if (createScopeSlot(grown, std::bit_ceil(slot.requested))) {
+      destroyScopeSlot(slot);
+      slot = std::move(grown);
+    }
+  }
+
+  slot.scopes.clear();
+  slot.open.clear();
+  slot.requested = 0;
+  slot.droppedOpen = 0;
+
+  vkCmdResetQueryPool(cmd, slot.timestamps, 0, slot.capacity * 2);
+  if (slot.statistics != VK_NULL_HANDLE) {
+    vkCmdResetQueryPool(cmd, slot.statistics, 0, slot.capacity);
+  }
+}
+
+void VkGpuProfiler::beginScope(VkCommandBuffer cmd, uint32_t frameIndex,
+                               std::string_view name) noexcept {
+  if (frameIndex >= m_scopeSlots.size()) {
+    return;
+  }
+
+  ScopeSlot &slot = m_scopeSlots[frameIndex];
+  ++slot.requested;
+  if (slot.scopes.size() == slot.capacity) {
+    ++slot.droppedOpen;
+    return;
+  }
+
+  // Only one pipeline statistics query may be active at a time
+  const auto index = static_cast<uint32_t>(slot.scopes.size());
+  const bool pipelineStats =
+      slot.statistics != VK_NULL_HANDLE && slot.open.empty();
+
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.timestamps,
+                      index * 2);
+  if (pipelineStats) {
+    vkCmdBeginQuery(cmd, slot.statistics, index, 0);
+  }
+
+  // Both reserved to capacity, never allocate here
+  ScopeRecord &record = slot.scopes.emplace_back();
+  record.name.assign(name);
+  record.depth = static_cast<uint32_t>(slot.open.size());
+  record.pipelineStats = pipelineStats;
+  slot.open.push_back(index);
+}
+
+void VkGpuProfiler::endScope(VkCommandBuffer cmd,
+                             uint32_t frameIndex) noexcept {
+  if (frameIndex >= m_scopeSlots.size()) {
+    return;
+  }
+
+  ScopeSlot &slot = m_scopeSlots[frameIndex];
+  if (slot.droppedOpen > 0) {
+    --slot.droppedOpen;
+    return;
+  }
+  if (slot.open.empty()) {
+    return;
+  }
+
+  const uint32_t index = slot.open.back();
+  slot.open.pop_back();
+
+  if (slot.scopes[index].pipelineStats) {
+    vkCmdEndQuery(cmd, slot.statistics, index);
+  }
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                      slot.timestamps, (index * 2) + 1);
+}
+
+bool VkGpuProfiler::createScopeSlot(ScopeSlot &slot,
+                                    uint32_t capacity) noexcept {
+  VkQueryPoolCreateInfo info{};
+  info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  info.queryCount = capacity * 2;
+
+  if (vkCreateQueryPool(m_device, &info, nullptr, &slot.timestamps) !=
+      VK_SUCCESS) {
+    LOGE("Failed to create scope VkQueryPool");
+    destroyScopeSlot(slot);
+    return false;
+  }
+
+  if (m_pipelineStatistics) {
+    info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    info.queryCount = capacity;
+    info.pipelineStatistics = kPipelineStatisticFlags;
+
+    if (vkCreateQueryPool(m_device, &info, nullptr, &slot.statistics) !=
+        VK_SUCCESS) {
+      LOGE("Failed to create statistics VkQueryPool");
+      destroyScopeSlot(slot);
+      return false;
+    }
+  }
+
+  // Recording and readback stay allocation free
+  try {
+    slot.scopes.reserve(capacity);
+    slot.open.reserve(capacity);
+    m_lastScopes.reserve(capacity);
+    m_scratch.reserve((size_t(capacity) * 2 * kU64sPerTimestamp) +
+                      (size_t(capacity) * kU64sPerStatistics));
+  } catch (...) {
+    destroyScopeSlot(slot);
+    return false;
+  }
+
+  slot.capacity = capacity;
+  return true;
+}
+
+void VkGpuProfiler::destroyScopeSlot(ScopeSlot &slot) noexcept {
+  if (m_device != VK_NULL_HANDLE) {
+    if (slot.timestamps != VK_NULL_HANDLE) {
+      vkDestroyQueryPool(m_device, slot.timestamps, nullptr);
+    }
+    if (slot.statistics != VK_NULL_HANDLE) {
+      vkDestroyQueryPool(m_device, slot.statistics, nullptr);
+    }
+  }
+
+  slot = ScopeSlot{};
+}
+
+void VkGpuProfiler::collectScopes(ScopeSlot &slot) noexcept {
+  m_lastScopes.clear();
+
+  const auto count = static_cast<uint32_t>(slot.scopes.size());
+  if (count == 0) {
+    return;
+  }
+
+  // [value, avail] per timestamp, then [counters..., avail] per scope
+  const size_t tsU64s = size_t(count) * 2 * kU64sPerTimestamp;
+  m_scratch.assign(tsU64s + (size_t(count) * kU64sPerStatistics), 0);
+  const std::span<uint64_t> ts(m_scratch.data(), tsU64s);
+  const std::span<uint64_t> stats(m_scratch.data() + tsU64s,
+                                  size_t(count) * kU64sPerStatistics);
+
+  // No WAIT bit, unavailable scopes are skipped
+  const VkResult res = vkGetQueryPoolResults(
+      m_device, slot.timestamps, 0, count * 2, ts.size_bytes(), ts.data(),
+      sizeof(uint64_t) * kU64sPerTimestamp,
+      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  if (res != VK_SUCCESS && res != VK_NOT_READY) {
+    LOGE("Scope readback failed: {}", static_cast<int>(res));
+    return;
+  }
+
+  if (slot.statistics != VK_NULL_HANDLE) {
+    (void)vkGetQueryPoolResults(
+        m_device, slot.statistics, 0, count, stats.size_bytes(), stats.data(),
+        sizeof(uint64_t) * kU64sPerStatistics,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  }
+
+  uint64_t baseTick = 0;
+  bool haveBase = false;
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint64_t *begin = &ts[size_t(i) * 2 * kU64sPerTimestamp];
+    const uint64_t *end = begin + kU64sPerTimestamp;
+    if (begin[1] == 0 || end[1] == 0 || end[0] < begin[0]) {
+      continue;
+    }
+
+    // Scopes are in submission order, the first one starts earliest
+    if (!haveBase) {
+      baseTick = begin[0];
+      haveBase = true;
+    }
+
+    GpuScopeStats out{};
+    out.name = slot.scopes[i].name;
+    out.depth = slot.scopes[i].depth;
+    out.startMs = static_cast<double>(begin[0] - std::min(begin[0], baseTick)) *
+                  m_timestampPeriodNs / 1e6;
+    out.ms = static_cast<double>(end[0] - begin[0]) * m_timestampPeriodNs / 1e6;
+
+    const uint64_t *counters = &stats[size_t(i) * kU64sPerStatistics];
+    const bool countersReady = counters[kPipelineStatisticCount] != 0;
+    if (slot.scopes[i].pipelineStats && countersReady) {
+      out.hasPipelineStats = true;
+      out.pipeline.primitives = counters[0];
+      out.pipeline.vertexInvocations = counters[1];
+      out.pipeline.clippingInvocations = counters[2];
+      out.pipeline.clippingPrimitives = counters[3];
+      out.pipeline.fragmentInvocations = counters[4];
+    }
+
+    m_lastScopes.push_back(out);
+  }
+
+  if (haveBase && profiling::TraceRecorder::enabled()) {
+    traceScopes(baseTick);
+  }
+}
+
+bool VkGpuProfiler::calibrate(uint64_t &gpuTicks,
+                              int64_t &hostNs) const noexcept {
+  if (m_getCalibratedTimestamps == nullptr) {
+    return false;
+  }
+
+  std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+  infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+  infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+  infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+  infos[1].timeDomain = m_hostTimeDomain;
+
+  std::array<uint64_t, 2> timestamps{};
+  uint64_t maxDeviation = 0;
+  if (m_getCalibratedTimestamps(m_device, 2, infos.data(), timestamps.data(),
+                                &maxDeviation) != VK_SUCCESS) {
+    return false;
+  }
+
+  gpuTicks = timestamps[0];
+  hostNs = static_cast<int64_t>(timestamps[1]);
+  return true;
+}
+
+void VkGpuProfiler::traceScopes(uint64_t baseTick) const noexcept {
+  // Recalibrated per frame so clock drift never accumulates
+  uint64_t gpuNow = 0;
+  int64_t hostNow = 0;
+  if (!calibrate(gpuNow, hostNow)) {
+    return;
+  }
+
+  const auto ticksBack = static_cast<int64_t>(gpuNow - baseTick);
+  const int64_t baseNs =
+      hostNow - static_cast<int64_t>(double(ticksBack) * m_timestampPeriodNs);
+
+  profiling::TraceRecorder &trace = profiling::TraceRecorder::instance();
+  std::array<int64_t, kMaxTraceDepth> ends{};
+  uint32_t depth = 0;
+
+  for (const GpuScopeStats &s : m_lastScopes) {
+    const int64_t begin = baseNs + static_cast<int64_t>(s.startMs * 1e6);
+    int64_t end = begin + static_cast<int64_t>(s.ms * 1e6);
+
+    while (depth > 0 && ends[depth - 1] <= begin) {
+      trace.gpuEnd(ends[--depth]);
+    }
+    if (depth == kMaxTraceDepth) {
+      continue;
+    }
+    // Stage placement can push a child a tick past its parent
+    if (depth > 0) {
+      end = std::min(end, ends[depth - 1]);
+    }
+
+    trace.gpuBegin(s.name.view(), begin);
+    ends[depth++] = end;
+  }
+
+  while (depth > 0) {
+    trace.gpuEnd(ends[--depth]);
+  }
 }
 
 void VkGpuProfiler::markFrameBegin(VkCommandBuffer cmd,
@@ -156,7 +522,7 @@ VkGpuProfiler::tryCollect(uint32_t frameIndex) noexcept {
     return out;
   }
   if (res != VK_SUCCESS) {
-    std::cerr << "[GpuProfiler] vkGetQueryPoolResults failed: " << res << "\n";
+    LOGE("vkGetQueryPoolResults failed: {}", static_cast<int>(res));
     return out;
   }
 
@@ -200,6 +566,7 @@ VkGpuProfiler::tryCollect(uint32_t frameIndex) noexcept {
   m_lastFrameEndTs = t1;
   m_haveLastFrameEndTs = true;
 
+  out.sequence = m_last.sequence + 1;
   m_last = out;
   return out;
 }
@@ -2,8 +2,15 @@
 
 #include "backend/core/vk_backend_ctx.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 class VkBackendCtx;
@@ -23,8 +30,45 @@ public:
     double frameMs = 0.0;
     double mainPassMs = 0.0;
     double idleGapMs = 0.0;
+    // Bumped per frame read back, last() keeps it while queries are pending
+    uint64_t sequence = 0;
   };
 
+  // Counters from VK_QUERY_TYPE_PIPELINE_STATISTICS
+  struct GpuPipelineStats {
+    uint64_t primitives = 0; // input assembly
+    uint64_t vertexInvocations = 0;
+    uint64_t clippingInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentInvocations = 0;
+  };
+
+  // Scope names are copied and truncated, temporaries are fine
+  static constexpr size_t kMaxScopeName = 40;
+  struct ScopeName {
+    std::array<char, kMaxScopeName> chars{};
+    uint8_t length = 0;
+
+    void assign(std::string_view name) noexcept {
+      length = static_cast<uint8_t>(std::min(name.size(), kMaxScopeName));
+      std::memcpy(chars.data(), name.data(), length);
+    }
+    [[nodiscard]] std::string_view view() const noexcept {
+      return {chars.data(), length};
+    }
+  };
+
+  struct GpuScopeStats {
+    ScopeName name;
+    uint32_t depth = 0;
+    double startMs = 0.0; // relative to the first scope of the frame
+    double ms = 0.0;
+    bool hasPipelineStats = false;
+    GpuPipelineStats pipeline{};
+  };
+
+  static constexpr uint32_t kInitialScopeCapacity = 16;
+
   VkGpuProfiler() = default;
   ~VkGpuProfiler() noexcept { shutdown(); }
 
@@ -45,6 +89,15 @@ public:
     m_timestampPeriodNs = std::exchange(other.m_timestampPeriodNs, 0.0);
     m_last = other.m_last;
     m_submittedFrames = std::exchange(other.m_submittedFrames, 0ULL);
+    m_lastFrameEndTs = std::exchange(other.m_lastFrameEndTs, 0ULL);
+    m_haveLastFrameEndTs = std::exchange(other.m_haveLastFrameEndTs, false);
+    m_scopeSlots = std::exchange(other.m_scopeSlots, {});
+    m_lastScopes = std::exchange(other.m_lastScopes, {});
+    m_scratch = std::exchange(other.m_scratch, {});
+    m_pipelineStatistics = std::exchange(other.m_pipelineStatistics, false);
+    m_getCalibratedTimestamps =
+        std::exchange(other.m_getCalibratedTimestamps, nullptr);
+    m_hostTimeDomain = other.m_hostTimeDomain;
 
     return *this;
   }
@@ -59,10 +112,23 @@ public:
   void markMainPassEnd(VkCommandBuffer cmd, uint32_t frameIndex) noexcept;
   void markFrameEnd(VkCommandBuffer cmd, uint32_t frameIndex) noexcept;
 
+  // Named scopes, nestable. Names are copied, up to kMaxScopeName bytes.
+  // Pools grow to the demand of the previous use of the frame slot, scopes
+  // past capacity are dropped until then. Top-level scopes also record
+  // pipeline statistics when the device supports them, and must begin and
+  // end on the same side of a vkCmdBeginRendering/vkCmdEndRendering pair.
+  void beginScope(VkCommandBuffer cmd, uint32_t frameIndex,
+                  std::string_view name) noexcept;
+  void endScope(VkCommandBuffer cmd, uint32_t frameIndex) noexcept;
+
   void onFrameSubmitted() noexcept { ++m_submittedFrames; }
 
   [[nodiscard]] GpuFrameStats tryCollect(uint32_t frameIndex) noexcept;
   [[nodiscard]] const GpuFrameStats &last() const noexcept { return m_last; }
+  // Scopes of the last frame read back, framesInFlight frames behind
+  [[nodiscard]] std::span<const GpuScopeStats> lastScopes() const noexcept {
+    return m_lastScopes;
+  }
 
 private:
   static constexpr uint32_t markersPerFrame() noexcept {
@@ -76,6 +142,29 @@ private:
   void writeTs(VkCommandBuffer cmd, uint32_t frameIndex, Marker marker,
                VkPipelineStageFlagBits stage) noexcept;
 
+  struct ScopeRecord {
+    ScopeName name;
+    uint32_t depth = 0;
+    bool pipelineStats = false;
+  };
+
+  // Query pools of one frame in flight, two timestamps per scope
+  struct ScopeSlot {
+    VkQueryPool timestamps = VK_NULL_HANDLE;
+    VkQueryPool statistics = VK_NULL_HANDLE;
+    uint32_t capacity = 0;
+    uint32_t requested = 0; // scopes begun last use, dropped ones included
+    uint32_t droppedOpen = 0;
+    std::vector<ScopeRecord> scopes;
+    std::vector<uint32_t> open;
+  };
+
+  bool createScopeSlot(ScopeSlot &slot, uint32_t capacity) noexcept;
+  void destroyScopeSlot(ScopeSlot &slot) noexcept;
+  void collectScopes(ScopeSlot &slot) noexcept;
+  void traceScopes(uint64_t baseTick) const noexcept;
+  bool calibrate(uint64_t &gpuTicks, int64_t &hostNs) const noexcept;
+
   VkDevice m_device = VK_NULL_HANDLE; // non-owning
   VkQueryPool m_pool = VK_NULL_HANDLE;
 
@@ -87,4 +176,12 @@ private:
   bool m_haveLastFrameEndTs = false;
 
   GpuFrameStats m_last{};
+
+  std::vector<ScopeSlot> m_scopeSlots; // one per frame in flight
+  std::vector<GpuScopeStats> m_lastScopes;
+  std::vector<uint64_t> m_scratch; // query readback
+  bool m_pipelineStatistics = false;
+
+  PFN_vkGetCalibratedTimestampsEXT m_getCalibratedTimestamps = nullptr;
+  VkTimeDomainEXT m_hostTimeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
 };
@@ -2,6 +2,9 @@
 
 layout(set=1, binding=0) uniform sampler2D u_baseColor;
 
+// Pipeline variant switches
+layout(constant_id = 0) const bool kAlphaTest = false;
+
 layout(location = 0) in vec3 v_color;
 layout(location = 1) in vec2 v_uv;
 layout(location = 2) flat in uint v_matId;
@@ -33,4 +36,8 @@ void main() {
   vec4 tex = texture(u_baseColor, v_uv);
   vec4 factor = mats.materials[v_matId].baseColorFactor;
   outColor = tex * factor;
+
+  if (kAlphaTest && outColor.a < mats.materials[v_matId].mrAoAlpha.w) {
+    discard;
+  }
 }
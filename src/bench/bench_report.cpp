@@ -0,0 +1,218 @@
+#include "bench/bench_report.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+double percentile(const std::vector<double> &sorted, double p) {
+  const auto rank =
+      static_cast<size_t>(std::ceil(p / 100.0 * double(sorted.size())));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+std::string baselineKey(std::string_view scenario, std::string_view metric) {
+  std::string key(scenario);
+  key += '/';
+  key += metric;
+  return key;
+}
+
+bool isTiming(std::string_view metric) { return metric.ends_with("_ms"); }
+
+void writeSummaryCsv(std::ostream &os, const Summary &s) {
+  os << s.count << ',' << s.min << ',' << s.mean << ',' << s.p50 << ','
+     << s.p95 << ',' << s.p99 << ',' << s.max << ',' << s.total;
+}
+
+} // namespace
+
+Summary summarize(std::vector<double> samples) {
+  Summary s{};
+  if (samples.empty()) {
+    return s;
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  s.count = samples.size();
+  s.min = samples.front();
+  s.max = samples.back();
+  s.total = std::accumulate(samples.begin(), samples.end(), 0.0);
+  s.mean = s.total / double(s.count);
+  s.p50 = percentile(samples, 50.0);
+  s.p95 = percentile(samples, 95.0);
+  s.p99 = percentile(samples, 99.0);
+
+  return s;
+}
+
+void ScenarioRecord::add(std::string_view metric, double value) {
+  auto it = std::find_if(
+      m_metrics.begin(), m_metrics.end(),
+      [metric](const Metric &m) { return m.first == metric; });
+  if (it == m_metrics.end()) {
+    m_metrics.emplace_back(std::string(metric), std::vector<double>{});
+    it = std::prev(m_metrics.end());
+  }
+
+  it->second.push_back(value);
+}
+
+bool writeCsv(const std::filesystem::path &path,
+              std::span<const ScenarioRecord> records) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "[Bench] Failed to open '" << path.string() << "'\n";
+    return false;
+  }
+
+  file << std::fixed << std::setprecision(4);
+  file << "scenario,metric,count,min,mean,p50,p95,p99,max,total\n";
+
+  for (const ScenarioRecord &record : records) {
+    for (const auto &[metric, samples] : record.metrics()) {
+      file << record.name() << ',' << metric << ',';
+      writeSummaryCsv(file, summarize(samples));
+      file << '\n';
+    }
+  }
+
+  return static_cast<bool>(file);
+}
+
+bool writeJson(const std::filesystem::path &path,
+               std::span<const ScenarioRecord> records) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "[Bench] Failed to open '" << path.string() << "'\n";
+    return false;
+  }
+
+  // Scenario and metric names are plain identifiers, no escaping needed
+  file << std::fixed << std::setprecision(4);
+  file << "{\n  \"scenarios\": [";
+
+  for (size_t r = 0; r < records.size(); ++r) {
+    const ScenarioRecord &record = records[r];
+    file << (r == 0 ? "\n" : ",\n") << "    {\"name\": \"" << record.name()
+         << "\", \"metrics\": {";
+
+    const auto &metrics = record.metrics();
+    for (size_t m = 0; m < metrics.size(); ++m) {
+      const Summary s = summarize(metrics[m].second);
+      file << (m == 0 ? "\n" : ",\n") << "      \"" << metrics[m].first
+           << "\": {\"count\": " << s.count << ", \"min\": " << s.min
+           << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50
+           << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99
+           << ", \"max\": " << s.max << ", \"total\": " << s.total << '}';
+    }
+
+    file << "\n    }}";
+  }
+
+  file << "\n  ]\n}\n";
+
+  return static_cast<bool>(file);
+}
+
+bool readBaseline(const std::filesystem::path &path, Baseline &out) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    std::cerr << "[Bench] Failed to open baseline '" << path.string()
+              << "'\n";
+    return false;
+  }
+
+  out.clear();
+
+  std::string line;
+  std::getline(file, line); // header
+
+  while (std::getline(file, line)) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    for (std::string field; std::getline(ss, field, ',');) {
+      fields.push_back(std::move(field));
+    }
+
+    if (fields.size() != 10) {
+      std::cerr << "[Bench] Skipping malformed baseline row: " << line
+                << '\n';
+      continue;
+    }
+
+    const auto num = [&fields](size_t i) {
+      return std::strtod(fields[i].c_str(), nullptr);
+    };
+
+    Summary s{};
+    s.count =
+        static_cast<size_t>(std::strtoull(fields[2].c_str(), nullptr, 10));
+    s.min = num(3);
+    s.mean = num(4);
+    s.p50 = num(5);
+    s.p95 = num(6);
+    s.p99 = num(7);
+    s.max = num(8);
+    s.total = num(9);
+
+    out.insert_or_assign(baselineKey(fields[0], fields[1]), s);
+  }
+
+  return true;
+}
+
+std::vector<Regression> compare(std::span<const ScenarioRecord> records,
+                                const Baseline &baseline, double threshold) {
+  std::vector<Regression> out;
+
+  for (const ScenarioRecord &record : records) {
+    for (const auto &[metric, samples] : record.metrics()) {
+      if (!isTiming(metric)) {
+        continue;
+      }
+
+      const auto it = baseline.find(baselineKey(record.name(), metric));
+      if (it == baseline.end()) {
+        continue;
+      }
+
+      const Summary cur = summarize(samples);
+      const Summary &base = it->second;
+
+      const auto check = [&](std::string_view stat, double b, double c) {
+        if (b > 0.0 && c > b * (1.0 + threshold)) {
+          out.push_back(Regression{.scenario = record.name(),
+                                   .metric = metric,
+                                   .stat = stat,
+                                   .baseline = b,
+                                   .current = c});
+        }
+      };
+
+      check("p50", base.p50, cur.p50);
+      check("p95", base.p95, cur.p95);
+    }
+  }
+
+  return out;
+}
+
+} // namespace bench
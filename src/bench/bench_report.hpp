@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+struct Summary {
+  size_t count = 0;
+  double min = 0.0;
+  double mean = 0.0;
+  double p50 = 0.0;
+  double p95 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+  double total = 0.0;
+};
+
+// Nearest-rank percentiles, an empty input gives a zero Summary
+[[nodiscard]] Summary summarize(std::vector<double> samples);
+
+// Per-frame samples of named metrics for one scenario. Metrics keep the
+// order they were first added in, so reports have stable rows.
+class ScenarioRecord {
+public:
+  using Metric = std::pair<std::string, std::vector<double>>;
+
+  explicit ScenarioRecord(std::string name) : m_name(std::move(name)) {}
+
+  void add(std::string_view metric, double value);
+
+  [[nodiscard]] const std::string &name() const noexcept { return m_name; }
+  [[nodiscard]] const std::vector<Metric> &metrics() const noexcept {
+    return m_metrics;
+  }
+
+private:
+  std::string m_name;
+  std::vector<Metric> m_metrics;
+};
+
+// One row per scenario and metric:
+// scenario,metric,count,min,mean,p50,p95,p99,max,total
+bool writeCsv(const std::filesystem::path &path,
+              std::span<const ScenarioRecord> records);
+bool writeJson(const std::filesystem::path &path,
+               std::span<const ScenarioRecord> records);
+
+// "scenario/metric" -> Summary, read back from a writeCsv() file
+using Baseline = std::map<std::string, Summary, std::less<>>;
+bool readBaseline(const std::filesystem::path &path, Baseline &out);
+
+struct Regression {
+  std::string scenario;
+  std::string metric;
+  std::string_view stat; // "p50" or "p95"
+  double baseline = 0.0;
+  double current = 0.0;
+};
+
+// Timing metrics (suffix "_ms") whose p50 or p95 grew by more than
+// threshold (0.1 = 10%) over the baseline. Metrics missing from the
+// baseline are skipped.
+[[nodiscard]] std::vector<Regression>
+compare(std::span<const ScenarioRecord> records, const Baseline &baseline,
+        double threshold);
+
+} // namespace bench
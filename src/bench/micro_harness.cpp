@@ -0,0 +1,118 @@
+#include "bench/micro_harness.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+namespace bench {
+
+namespace {
+
+double gbPerSecond(const MicroResult &r) {
+  if (r.bytesPerElement == 0 || r.nsPerElement <= 0.0) {
+    return 0.0;
+  }
+  return double(r.bytesPerElement) / r.nsPerElement; // bytes/ns == GB/s
+}
+
+} // namespace
+
+bool pinToCpu(int cpu) {
+  if (cpu < 0) {
+    return false;
+  }
+
+#if defined(_WIN32)
+  if (cpu >= 64) {
+    return false;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(),
+                               DWORD_PTR(1) << DWORD_PTR(cpu)) != 0;
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  // macOS only has affinity hints
+  return false;
+#endif
+}
+
+uint64_t readCycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||            \
+    defined(_M_IX86)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+bool hasCycleCounter() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||            \
+    defined(_M_IX86)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool MicroRunner::writeCsv(const std::filesystem::path &path) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "[Bench] Failed to open '" << path.string() << "'\n";
+    return false;
+  }
+
+  file << std::fixed << std::setprecision(4);
+  file << "name,size,elements,ns_per_element,cycles_per_element,gb_per_s\n";
+  for (const MicroResult &r : m_results) {
+    file << r.name << ',' << r.size << ',' << r.elements << ','
+         << r.nsPerElement << ',' << r.cyclesPerElement << ','
+         << gbPerSecond(r) << '\n';
+  }
+
+  return static_cast<bool>(file);
+}
+
+void MicroRunner::printHeader() {
+  // TSC cycles tick at a fixed reference rate, not the boosted core clock
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-28s %10s %12s %12s", "case", "size",
+                "ns/elem", "cycles/elem");
+  std::cout << line << '\n';
+}
+
+void MicroRunner::report(const MicroResult &result) {
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-28s %10llu %12.3f %12.3f",
+                result.name.c_str(),
+                static_cast<unsigned long long>(result.size),
+                result.nsPerElement, result.cyclesPerElement);
+  std::cout << line;
+
+  if (const double gbps = gbPerSecond(result); gbps > 0.0) {
+    std::cout << "  " << std::fixed << std::setprecision(2) << gbps
+              << " GB/s";
+  }
+  std::cout << '\n';
+}
+
+} // namespace bench
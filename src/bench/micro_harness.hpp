@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Pins the calling thread to one CPU. False when the platform has no
+// affinity API or the CPU is not available to the process.
+bool pinToCpu(int cpu);
+
+// TSC reference cycles on x86, 0 elsewhere
+[[nodiscard]] uint64_t readCycles() noexcept;
+[[nodiscard]] bool hasCycleCounter() noexcept;
+
+// Keeps value and everything it depends on from being optimized away
+template <class T> inline void doNotOptimize(const T &value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+struct MicroResult {
+  std::string name;
+  uint64_t size = 0;     // case parameter as listed by the case
+  uint64_t elements = 0; // work items per repetition
+  uint64_t bytesPerElement = 0;
+  double nsPerElement = 0.0;     // median over repetitions
+  double cyclesPerElement = 0.0; // median, 0 without a cycle counter
+};
+
+class MicroRunner {
+public:
+  struct Config {
+    uint32_t reps = 11;
+    std::string filter; // substring of the case name, empty runs all
+  };
+
+  explicit MicroRunner(Config cfg) : m_cfg(std::move(cfg)) {}
+
+  [[nodiscard]] bool enabled(std::string_view name) const noexcept {
+    return m_cfg.filter.empty() ||
+           name.find(m_cfg.filter) != std::string_view::npos;
+  }
+
+  // One untimed call to warm caches, then reps timed calls
+  template <class Body>
+  void run(std::string_view name, uint64_t size, uint64_t elements,
+           uint64_t bytesPerElement, Body &&body) {
+    if (!enabled(name) || elements == 0) {
+      return;
+    }
+
+    body();
+
+    std::vector<double> ns(m_cfg.reps);
+    std::vector<double> cycles(m_cfg.reps);
+    for (uint32_t r = 0; r < m_cfg.reps; ++r) {
+      const auto t0 = std::chrono::steady_clock::now();
+      const uint64_t c0 = readCycles();
+      body();
+      const uint64_t c1 = readCycles();
+      const auto t1 = std::chrono::steady_clock::now();
+
+      ns[r] = std::chrono::duration<double, std::nano>(t1 - t0).count();
+      cycles[r] = double(c1 - c0);
+    }
+
+    MicroResult result{};
+    result.name = std::string(name);
+    result.size = size;
+    result.elements = elements;
+    result.bytesPerElement = bytesPerElement;
+    result.nsPerElement = median(ns) / double(elements);
+    result.cyclesPerElement = median(cycles) / double(elements);
+
+    report(result);
+    m_results.push_back(std::move(result));
+  }
+
+  // Column titles for the rows run() prints
+  static void printHeader();
+
+  [[nodiscard]] const std::vector<MicroResult> &results() const noexcept {
+    return m_results;
+  }
+
+  // name,size,elements,ns_per_element,cycles_per_element,gb_per_s
+  bool writeCsv(const std::filesystem::path &path) const;
+
+private:
+  static double median(std::vector<double> &v) {
+    std::nth_element(v.begin(), v.begin() + std::ptrdiff_t(v.size() / 2),
+                     v.end());
+    return v[v.size() / 2];
+  }
+
+  static void report(const MicroResult &result);
+
+  Config m_cfg;
+  std::vector<MicroResult> m_results;
+};
+
+} // namespace bench
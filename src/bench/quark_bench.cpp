@@ -0,0 +1,421 @@
+#include "backend/profiling/alloc_tracker.hpp"
+#include "backend/profiling/memory_tracker.hpp"
+#include "bench/bench_report.hpp"
+#include "engine/app/app.hpp"
+#include "engine/app/cube_grid.hpp"
+#include "engine/assets/gltf/gltf_asset.hpp"
+#include "engine/camera/camera.hpp"
+#include "engine/geometry/transform.hpp"
+#include "engine/jobs/job_system.hpp"
+#include "engine/logging/log.hpp"
+#include "render/renderer.hpp"
+#include "render/util/scope_exit.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <iostream>
+#include <numbers>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Deterministic scene benchmark. Every scenario renders warmup + measured
+// frames with a fixed timestep and a camera path driven by the frame index,
+// so runs only differ by the machine they ran on.
+
+namespace {
+
+enum class SceneKind : uint8_t { CubeGrid, TreeField };
+
+struct Scenario {
+  std::string_view name;
+  SceneKind kind;
+  uint32_t count;     // cubes or trees
+  uint32_t materials; // cube grids cycle through this many materials
+};
+
+constexpr std::array kScenarios{
+    Scenario{"cubes_1k", SceneKind::CubeGrid, 1'000, 1},
+    Scenario{"cubes_10k", SceneKind::CubeGrid, 10'000, 1},
+    Scenario{"cubes_100k", SceneKind::CubeGrid, 100'000, 1},
+    Scenario{"trees_64", SceneKind::TreeField, 64, 0},
+    Scenario{"trees_256", SceneKind::TreeField, 256, 0},
+    Scenario{"materials_16", SceneKind::CubeGrid, 10'000, 16},
+    Scenario{"materials_256", SceneKind::CubeGrid, 10'000, 256},
+};
+
+constexpr uint32_t kMaxMaterials = 256;
+constexpr float kCubeSpacing = 2.5F;
+constexpr float kTreeSpacing = 4.0F;
+constexpr float kTimestep = 1.0F / 60.0F;
+
+struct Options {
+  std::vector<std::string_view> scenarios; // empty runs all
+  uint32_t warmup = 60;
+  uint32_t frames = 600;
+  std::filesystem::path csv = "quark_bench.csv";
+  std::filesystem::path json;
+  std::filesystem::path baseline;
+  std::filesystem::path vmaJson;
+  double threshold = 0.10;
+  bool headless = true;
+};
+
+struct Assets {
+  MeshHandle cube{};
+  std::vector<uint32_t> materials; // distinct base colors
+  engine::assets::GltfAsset tree;
+};
+
+void printUsage() {
+  std::cerr << "usage: quark_bench [--scenario NAME]... [--warmup N] "
+               "[--frames N]\n"
+               "                   [--csv PATH] [--json PATH] "
+               "[--baseline CSV] [--threshold F] [--window]\n"
+               "                   [--vma-json PATH]\n"
+               "scenarios:";
+  for (const Scenario &s : kScenarios) {
+    std::cerr << ' ' << s.name;
+  }
+  std::cerr << '\n';
+}
+
+bool parseArgs(int argc, char **argv, Options &out) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    if (arg == "--scenario" && hasValue) {
+      out.scenarios.emplace_back(argv[++i]);
+    } else if (arg == "--warmup" && hasValue) {
+      out.warmup =
+          static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--frames" && hasValue) {
+      out.frames =
+          static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--csv" && hasValue) {
+      out.csv = argv[++i];
+    } else if (arg == "--json" && hasValue) {
+      out.json = argv[++i];
+    } else if (arg == "--baseline" && hasValue) {
+      out.baseline = argv[++i];
+    } else if (arg == "--threshold" && hasValue) {
+      out.threshold = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--vma-json" && hasValue) {
+      out.vmaJson = argv[++i];
+    } else if (arg == "--window") {
+      out.headless = false;
+    } else {
+      printUsage();
+      return false;
+    }
+  }
+
+  for (std::string_view name : out.scenarios) {
+    if (std::none_of(kScenarios.begin(), kScenarios.end(),
+                     [name](const Scenario &s) { return s.name == name; })) {
+      std::cerr << "[Bench] Unknown scenario '" << name << "'\n";
+      printUsage();
+      return false;
+    }
+  }
+
+  return out.frames > 0;
+}
+
+bool loadAssets(Renderer &renderer, MeshFactory &meshes,
+                engine::jobs::JobSystem &jobs, Assets &out) {
+  if (!renderer.beginUpload(0)) {
+    std::cerr << "[Bench] Failed to begin upload\n";
+    return false;
+  }
+
+  out.cube = meshes.cube();
+
+  // Hues spread evenly, fixed so every run gets the same materials
+  out.materials.reserve(kMaxMaterials);
+  for (uint32_t i = 0; i < kMaxMaterials; ++i) {
+    const float h = float(i) / float(kMaxMaterials) * 2.0F *
+                    std::numbers::pi_v<float>;
+    const glm::vec4 color{0.5F + (0.5F * std::cos(h)),
+                          0.5F + (0.5F * std::cos(h + 2.094F)),
+                          0.5F + (0.5F * std::cos(h + 4.189F)), 1.0F};
+    out.materials.push_back(renderer.createMaterialFromBaseColorFactor(color));
+  }
+
+  engine::assets::GltfLoadOptions opt{};
+  opt.flipTexcoordV = true;
+  opt.axis.yUpToZUp = true;
+  opt.jobs = &jobs;
+  if (!engine::assets::loadGltf(renderer, "assets/tree.glb", out.tree, opt)) {
+    std::cerr << "[Bench] Failed to load assets/tree.glb, tree scenarios "
+                 "render nothing\n";
+  }
+
+  return renderer.endUpload(/*wait=*/true);
+}
+
+// Extent of the scene along its widest axis
+float sceneSize(const Scenario &scenario) {
+  const float spacing =
+      scenario.kind == SceneKind::CubeGrid ? kCubeSpacing : kTreeSpacing;
+  return std::ceil(std::sqrt(float(scenario.count))) * spacing;
+}
+
+void buildDraws(const Scenario &scenario, const Assets &assets, float t,
+                std::vector<DrawItem> &out) {
+  out.clear();
+
+  if (scenario.kind == SceneKind::CubeGrid) {
+    pushCubeGrid(out, assets.cube, assets.materials[0], scenario.count,
+                 kCubeSpacing, t);
+
+    const uint32_t n = std::min(scenario.materials, kMaxMaterials);
+    if (n > 1) {
+      for (size_t i = 0; i < out.size(); ++i) {
+        out[i].material = assets.materials[i % n];
+      }
+    }
+    return;
+  }
+
+  // Trees on the ground plane (Z-up), one copy of every draw item per tree
+  const auto gridW =
+      static_cast<uint32_t>(std::ceil(std::sqrt(double(scenario.count))));
+  const float half = float(gridW - 1) * 0.5F;
+
+  out.reserve(size_t(scenario.count) * assets.tree.drawItems.size());
+  for (uint32_t i = 0; i < scenario.count; ++i) {
+    const float x = (float(i % gridW) - half) * kTreeSpacing;
+    const float y = (float(i / gridW) - half) * kTreeSpacing;
+    const glm::mat4 placement = engine::makeModel({x, y, 0.0F});
+
+    for (DrawItem item : assets.tree.drawItems) {
+      item.model = placement * item.model;
+      out.push_back(item);
+    }
+  }
+}
+
+// Slow pan in front of the scene, looking along +Y
+void placeCamera(const Scenario &scenario, uint32_t frame, Camera &camera) {
+  const float size = sceneSize(scenario);
+  const float distance = size * 0.75F + 5.0F;
+  const float height =
+      scenario.kind == SceneKind::TreeField ? distance * 0.5F : 0.0F;
+  const float pan =
+      size * 0.25F * std::sin(float(frame) * kTimestep * 0.5F);
+
+  camera.position = {pan, -distance, height};
+  camera.yawDeg = 90.0F;
+  camera.pitchDeg =
+      -std::atan2(height, distance) * 180.0F / std::numbers::pi_v<float>;
+  camera.zNear = 0.1F;
+  camera.zFar = distance + size * 2.0F;
+}
+
+void recordFrame(const Renderer &renderer, bench::ScenarioRecord &record) {
+  const CpuProfiler::FrameStats &cpu = renderer.cpuProfiler().last();
+  for (size_t i = 0; i < cpu.ms.size(); ++i) {
+    const auto stat = static_cast<CpuProfiler::Stat>(i);
+    record.add("cpu." + std::string(CpuProfiler::name(stat)) + "_ms",
+               cpu.ms[i]);
+  }
+  record.add("cpu.drawCalls", cpu.drawCalls);
+  record.add("cpu.triangles", double(cpu.triangles));
+  record.add("cpu.pipelineBinds", cpu.pipelineBinds);
+  record.add("cpu.descriptorBinds", cpu.descriptorBinds);
+  record.add("cpu.instances", cpu.instances);
+  record.add("cpu.arenaBytes", double(cpu.arenaBytes));
+  if constexpr (profiling::AllocTracker::kCompiledIn) {
+    const auto frame = static_cast<size_t>(CpuProfiler::Stat::FrameTotal);
+    record.add("cpu.allocations", cpu.allocations[frame]);
+    record.add("cpu.allocatedBytes", double(cpu.allocatedBytes[frame]));
+  }
+
+  // Timestamps trail the CPU by framesInFlight, skip until they land
+  const VkGpuProfiler::GpuFrameStats &gpu = renderer.gpuProfiler().last();
+  if (gpu.valid) {
+    record.add("gpu.frame_ms", gpu.frameMs);
+    record.add("gpu.mainPass_ms", gpu.mainPassMs);
+    record.add("gpu.idleGap_ms", gpu.idleGapMs);
+  }
+
+  const UploadProfiler::Stats &upload = renderer.uploadProfiler().last();
+  for (size_t i = 0; i < upload.v.size(); ++i) {
+    const auto stat = static_cast<UploadProfiler::Stat>(i);
+    record.add("upload." + std::string(UploadProfiler::name(stat)),
+               double(upload.v[i]));
+  }
+
+  const profiling::MemorySnapshot mem =
+      profiling::MemoryTracker::instance().snapshot();
+  for (size_t i = 0; i < mem.categories.size(); ++i) {
+    const auto tag = static_cast<profiling::MemoryTag>(i);
+    record.add("mem." + std::string(profiling::name(tag)) + "_bytes",
+               double(mem.categories[i].liveBytes));
+  }
+  record.add("mem.total_bytes", double(mem.liveBytes));
+}
+
+// Growth between two points that should hold the same resources
+void reportMemoryDiff(std::string_view what,
+                      const profiling::MemorySnapshot &before,
+                      const profiling::MemorySnapshot &after) {
+  for (const profiling::MemoryDiff &d : profiling::diff(before, after)) {
+    std::cerr << "[Bench]   " << what << ": " << profiling::name(d.tag) << ' '
+              << (d.liveBytes >= 0 ? "+" : "") << d.liveBytes << " bytes in "
+              << (d.liveCount >= 0 ? "+" : "") << d.liveCount
+              << " allocations\n";
+  }
+}
+
+bool runScenario(EngineApp &app, const Options &opt, const Scenario &scenario,
+                 const Assets &assets, bench::ScenarioRecord &record) {
+  Renderer &renderer = app.renderer();
+  Camera camera;
+  std::vector<DrawItem> draw;
+
+  const uint32_t total = opt.warmup + opt.frames;
+  for (uint32_t frame = 0; frame < total; ++frame) {
+    if (!opt.headless) {
+      if (app.window().shouldClose()) {
+        return false;
+      }
+      app.window().pollEvents();
+    }
+
+    const float t = float(frame) * kTimestep;
+    buildDraws(scenario, assets, t, draw);
+    placeCamera(scenario, frame, camera);
+    renderer.setCameraUBO(camera.makeUbo(app.presenter().swapchainExtent()));
+
+    if (!renderer.drawFrame(app.presenter(), draw)) {
+      std::cerr << "[Bench] drawFrame failed in '" << scenario.name << "'\n";
+      return false;
+    }
+
+    if (frame >= opt.warmup) {
+      recordFrame(renderer, record);
+    }
+  }
+
+  // The engine drops batches past its per-frame instance budget
+  const auto &metrics = record.metrics();
+  const auto instances = std::find_if(
+      metrics.begin(), metrics.end(),
+      [](const auto &m) { return m.first == "cpu.instances"; });
+  if (instances != metrics.end() && !instances->second.empty() &&
+      instances->second.back() < double(draw.size())) {
+    std::cerr << "[Bench] '" << scenario.name << "' drew "
+              << instances->second.back() << " of " << draw.size()
+              << " instances\n";
+  }
+
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opt{};
+  if (!parseArgs(argc, argv, opt)) {
+    return 1;
+  }
+
+  log::init();
+  // Declared before the app so its teardown messages are written too
+  const auto logShutdown = makeScopeExit([]() noexcept { log::shutdown(); });
+
+  EngineApp app;
+  AppConfig cfg{};
+  cfg.title = "Quark Bench";
+  cfg.width = 1280;
+  cfg.height = 720;
+  cfg.headless = opt.headless;
+
+  if (!app.init(cfg)) {
+    std::cerr << "[Bench] App init failed\n";
+    return 1;
+  }
+
+  const profiling::MemorySnapshot beforeAssets =
+      profiling::MemoryTracker::instance().snapshot();
+
+  Assets assets;
+  if (!loadAssets(app.renderer(), app.meshes(), app.jobs(), assets)) {
+    return 1;
+  }
+
+  std::vector<bench::ScenarioRecord> records;
+  for (const Scenario &scenario : kScenarios) {
+    if (!opt.scenarios.empty() &&
+        std::find(opt.scenarios.begin(), opt.scenarios.end(),
+                  scenario.name) == opt.scenarios.end()) {
+      continue;
+    }
+
+    std::cerr << "[Bench] " << scenario.name << ": " << opt.warmup
+              << " warmup + " << opt.frames << " frames\n";
+
+    const profiling::MemorySnapshot before =
+        profiling::MemoryTracker::instance().snapshot();
+
+    bench::ScenarioRecord &record =
+        records.emplace_back(std::string(scenario.name));
+    if (!runScenario(app, opt, scenario, assets, record)) {
+      return 1;
+    }
+
+    reportMemoryDiff(scenario.name, before,
+                     profiling::MemoryTracker::instance().snapshot());
+
+    const bench::Summary frame = bench::summarize(
+        record.metrics().front().second); // cpu.FrameTotal_ms
+    std::cerr << "[Bench]   FrameTotal p50 " << frame.p50 << " ms, p95 "
+              << frame.p95 << " ms, p99 " << frame.p99 << " ms\n";
+  }
+
+  if (!opt.vmaJson.empty() && !app.renderer().writeVmaStatsJson(opt.vmaJson)) {
+    return 1;
+  }
+
+  // Only the tree is released, the cube and its materials stay alive
+  engine::assets::releaseGltf(app.renderer(), assets.tree);
+  reportMemoryDiff("after release", beforeAssets,
+                   profiling::MemoryTracker::instance().snapshot());
+
+  if (!opt.csv.empty() && !bench::writeCsv(opt.csv, records)) {
+    return 1;
+  }
+  if (!opt.json.empty() && !bench::writeJson(opt.json, records)) {
+    return 1;
+  }
+
+  if (opt.baseline.empty()) {
+    return 0;
+  }
+
+  bench::Baseline baseline;
+  if (!bench::readBaseline(opt.baseline, baseline)) {
+    return 1;
+  }
+
+  const std::vector<bench::Regression> regressions =
+      bench::compare(records, baseline, opt.threshold);
+  for (const bench::Regression &r : regressions) {
+    std::cerr << "[Bench] REGRESSION " << r.scenario << ' ' << r.metric << ' '
+              << r.stat << ": " << r.baseline << " -> " << r.current
+              << " ms (+"
+              << (r.current / r.baseline - 1.0) * 100.0 << "%)\n";
+  }
+
+  return regressions.empty() ? 0 : 2;
+}
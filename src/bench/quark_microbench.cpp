@@ -0,0 +1,501 @@
+#include "bench/micro_harness.hpp"
+#include "bench/synthetic_assets.hpp"
+#include "engine/assets/gltf/gltf_accessors.hpp"
+#include "engine/assets/gltf/gltf_cpu_loader.hpp"
+#include "engine/assets/gltf/gltf_types.hpp"
+#include "engine/assets/image_data.hpp"
+#include "engine/assets/stb_image/stb_image_loader.hpp"
+#include "engine/geometry/mesh_builder.hpp"
+#include "engine/geometry/primitives.hpp"
+#include "engine/geometry/transform.hpp"
+#include "engine/jobs/job_system.hpp"
+#include "engine/logging/async_log_sink.hpp"
+#include "engine/mesh/mesh_data.hpp"
+#include "render/draw_batcher.hpp"
+#include "render/frame_arena.hpp"
+#include "render/resources/mesh_store.hpp"
+
+#include <array>
+#include <atomic>
+#include <cgltf.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// CPU hot paths measured without a device. Each case reports the median
+// repetition divided by the number of elements it processed. The JobSystem
+// and AsyncLogSink cases also check their counts and fail the run on a
+// mismatch, the repo has no other stress test for them.
+
+namespace {
+
+struct Options {
+  bench::MicroRunner::Config runner;
+  int cpu = 0;       // -1 leaves affinity alone
+  uint64_t size = 0; // replaces every case's size list when set
+  std::filesystem::path csv;
+};
+
+struct CgltfFree {
+  void operator()(cgltf_data *data) const noexcept { cgltf_free(data); }
+};
+using CgltfPtr = std::unique_ptr<cgltf_data, CgltfFree>;
+
+std::vector<uint64_t> sizesOr(const Options &opt,
+                              std::initializer_list<uint64_t> defaults) {
+  if (opt.size != 0) {
+    return {opt.size};
+  }
+  return defaults;
+}
+
+std::filesystem::path scratchDir() {
+  std::error_code ec;
+  std::filesystem::path dir =
+      std::filesystem::temp_directory_path(ec) / "quark_microbench";
+  std::filesystem::create_directories(dir, ec);
+  return dir;
+}
+
+// Renderer::recordFrame without the GPU: a fresh batcher per frame, 64
+// meshes x 16 materials, four pipeline variants
+void benchBatching(bench::MicroRunner &runner, const Options &opt) {
+  for (const uint64_t n : sizesOr(opt, {1'000, 10'000, 100'000})) {
+    std::vector<MeshHandle> meshes(n);
+    std::vector<uint32_t> materials(n);
+    std::vector<glm::mat4> models(n);
+    for (uint64_t i = 0; i < n; ++i) {
+      meshes[i].id = static_cast<uint32_t>(i % 64);
+      materials[i] = static_cast<uint32_t>((i / 64) % 16);
+      models[i] = engine::makeModel({float(i), 0.0F, 0.0F});
+    }
+
+    runner.run("batching", n, n, 0, [&] {
+      DrawBatcher batches;
+      batches.begin(n);
+      for (uint64_t i = 0; i < n; ++i) {
+        batches.add(meshes[i], materials[i], models[i]);
+      }
+      const auto sorted =
+          batches.sort([](uint32_t material) { return material & 3U; });
+      bench::doNotOptimize(sorted.data());
+    });
+
+    // Same, out of a frame arena as the renderer does
+    LinearArena arena;
+    runner.run("batching/arena", n, n, 0, [&] {
+      arena.reset();
+      DrawBatcher batches(&arena);
+      batches.begin(n);
+      for (uint64_t i = 0; i < n; ++i) {
+        batches.add(meshes[i], materials[i], models[i]);
+      }
+      const auto sorted =
+          batches.sort([](uint32_t material) { return material & 3U; });
+      bench::doNotOptimize(sorted.data());
+    });
+  }
+}
+
+void benchMakeModel(bench::MicroRunner &runner, const Options &opt) {
+  for (const uint64_t n : sizesOr(opt, {1'024, 65'536, 1'048'576})) {
+    std::vector<glm::vec3> pos(n);
+    std::vector<glm::vec3> rot(n);
+    for (uint64_t i = 0; i < n; ++i) {
+      pos[i] = {float(i), float(i % 7), 0.0F};
+      rot[i] = {0.0F, float(i) * 0.001F, float(i) * 0.002F};
+    }
+
+    runner.run("makeModel", n, n, 0, [&] {
+      for (uint64_t i = 0; i < n; ++i) {
+        const glm::mat4 m = engine::makeModel(pos[i], rot[i]);
+        bench::doNotOptimize(m);
+      }
+    });
+  }
+}
+
+// Sizes are vertex counts, rounded down to a square grid
+void benchGltf(bench::MicroRunner &runner, const Options &opt,
+               const std::filesystem::path &dir) {
+  const bool cpu = runner.enabled("loadGltfCpu");
+  const bool accessors = runner.enabled("readVecN/vec3") ||
+                         runner.enabled("readVecN/vec2") ||
+                         runner.enabled("readVecN/vec4");
+  if (!cpu && !accessors) {
+    return;
+  }
+
+  for (const uint64_t n : sizesOr(opt, {10'000, 100'000, 1'000'000})) {
+    const auto gridW = static_cast<uint32_t>(std::sqrt(double(n)));
+    const uint64_t vertices = uint64_t(gridW) * gridW;
+    const std::filesystem::path path =
+        dir / ("grid_" + std::to_string(gridW) + ".glb");
+    if (!bench::writeGridGlb(path, gridW)) {
+      continue;
+    }
+
+    if (cpu) {
+      engine::assets::GltfSceneCpu probe;
+      if (!engine::assets::loadGltfCpu(path.string(), probe)) {
+        std::cerr << "[Bench] loadGltfCpu rejected '" << path.string()
+                  << "'\n";
+        continue;
+      }
+
+      runner.run("loadGltfCpu", vertices, vertices, 0, [&] {
+        engine::assets::GltfSceneCpu scene;
+        (void)engine::assets::loadGltfCpu(path.string(), scene);
+        bench::doNotOptimize(scene.primitives.data());
+      });
+    }
+
+    if (!accessors) {
+      continue;
+    }
+
+    cgltf_options options{};
+    cgltf_data *raw = nullptr;
+    if (cgltf_parse_file(&options, path.string().c_str(), &raw) !=
+        cgltf_result_success) {
+      continue;
+    }
+    CgltfPtr doc(raw);
+    if (cgltf_load_buffers(&options, doc.get(), path.string().c_str()) !=
+        cgltf_result_success) {
+      continue;
+    }
+
+    // POSITION, TEXCOORD_0, COLOR_0 in the order writeGridGlb emits them
+    constexpr std::array<std::pair<std::string_view, int>, 3> kAttributes{
+        {{"readVecN/vec3", 3}, {"readVecN/vec2", 2}, {"readVecN/vec4", 4}}};
+    std::vector<float> out;
+    for (size_t a = 0; a < kAttributes.size(); ++a) {
+      const cgltf_accessor *acc = &doc->accessors[a];
+      const auto [name, comps] = kAttributes[a];
+      runner.run(name, vertices, acc->count, sizeof(float) * size_t(comps),
+                 [&] {
+                   engine::assets::readVecN(acc, comps, out);
+                   bench::doNotOptimize(out.data());
+                 });
+    }
+  }
+}
+
+// Sizes are square image edges, elements are pixels
+void benchImages(bench::MicroRunner &runner, const Options &opt,
+                 const std::filesystem::path &dir) {
+  if (!runner.enabled("loadImageRGBA8")) {
+    return;
+  }
+
+  for (const uint64_t edge : sizesOr(opt, {256, 1024, 2048})) {
+    const auto w = static_cast<uint32_t>(edge);
+    const std::filesystem::path path =
+        dir / ("noise_" + std::to_string(w) + ".png");
+    if (!bench::writeNoisePng(path, w, w)) {
+      continue;
+    }
+
+    runner.run("loadImageRGBA8", edge, edge * edge, 4, [&] {
+      engine::ImageData img;
+      (void)engine::assets::loadImageRGBA8(path.string(), img, true);
+      bench::doNotOptimize(img.pixels.data());
+    });
+  }
+}
+
+// The copy VkInstanceUploader makes into its staging slice. Staging memory
+// needs a device, so a host allocation with the same alignment stands in.
+void benchInstanceMemcpy(bench::MicroRunner &runner, const Options &opt) {
+  for (const uint64_t n : sizesOr(opt, {1'024, 16'384, 131'072})) {
+    const std::vector<glm::mat4> models(n, glm::mat4(1.0F));
+    std::vector<glm::mat4> staging(n);
+    const size_t bytes = n * sizeof(glm::mat4);
+
+    runner.run("instanceMemcpy", n, n, sizeof(glm::mat4), [&] {
+      std::memcpy(staging.data(), models.data(), bytes);
+      bench::doNotOptimize(staging.data());
+    });
+  }
+}
+
+// Failed checks are reported and turn the exit code to 1
+bool expectCount(std::string_view name, uint64_t got, uint64_t want) {
+  if (got == want) {
+    return true;
+  }
+  std::cerr << "[Bench] " << name << " counted " << got << ", expected "
+            << want << "\n";
+  return false;
+}
+
+// fanOut: jobs on every thread produce the leaf jobs, so each deque is
+// pushed by its owner and drained by thieves. continuations: stages that
+// start through the previous stage's counter, a job that sees its
+// predecessor stage unfinished counts as early.
+bool benchJobs(bench::MicroRunner &runner, const Options &opt) {
+  if (!runner.enabled("JobSystem/fanOut") &&
+      !runner.enabled("JobSystem/continuations")) {
+    return true;
+  }
+
+  constexpr uint32_t kProducers = 64;
+  constexpr uint32_t kStages = 8;
+
+  engine::jobs::JobSystem jobs;
+  if (!jobs.init()) {
+    std::cerr << "[Bench] JobSystem init failed\n";
+    return false;
+  }
+
+  bool ok = true;
+  for (const uint64_t n : sizesOr(opt, {10'000, 100'000, 1'000'000})) {
+    const auto count = static_cast<uint32_t>(n);
+
+    std::atomic<uint32_t> done{0};
+    runner.run("JobSystem/fanOut", n, n, 0, [&] {
+      done.store(0, std::memory_order_relaxed);
+      engine::jobs::JobCounter counter;
+      for (uint32_t p = 0; p < kProducers; ++p) {
+        const uint32_t begin = uint32_t(uint64_t(count) * p / kProducers);
+        const uint32_t end = uint32_t(uint64_t(count) * (p + 1) / kProducers);
+        jobs.run(
+            "Produce",
+            [&jobs, &done, &counter, begin, end] {
+              for (uint32_t i = begin; i < end; ++i) {
+                jobs.run(
+                    "Leaf",
+                    [&done] { done.fetch_add(1, std::memory_order_relaxed); },
+                    &counter);
+              }
+            },
+            &counter);
+      }
+      jobs.wait(counter);
+      ok &= expectCount("JobSystem/fanOut",
+                        done.load(std::memory_order_relaxed), count);
+    });
+
+    const uint32_t perStage = count / kStages;
+    const uint64_t staged = uint64_t(perStage) * kStages;
+    std::array<std::atomic<uint32_t>, kStages> stageDone{};
+    std::atomic<uint32_t> early{0};
+    runner.run("JobSystem/continuations", n, staged, 0, [&] {
+      for (std::atomic<uint32_t> &stage : stageDone) {
+        stage.store(0, std::memory_order_relaxed);
+      }
+      early.store(0, std::memory_order_relaxed);
+
+      std::array<engine::jobs::JobCounter, kStages> counters;
+      for (uint32_t s = 0; s < kStages; ++s) {
+        engine::jobs::JobCounter *after = s > 0 ? &counters[s - 1] : nullptr;
+        const std::atomic<uint32_t> *prev = s > 0 ? &stageDone[s - 1] : nullptr;
+        std::atomic<uint32_t> *mine = &stageDone[s];
+        for (uint32_t i = 0; i < perStage; ++i) {
+          jobs.run(
+              "Stage",
+              [prev, mine, &early, perStage] {
+                if (prev != nullptr &&
+                    prev->load(std::memory_order_relaxed) != perStage) {
+                  early.fetch_add(1, std::memory_order_relaxed);
+                }
+                mine->fetch_add(1, std::memory_order_relaxed);
+              },
+              &counters[s], after);
+        }
+      }
+      // Earlier counters may still be finishing, wait on all of them
+      for (engine::jobs::JobCounter &counter : counters) {
+        jobs.wait(counter);
+      }
+
+      for (const std::atomic<uint32_t> &stage : stageDone) {
+        ok &= expectCount("JobSystem/continuations",
+                          stage.load(std::memory_order_relaxed), perStage);
+      }
+      ok &= expectCount("JobSystem/continuations early",
+                        early.load(std::memory_order_relaxed), 0);
+    });
+  }
+
+  jobs.shutdown();
+  return ok;
+}
+
+// Counts what the async writer hands on, called on the writer thread
+class CountingSink final
+    : public spdlog::sinks::base_sink<spdlog::details::null_mutex> {
+public:
+  std::atomic<uint64_t> messages{0};
+  std::atomic<uint64_t> bytes{0};
+
+protected:
+  void sink_it_(const spdlog::details::log_msg &msg) override {
+    messages.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(msg.payload.size(), std::memory_order_relaxed);
+  }
+  void flush_() override {}
+};
+
+// Producers log through a ring much smaller than n, so they keep blocking
+// on the writer. Payload lengths cycle, a torn slot shows in the byte sum.
+bool benchLogRing(bench::MicroRunner &runner, const Options &opt) {
+  if (!runner.enabled("AsyncLogSink/block")) {
+    return true;
+  }
+
+  constexpr uint32_t kProducers = 4;
+  constexpr uint32_t kCapacity = 256;
+  constexpr uint64_t kLengths = 64;
+
+  const auto counting = std::make_shared<CountingSink>();
+  log::AsyncLogSink sink({counting}, kCapacity, log::Overflow::Block);
+  const std::string text(kLengths, 'x');
+
+  bool ok = true;
+  for (const uint64_t n : sizesOr(opt, {10'000, 100'000, 1'000'000})) {
+    uint64_t expectedBytes = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      expectedBytes += (i % kLengths) + 1;
+    }
+
+    runner.run("AsyncLogSink/block", n, n, 0, [&] {
+      const uint64_t messages0 =
+          counting->messages.load(std::memory_order_relaxed);
+      const uint64_t bytes0 = counting->bytes.load(std::memory_order_relaxed);
+      {
+        std::vector<std::jthread> producers;
+        producers.reserve(kProducers);
+        for (uint32_t p = 0; p < kProducers; ++p) {
+          producers.emplace_back([&, p] {
+            for (uint64_t i = p; i < n; i += kProducers) {
+              const spdlog::details::log_msg msg(
+                  "Bench", spdlog::level::info,
+                  spdlog::string_view_t(text.data(), (i % kLengths) + 1));
+              sink.log(msg);
+            }
+          });
+        }
+      }
+      sink.flush();
+
+      ok &= expectCount(
+          "AsyncLogSink/block",
+          counting->messages.load(std::memory_order_relaxed) - messages0, n);
+      ok &= expectCount(
+          "AsyncLogSink/block bytes",
+          counting->bytes.load(std::memory_order_relaxed) - bytes0,
+          expectedBytes);
+    });
+  }
+
+  ok &= expectCount("AsyncLogSink/block dropped", sink.dropped(), 0);
+  sink.stop();
+  return ok;
+}
+
+void benchMeshBuilder(bench::MicroRunner &runner, const Options &opt) {
+  for (const uint64_t n : sizesOr(opt, {1'000, 10'000, 100'000})) {
+    runner.run("MeshBuilder/addQuad", n, n, 0, [&] {
+      engine::MeshBuilder b;
+      for (uint64_t i = 0; i < n; ++i) {
+        const float x = float(i);
+        b.addQuad({x, 0, 0}, {x + 1, 0, 0}, {x + 1, 1, 0}, {x, 1, 0},
+                  {1, 1, 1});
+      }
+      const engine::MeshData mesh = std::move(b).build();
+      bench::doNotOptimize(mesh.vertices.data());
+    });
+
+    const auto segments = static_cast<uint32_t>(n);
+    runner.run("primitives::circle", n, n, 0, [&] {
+      const engine::MeshData mesh = engine::primitives::circle(segments);
+      bench::doNotOptimize(mesh.vertices.data());
+    });
+  }
+}
+
+void printUsage() {
+  std::cerr << "usage: quark_microbench [--filter SUBSTR] [--reps N] "
+               "[--cpu N|-1] [--size N] [--csv PATH]\n";
+}
+
+bool parseArgs(int argc, char **argv, Options &out) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    if (arg == "--filter" && hasValue) {
+      out.runner.filter = argv[++i];
+    } else if (arg == "--reps" && hasValue) {
+      out.runner.reps =
+          static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--cpu" && hasValue) {
+      out.cpu = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+    } else if (arg == "--size" && hasValue) {
+      out.size = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--csv" && hasValue) {
+      out.csv = argv[++i];
+    } else {
+      printUsage();
+      return false;
+    }
+  }
+
+  return out.runner.reps > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opt{};
+  if (!parseArgs(argc, argv, opt)) {
+    return 1;
+  }
+
+  if (opt.cpu >= 0 && !bench::pinToCpu(opt.cpu)) {
+    std::cerr << "[Bench] Could not pin to CPU " << opt.cpu
+              << ", results may be noisy\n";
+  }
+  if (!bench::hasCycleCounter()) {
+    std::cerr << "[Bench] No cycle counter, cycles/elem reads 0\n";
+  }
+
+  bench::MicroRunner runner(opt.runner);
+  runner.printHeader();
+  const std::filesystem::path dir = scratchDir();
+
+  benchBatching(runner, opt);
+  benchMakeModel(runner, opt);
+  benchGltf(runner, opt, dir);
+  benchImages(runner, opt, dir);
+  benchInstanceMemcpy(runner, opt);
+  benchMeshBuilder(runner, opt);
+  bool ok = benchJobs(runner, opt);
+  ok &= benchLogRing(runner, opt);
+
+  if (!opt.csv.empty() && !runner.writeCsv(opt.csv)) {
+    return 1;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+#include "bench/synthetic_assets.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+void appendBytes(std::vector<uint8_t> &out, const void *data, size_t size) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  out.insert(out.end(), bytes, bytes + size);
+}
+
+void appendU32LE(std::vector<uint8_t> &out, uint32_t v) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+  }
+}
+
+void appendU32BE(std::vector<uint8_t> &out, uint32_t v) {
+  for (int i = 3; i >= 0; --i) {
+    out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+  }
+}
+
+bool writeFile(const std::filesystem::path &path,
+               const std::vector<uint8_t> &bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(reinterpret_cast<const char *>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()))) {
+    std::cerr << "[Bench] Failed to write '" << path.string() << "'\n";
+    return false;
+  }
+  return true;
+}
+
+uint32_t xorshift(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// PNG chunk CRC, the zlib polynomial
+uint32_t crc32(const uint8_t *data, size_t size) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1U) != 0 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+
+  uint32_t c = 0xFFFFFFFFU;
+  for (size_t i = 0; i < size; ++i) {
+    c = table[(c ^ data[i]) & 0xFFU] ^ (c >> 8);
+  }
+  return c ^ 0xFFFFFFFFU;
+}
+
+uint32_t adler32(const std::vector<uint8_t> &data) {
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (const uint8_t v : data) {
+    a = (a + v) % 65521U;
+    b = (b + a) % 65521U;
+  }
+  return (b << 16) | a;
+}
+
+// Deflate packs bits LSB first, Huffman codes MSB first
+class BitWriter {
+public:
+  void bits(uint32_t value, int count) {
+    for (int i = 0; i < count; ++i) {
+      push((value >> i) & 1U);
+    }
+  }
+
+  void code(uint32_t value, int length) {
+    for (int i = length - 1; i >= 0; --i) {
+      push((value >> i) & 1U);
+    }
+  }
+
+  std::vector<uint8_t> finish() && {
+    if (m_used != 0) {
+      m_out.push_back(m_cur);
+    }
+    return std::move(m_out);
+  }
+
+private:
+  void push(uint32_t bit) {
+    m_cur = static_cast<uint8_t>(m_cur | (bit << m_used));
+    if (++m_used == 8) {
+      m_out.push_back(m_cur);
+      m_cur = 0;
+      m_used = 0;
+    }
+  }
+
+  std::vector<uint8_t> m_out;
+  uint8_t m_cur = 0;
+  int m_used = 0;
+};
+
+// zlib stream of a single fixed-Huffman block without back-references
+std::vector<uint8_t> deflateLiterals(const std::vector<uint8_t> &raw) {
+  BitWriter w;
+  w.bits(1, 1); // BFINAL
+  w.bits(1, 2); // BTYPE fixed Huffman
+
+  for (const uint8_t lit : raw) {
+    if (lit < 144) {
+      w.code(0x30U + lit, 8);
+    } else {
+      w.code(0x190U + (lit - 144U), 9);
+    }
+  }
+  w.code(0, 7); // end of block
+
+  std::vector<uint8_t> out{0x78, 0x01};
+  const std::vector<uint8_t> body = std::move(w).finish();
+  appendBytes(out, body.data(), body.size());
+  appendU32BE(out, adler32(raw));
+  return out;
+}
+
+void appendPngChunk(std::vector<uint8_t> &out, std::string_view type,
+                    const std::vector<uint8_t> &data) {
+  appendU32BE(out, static_cast<uint32_t>(data.size()));
+
+  std::vector<uint8_t> typed(type.begin(), type.end());
+  appendBytes(typed, data.data(), data.size());
+  appendBytes(out, typed.data(), typed.size());
+  appendU32BE(out, crc32(typed.data(), typed.size()));
+}
+
+} // namespace
+
+bool writeGridGlb(const std::filesystem::path &path, uint32_t gridW) {
+  if (gridW < 2) {
+    return false;
+  }
+
+  const uint32_t vertexCount = gridW * gridW;
+  const uint32_t indexCount = (gridW - 1) * (gridW - 1) * 6;
+
+  std::vector<float> pos;
+  std::vector<float> uv;
+  std::vector<float> col;
+  pos.reserve(size_t(vertexCount) * 3);
+  uv.reserve(size_t(vertexCount) * 2);
+  col.reserve(size_t(vertexCount) * 4);
+
+  const float inv = 1.0F / float(gridW - 1);
+  for (uint32_t y = 0; y < gridW; ++y) {
+    for (uint32_t x = 0; x < gridW; ++x) {
+      pos.insert(pos.end(), {float(x), float(y), 0.0F});
+      uv.insert(uv.end(), {float(x) * inv, float(y) * inv});
+      col.insert(col.end(), {float(x) * inv, float(y) * inv, 0.5F, 1.0F});
+    }
+  }
+
+  std::vector<uint32_t> idx;
+  idx.reserve(indexCount);
+  for (uint32_t y = 0; y + 1 < gridW; ++y) {
+    for (uint32_t x = 0; x + 1 < gridW; ++x) {
+      const uint32_t i = (y * gridW) + x;
+      idx.insert(idx.end(), {i, i + 1, i + gridW, i + 1, i + gridW + 1,
+                             i + gridW});
+    }
+  }
+
+  std::vector<uint8_t> bin;
+  const auto view = [&bin](const auto &v) {
+    const size_t offset = bin.size();
+    const size_t bytes = v.size() * sizeof(v[0]);
+    appendBytes(bin, v.data(), bytes);
+    return "{\"buffer\":0,\"byteOffset\":" + std::to_string(offset) +
+           ",\"byteLength\":" + std::to_string(bytes) + "}";
+  };
+
+  // One statement each, operands of + are unsequenced
+  std::string views = "[" + view(pos);
+  views += "," + view(uv);
+  views += "," + view(col);
+  views += "," + view(idx) + "]";
+  const std::string n = std::to_string(vertexCount);
+  const std::string maxXY = std::to_string(gridW - 1);
+
+  std::string json =
+      R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],)"
+      R"("nodes":[{"mesh":0}],"meshes":[{"primitives":[{"attributes":)"
+      R"({"POSITION":0,"TEXCOORD_0":1,"COLOR_0":2},"indices":3}]}],)"
+      R"("accessors":[)"
+      R"({"bufferView":0,"componentType":5126,"type":"VEC3","count":)" +
+      n + R"(,"min":[0,0,0],"max":[)" + maxXY + "," + maxXY + R"(,0]},)" +
+      R"({"bufferView":1,"componentType":5126,"type":"VEC2","count":)" + n +
+      "}," +
+      R"({"bufferView":2,"componentType":5126,"type":"VEC4","count":)" + n +
+      "}," +
+      R"({"bufferView":3,"componentType":5125,"type":"SCALAR","count":)" +
+      std::to_string(indexCount) + "}]," +
+      R"("bufferViews":)" + views + "," +
+      R"("buffers":[{"byteLength":)" + std::to_string(bin.size()) + "}]}";
+
+  // Chunks are 4-byte aligned, JSON pads with spaces and BIN with zeros
+  while (json.size() % 4 != 0) {
+    json.push_back(' ');
+  }
+  while (bin.size() % 4 != 0) {
+    bin.push_back(0);
+  }
+
+  std::vector<uint8_t> glb;
+  glb.reserve(12 + 8 + json.size() + 8 + bin.size());
+  appendU32LE(glb, 0x46546C67U); // "glTF"
+  appendU32LE(glb, 2);
+  appendU32LE(glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 +
+                                         bin.size()));
+  appendU32LE(glb, static_cast<uint32_t>(json.size()));
+  appendU32LE(glb, 0x4E4F534AU); // "JSON"
+  appendBytes(glb, json.data(), json.size());
+  appendU32LE(glb, static_cast<uint32_t>(bin.size()));
+  appendU32LE(glb, 0x004E4942U); // "BIN\0"
+  appendBytes(glb, bin.data(), bin.size());
+
+  return writeFile(path, glb);
+}
+
+bool writeNoisePng(const std::filesystem::path &path, uint32_t width,
+                   uint32_t height) {
+  if (width == 0 || height == 0) {
+    return false;
+  }
+
+  const size_t stride = size_t(width) * 4;
+  std::vector<uint8_t> raw;
+  raw.reserve((stride + 1) * height);
+
+  uint32_t state = 0x9E3779B9U;
+  std::vector<uint8_t> row(stride);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      const uint32_t noise = xorshift(state);
+      row[(x * 4) + 0] = static_cast<uint8_t>(x + (noise & 0x0FU));
+      row[(x * 4) + 1] = static_cast<uint8_t>(y + ((noise >> 4) & 0x0FU));
+      row[(x * 4) + 2] = static_cast<uint8_t>(noise >> 8);
+      row[(x * 4) + 3] = 0xFF;
+    }
+
+    raw.push_back(1); // Sub filter
+    for (size_t i = 0; i < stride; ++i) {
+      const uint8_t left = i >= 4 ? row[i - 4] : 0;
+      raw.push_back(static_cast<uint8_t>(row[i] - left));
+    }
+  }
+
+  std::vector<uint8_t> ihdr;
+  appendU32BE(ihdr, width);
+  appendU32BE(ihdr, height);
+  ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // RGBA8, no interlace
+
+  std::vector<uint8_t> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  appendPngChunk(png, "IHDR", ihdr);
+  appendPngChunk(png, "IDAT", deflateLiterals(raw));
+  appendPngChunk(png, "IEND", {});
+
+  return writeFile(path, png);
+}
+
+} // namespace bench
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace bench {
+
+// gridW x gridW vertex plane as a binary glTF: float POSITION, TEXCOORD_0
+// and COLOR_0 (vec4), uint32 indices, one node
+bool writeGridGlb(const std::filesystem::path &path, uint32_t gridW);
+
+// RGBA8 noise PNG. Rows use the Sub filter and the data is one fixed-Huffman
+// deflate block of literals, so decoding exercises inflate and unfiltering
+// without needing a compressor here.
+bool writeNoisePng(const std::filesystem::path &path, uint32_t width,
+                   uint32_t height);
+
+} // namespace bench
@@ -2,7 +2,8 @@
 
 #include "engine/logging/log.hpp"
 
-#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <vulkan/vulkan_core.h>
@@ -12,37 +13,60 @@ bool EngineApp::init(const AppConfig &cfg) {
 
   m_cfg = cfg;
 
-  if (!m_window.init(cfg.width, cfg.height, cfg.title)) {
-    std::cerr << "[App] Failed to init window\n";
+  if (!m_jobs.init(cfg.jobWorkers)) {
+    std::cerr << "[App] Job system init failed\n";
     return false;
   }
-
-  LOG_INFO("App initialized");
-
-  const auto platformExtensions = m_window.requiredVulkanExtensions();
-  if (platformExtensions.empty()) {
-    std::cerr << "[App] requiredVulkanExtensions returned nothing\n";
-    shutdown();
-    return false;
-  }
-
-  if (!m_ctx.init(platformExtensions, cfg.enableValidation)) {
-    std::cerr << "[App] VkBackendCtx init failed\n";
-    shutdown();
-    return false;
+  LOG_INFO("Job system: {} threads", m_jobs.threadCount());
+
+  if (cfg.headless) {
+    if (!m_ctx.init({}, cfg.enableValidation, /*headless=*/true)) {
+      std::cerr << "[App] VkBackendCtx init failed\n";
+      shutdown();
+      return false;
+    }
+
+    if (!m_presenter.initHeadless(m_ctx, cfg.width, cfg.height,
+                                  cfg.framesInFlight)) {
+      std::cerr << "[App] Headless presenter init failed\n";
+      shutdown();
+      return false;
+    }
+
+    LOG_INFO("App initialized (headless {}x{})", cfg.width, cfg.height);
+  } else {
+    if (!m_window.init(cfg.width, cfg.height, cfg.title)) {
+      std::cerr << "[App] Failed to init window\n";
+      return false;
+    }
+
+    LOG_INFO("App initialized");
+
+    const auto platformExtensions = m_window.requiredVulkanExtensions();
+    if (platformExtensions.empty()) {
+      std::cerr << "[App] requiredVulkanExtensions returned nothing\n";
+      shutdown();
+      return false;
+    }
+
+    if (!m_ctx.init(platformExtensions, cfg.enableValidation)) {
+      std::cerr << "[App] VkBackendCtx init failed\n";
+      shutdown();
+      return false;
+    }
+
+    uint32_t fbWidth = 0;
+    uint32_t fbHeight = 0;
+    m_window.framebufferSize(fbWidth, fbHeight);
+    if (!m_presenter.init(m_ctx, &m_window, fbWidth, fbHeight)) {
+      std::cerr << "[App] Presenter init failed\n";
+      shutdown();
+      return false;
+    }
   }
 
-  uint32_t fbWidth = 0;
-  uint32_t fbHeight = 0;
-  m_window.framebufferSize(fbWidth, fbHeight);
-  if (!m_presenter.init(m_ctx, &m_window, fbWidth, fbHeight)) {
-    std::cerr << "[App] Presenter init failed\n";
-    shutdown();
-    return false;
-  }
-
-  if (!m_renderer.init(m_ctx, m_presenter, cfg.framesInFlight, cfg.vertSpvPath,
-                       cfg.fragSpvPath)) {
+  if (!m_renderer.init(m_ctx, m_presenter, m_jobs, cfg.framesInFlight,
+                       cfg.vertSpvPath, cfg.fragSpvPath)) {
     std::cerr << "[App] Renderer init failed\n";
     shutdown();
     return false;
@@ -61,6 +85,7 @@ void EngineApp::shutdown() noexcept {
   m_presenter.shutdown();
   m_ctx.shutdown();
   m_window.shutdown();
+  m_jobs.shutdown();
 
   m_inited = false;
 }
@@ -70,15 +95,27 @@ void EngineApp::run(const std::function<void(float dt)> &tick) {
     return;
   }
 
-  double lastTime = glfwGetTime();
-
-  while (!m_window.shouldClose()) {
-    m_window.pollEvents();
-
-    const double now = glfwGetTime();
-    const float dt = static_cast<float>(now - lastTime);
+  using clock = std::chrono::steady_clock;
+  auto lastTime = clock::now();
+
+  m_quit = false;
+  for (uint32_t frame = 0; m_cfg.maxFrames == 0 || frame < m_cfg.maxFrames;
+       ++frame) {
+    if (!m_cfg.headless) {
+      if (m_window.shouldClose()) {
+        break;
+      }
+      m_window.pollEvents();
+    }
+
+    const auto now = clock::now();
+    const float dt = std::chrono::duration<float>(now - lastTime).count();
     lastTime = now;
 
     tick(dt);
+
+    if (m_quit) {
+      break;
+    }
   }
 }
@@ -3,6 +3,7 @@
 #include "backend/core/vk_backend_ctx.hpp"
 #include "backend/presentation/vk_presenter.hpp"
 #include "engine/geometry/mesh_factory.hpp"
+#include "engine/jobs/job_system.hpp"
 #include "platform/window/glfw_window.hpp"
 #include "render/renderer.hpp"
 
@@ -17,6 +18,14 @@ struct AppConfig {
   uint32_t framesInFlight = 2;
   std::string vertSpvPath = "shaders/bin/shader.vert.spv";
   std::string fragSpvPath = "shaders/bin/shader.frag.spv";
+  // No window or surface, frames render into offscreen images. Works on
+  // software ICDs such as lavapipe.
+  bool headless = false;
+  // run() returns after this many frames, 0 runs until the window closes
+  // (or requestQuit() when headless)
+  uint32_t maxFrames = 0;
+  // Job workers, 0 leaves one hardware thread for the main thread
+  uint32_t jobWorkers = 0;
   bool enableValidation =
 #ifndef NDEBUG
       true;
@@ -40,16 +49,21 @@ public:
   void shutdown() noexcept;
 
   void run(const std::function<void(float dt)> &tick);
+  // run() returns after the current tick
+  void requestQuit() noexcept { m_quit = true; }
 
   GlfwWindow &window() noexcept { return m_window; }
   VkBackendCtx &ctx() noexcept { return m_ctx; }
   VkPresenter &presenter() noexcept { return m_presenter; }
   Renderer &renderer() noexcept { return m_renderer; }
+  // Owned by the thread that called init()
+  engine::jobs::JobSystem &jobs() noexcept { return m_jobs; }
 
   MeshFactory &meshes() noexcept { return m_meshes; }
   [[nodiscard]] const MeshFactory &meshes() const noexcept { return m_meshes; }
 
 private:
+  engine::jobs::JobSystem m_jobs;
   GlfwWindow m_window;
   VkBackendCtx m_ctx;
   VkPresenter m_presenter;
@@ -59,4 +73,5 @@ private:
 
   AppConfig m_cfg{};
   bool m_inited = false;
+  bool m_quit = false;
 };
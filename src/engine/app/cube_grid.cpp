@@ -0,0 +1,33 @@
+#include "engine/app/cube_grid.hpp"
+
+#include "engine/geometry/transform.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+void pushCubeGrid(std::vector<DrawItem> &out, MeshHandle mesh,
+                  uint32_t material, uint32_t cubeCount, float spacing,
+                  float t) {
+  const uint32_t gridW = uint32_t(std::ceil(std::sqrt(double(cubeCount))));
+  const uint32_t gridH = (cubeCount + gridW - 1) / gridW;
+
+  out.reserve(out.size() + cubeCount);
+
+  for (uint32_t i = 0; i < cubeCount; ++i) {
+    const uint32_t x = i % gridW;
+    const uint32_t z = i / gridW;
+
+    const float fx = (float(x) - float(gridW - 1) * 0.5F) * spacing;
+    const float fz = (float(z) - float(gridH - 1) * 0.5F) * spacing;
+
+    const float r = (t * 0.7F) + (float(i) * 0.001F);
+
+    DrawItem item{};
+    item.mesh = mesh;
+    item.material = material;
+    item.model = engine::makeModel({fx, 0.0F, fz}, {0.0F, r, 0.0F});
+
+    out.push_back(item);
+  }
+}
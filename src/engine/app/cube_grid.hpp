@@ -0,0 +1,12 @@
+#pragma once
+
+#include "render/renderer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Appends cubeCount instances on a square grid centred at the origin, each
+// spinning at a slightly different phase of t
+void pushCubeGrid(std::vector<DrawItem> &out, MeshHandle mesh,
+                  uint32_t material, uint32_t cubeCount, float spacing,
+                  float t);
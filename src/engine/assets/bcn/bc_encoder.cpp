@@ -0,0 +1,455 @@
+#include "engine/assets/bcn/bc_encoder.hpp"
+
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/texture_format.hpp"
+#include "engine/jobs/job_system.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr uint32_t kBlockTexels = 16;
+
+// BC7 interpolation weights for 4 bit indices
+constexpr std::array<int32_t, 16> kBC7Weights4 = {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Endpoints along the principal axis of the first `channels` channels.
+// Power iteration is plenty for 16 texels.
+void fitEndpoints(const uint8_t *rgba, uint32_t channels, float *lo,
+                  float *hi) {
+  std::array<float, 4> mean{};
+  for (uint32_t i = 0; i < kBlockTexels; ++i) {
+    for (uint32_t c = 0; c < channels; ++c) {
+      mean[c] += static_cast<float>(rgba[(i * 4U) + c]);
+    }
+  }
+  for (uint32_t c = 0; c < channels; ++c) {
+    mean[c] /= float(kBlockTexels);
+  }
+
+  std::array<std::array<float, 4>, 4> cov{};
+  for (uint32_t i = 0; i < kBlockTexels; ++i) {
+    std::array<float, 4> d{};
+    for (uint32_t c = 0; c < channels; ++c) {
+      d[c] = static_cast<float>(rgba[(i * 4U) + c]) - mean[c];
+    }
+    for (uint32_t r = 0; r < channels; ++r) {
+      for (uint32_t c = 0; c < channels; ++c) {
+        cov[r][c] += d[r] * d[c];
+      }
+    }
+  }
+
+  // Start from the row of the channel with the most variance
+  uint32_t start = 0;
+  for (uint32_t c = 1; c < channels; ++c) {
+    if (cov[c][c] > cov[start][start]) {
+      start = c;
+    }
+  }
+
+  std::array<float, 4> axis = cov[start];
+  for (uint32_t iter = 0; iter < 8; ++iter) {
+    std::array<float, 4> next{};
+    for (uint32_t r = 0; r < channels; ++r) {
+      for (uint32_t c = 0; c < channels; ++c) {
+        next[r] += cov[r][c] * axis[c];
+      }
+    }
+
+    float len = 0.0F;
+    for (uint32_t c = 0; c < channels; ++c) {
+      len += next[c] * next[c];
+    }
+    if (len < 1e-12F) {
+      break;
+    }
+
+    len = 1.0F / std::sqrt(len);
+    for (uint32_t c = 0; c < channels; ++c) {
+      axis[c] = next[c] * len;
+    }
+  }
+
+  float len = 0.0F;
+  for (uint32_t c = 0; c < channels; ++c) {
+    len += axis[c] * axis[c];
+  }
+
+  if (len < 1e-12F) {
+    // Flat block
+    for (uint32_t c = 0; c < channels; ++c) {
+      lo[c] = mean[c];
+      hi[c] = mean[c];
+    }
+    return;
+  }
+
+  len = 1.0F / std::sqrt(len);
+  for (uint32_t c = 0; c < channels; ++c) {
+    axis[c] *= len;
+  }
+
+  float tMin = 0.0F;
+  float tMax = 0.0F;
+  for (uint32_t i = 0; i < kBlockTexels; ++i) {
+    float t = 0.0F;
+    for (uint32_t c = 0; c < channels; ++c) {
+      t += (static_cast<float>(rgba[(i * 4U) + c]) - mean[c]) * axis[c];
+    }
+    tMin = std::min(tMin, t);
+    tMax = std::max(tMax, t);
+  }
+
+  for (uint32_t c = 0; c < channels; ++c) {
+    lo[c] = std::clamp(mean[c] + (axis[c] * tMin), 0.0F, 255.0F);
+    hi[c] = std::clamp(mean[c] + (axis[c] * tMax), 0.0F, 255.0F);
+  }
+}
+
+uint16_t packRGB565(const float *c) noexcept {
+  const auto r = static_cast<uint32_t>(std::lround(c[0] * 31.0F / 255.0F));
+  const auto g = static_cast<uint32_t>(std::lround(c[1] * 63.0F / 255.0F));
+  const auto b = static_cast<uint32_t>(std::lround(c[2] * 31.0F / 255.0F));
+  return static_cast<uint16_t>((r << 11U) | (g << 5U) | b);
+}
+
+std::array<int32_t, 3> unpackRGB565(uint16_t v) noexcept {
+  const auto r = static_cast<int32_t>((v >> 11U) & 31U);
+  const auto g = static_cast<int32_t>((v >> 5U) & 63U);
+  const auto b = static_cast<int32_t>(v & 31U);
+  return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+// Always 4 color mode, alpha is ignored
+void encodeColorBlock(const uint8_t *rgba, uint8_t *dst) noexcept {
+  std::array<float, 4> lo{};
+  std::array<float, 4> hi{};
+  fitEndpoints(rgba, 3, lo.data(), hi.data());
+
+  uint16_t c0 = packRGB565(hi.data());
+  uint16_t c1 = packRGB565(lo.data());
+  if (c0 < c1) {
+    std::swap(c0, c1);
+  }
+
+  uint32_t indices = 0;
+  if (c0 != c1) {
+    std::array<std::array<int32_t, 3>, 4> palette{};
+    palette[0] = unpackRGB565(c0);
+    palette[1] = unpackRGB565(c1);
+    for (uint32_t c = 0; c < 3; ++c) {
+      palette[2][c] = ((2 * palette[0][c]) + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + (2 * palette[1][c])) / 3;
+    }
+
+    for (uint32_t i = 0; i < kBlockTexels; ++i) {
+      uint32_t best = 0;
+      int32_t bestErr = INT32_MAX;
+      for (uint32_t p = 0; p < 4; ++p) {
+        int32_t err = 0;
+        for (uint32_t c = 0; c < 3; ++c) {
+          const int32_t d = int32_t(rgba[(i * 4U) + c]) - palette[p][c];
+          err += d * d;
+        }
+        if (err < bestErr) {
+          bestErr = err;
+          best = p;
+        }
+      }
+      indices |= best << (i * 2U);
+    }
+  }
+
+  dst[0] = static_cast<uint8_t>(c0 & 0xFFU);
+  dst[1] = static_cast<uint8_t>(c0 >> 8U);
+  dst[2] = static_cast<uint8_t>(c1 & 0xFFU);
+  dst[3] = static_cast<uint8_t>(c1 >> 8U);
+  for (uint32_t b = 0; b < 4; ++b) {
+    dst[4 + b] = static_cast<uint8_t>((indices >> (b * 8U)) & 0xFFU);
+  }
+}
+
+// BC4 block of one channel, 8 value mode
+void encodeChannelBlock(const uint8_t *rgba, uint32_t channel,
+                        uint8_t *dst) noexcept {
+  int32_t lo = 255;
+  int32_t hi = 0;
+  for (uint32_t i = 0; i < kBlockTexels; ++i) {
+    const int32_t v = rgba[(i * 4U) + channel];
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  }
+
+  std::memset(dst, 0, 8);
+  dst[0] = static_cast<uint8_t>(hi);
+  dst[1] = static_cast<uint8_t>(lo);
+  if (lo == hi) {
+    return;
+  }
+
+  std::array<int32_t, 8> palette{};
+  palette[0] = hi;
+  palette[1] = lo;
+  for (int32_t p = 2; p < 8; ++p) {
+    palette[p] = (((8 - p) * hi) + ((p - 1) * lo) + 3) / 7;
+  }
+
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < kBlockTexels; ++i) {
+    const int32_t v = rgba[(i * 4U) + channel];
+    uint64_t best = 0;
+    int32_t bestErr = INT32_MAX;
+    for (uint32_t p = 0; p < 8; ++p) {
+      const int32_t err = std::abs(v - palette[p]);
+      if (err < bestErr) {
+        bestErr = err;
+        best = p;
+      }
+    }
+    bits |= best << (i * 3U);
+  }
+
+  for (uint32_t b = 0; b < 6; ++b) {
+    dst[2 + b] = static_cast<uint8_t>((bits >> (b * 8U)) & 0xFFU);
+  }
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(uint8_t *dst) noexcept : m_dst(dst) {}
+
+  void write(uint32_t value, uint32_t bits) noexcept {
+    for (uint32_t b = 0; b < bits; ++b) {
+      if (((value >> b) & 1U) != 0) {
+        m_dst[m_pos >> 3U] |= static_cast<uint8_t>(1U << (m_pos & 7U));
+      }
+      ++m_pos;
+    }
+  }
+
+private:
+  uint8_t *m_dst = nullptr; // non-owning
+  uint32_t m_pos = 0;
+};
+
+// 7 bit endpoint plus a shared p-bit, picks the p-bit with less error
+void quantizeBC7Endpoint(const float *e, std::array<uint32_t, 4> &q,
+                         uint32_t &pbit) noexcept {
+  float bestErr = 0.0F;
+  for (uint32_t p = 0; p < 2; ++p) {
+    std::array<uint32_t, 4> cand{};
+    float err = 0.0F;
+    for (uint32_t c = 0; c < 4; ++c) {
+      const float v = (e[c] - static_cast<float>(p)) * 0.5F;
+      cand[c] = static_cast<uint32_t>(std::clamp(std::lround(v), 0L, 127L));
+      const float d = static_cast<float>((cand[c] << 1U) | p) - e[c];
+      err += d * d;
+    }
+
+    if (p == 0 || err < bestErr) {
+      bestErr = err;
+      q = cand;
+      pbit = p;
+    }
+  }
+}
+
+// Per-level block rows handed out to the workers
+struct BlockRow {
+  uint32_t level = 0;
+  uint32_t blockY = 0;
+};
+
+using BlockEncoder = void (*)(const uint8_t *, uint8_t *) noexcept;
+
+BlockEncoder blockEncoder(TextureFormat format) noexcept {
+  switch (format) {
+  case TextureFormat::BC1:
+    return &encodeBlockBC1;
+  case TextureFormat::BC3:
+    return &encodeBlockBC3;
+  case TextureFormat::BC5:
+    return &encodeBlockBC5;
+  case TextureFormat::BC7:
+    return &encodeBlockBC7;
+  case TextureFormat::RGBA8:
+    break;
+  }
+
+  return nullptr;
+}
+
+// Edges of levels that are not a multiple of 4 repeat the last texel
+void encodeRow(const MipChain &src, MipChain &dst, const BlockRow &row,
+               BlockEncoder encode) {
+  const MipLevel &in = src.levels[row.level];
+  const MipLevel &out = dst.levels[row.level];
+  const uint8_t *pixels = src.levelData(row.level);
+  const uint32_t blocksX = (in.width + 3U) / 4U;
+  const uint32_t blockBytes = textureBlockBytes(dst.format);
+
+  std::array<uint8_t, kBlockTexels * 4U> block{};
+  for (uint32_t bx = 0; bx < blocksX; ++bx) {
+    for (uint32_t y = 0; y < 4; ++y) {
+      const uint32_t sy = std::min((row.blockY * 4U) + y, in.height - 1U);
+      for (uint32_t x = 0; x < 4; ++x) {
+        const uint32_t sx = std::min((bx * 4U) + x, in.width - 1U);
+        std::memcpy(block.data() + (((y * 4U) + x) * 4U),
+                    pixels + (((size_t(sy) * in.width) + sx) * 4U), 4);
+      }
+    }
+
+    uint8_t *blockDst = dst.pixels.data() + out.offset +
+                        ((size_t(row.blockY) * blocksX + bx) * blockBytes);
+    encode(block.data(), blockDst);
+  }
+}
+
+} // namespace
+
+void encodeBlockBC1(const uint8_t *rgba, uint8_t *dst) noexcept {
+  encodeColorBlock(rgba, dst);
+}
+
+void encodeBlockBC3(const uint8_t *rgba, uint8_t *dst) noexcept {
+  encodeChannelBlock(rgba, 3, dst);
+  encodeColorBlock(rgba, dst + 8);
+}
+
+void encodeBlockBC5(const uint8_t *rgba, uint8_t *dst) noexcept {
+  encodeChannelBlock(rgba, 0, dst);
+  encodeChannelBlock(rgba, 1, dst + 8);
+}
+
+void encodeBlockBC7(const uint8_t *rgba, uint8_t *dst) noexcept {
+  std::array<float, 4> lo{};
+  std::array<float, 4> hi{};
+  fitEndpoints(rgba, 4, lo.data(), hi.data());
+
+  std::array<std::array<uint32_t, 4>, 2> q{};
+  std::array<uint32_t, 2> pbit{};
+  quantizeBC7Endpoint(lo.data(), q[0], pbit[0]);
+  quantizeBC7Endpoint(hi.data(), q[1], pbit[1]);
+
+  std::array<std::array<int32_t, 4>, 16> palette{};
+  for (uint32_t c = 0; c < 4; ++c) {
+    const auto e0 = static_cast<int32_t>((q[0][c] << 1U) | pbit[0]);
+    const auto e1 = static_cast<int32_t>((q[1][c] << 1U) | pbit[1]);
+    for (uint32_t p = 0; p < 16; ++p) {
+      palette[p][c] =
+          (((64 - kBC7Weights4[p]) * e0) + (kBC7Weights4[p] * e1) + 32) >> 6;
+    }
+  }
+
+  std::array<uint32_t, kBlockTexels> indices{};
+  for (uint32_t i = 0; i < kBlockTexels; ++i) {
+    int32_t bestErr = INT32_MAX;
+    for (uint32_t p = 0; p < 16; ++p) {
+      int32_t err = 0;
+      for (uint32_t c = 0; c < 4; ++c) {
+        const int32_t d = int32_t(rgba[(i * 4U) + c]) - palette[p][c];
+        err += d * d;
+      }
+      if (err < bestErr) {
+        bestErr = err;
+        indices[i] = p;
+      }
+    }
+  }
+
+  // The anchor index is stored without its high bit
+  if ((indices[0] & 8U) != 0) {
+    std::swap(q[0], q[1]);
+    std::swap(pbit[0], pbit[1]);
+    for (uint32_t &index : indices) {
+      index = 15U - index;
+    }
+  }
+
+  std::memset(dst, 0, 16);
+  BitWriter bits(dst);
+  bits.write(1U << 6U, 7); // mode 6
+  for (uint32_t c = 0; c < 4; ++c) {
+    bits.write(q[0][c], 7);
+    bits.write(q[1][c], 7);
+  }
+  bits.write(pbit[0], 1);
+  bits.write(pbit[1], 1);
+  bits.write(indices[0], 3);
+  for (uint32_t i = 1; i < kBlockTexels; ++i) {
+    bits.write(indices[i], 4);
+  }
+}
+
+bool compressMipChain(const MipChain &src, TextureFormat format,
+                      MipChain &out, jobs::JobSystem *jobs) {
+  if (!src.valid() || src.format != TextureFormat::RGBA8) {
+    std::cerr << "[BCn] compressMipChain expects an RGBA8 chain\n";
+    return false;
+  }
+
+  if (format == TextureFormat::RGBA8) {
+    out = src;
+    return true;
+  }
+
+  const BlockEncoder encode = blockEncoder(format);
+  if (encode == nullptr) {
+    std::cerr << "[BCn] Unsupported format " << textureFormatName(format)
+              << "\n";
+    return false;
+  }
+
+  MipChain result;
+  result.format = format;
+  // BC5 holds vectors, never color
+  result.srgb = src.srgb && format != TextureFormat::BC5;
+  result.levels.resize(src.levels.size());
+
+  std::vector<BlockRow> rows;
+  size_t total = 0;
+  for (uint32_t level = 0; level < src.levelCount(); ++level) {
+    const MipLevel &in = src.levels[level];
+    MipLevel &lvl = result.levels[level];
+    lvl.width = in.width;
+    lvl.height = in.height;
+    lvl.offset = total;
+    lvl.size = textureLevelSize(format, in.width, in.height);
+    total += lvl.size;
+
+    for (uint32_t by = 0; by < (in.height + 3U) / 4U; ++by) {
+      rows.push_back(BlockRow{level, by});
+    }
+  }
+  result.pixels.resize(total);
+
+  auto encodeRows = [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      encodeRow(src, result, rows[i], encode);
+    }
+  };
+
+  const auto rowCount = static_cast<uint32_t>(rows.size());
+  if (jobs != nullptr) {
+    jobs->parallelFor("EncodeBCn", rowCount, encodeRows);
+  } else {
+    encodeRows(0U, rowCount);
+  }
+
+  out = std::move(result);
+  return true;
+}
+
+} // namespace engine::assets
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/texture_format.hpp"
+#include "engine/jobs/job_system.hpp"
+
+#include <cstdint>
+
+namespace engine::assets {
+
+// Encode one 4x4 block. rgba holds 16 texels row by row (64 bytes).
+void encodeBlockBC1(const uint8_t *rgba, uint8_t *dst) noexcept;
+void encodeBlockBC3(const uint8_t *rgba, uint8_t *dst) noexcept;
+void encodeBlockBC5(const uint8_t *rgba, uint8_t *dst) noexcept; // R and G
+void encodeBlockBC7(const uint8_t *rgba, uint8_t *dst) noexcept;
+
+// Compress every level of an RGBA8 chain into format. Block rows of all
+// levels are split with jobs->parallelFor, or encoded on the calling thread
+// when jobs is null. BC7 only uses mode 6, one subset with 4 bit indices.
+bool compressMipChain(const MipChain &src, TextureFormat format,
+                      MipChain &out, jobs::JobSystem *jobs = nullptr);
+
+} // namespace engine::assets
@@ -0,0 +1,259 @@
+#include "engine/assets/gltf/gltf_accessors.hpp"
+
+#include <array>
+#include <cgltf.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define QUARK_GLTF_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define QUARK_GLTF_NEON 1
+#endif
+
+namespace engine::assets {
+
+namespace {
+
+template <int V> using Int = std::integral_constant<int, V>;
+
+// First byte of element 0, null when cgltf has to decode (sparse, no view,
+// buffers not loaded)
+const std::byte *accessorBytes(const cgltf_accessor *acc) {
+  if (acc->is_sparse != 0 || acc->buffer_view == nullptr) {
+    return nullptr;
+  }
+
+  const cgltf_buffer_view *view = acc->buffer_view;
+  if (view->data != nullptr) {
+    // Decompressed by an extension
+    return static_cast<const std::byte *>(view->data) + acc->offset;
+  }
+  if (view->buffer == nullptr || view->buffer->data == nullptr) {
+    return nullptr;
+  }
+  return static_cast<const std::byte *>(view->buffer->data) + view->offset +
+         acc->offset;
+}
+
+// Element shapes the loader reads, n components in and keep floats out
+template <typename F> bool dispatchShape(int n, int keep, F &&body) {
+  switch ((n * 8) + keep) {
+  case (2 * 8) + 2:
+    body(Int<2>{}, Int<2>{});
+    return true;
+  case (3 * 8) + 3:
+    body(Int<3>{}, Int<3>{});
+    return true;
+  case (4 * 8) + 3:
+    body(Int<4>{}, Int<3>{});
+    return true;
+  case (4 * 8) + 4:
+    body(Int<4>{}, Int<4>{});
+    return true;
+  default:
+    return false;
+  }
+}
+
+template <int N, int Keep>
+void copyFloats(const std::byte *src, size_t srcStride, size_t count,
+                std::byte *dst, size_t dstStride) {
+  if (N == Keep && srcStride == dstStride && srcStride == Keep * 4) {
+    std::memcpy(dst, src, count * srcStride);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    std::memcpy(dst + (i * dstStride), src + (i * srcStride),
+                sizeof(float) * Keep);
+  }
+}
+
+// Matches cgltf: c / 255 and c / 65535, so results are bit identical
+inline void unorm4(const std::array<uint8_t, 4> &in, float *out) {
+#if defined(QUARK_GLTF_SSE)
+  int32_t packed = 0;
+  std::memcpy(&packed, in.data(), sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wide = _mm_unpacklo_epi16(
+      _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+  _mm_storeu_ps(out,
+                _mm_div_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(255.0F)));
+#elif defined(QUARK_GLTF_NEON)
+  uint32_t packed = 0;
+  std::memcpy(&packed, in.data(), sizeof(packed));
+  const uint32x4_t wide =
+      vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(packed))));
+  vst1q_f32(out, vdivq_f32(vcvtq_f32_u32(wide), vdupq_n_f32(255.0F)));
+#else
+  for (size_t c = 0; c < 4; ++c) {
+    out[c] = float(in[c]) / 255.0F;
+  }
+#endif
+}
+
+inline void unorm4(const std::array<uint16_t, 4> &in, float *out) {
+#if defined(QUARK_GLTF_SSE)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wide = _mm_unpacklo_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in.data())), zero);
+  _mm_storeu_ps(out,
+                _mm_div_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(65535.0F)));
+#elif defined(QUARK_GLTF_NEON)
+  const uint32x4_t wide = vmovl_u16(vld1_u16(in.data()));
+  vst1q_f32(out, vdivq_f32(vcvtq_f32_u32(wide), vdupq_n_f32(65535.0F)));
+#else
+  for (size_t c = 0; c < 4; ++c) {
+    out[c] = float(in[c]) / 65535.0F;
+  }
+#endif
+}
+
+template <typename T, int N, int Keep>
+void unormToFloats(const std::byte *src, size_t srcStride, size_t count,
+                   std::byte *dst, size_t dstStride) {
+  std::array<T, 4> raw{};
+  std::array<float, 4> out{};
+  for (size_t i = 0; i < count; ++i) {
+    // Only N components, the last element may end the buffer
+    std::memcpy(raw.data(), src + (i * srcStride), sizeof(T) * N);
+    unorm4(raw, out.data());
+    std::memcpy(dst + (i * dstStride), out.data(), sizeof(float) * Keep);
+  }
+}
+
+bool readFast(const cgltf_accessor *acc, int n, int keep, size_t first,
+              size_t count, float *dst, size_t strideBytes) {
+  const std::byte *base = accessorBytes(acc);
+  if (base == nullptr || cgltf_num_components(acc->type) != size_t(n)) {
+    return false;
+  }
+
+  const size_t srcStride = acc->stride;
+  const std::byte *src = base + (first * srcStride);
+  auto *out = reinterpret_cast<std::byte *>(dst);
+
+  switch (acc->component_type) {
+  case cgltf_component_type_r_32f:
+    return dispatchShape(n, keep, [&](auto vn, auto vkeep) {
+      copyFloats<decltype(vn)::value, decltype(vkeep)::value>(
+          src, srcStride, count, out, strideBytes);
+    });
+  case cgltf_component_type_r_8u:
+    if (acc->normalized == 0) {
+      return false;
+    }
+    return dispatchShape(n, keep, [&](auto vn, auto vkeep) {
+      unormToFloats<uint8_t, decltype(vn)::value, decltype(vkeep)::value>(
+          src, srcStride, count, out, strideBytes);
+    });
+  case cgltf_component_type_r_16u:
+    if (acc->normalized == 0) {
+      return false;
+    }
+    return dispatchShape(n, keep, [&](auto vn, auto vkeep) {
+      unormToFloats<uint16_t, decltype(vn)::value, decltype(vkeep)::value>(
+          src, srcStride, count, out, strideBytes);
+    });
+  default:
+    return false;
+  }
+}
+
+// Tightly packed u16 to u32
+void widenU16(const std::byte *src, size_t count, uint32_t *dst) {
+  size_t i = 0;
+#if defined(QUARK_GLTF_SSE)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= count; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (i * 2)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_unpacklo_epi16(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4),
+                     _mm_unpackhi_epi16(v, zero));
+  }
+#elif defined(QUARK_GLTF_NEON)
+  for (; i + 8 <= count; i += 8) {
+    uint16x8_t v;
+    std::memcpy(&v, src + (i * 2), sizeof(v));
+    vst1q_u32(dst + i, vmovl_u16(vget_low_u16(v)));
+    vst1q_u32(dst + i + 4, vmovl_u16(vget_high_u16(v)));
+  }
+#endif
+  for (; i < count; ++i) {
+    uint16_t v = 0;
+    std::memcpy(&v, src + (i * 2), sizeof(v));
+    dst[i] = v;
+  }
+}
+
+} // namespace
+
+void readVecN(const cgltf_accessor *acc, int n, std::vector<float> &out) {
+  out.resize(static_cast<size_t>(acc->count) * static_cast<size_t>(n));
+  readVecN(acc, n, n, 0, static_cast<size_t>(acc->count), out.data(),
+           sizeof(float) * static_cast<size_t>(n));
+}
+
+void readVecN(const cgltf_accessor *acc, int n, int keep, size_t first,
+              size_t count, float *dst, size_t strideBytes) {
+  if (readFast(acc, n, keep, first, count, dst, strideBytes)) {
+    return;
+  }
+
+  // Sparse, signed or unusual shapes: cgltf per element
+  auto *bytes = reinterpret_cast<std::byte *>(dst);
+  std::array<float, 16> element{};
+  for (size_t i = 0; i < count; ++i) {
+    cgltf_accessor_read_float(acc, first + i, element.data(),
+                              static_cast<cgltf_size>(n));
+    std::memcpy(bytes + (i * strideBytes), element.data(),
+                sizeof(float) * static_cast<size_t>(keep));
+  }
+}
+
+void readIndices(const cgltf_accessor *acc, size_t first, size_t count,
+                 uint32_t *dst) {
+  const std::byte *base = accessorBytes(acc);
+  const size_t stride = acc->stride;
+  if (base != nullptr) {
+    const std::byte *src = base + (first * stride);
+
+    switch (acc->component_type) {
+    case cgltf_component_type_r_32u:
+      if (stride == sizeof(uint32_t)) {
+        std::memcpy(dst, src, count * sizeof(uint32_t));
+        return;
+      }
+      break;
+    case cgltf_component_type_r_16u:
+      if (stride == sizeof(uint16_t)) {
+        widenU16(src, count, dst);
+        return;
+      }
+      break;
+    case cgltf_component_type_r_8u:
+      if (stride == sizeof(uint8_t)) {
+        for (size_t i = 0; i < count; ++i) {
+          dst[i] = static_cast<uint32_t>(src[i]);
+        }
+        return;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = static_cast<uint32_t>(cgltf_accessor_read_index(acc, first + i));
+  }
+}
+
+} // namespace engine::assets
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct cgltf_accessor;
+
+namespace engine::assets {
+
+// Every element of acc as n floats, normalized integers come out in [0, 1]
+void readVecN(const cgltf_accessor *acc, int n, std::vector<float> &out);
+
+// Elements [first, first + count) read as n floats, the first keep of each
+// written to dst with strideBytes between elements. Interleaves straight
+// into vertex structs, disjoint ranges may be read from several threads.
+// Float and normalized u8/u16 data is converted in bulk, anything else
+// (sparse, signed) goes through cgltf per element.
+void readVecN(const cgltf_accessor *acc, int n, int keep, size_t first,
+              size_t count, float *dst, size_t strideBytes);
+
+// Indices [first, first + count) widened to u32, dst is element first
+void readIndices(const cgltf_accessor *acc, size_t first, size_t count,
+                 uint32_t *dst);
+
+} // namespace engine::assets
@@ -25,8 +25,25 @@ bool loadGltf(Renderer &renderer, const std::string &path, GltfAsset &out,
 
   out.drawItems = std::move(gpu.drawItems);
   out.root = glm::mat4(1.0F);
+  out.textures = std::move(gpu.textures);
+  for (const MeshHandle mesh : gpu.primitiveMeshes) {
+    if (mesh.id != UINT32_MAX) {
+      out.meshes.push_back(mesh);
+    }
+  }
 
   return !out.drawItems.empty();
 }
 
+void releaseGltf(Renderer &renderer, GltfAsset &asset) {
+  for (const MeshHandle mesh : asset.meshes) {
+    renderer.releaseMesh(mesh);
+  }
+  for (const TextureHandle texture : asset.textures) {
+    renderer.releaseTexture(texture);
+  }
+
+  asset = {};
+}
+
 } // namespace engine::assets
@@ -11,9 +11,15 @@ namespace engine::assets {
 struct GltfAsset {
   std::vector<DrawItem> drawItems;
   glm::mat4 root = glm::mat4(1.0F);
+
+  // References held by the asset, dropped by releaseGltf()
+  std::vector<MeshHandle> meshes;
+  std::vector<TextureHandle> textures;
 };
 
 bool loadGltf(Renderer &renderer, const std::string &path, GltfAsset &out,
               const GltfLoadOptions &options = {});
+// Meshes and textures shared with other assets stay alive
+void releaseGltf(Renderer &renderer, GltfAsset &asset);
 
 } // namespace engine::assets
@@ -1,5 +1,11 @@
 #include "gltf_cpu_loader.hpp"
 
+#include "engine/assets/gltf/gltf_accessors.hpp"
+#include "engine/assets/io/mapped_file.hpp"
+#include "engine/jobs/job_system.hpp"
+#include "engine/mesh/vertex.hpp"
+
+#include <algorithm>
 #include <cgltf.h>
 #include <cstddef>
 #include <cstdint>
@@ -23,6 +29,9 @@ namespace engine::assets {
 
 struct CgltfDoc {
   cgltf_data *data = nullptr;
+  // Files cgltf reads through mapFile, buffers point into them
+  std::vector<MappedFile> mappings;
+
   ~CgltfDoc() {
     if (data != nullptr) {
       cgltf_free(data);
@@ -32,23 +41,49 @@ struct CgltfDoc {
   CgltfDoc() = default;
   CgltfDoc(const CgltfDoc &) = delete;
   CgltfDoc &operator=(const CgltfDoc &) = delete;
-  CgltfDoc(CgltfDoc &&other) noexcept : data(other.data) {
-    other.data = nullptr;
-  }
+  CgltfDoc(CgltfDoc &&other) noexcept
+      : data(std::exchange(other.data, nullptr)),
+        mappings(std::move(other.mappings)) {}
   CgltfDoc &operator=(CgltfDoc &&other) noexcept {
     if (this != &other) {
       if (data != nullptr) {
         cgltf_free(data);
       }
 
-      data = other.data;
-      other.data = nullptr;
+      data = std::exchange(other.data, nullptr);
+      mappings = std::move(other.mappings);
     }
 
     return *this;
   }
 };
 
+// cgltf file callbacks: .glb/.gltf/.bin are mapped instead of read into the
+// heap, so accessors decode straight from the page cache
+static cgltf_result mapFile(const cgltf_memory_options * /*memory*/,
+                            const cgltf_file_options *file, const char *path,
+                            cgltf_size *size, void **data) {
+  auto *mappings = static_cast<std::vector<MappedFile> *>(file->user_data);
+
+  MappedFile mapped;
+  if (!mapped.open(path)) {
+    return cgltf_result_file_not_found;
+  }
+
+  *size = mapped.size();
+  // cgltf never writes through file data
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  *data = const_cast<uint8_t *>(mapped.data());
+  mappings->push_back(std::move(mapped));
+  return cgltf_result_success;
+}
+
+static void keepMapped(const cgltf_memory_options * /*memory*/,
+                       const cgltf_file_options * /*file*/, void * /*data*/,
+                       cgltf_size /*size*/) {
+  // Unmapped with the doc, after cgltf_free
+}
+
 static glm::mat4 nodeLocalMatrix(const cgltf_node *node) {
   // If matrix is present, cgltf stores it as column major float[16]
   if (node->has_matrix != 0) {
@@ -94,14 +129,6 @@ static glm::mat4 axisFixup(const GltfAxisOptions &axis) {
   return m;
 }
 
-static void readVecN(const cgltf_accessor *acc, int n,
-                     std::vector<float> &out) {
-  out.resize(static_cast<size_t>(acc->count) * static_cast<size_t>(n));
-  for (cgltf_size i = 0; i < acc->count; ++i) {
-    cgltf_accessor_read_float(acc, i, &out[static_cast<size_t>(i) * n], n);
-  }
-}
-
 static std::string baseColorUri(const cgltf_material *material) {
   if (material == nullptr) {
     return {};
@@ -137,8 +164,14 @@ static glm::vec4 baseColorFactor(const cgltf_material *material) {
           pbr.base_color_factor[2], pbr.base_color_factor[3]};
 }
 
-static bool parseCgltfFile(const std::string &path, CgltfDoc &outDoc) {
+static bool parseCgltfFile(const std::string &path, bool mapFiles,
+                           CgltfDoc &outDoc) {
   cgltf_options options{};
+  if (mapFiles) {
+    options.file.read = mapFile;
+    options.file.release = keepMapped;
+    options.file.user_data = &outDoc.mappings;
+  }
   cgltf_data *data = nullptr;
 
   cgltf_result res = cgltf_parse_file(&options, path.c_str(), &data);
@@ -181,17 +214,38 @@ static void loadMaterials(const cgltf_data *data, GltfSceneCpu &out,
     GltfMaterialCpu m{};
     m.baseColorTextureUri = baseColorUri(mat);
     m.baseColorFactor = baseColorFactor(mat);
+    m.alphaMask = mat->alpha_mode == cgltf_alpha_mode_mask;
+    m.alphaCutoff = mat->alpha_cutoff;
+    m.doubleSided = mat->double_sided != 0;
 
     out.materials.push_back(m);
     materialMap[mat] = outIdx;
   }
 }
 
-static void loadTrianglePrimitives(const cgltf_primitive *primitive,
-                                   const MaterialMap &materialMap,
-                                   const GltfLoadOptions &options,
-                                   GltfSceneCpu &out,
-                                   PrimitiveMap &primitiveMap) {
+// Decode work items are at most this many vertices or indices, so one
+// huge primitive still spreads across threads
+static constexpr size_t kDecodeChunk = 16 * 1024;
+
+// A triangle primitive that passed validation, one per output primitive
+struct PrimitiveSource {
+  const cgltf_accessor *pos = nullptr;
+  const cgltf_accessor *uv = nullptr; // vec2 or null
+  const cgltf_accessor *col = nullptr;
+  int colN = 0; // 3 or 4 when col is set
+  const cgltf_accessor *indices = nullptr;
+};
+
+struct DecodeRange {
+  uint32_t primitive = 0;
+  bool indices = false; // vertices otherwise
+  size_t first = 0;
+  size_t count = 0;
+};
+
+static bool resolveTrianglePrimitive(const cgltf_primitive *primitive,
+                                     const GltfLoadOptions &options,
+                                     PrimitiveSource &src) {
   const cgltf_accessor *posAcc = nullptr;
   const cgltf_accessor *uvAcc = nullptr;
   const cgltf_accessor *colAcc = nullptr;
@@ -215,106 +269,63 @@ static void loadTrianglePrimitives(const cgltf_primitive *primitive,
 
   if (posAcc == nullptr) {
     std::cerr << "[gltf] primitive missing POSITION\n";
-    return;
+    return false;
   }
 
   if (options.requireTexcoord0 && uvAcc == nullptr) {
     std::cerr << "[gltf] primitive mising TEXCOORD_0\n";
-    return;
+    return false;
   }
 
-  // Read arrays
-  std::vector<float> posF;
-  std::vector<float> uvF;
-  std::vector<float> colF;
-  readVecN(posAcc, 3, posF);
+  src = {};
+  src.pos = posAcc;
+  src.indices = primitive->indices;
 
   if (uvAcc != nullptr) {
     if (uvAcc->type != cgltf_type_vec2) {
       std::cerr << "[gltf] TEXCOORD_0 not vec2; ignoring\n";
     } else {
-      readVecN(uvAcc, 2, uvF);
+      src.uv = uvAcc;
     }
   }
 
-  // gLTF COLOR_0 can be vec3 or vec4
-  int colN = 0;
+  // gLTF COLOR_0 can be vec3 or vec4, anything else is ignored
   if (colAcc != nullptr) {
     if (colAcc->type == cgltf_type_vec3) {
-      colN = 3;
+      src.colN = 3;
     } else if (colAcc->type == cgltf_type_vec4) {
-      colN = 4;
-    } else {
-      colN = 0; // ignore unsupported
+      src.colN = 4;
     }
-
-    if (colN != 0) {
-      readVecN(colAcc, colN, colF);
+    if (src.colN != 0) {
+      src.col = colAcc;
     }
   }
 
-  const std::uint32_t vertexCount = static_cast<std::uint32_t>(posAcc->count);
-  engine::MeshData meshData;
-  meshData.vertices.resize(vertexCount);
-
-  for (std::uint32_t vertexIdx = 0; vertexIdx < vertexCount; ++vertexIdx) {
-    engine::Vertex vert{};
-
-    vert.pos = {posF[(vertexIdx * 3) + 0], posF[(vertexIdx * 3) + 1],
-                posF[(vertexIdx * 3) + 2]};
-
-    // Default color
-    vert.color = {1.0F, 1.0F, 1.0F};
-    if (!colF.empty()) {
-      if (colN == 3) {
-        vert.color = {colF[(vertexIdx * 3) + 0], colF[(vertexIdx * 3) + 1],
-                      colF[(vertexIdx * 3) + 2]};
-      }
-
-      if (colN == 4) {
-        vert.color = {colF[(vertexIdx * 4) + 0], colF[(vertexIdx * 4) + 1],
-                      colF[(vertexIdx * 4) + 2]};
-      }
-    }
-
-    // Default UV
-    vert.uv = {0.0F, 0.0F};
-    if (!uvF.empty()) {
-      float u = uvF[(vertexIdx * 2) + 0];
-      float vv = uvF[(vertexIdx * 2) + 1];
-      if (options.flipTexcoordV) {
-        vv = 1.0F - vv;
-      }
+  return true;
+}
 
-      vert.uv = {u, vv};
-    }
+// Fields without an accessor keep the Vertex defaults
+static void decodeVertices(const PrimitiveSource &src,
+                           const GltfLoadOptions &options, size_t first,
+                           size_t count, engine::Vertex *vertices) {
+  engine::Vertex *v = vertices + first;
 
-    meshData.vertices[vertexIdx] = vert;
-  }
+  readVecN(src.pos, 3, 3, first, count, &v->pos.x, sizeof(engine::Vertex));
 
-  if (primitive->indices != nullptr) {
-    meshData.indices.resize(static_cast<size_t>(primitive->indices->count));
-    for (cgltf_size indexIndex = 0; indexIndex < primitive->indices->count;
-         ++indexIndex) {
-      meshData.indices[static_cast<size_t>(indexIndex)] =
-          static_cast<std::uint32_t>(
-              cgltf_accessor_read_index(primitive->indices, indexIndex));
-    }
+  if (src.col != nullptr) {
+    // Alpha is dropped
+    readVecN(src.col, src.colN, 3, first, count, &v->color.x,
+             sizeof(engine::Vertex));
   }
 
-  std::uint32_t matIdx = UINT32_MAX;
-  if (primitive->material != nullptr) {
-    auto it = materialMap.find(primitive->material);
-    if (it != materialMap.end()) {
-      matIdx = it->second;
+  if (src.uv != nullptr) {
+    readVecN(src.uv, 2, 2, first, count, &v->uv.x, sizeof(engine::Vertex));
+    if (options.flipTexcoordV) {
+      for (size_t i = 0; i < count; ++i) {
+        v[i].uv.y = 1.0F - v[i].uv.y;
+      }
     }
   }
-
-  const std::uint32_t primIdx =
-      static_cast<std::uint32_t>(out.primitives.size());
-  out.primitives.push_back(
-      GltfPrimitiveCpu{.mesh = std::move(meshData), .materialIndex = matIdx});
-  primitiveMap[primitive] = primIdx;
 }
 
 static void loadPrimitives(const cgltf_data *data,
@@ -323,6 +334,9 @@ static void loadPrimitives(const cgltf_data *data,
                            PrimitiveMap &primitiveMap) {
   out.primitives.clear();
 
+  // Validate and size everything up front, in file order, so indices and
+  // the primitive map come out the same however the decode is scheduled
+  std::vector<PrimitiveSource> sources;
   // TODO: cache by material index
   for (cgltf_size meshIndex = 0; meshIndex < data->meshes_count; ++meshIndex) {
     const cgltf_mesh *mesh = &data->meshes[meshIndex];
@@ -335,10 +349,69 @@ static void loadPrimitives(const cgltf_data *data,
         continue;
       }
 
-      loadTrianglePrimitives(primitive, materialMap, options, out,
-                             primitiveMap);
+      PrimitiveSource src;
+      if (!resolveTrianglePrimitive(primitive, options, src)) {
+        continue;
+      }
+
+      std::uint32_t matIdx = UINT32_MAX;
+      if (primitive->material != nullptr) {
+        auto it = materialMap.find(primitive->material);
+        if (it != materialMap.end()) {
+          matIdx = it->second;
+        }
+      }
+
+      primitiveMap[primitive] = static_cast<std::uint32_t>(sources.size());
+      sources.push_back(src);
+      out.primitives.push_back(GltfPrimitiveCpu{.materialIndex = matIdx});
     }
   }
+
+  std::vector<DecodeRange> ranges;
+  for (uint32_t i = 0; i < sources.size(); ++i) {
+    const PrimitiveSource &src = sources[i];
+    engine::MeshData &mesh = out.primitives[i].mesh;
+
+    const auto vertexCount = static_cast<size_t>(src.pos->count);
+    mesh.vertices.resize(vertexCount);
+    for (size_t first = 0; first < vertexCount; first += kDecodeChunk) {
+      ranges.push_back(
+          {i, false, first, std::min(kDecodeChunk, vertexCount - first)});
+    }
+
+    if (src.indices != nullptr) {
+      const auto indexCount = static_cast<size_t>(src.indices->count);
+      mesh.indices.resize(indexCount);
+      for (size_t first = 0; first < indexCount; first += kDecodeChunk) {
+        ranges.push_back(
+            {i, true, first, std::min(kDecodeChunk, indexCount - first)});
+      }
+    }
+  }
+
+  // Every range writes its own slice of a preallocated mesh
+  auto decode = [&](uint32_t begin, uint32_t end) {
+    for (uint32_t r = begin; r < end; ++r) {
+      const DecodeRange &range = ranges[r];
+      const PrimitiveSource &src = sources[range.primitive];
+      engine::MeshData &mesh = out.primitives[range.primitive].mesh;
+      if (range.indices) {
+        readIndices(src.indices, range.first, range.count,
+                    mesh.indices.data() + range.first);
+      } else {
+        decodeVertices(src, options, range.first, range.count,
+                       mesh.vertices.data());
+      }
+    }
+  };
+
+  const auto rangeCount = static_cast<uint32_t>(ranges.size());
+  if (options.jobs != nullptr) {
+    options.jobs->parallelFor("DecodeGltfPrimitives", rangeCount, decode);
+  } else {
+    decode(0, rangeCount);
+  }
 }
 
 static void buildNodes(const cgltf_data *data, const glm::mat4 &fix,
@@ -399,7 +472,7 @@ bool loadGltfCpu(const std::string &path, GltfSceneCpu &out,
   out = {};
 
   CgltfDoc doc{};
-  if (!parseCgltfFile(path, doc)) {
+  if (!parseCgltfFile(path, options.mapFiles, doc)) {
     return false;
   }
 
@@ -6,65 +6,66 @@
 
 #include <cstdint>
 #include <glm/ext/vector_float4.hpp>
-#include <iostream>
 #include <string>
+#include <vector>
 
 namespace engine::assets {
 
+uint32_t createGltfMaterial(Renderer &renderer, const std::string &gltfPath,
+                            const GltfMaterialCpu &m,
+                            std::vector<TextureHandle> &textures,
+                            const GltfBuildOptions &options) {
+  uint32_t matId = UINT32_MAX;
+
+  if (!m.baseColorTextureUri.empty()) {
+    const std::string texPath =
+        resolveUriRelativeToFile(gltfPath, m.baseColorTextureUri);
+
+    // Shared with other materials and assets using the same file or
+    // texels. Decoded on worker threads, materials show the default
+    // texture until it is uploaded.
+    const TextureHandle texHandle =
+        renderer.acquireTexture(texPath, options.flipTextureY);
+
+    if (texHandle.id != UINT32_MAX) {
+      textures.push_back(texHandle);
+      matId = renderer.createMaterialFromTexture(texHandle);
+    }
+  } else {
+    matId = renderer.createMaterialFromBaseColorFactor(m.baseColorFactor);
+  }
+
+  // set factor (texture * factor), alpha mode and sidedness
+  if (matId != UINT32_MAX) {
+    MaterialGPU gpu{};
+    gpu.baseColorFactor = m.baseColorFactor;
+    gpu.mrAoAlpha.w = m.alphaCutoff;
+    gpu.flags.x = (m.alphaMask ? MaterialGPU::kFlagAlphaMask : 0U) |
+                  (m.doubleSided ? MaterialGPU::kFlagDoubleSided : 0U);
+    (void)renderer.updateMaterialGPU(matId, gpu);
+  }
+
+  return matId;
+}
+
 bool buildGltfSceneGpu(Renderer &renderer, const std::string &gltfPath,
                        const GltfSceneCpu &cpu, GltfSceneGpu &outGpu,
                        const GltfBuildOptions &options) {
   outGpu = {};
   outGpu.materialIds.resize(cpu.materials.size(), UINT32_MAX);
 
-  // TODO: cache textures by resolved path
-  std::unordered_map<std::string, TextureHandle> texCache;
-
   for (size_t materialIdx = 0; materialIdx < cpu.materials.size();
        ++materialIdx) {
-    const auto &m = cpu.materials[materialIdx];
-
-    uint32_t matId = UINT32_MAX;
-
-    if (!m.baseColorTextureUri.empty()) {
-      const std::string texPath =
-          resolveUriRelativeToFile(gltfPath, m.baseColorTextureUri);
-
-      std::cout << "baseColorTextureUri found\n";
-
-      TextureHandle texHandle{UINT32_MAX};
-      if (auto item = texCache.find(texPath); item != texCache.end()) {
-        texHandle = item->second;
-      } else {
-        texHandle =
-            renderer.createTextureFromFile(texPath, options.flipTextureY);
-        if (texHandle.id != UINT32_MAX) {
-          texCache.emplace(texPath, texHandle);
-        }
-      }
-
-      if (texHandle.id != UINT32_MAX) {
-        matId = renderer.createMaterialFromTexture(texHandle);
-
-        // set factor (texture * factor)
-        if (matId != UINT32_MAX) {
-          MaterialGPU gpu{};
-          gpu.baseColorFactor = m.baseColorFactor;
-          (void)renderer.updateMaterialGPU(matId, gpu);
-        }
-      }
-    } else {
-      matId = renderer.createMaterialFromBaseColorFactor(m.baseColorFactor);
-    }
-
-    outGpu.materialIds[materialIdx] = matId;
+    outGpu.materialIds[materialIdx] = createGltfMaterial(
+        renderer, gltfPath, cpu.materials[materialIdx], outGpu.textures,
+        options);
   }
 
   outGpu.primitiveMeshes.resize(cpu.primitives.size());
   for (size_t primitiveIdx = 0; primitiveIdx < cpu.primitives.size();
        ++primitiveIdx) {
     outGpu.primitiveMeshes[primitiveIdx] =
-        renderer.createMesh(cpu.primitives[primitiveIdx].mesh);
+        renderer.acquireMesh(cpu.primitives[primitiveIdx].mesh);
   }
 
   outGpu.drawItems.reserve(cpu.nodes.size());
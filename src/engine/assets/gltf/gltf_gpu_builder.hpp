@@ -10,6 +10,9 @@ struct GltfSceneGpu {
       primitiveMeshes;               // index = GltfSceneCpu::primitives index
   std::vector<uint32_t> materialIds; // index = GltfSceneCpu::materials index
   std::vector<DrawItem> drawItems;   // one per node primitive instance
+
+  // One acquired reference each, primitiveMeshes hold one too
+  std::vector<TextureHandle> textures;
 };
 
 struct GltfBuildOptions {
@@ -17,6 +20,13 @@ struct GltfBuildOptions {
   bool preferTextureOverFactor = true;
 };
 
+// Material id or UINT32_MAX, an acquired base color texture is appended
+// to textures
+uint32_t createGltfMaterial(Renderer &renderer, const std::string &gltfPath,
+                            const GltfMaterialCpu &material,
+                            std::vector<TextureHandle> &textures,
+                            const GltfBuildOptions &options = {});
+
 bool buildGltfSceneGpu(Renderer &renderer, const std::string &gltfPath,
                        const engine::assets::GltfSceneCpu &cpu,
                        GltfSceneGpu &outGpu,
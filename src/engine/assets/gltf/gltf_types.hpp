@@ -7,6 +7,10 @@
 #include <string>
 #include <vector>
 
+namespace engine::jobs {
+class JobSystem;
+} // namespace engine::jobs
+
 namespace engine::assets {
 
 struct GltfMaterialCpu {
@@ -15,6 +19,11 @@ struct GltfMaterialCpu {
 
   // gLTF baseColorFactor in (RGBA)
   glm::vec4 baseColorFactor{1.0F, 1.0F, 1.0F, 1.0F};
+
+  // alphaMode MASK, BLEND is drawn opaque for now
+  bool alphaMask = false;
+  float alphaCutoff = 0.5F;
+  bool doubleSided = false;
 };
 
 struct GltfPrimitiveCpu {
@@ -45,8 +54,13 @@ struct GltfAxisOptions {
 struct GltfLoadOptions {
   bool flipTexcoordV = true;
   bool requireTexcoord0 = false;
+  // mmap the .glb and .bin files instead of reading them into the heap
+  bool mapFiles = true;
 
   GltfAxisOptions axis{};
+
+  // Decodes primitives across the pool when set, serially otherwise
+  engine::jobs::JobSystem *jobs = nullptr; // non-owning
 };
 
 } // namespace engine::assets
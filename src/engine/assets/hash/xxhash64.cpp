@@ -0,0 +1,108 @@
+#include "engine/assets/hash/xxhash64.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t read64(const uint8_t *p) noexcept {
+  uint64_t v = 0;
+  std::memcpy(&v, p, sizeof(v));
+  if constexpr (std::endian::native == std::endian::big) {
+    v = std::byteswap(v);
+  }
+  return v;
+}
+
+uint32_t read32(const uint8_t *p) noexcept {
+  uint32_t v = 0;
+  std::memcpy(&v, p, sizeof(v));
+  if constexpr (std::endian::native == std::endian::big) {
+    v = std::byteswap(v);
+  }
+  return v;
+}
+
+uint64_t xxRound(uint64_t acc, uint64_t input) noexcept {
+  acc += input * kPrime2;
+  acc = std::rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+uint64_t mergeRound(uint64_t acc, uint64_t val) noexcept {
+  acc ^= xxRound(0, val);
+  return (acc * kPrime1) + kPrime4;
+}
+
+} // namespace
+
+uint64_t xxhash64(const void *data, size_t size, uint64_t seed) noexcept {
+  const auto *p = static_cast<const uint8_t *>(data);
+  const uint8_t *const end = p + size;
+  uint64_t h = 0;
+
+  if (size >= 32) {
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+
+    const uint8_t *const limit = end - 32;
+    do {
+      v1 = xxRound(v1, read64(p));
+      v2 = xxRound(v2, read64(p + 8));
+      v3 = xxRound(v3, read64(p + 16));
+      v4 = xxRound(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) +
+        std::rotl(v4, 18);
+    h = mergeRound(h, v1);
+    h = mergeRound(h, v2);
+    h = mergeRound(h, v3);
+    h = mergeRound(h, v4);
+  } else {
+    h = seed + kPrime5;
+  }
+
+  h += static_cast<uint64_t>(size);
+
+  while (p + 8 <= end) {
+    h ^= xxRound(0, read64(p));
+    h = (std::rotl(h, 27) * kPrime1) + kPrime4;
+    p += 8;
+  }
+
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+    h = (std::rotl(h, 23) * kPrime2) + kPrime3;
+    p += 4;
+  }
+
+  while (p < end) {
+    h ^= static_cast<uint64_t>(*p) * kPrime5;
+    h = std::rotl(h, 11) * kPrime1;
+    ++p;
+  }
+
+  h ^= h >> 33U;
+  h *= kPrime2;
+  h ^= h >> 29U;
+  h *= kPrime3;
+  h ^= h >> 32U;
+
+  return h;
+}
+
+} // namespace engine::assets
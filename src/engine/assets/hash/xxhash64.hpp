@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine::assets {
+
+// XXH64, bit compatible with the reference implementation. Chain calls by
+// passing the previous result as the seed.
+uint64_t xxhash64(const void *data, size_t size, uint64_t seed = 0) noexcept;
+
+} // namespace engine::assets
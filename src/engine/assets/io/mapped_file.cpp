@@ -0,0 +1,130 @@
+#include "engine/assets/io/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine::assets {
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string &path) {
+  close();
+
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    std::cerr << "[MappedFile] Failed to open " << path << "\n";
+    return false;
+  }
+
+  LARGE_INTEGER size{};
+  if (GetFileSizeEx(file, &size) == 0 || size.QuadPart <= 0) {
+    std::cerr << "[MappedFile] Empty or unreadable file " << path << "\n";
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    std::cerr << "[MappedFile] CreateFileMapping failed for " << path << "\n";
+    CloseHandle(file);
+    return false;
+  }
+
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    std::cerr << "[MappedFile] MapViewOfFile failed for " << path << "\n";
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  m_file = file;
+  m_mapping = mapping;
+  m_data = static_cast<const uint8_t *>(view);
+  m_size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::close() noexcept {
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+  }
+  if (m_file != nullptr) {
+    CloseHandle(m_file);
+  }
+
+  m_data = nullptr;
+  m_size = 0;
+  m_mapping = nullptr;
+  m_file = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string &path) {
+  close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << "[MappedFile] Failed to open " << path << "\n";
+    return false;
+  }
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    std::cerr << "[MappedFile] Empty or unreadable file " << path << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  const auto size = static_cast<size_t>(st.st_size);
+  void *view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file
+  ::close(fd);
+
+  if (view == MAP_FAILED) {
+    std::cerr << "[MappedFile] mmap failed for " << path << "\n";
+    return false;
+  }
+
+  // Payloads are read front to back once, mostly by the upload memcpy
+  ::madvise(view, size, MADV_SEQUENTIAL);
+  ::madvise(view, size, MADV_WILLNEED);
+
+  m_data = static_cast<const uint8_t *>(view);
+  m_size = size;
+  return true;
+}
+
+void MappedFile::close() noexcept {
+  if (m_data != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<uint8_t *>(m_data), m_size);
+  }
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+#endif
+
+} // namespace engine::assets
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace engine::assets {
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() noexcept { close(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+  MappedFile &operator=(MappedFile &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    close();
+
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0U);
+#if defined(_WIN32)
+    m_file = std::exchange(other.m_file, nullptr);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+
+    return *this;
+  }
+
+  bool open(const std::string &path);
+  void close() noexcept;
+
+  [[nodiscard]] bool valid() const noexcept { return m_data != nullptr; }
+  [[nodiscard]] const uint8_t *data() const noexcept { return m_data; }
+  [[nodiscard]] size_t size() const noexcept { return m_size; }
+
+private:
+  const uint8_t *m_data = nullptr; // owning mapping
+  size_t m_size = 0;
+#if defined(_WIN32)
+  void *m_file = nullptr;    // owning HANDLE
+  void *m_mapping = nullptr; // owning HANDLE
+#endif
+};
+
+} // namespace engine::assets
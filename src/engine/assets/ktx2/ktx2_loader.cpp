@@ -0,0 +1,175 @@
+#include "engine/assets/ktx2/ktx2_loader.hpp"
+
+#include "engine/assets/io/mapped_file.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/texture_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr std::array<uint8_t, 12> kIdentifier = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+// identifier + 9 x u32 header + 4 x u32 / 2 x u64 index
+constexpr size_t kHeaderSize = 80;
+constexpr size_t kLevelIndexEntrySize = 24;
+
+// VkFormat values, the engine side does not include Vulkan
+constexpr uint32_t kVkR8G8B8A8Unorm = 37;
+constexpr uint32_t kVkR8G8B8A8Srgb = 43;
+constexpr uint32_t kVkBC1RGBUnorm = 131;
+constexpr uint32_t kVkBC1RGBSrgb = 132;
+constexpr uint32_t kVkBC3Unorm = 137;
+constexpr uint32_t kVkBC3Srgb = 138;
+constexpr uint32_t kVkBC5Unorm = 141;
+constexpr uint32_t kVkBC7Unorm = 145;
+constexpr uint32_t kVkBC7Srgb = 146;
+
+// KTX2 is little endian regardless of host
+uint32_t readU32(const uint8_t *p) noexcept {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8U) | (uint32_t(p[2]) << 16U) |
+         (uint32_t(p[3]) << 24U);
+}
+
+uint64_t readU64(const uint8_t *p) noexcept {
+  return uint64_t(readU32(p)) | (uint64_t(readU32(p + 4)) << 32U);
+}
+
+bool mapVkFormat(uint32_t vkFormat, TextureFormat &format,
+                 bool &srgb) noexcept {
+  switch (vkFormat) {
+  case kVkR8G8B8A8Unorm:
+  case kVkR8G8B8A8Srgb:
+    format = TextureFormat::RGBA8;
+    srgb = vkFormat == kVkR8G8B8A8Srgb;
+    return true;
+  case kVkBC1RGBUnorm:
+  case kVkBC1RGBSrgb:
+    format = TextureFormat::BC1;
+    srgb = vkFormat == kVkBC1RGBSrgb;
+    return true;
+  case kVkBC3Unorm:
+  case kVkBC3Srgb:
+    format = TextureFormat::BC3;
+    srgb = vkFormat == kVkBC3Srgb;
+    return true;
+  case kVkBC5Unorm:
+    format = TextureFormat::BC5;
+    srgb = false;
+    return true;
+  case kVkBC7Unorm:
+  case kVkBC7Srgb:
+    format = TextureFormat::BC7;
+    srgb = vkFormat == kVkBC7Srgb;
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+bool loadKtx2(const std::string &path, MipChain &out) {
+  out = {};
+
+  MappedFile file;
+  if (!file.open(path)) {
+    return false;
+  }
+
+  const uint8_t *data = file.data();
+  const size_t size = file.size();
+
+  if (size < kHeaderSize ||
+      std::memcmp(data, kIdentifier.data(), kIdentifier.size()) != 0) {
+    std::cerr << "[KTX2] Not a KTX2 file: " << path << "\n";
+    return false;
+  }
+
+  const uint8_t *header = data + kIdentifier.size();
+  const uint32_t vkFormat = readU32(header + 0);
+  const uint32_t width = readU32(header + 8);
+  const uint32_t height = readU32(header + 12);
+  const uint32_t depth = readU32(header + 16);
+  const uint32_t layerCount = readU32(header + 20);
+  const uint32_t faceCount = readU32(header + 24);
+  const uint32_t levelCount = std::max(readU32(header + 28), 1U);
+  const uint32_t supercompression = readU32(header + 32);
+
+  if (width == 0 || height == 0 || depth != 0 || layerCount > 1 ||
+      faceCount != 1) {
+    std::cerr << "[KTX2] Only single 2D images are supported: " << path
+              << "\n";
+    return false;
+  }
+
+  if (supercompression != 0) {
+    std::cerr << "[KTX2] Supercompression scheme " << supercompression
+              << " unsupported: " << path << "\n";
+    return false;
+  }
+
+  TextureFormat format = TextureFormat::RGBA8;
+  bool srgb = false;
+  if (!mapVkFormat(vkFormat, format, srgb)) {
+    std::cerr << "[KTX2] Unsupported vkFormat " << vkFormat << ": " << path
+              << "\n";
+    return false;
+  }
+
+  if (levelCount > mipLevelCount(width, height) ||
+      kHeaderSize + (size_t(levelCount) * kLevelIndexEntrySize) > size) {
+    std::cerr << "[KTX2] Invalid level count " << levelCount << ": " << path
+              << "\n";
+    return false;
+  }
+
+  // Level data is aligned to lcm(block size, 4)
+  const uint64_t alignment = std::lcm(uint64_t(textureBlockBytes(format)), 4U);
+
+  out.levels.resize(levelCount);
+  for (uint32_t level = 0; level < levelCount; ++level) {
+    const uint8_t *entry =
+        data + kHeaderSize + (size_t(level) * kLevelIndexEntrySize);
+    const uint64_t offset = readU64(entry);
+    const uint64_t length = readU64(entry + 8);
+
+    const uint32_t w = std::max(1U, width >> level);
+    const uint32_t h = std::max(1U, height >> level);
+    const size_t expected = textureLevelSize(format, w, h);
+
+    if (length != expected || offset > size || length > size - offset ||
+        offset % alignment != 0) {
+      std::cerr << "[KTX2] Level " << level << " out of bounds or sized "
+                << length << " (expected " << expected << "): " << path
+                << "\n";
+      out = {};
+      return false;
+    }
+
+    MipLevel &mip = out.levels[level];
+    mip.width = w;
+    mip.height = h;
+    mip.offset = static_cast<size_t>(offset);
+    mip.size = expected;
+  }
+
+  out.format = format;
+  out.srgb = srgb;
+  out.mapping = std::make_shared<const MappedFile>(std::move(file));
+  return true;
+}
+
+} // namespace engine::assets
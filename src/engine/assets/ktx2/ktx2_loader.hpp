@@ -0,0 +1,15 @@
+#pragma once
+
+#include "engine/assets/mips/mip_chain.hpp"
+
+#include <string>
+
+namespace engine::assets {
+
+// Map a KTX2 file and describe its levels in place; no pixel data is copied
+// and the chain keeps the mapping alive. Supports 2D, single layer and face,
+// non-supercompressed RGBA8, BC1 (RGB), BC3, BC5 and BC7. A file without
+// mips (levelCount 0) loads as a single level.
+bool loadKtx2(const std::string &path, MipChain &out);
+
+} // namespace engine::assets
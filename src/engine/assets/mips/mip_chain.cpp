@@ -0,0 +1,276 @@
+#include "engine/assets/mips/mip_chain.hpp"
+
+#include "engine/assets/image_data.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define QUARK_MIPS_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define QUARK_MIPS_NEON 1
+#endif
+
+namespace engine {
+
+uint32_t mipLevelCount(uint32_t width, uint32_t height) noexcept {
+  uint32_t dim = std::max(width, height);
+  uint32_t levels = 1;
+
+  while (dim > 1) {
+    dim >>= 1U;
+    ++levels;
+  }
+
+  return levels;
+}
+
+} // namespace engine
+
+namespace engine::assets {
+
+namespace {
+
+// Resolution of the linear -> sRGB encode table
+constexpr uint32_t kEncodeSteps = 4096;
+
+const std::array<float, 256> &srgbToLinearTable() {
+  static const std::array<float, 256> table = [] {
+    std::array<float, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      const float c = static_cast<float>(i) / 255.0F;
+      t[i] = c <= 0.04045F ? c / 12.92F
+                           : std::pow((c + 0.055F) / 1.055F, 2.4F);
+    }
+    return t;
+  }();
+
+  return table;
+}
+
+const std::array<uint8_t, kEncodeSteps> &linearToSrgbTable() {
+  static const std::array<uint8_t, kEncodeSteps> table = [] {
+    std::array<uint8_t, kEncodeSteps> t{};
+    for (uint32_t i = 0; i < kEncodeSteps; ++i) {
+      const float l = static_cast<float>(i) / float(kEncodeSteps - 1);
+      const float c = l <= 0.0031308F
+                          ? l * 12.92F
+                          : (1.055F * std::pow(l, 1.0F / 2.4F)) - 0.055F;
+      t[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0F, 1.0F) *
+                                              255.0F));
+    }
+    return t;
+  }();
+
+  return table;
+}
+
+// RGBA8 -> float RGBA in [0, 1], color linearized when srgb
+void decodeLevel(const uint8_t *src, size_t pixelCount, bool srgb,
+                 float *dst) {
+  const std::array<float, 256> &toLinear = srgbToLinearTable();
+
+  for (size_t i = 0; i < pixelCount; ++i) {
+    const uint8_t *p = src + (i * 4U);
+    float *out = dst + (i * 4U);
+
+    for (uint32_t c = 0; c < 3; ++c) {
+      out[c] = srgb ? toLinear[p[c]] : static_cast<float>(p[c]) / 255.0F;
+    }
+    out[3] = static_cast<float>(p[3]) / 255.0F;
+  }
+}
+
+void encodeLevel(const float *src, size_t pixelCount, bool srgb,
+                 uint8_t *dst) {
+  const std::array<uint8_t, kEncodeSteps> &toSrgb = linearToSrgbTable();
+
+  auto unorm = [](float v) {
+    return static_cast<uint8_t>(std::lround(std::clamp(v, 0.0F, 1.0F) *
+                                            255.0F));
+  };
+
+  for (size_t i = 0; i < pixelCount; ++i) {
+    const float *p = src + (i * 4U);
+    uint8_t *out = dst + (i * 4U);
+
+    for (uint32_t c = 0; c < 3; ++c) {
+      if (srgb) {
+        const float l = std::clamp(p[c], 0.0F, 1.0F);
+        out[c] = toSrgb[static_cast<uint32_t>(
+            std::lround(l * float(kEncodeSteps - 1)))];
+      } else {
+        out[c] = unorm(p[c]);
+      }
+    }
+    out[3] = unorm(p[3]);
+  }
+}
+
+// out = (a + b + c + d) / 4 for one RGBA texel
+inline void average4(const float *a, const float *b, const float *c,
+                     const float *d, float *out) {
+#if defined(QUARK_MIPS_SSE)
+  const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)),
+                                _mm_add_ps(_mm_loadu_ps(c), _mm_loadu_ps(d)));
+  _mm_storeu_ps(out, _mm_mul_ps(sum, _mm_set1_ps(0.25F)));
+#elif defined(QUARK_MIPS_NEON)
+  const float32x4_t sum = vaddq_f32(vaddq_f32(vld1q_f32(a), vld1q_f32(b)),
+                                    vaddq_f32(vld1q_f32(c), vld1q_f32(d)));
+  vst1q_f32(out, vmulq_n_f32(sum, 0.25F));
+#else
+  for (uint32_t ch = 0; ch < 4; ++ch) {
+    out[ch] = (a[ch] + b[ch] + c[ch] + d[ch]) * 0.25F;
+  }
+#endif
+}
+
+// acc += src * w for one RGBA texel
+inline void accumulate(const float *src, float w, float *acc) {
+#if defined(QUARK_MIPS_SSE)
+  _mm_storeu_ps(acc, _mm_add_ps(_mm_loadu_ps(acc),
+                                _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(w))));
+#elif defined(QUARK_MIPS_NEON)
+  vst1q_f32(acc, vmlaq_n_f32(vld1q_f32(acc), vld1q_f32(src), w));
+#else
+  for (uint32_t ch = 0; ch < 4; ++ch) {
+    acc[ch] += src[ch] * w;
+  }
+#endif
+}
+
+// Source texels under one destination texel along an axis
+struct Taps {
+  std::array<uint32_t, 3> index{};
+  std::array<float, 3> weight{};
+  uint32_t count = 0;
+};
+
+// An odd source of 2n+1 texels maps onto n destination texels of 2n+1
+// parts each, every source texel weighted by the area it covers
+Taps axisTaps(uint32_t i, uint32_t srcSize, uint32_t dstSize) {
+  if (srcSize == 1) {
+    return {{0, 0, 0}, {1.0F, 0.0F, 0.0F}, 1};
+  }
+  if (srcSize % 2U == 0) {
+    return {{i * 2U, (i * 2U) + 1U, 0}, {0.5F, 0.5F, 0.0F}, 2};
+  }
+
+  const auto n = static_cast<float>(dstSize);
+  const float inv = 1.0F / ((2.0F * n) + 1.0F);
+  return {{i * 2U, (i * 2U) + 1U, (i * 2U) + 2U},
+          {(n - float(i)) * inv, n * inv, (float(i) + 1.0F) * inv},
+          3};
+}
+
+void downsampleBox(const float *src, uint32_t srcW, uint32_t srcH, float *dst,
+                   uint32_t dstW, uint32_t dstH) {
+  if (srcW % 2U == 0 && srcH % 2U == 0) {
+    for (uint32_t y = 0; y < dstH; ++y) {
+      const float *row0 = src + (size_t(y) * 2U * srcW * 4U);
+      const float *row1 = row0 + (size_t(srcW) * 4U);
+      float *out = dst + (size_t(y) * dstW * 4U);
+
+      for (uint32_t x = 0; x < dstW; ++x) {
+        const size_t x0 = size_t(x) * 8U;
+        average4(row0 + x0, row0 + x0 + 4U, row1 + x0, row1 + x0 + 4U,
+                 out + (size_t(x) * 4U));
+      }
+    }
+    return;
+  }
+
+  // Odd or unit edge: separable 1-3 tap weights, no texel is skipped
+  std::vector<Taps> columns(dstW);
+  for (uint32_t x = 0; x < dstW; ++x) {
+    columns[x] = axisTaps(x, srcW, dstW);
+  }
+
+  for (uint32_t y = 0; y < dstH; ++y) {
+    const Taps rows = axisTaps(y, srcH, dstH);
+    float *out = dst + (size_t(y) * dstW * 4U);
+
+    for (uint32_t x = 0; x < dstW; ++x) {
+      const Taps &cols = columns[x];
+      float *texel = out + (size_t(x) * 4U);
+      std::fill_n(texel, 4, 0.0F);
+
+      for (uint32_t ty = 0; ty < rows.count; ++ty) {
+        const float *row = src + (size_t(rows.index[ty]) * srcW * 4U);
+        for (uint32_t tx = 0; tx < cols.count; ++tx) {
+          accumulate(row + (size_t(cols.index[tx]) * 4U),
+                     rows.weight[ty] * cols.weight[tx], texel);
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+bool buildMipChainRGBA8(const ImageData &img, MipChain &out, bool srgb) {
+  out = {};
+
+  if (!img.valid()) {
+    std::cerr << "[Mips] buildMipChainRGBA8 invalid image\n";
+    return false;
+  }
+
+  const uint32_t count = mipLevelCount(img.width, img.height);
+  out.levels.resize(count);
+  out.format = TextureFormat::RGBA8;
+  out.srgb = srgb;
+
+  size_t total = 0;
+  uint32_t w = img.width;
+  uint32_t h = img.height;
+  for (uint32_t level = 0; level < count; ++level) {
+    out.levels[level].width = w;
+    out.levels[level].height = h;
+    out.levels[level].offset = total;
+    out.levels[level].size = size_t(w) * h * 4U;
+    total += out.levels[level].size;
+
+    w = std::max(1U, w >> 1U);
+    h = std::max(1U, h >> 1U);
+  }
+
+  out.pixels.resize(total);
+  std::memcpy(out.pixels.data(), img.pixels.data(), out.levels[0].size);
+
+  if (count == 1) {
+    return true;
+  }
+
+  // Filter from the float result of the previous level rather than the
+  // quantized bytes so rounding does not accumulate down the chain
+  std::vector<float> prev(size_t(img.width) * img.height * 4U);
+  std::vector<float> next(size_t(out.levels[1].width) * out.levels[1].height *
+                          4U);
+  decodeLevel(img.pixels.data(), size_t(img.width) * img.height, srgb,
+              prev.data());
+
+  for (uint32_t level = 1; level < count; ++level) {
+    const MipLevel &src = out.levels[level - 1];
+    const MipLevel &dst = out.levels[level];
+    const size_t dstPixels = size_t(dst.width) * dst.height;
+
+    downsampleBox(prev.data(), src.width, src.height, next.data(), dst.width,
+                  dst.height);
+    encodeLevel(next.data(), dstPixels, srgb, out.pixels.data() + dst.offset);
+
+    std::swap(prev, next);
+  }
+
+  return true;
+}
+
+} // namespace engine::assets
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "engine/assets/image_data.hpp"
+#include "engine/assets/io/mapped_file.hpp"
+#include "engine/assets/texture_format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+struct MipLevel {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  size_t offset = 0; // byte offset into MipChain::data()
+  size_t size = 0;   // byte size of the level
+};
+
+// Mip chain with level 0 first. Levels live either in pixels or, for
+// containers loaded in place, in a file mapping; level order in memory is
+// whatever the source used.
+struct MipChain {
+  std::vector<MipLevel> levels;
+  std::vector<uint8_t> pixels;
+  std::shared_ptr<const assets::MappedFile> mapping; // used when set
+  TextureFormat format = TextureFormat::RGBA8;
+  bool srgb = true; // color channels are sRGB encoded
+
+  [[nodiscard]] bool valid() const noexcept { return !levels.empty(); }
+  [[nodiscard]] uint32_t levelCount() const noexcept {
+    return static_cast<uint32_t>(levels.size());
+  }
+  [[nodiscard]] const uint8_t *data() const noexcept {
+    return mapping ? mapping->data() : pixels.data();
+  }
+  [[nodiscard]] const uint8_t *levelData(uint32_t level) const noexcept {
+    return data() + levels[level].offset;
+  }
+
+  // Bytes held by levels [baseLevel, levelCount)
+  [[nodiscard]] size_t bytesFrom(uint32_t baseLevel) const noexcept {
+    size_t bytes = 0;
+    for (size_t level = baseLevel; level < levels.size(); ++level) {
+      bytes += levels[level].size;
+    }
+
+    return bytes;
+  }
+};
+
+uint32_t mipLevelCount(uint32_t width, uint32_t height) noexcept;
+
+} // namespace engine
+
+namespace engine::assets {
+
+// Build a full mip chain down to 1x1 with a 2x2 box filter. When srgb is
+// set the color channels are filtered in linear space; alpha always is.
+bool buildMipChainRGBA8(const ImageData &img, MipChain &out, bool srgb = true);
+
+} // namespace engine::assets
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "engine/assets/gltf/gltf_asset.hpp"
+#include "engine/assets/gltf/gltf_types.hpp"
+#include "render/renderer.hpp"
+
+#include <string>
+
+namespace engine::assets {
+
+struct PackageLoadOptions {
+  // Hash every section against the table of contents and each mesh's
+  // stored content hash against its data. Costs a pass over the blobs,
+  // the header and the table are always checked. Without it the stored
+  // mesh hashes are trusted as MeshStore dedup keys.
+  bool verifyHashes = false;
+  bool flipTextureY = true;
+};
+
+// Cook a decoded scene into a package, see scene_package_format.hpp.
+// Texture URIs are stored as is, so the package has to sit next to the
+// glTF it came from.
+bool writeScenePackage(const std::string &path, const GltfSceneCpu &scene);
+
+// Map a package and hand its blobs to the renderer without decoding
+// anything. The result is released with releaseGltf() like a glTF asset.
+bool loadScenePackage(Renderer &renderer, const std::string &path,
+                      GltfAsset &out, const PackageLoadOptions &options = {});
+
+} // namespace engine::assets
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "engine/mesh/vertex.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+namespace engine::assets {
+
+// Cooked scene package (.qpkg), written by quark_cook. Structs are stored
+// as is, little endian, with every section at a kPackageAlignment offset so
+// the vertex and index blobs go from the mapping to staging untouched:
+//
+//   PackageHeader
+//   PackageSection[sectionCount]   table of contents
+//   sections, in any order
+//
+// Any change to these structs or to engine::Vertex bumps kPackageVersion.
+
+constexpr std::array<char, 4> kPackageMagic = {'Q', 'P', 'K', 'G'};
+constexpr uint32_t kPackageVersion = 1;
+constexpr uint64_t kPackageAlignment = 64;
+
+enum class PackageSectionKind : uint32_t {
+  Meshes = 1,    // PackageMesh
+  Materials = 2, // PackageMaterial
+  Nodes = 3,     // PackageNode
+  Vertices = 4,  // engine::Vertex, every mesh back to back
+  Indices = 5,   // uint32_t, every mesh back to back
+  Strings = 6,   // char, not terminated
+};
+
+struct PackageHeader {
+  std::array<char, 4> magic = kPackageMagic;
+  uint32_t version = kPackageVersion;
+  uint32_t vertexSize = sizeof(engine::Vertex);
+  uint32_t sectionCount = 0;
+  uint64_t fileSize = 0;
+  uint64_t tocHash = 0; // xxHash64 of the section table
+};
+
+struct PackageSection {
+  PackageSectionKind kind = PackageSectionKind::Meshes;
+  uint32_t count = 0; // elements
+  uint64_t offset = 0;
+  uint64_t size = 0; // bytes
+  uint64_t hash = 0; // xxHash64 of the section bytes
+};
+
+struct PackageMesh {
+  uint64_t firstVertex = 0;
+  uint64_t firstIndex = 0;
+  uint32_t vertexCount = 0;
+  uint32_t indexCount = 0;
+  uint32_t materialIndex = UINT32_MAX;
+  uint32_t reserved = 0;
+  uint64_t contentHash = 0; // MeshStore::contentHash of the blobs
+};
+
+struct PackageMaterial {
+  static constexpr uint32_t kFlagAlphaMask = 1U << 0U;
+  static constexpr uint32_t kFlagDoubleSided = 1U << 1U;
+
+  std::array<float, 4> baseColorFactor{1.0F, 1.0F, 1.0F, 1.0F};
+  float alphaCutoff = 0.5F;
+  uint32_t flags = 0;
+  // Base color texture URI in the string section, relative to the package
+  uint32_t textureUriOffset = 0;
+  uint32_t textureUriLength = 0;
+};
+
+struct PackageNode {
+  std::array<float, 16> model{}; // column major
+  uint32_t meshIndex = UINT32_MAX;
+  std::array<uint32_t, 3> reserved{};
+};
+
+static_assert(std::endian::native == std::endian::little,
+              "Packages are read in place, big endian hosts need a swap");
+static_assert(sizeof(PackageHeader) == 32);
+static_assert(sizeof(PackageSection) == 32);
+static_assert(sizeof(PackageMesh) == 40);
+static_assert(sizeof(PackageMaterial) == 32);
+static_assert(sizeof(PackageNode) == 80);
+static_assert(std::is_trivially_copyable_v<PackageHeader> &&
+              std::is_trivially_copyable_v<PackageSection> &&
+              std::is_trivially_copyable_v<PackageMesh> &&
+              std::is_trivially_copyable_v<PackageMaterial> &&
+              std::is_trivially_copyable_v<PackageNode> &&
+              std::is_trivially_copyable_v<engine::Vertex>);
+
+} // namespace engine::assets
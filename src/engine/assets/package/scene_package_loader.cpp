@@ -0,0 +1,247 @@
+#include "engine/assets/package/scene_package.hpp"
+
+#include "engine/assets/gltf/gltf_gpu_builder.hpp"
+#include "engine/assets/hash/xxhash64.hpp"
+#include "engine/assets/io/mapped_file.hpp"
+#include "engine/assets/package/scene_package_format.hpp"
+#include "engine/logging/log.hpp"
+#include "engine/mesh/vertex.hpp"
+#include "render/resources/mesh_store.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+DEFINE_TU_LOGGER("Assets.Package");
+#define LOG_TU_LOGGER() ThisLogger()
+
+namespace engine::assets {
+
+namespace {
+
+// Sections are read in place: the mapping is page aligned and every
+// section offset is a multiple of kPackageAlignment
+class PackageView {
+public:
+  PackageView(const MappedFile &file, std::span<const PackageSection> toc)
+      : m_file(&file), m_toc(toc) {}
+
+  // Empty span and false when the section is missing or out of bounds
+  template <typename T>
+  bool get(PackageSectionKind kind, std::span<const T> &out) const {
+    out = {};
+    for (const PackageSection &section : m_toc) {
+      if (section.kind != kind) {
+        continue;
+      }
+      if (section.offset % kPackageAlignment != 0 ||
+          section.size > m_file->size() ||
+          section.offset > m_file->size() - section.size ||
+          section.size != uint64_t(section.count) * sizeof(T)) {
+        return false;
+      }
+
+      out = {reinterpret_cast<const T *>(m_file->data() + section.offset),
+             section.count};
+      return true;
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool verifyHashes() const {
+    for (const PackageSection &section : m_toc) {
+      if (section.size > m_file->size() ||
+          section.offset > m_file->size() - section.size ||
+          xxhash64(m_file->data() + section.offset, section.size) !=
+              section.hash) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  const MappedFile *m_file;              // non-owning
+  std::span<const PackageSection> m_toc; // non-owning
+};
+
+bool readToc(const MappedFile &file, const std::string &path,
+             std::span<const PackageSection> &outToc) {
+  PackageHeader header{};
+  if (file.size() < sizeof(header)) {
+    LOGE("Too small to be a package: {}", path);
+    return false;
+  }
+  std::memcpy(&header, file.data(), sizeof(header));
+
+  if (header.magic != kPackageMagic) {
+    LOGE("Not a package: {}", path);
+    return false;
+  }
+  if (header.version != kPackageVersion ||
+      header.vertexSize != sizeof(engine::Vertex)) {
+    LOGE("{} is version {}, expected {}, re-cook it", path, header.version,
+         kPackageVersion);
+    return false;
+  }
+
+  const uint64_t tocBytes =
+      uint64_t(header.sectionCount) * sizeof(PackageSection);
+  if (header.fileSize != file.size() ||
+      tocBytes > file.size() - sizeof(header)) {
+    LOGE("Truncated package: {}", path);
+    return false;
+  }
+
+  const uint8_t *toc = file.data() + sizeof(header);
+  if (xxhash64(toc, tocBytes) != header.tocHash) {
+    LOGE("Corrupt table of contents: {}", path);
+    return false;
+  }
+
+  outToc = {reinterpret_cast<const PackageSection *>(toc),
+            header.sectionCount};
+  return true;
+}
+
+} // namespace
+
+bool loadScenePackage(Renderer &renderer, const std::string &path,
+                      GltfAsset &out, const PackageLoadOptions &options) {
+  out = {};
+
+  MappedFile file;
+  if (!file.open(path)) {
+    return false;
+  }
+
+  std::span<const PackageSection> toc;
+  if (!readToc(file, path, toc)) {
+    return false;
+  }
+
+  const PackageView view(file, toc);
+  std::span<const PackageMesh> meshes;
+  std::span<const PackageMaterial> materials;
+  std::span<const PackageNode> nodes;
+  std::span<const engine::Vertex> vertices;
+  std::span<const uint32_t> indices;
+  std::span<const char> strings;
+  if (!view.get(PackageSectionKind::Meshes, meshes) ||
+      !view.get(PackageSectionKind::Materials, materials) ||
+      !view.get(PackageSectionKind::Nodes, nodes) ||
+      !view.get(PackageSectionKind::Vertices, vertices) ||
+      !view.get(PackageSectionKind::Indices, indices) ||
+      !view.get(PackageSectionKind::Strings, strings)) {
+    LOGE("Missing or out of bounds section: {}", path);
+    return false;
+  }
+
+  if (options.verifyHashes && !view.verifyHashes()) {
+    LOGE("Section hash mismatch: {}", path);
+    return false;
+  }
+
+  // Ranges are checked up front so a bad package uploads nothing
+  for (const PackageMesh &mesh : meshes) {
+    if (mesh.firstVertex > vertices.size() ||
+        mesh.vertexCount > vertices.size() - mesh.firstVertex ||
+        mesh.firstIndex > indices.size() ||
+        mesh.indexCount > indices.size() - mesh.firstIndex) {
+      LOGE("Mesh range out of bounds: {}", path);
+      return false;
+    }
+
+    const std::span<const uint32_t> meshIndices =
+        indices.subspan(mesh.firstIndex, mesh.indexCount);
+    if (!meshIndices.empty() &&
+        std::ranges::max(meshIndices) >= mesh.vertexCount) {
+      LOGE("Mesh index out of range: {}", path);
+      return false;
+    }
+
+    // The stored hash keys MeshStore's dedup as is, the cooker wrote it and
+    // the Meshes section hash covers it. A stale one would alias another
+    // mesh's GPU copy, so verifyHashes recomputes it too.
+    if (mesh.contentHash == 0 ||
+        (options.verifyHashes &&
+         mesh.contentHash !=
+             MeshStore::contentHash(vertices.data() + mesh.firstVertex,
+                                    mesh.vertexCount, meshIndices.data(),
+                                    meshIndices.size()))) {
+      LOGE("Mesh content hash mismatch: {}", path);
+      return false;
+    }
+  }
+  for (const PackageMaterial &material : materials) {
+    if (material.textureUriOffset > strings.size() ||
+        material.textureUriLength >
+            strings.size() - material.textureUriOffset) {
+      LOGE("Texture URI out of bounds: {}", path);
+      return false;
+    }
+  }
+
+  GltfBuildOptions buildOptions{};
+  buildOptions.flipTextureY = options.flipTextureY;
+
+  std::vector<uint32_t> materialIds(materials.size(), UINT32_MAX);
+  for (size_t i = 0; i < materials.size(); ++i) {
+    const PackageMaterial &packed = materials[i];
+
+    GltfMaterialCpu material{};
+    material.baseColorTextureUri.assign(
+        strings.data() + packed.textureUriOffset, packed.textureUriLength);
+    material.baseColorFactor = {
+        packed.baseColorFactor[0], packed.baseColorFactor[1],
+        packed.baseColorFactor[2], packed.baseColorFactor[3]};
+    material.alphaCutoff = packed.alphaCutoff;
+    material.alphaMask = (packed.flags & PackageMaterial::kFlagAlphaMask) != 0;
+    material.doubleSided =
+        (packed.flags & PackageMaterial::kFlagDoubleSided) != 0;
+
+    materialIds[i] = createGltfMaterial(renderer, path, material,
+                                        out.textures, buildOptions);
+  }
+
+  // Straight from the mapping into staging
+  std::vector<MeshHandle> meshHandles(meshes.size());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    const PackageMesh &mesh = meshes[i];
+    meshHandles[i] = renderer.acquireMesh(
+        vertices.data() + mesh.firstVertex, mesh.vertexCount,
+        mesh.indexCount != 0 ? indices.data() + mesh.firstIndex : nullptr,
+        mesh.indexCount, mesh.contentHash);
+    if (meshHandles[i].id != UINT32_MAX) {
+      out.meshes.push_back(meshHandles[i]);
+    }
+  }
+
+  out.drawItems.reserve(nodes.size());
+  for (const PackageNode &node : nodes) {
+    if (node.meshIndex >= meshHandles.size() ||
+        meshHandles[node.meshIndex].id == UINT32_MAX) {
+      continue;
+    }
+
+    const uint32_t materialIndex = meshes[node.meshIndex].materialIndex;
+
+    DrawItem drawItem{};
+    drawItem.mesh = meshHandles[node.meshIndex];
+    drawItem.material = materialIndex < materialIds.size()
+                            ? materialIds[materialIndex]
+                            : UINT32_MAX;
+    std::memcpy(&drawItem.model[0][0], node.model.data(), sizeof(node.model));
+    out.drawItems.push_back(drawItem);
+  }
+
+  out.root = glm::mat4(1.0F);
+  return !out.drawItems.empty();
+}
+
+} // namespace engine::assets
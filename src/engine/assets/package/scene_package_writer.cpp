@@ -0,0 +1,161 @@
+#include "engine/assets/package/scene_package.hpp"
+
+#include "engine/assets/hash/xxhash64.hpp"
+#include "engine/assets/package/scene_package_format.hpp"
+#include "engine/mesh/vertex.hpp"
+#include "render/resources/mesh_store.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace engine::assets {
+
+namespace {
+
+struct SectionBlob {
+  PackageSectionKind kind;
+  uint32_t count;
+  const void *data;
+  size_t size;
+};
+
+template <typename T>
+SectionBlob blobOf(PackageSectionKind kind, const std::vector<T> &items) {
+  return {kind, static_cast<uint32_t>(items.size()), items.data(),
+          items.size() * sizeof(T)};
+}
+
+uint64_t alignUp(uint64_t value) noexcept {
+  return (value + kPackageAlignment - 1) & ~(kPackageAlignment - 1);
+}
+
+} // namespace
+
+bool writeScenePackage(const std::string &path, const GltfSceneCpu &scene) {
+  std::vector<PackageMesh> meshes;
+  std::vector<engine::Vertex> vertices;
+  std::vector<uint32_t> indices;
+  meshes.reserve(scene.primitives.size());
+
+  for (const GltfPrimitiveCpu &primitive : scene.primitives) {
+    const MeshData &mesh = primitive.mesh;
+
+    PackageMesh packed{};
+    packed.firstVertex = vertices.size();
+    packed.firstIndex = indices.size();
+    packed.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    packed.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    packed.materialIndex = primitive.materialIndex;
+    packed.contentHash =
+        MeshStore::contentHash(mesh.vertices.data(), mesh.vertices.size(),
+                               mesh.indices.data(), mesh.indices.size());
+    meshes.push_back(packed);
+
+    vertices.insert(vertices.end(), mesh.vertices.begin(),
+                    mesh.vertices.end());
+    indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+  }
+
+  std::string strings;
+  std::vector<PackageMaterial> materials;
+  materials.reserve(scene.materials.size());
+  for (const GltfMaterialCpu &material : scene.materials) {
+    PackageMaterial packed{};
+    std::memcpy(packed.baseColorFactor.data(), &material.baseColorFactor[0],
+                sizeof(packed.baseColorFactor));
+    packed.alphaCutoff = material.alphaCutoff;
+    packed.flags =
+        (material.alphaMask ? PackageMaterial::kFlagAlphaMask : 0U) |
+        (material.doubleSided ? PackageMaterial::kFlagDoubleSided : 0U);
+    packed.textureUriOffset = static_cast<uint32_t>(strings.size());
+    packed.textureUriLength =
+        static_cast<uint32_t>(material.baseColorTextureUri.size());
+    strings += material.baseColorTextureUri;
+    materials.push_back(packed);
+  }
+
+  std::vector<PackageNode> nodes;
+  nodes.reserve(scene.nodes.size());
+  for (const GltfNodeCpu &node : scene.nodes) {
+    PackageNode packed{};
+    std::memcpy(packed.model.data(), &node.model[0][0], sizeof(packed.model));
+    packed.meshIndex = node.primitiveIndex;
+    nodes.push_back(packed);
+  }
+
+  const std::array<SectionBlob, 6> blobs = {
+      blobOf(PackageSectionKind::Meshes, meshes),
+      blobOf(PackageSectionKind::Materials, materials),
+      blobOf(PackageSectionKind::Nodes, nodes),
+      blobOf(PackageSectionKind::Vertices, vertices),
+      blobOf(PackageSectionKind::Indices, indices),
+      SectionBlob{PackageSectionKind::Strings,
+                  static_cast<uint32_t>(strings.size()), strings.data(),
+                  strings.size()},
+  };
+
+  std::array<PackageSection, blobs.size()> toc{};
+  uint64_t offset = alignUp(sizeof(PackageHeader) + sizeof(toc));
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    toc[i].kind = blobs[i].kind;
+    toc[i].count = blobs[i].count;
+    toc[i].offset = offset;
+    toc[i].size = blobs[i].size;
+    toc[i].hash = xxhash64(blobs[i].data, blobs[i].size);
+    offset = alignUp(offset + blobs[i].size);
+  }
+
+  PackageHeader header{};
+  header.sectionCount = static_cast<uint32_t>(toc.size());
+  header.fileSize = toc.back().offset + toc.back().size;
+  header.tocHash = xxhash64(toc.data(), sizeof(toc));
+
+  // Written aside and renamed, a half written package is never picked up
+  const std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      std::cerr << "[Package] Failed to open " << tmpPath << "\n";
+      return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(toc.data()), sizeof(toc));
+
+    const std::array<char, kPackageAlignment> zeros{};
+    uint64_t written = sizeof(header) + sizeof(toc);
+    for (size_t i = 0; i < blobs.size(); ++i) {
+      file.write(zeros.data(),
+                 static_cast<std::streamsize>(toc[i].offset - written));
+      file.write(static_cast<const char *>(blobs[i].data),
+                 static_cast<std::streamsize>(blobs[i].size));
+      written = toc[i].offset + toc[i].size;
+    }
+
+    if (!file.flush()) {
+      std::cerr << "[Package] Failed to write " << tmpPath << "\n";
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmpPath, path, ec);
+  if (ec) {
+    std::cerr << "[Package] Failed to move " << tmpPath << " to " << path
+              << ": " << ec.message() << "\n";
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace engine::assets
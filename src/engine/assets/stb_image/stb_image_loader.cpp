@@ -13,7 +13,8 @@ namespace engine::assets {
 bool loadImageRGBA8(const std::string &path, ImageData &out, bool flipY) {
   out = {};
 
-  stbi_set_flip_vertically_on_load(flipY ? 1 : 0);
+  // Per thread, images are decoded on texture loader workers
+  stbi_set_flip_vertically_on_load_thread(flipY ? 1 : 0);
 
   int width = 0;
   int height = 0;
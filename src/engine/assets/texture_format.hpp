@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine {
+
+// CPU side texel formats. BCn formats store 4x4 texel blocks.
+enum class TextureFormat : uint8_t {
+  RGBA8,
+  BC1, // RGB, 8 bytes per block
+  BC3, // RGBA, BC1 color + BC4 alpha, 16 bytes per block
+  BC5, // two channel (normal maps), 16 bytes per block
+  BC7, // RGBA, 16 bytes per block
+};
+
+[[nodiscard]] constexpr bool
+isBlockCompressed(TextureFormat format) noexcept {
+  return format != TextureFormat::RGBA8;
+}
+
+// Bytes per block, or per texel for uncompressed formats
+[[nodiscard]] constexpr uint32_t
+textureBlockBytes(TextureFormat format) noexcept {
+  switch (format) {
+  case TextureFormat::RGBA8:
+    return 4;
+  case TextureFormat::BC1:
+    return 8;
+  case TextureFormat::BC3:
+  case TextureFormat::BC5:
+  case TextureFormat::BC7:
+    return 16;
+  }
+
+  return 0;
+}
+
+[[nodiscard]] constexpr size_t textureLevelSize(TextureFormat format,
+                                                uint32_t width,
+                                                uint32_t height) noexcept {
+  if (!isBlockCompressed(format)) {
+    return size_t(width) * height * textureBlockBytes(format);
+  }
+
+  const size_t blocksX = (size_t(width) + 3U) / 4U;
+  const size_t blocksY = (size_t(height) + 3U) / 4U;
+  return blocksX * blocksY * textureBlockBytes(format);
+}
+
+[[nodiscard]] constexpr const char *
+textureFormatName(TextureFormat format) noexcept {
+  switch (format) {
+  case TextureFormat::RGBA8:
+    return "RGBA8";
+  case TextureFormat::BC1:
+    return "BC1";
+  case TextureFormat::BC3:
+    return "BC3";
+  case TextureFormat::BC5:
+    return "BC5";
+  case TextureFormat::BC7:
+    return "BC7";
+  }
+
+  return "Unknown";
+}
+
+} // namespace engine
@@ -0,0 +1,295 @@
+#include "engine/jobs/job_system.hpp"
+
+#include "backend/profiling/trace_recorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace engine::jobs {
+
+namespace {
+
+// Failed searches before a worker goes to sleep
+constexpr uint32_t kIdleSpins = 64;
+
+thread_local const JobSystem *t_system = nullptr;
+thread_local uint32_t t_index = UINT32_MAX;
+thread_local uint32_t t_rng = 0x9e3779b9U;
+
+uint32_t nextRandom() noexcept {
+  // xorshift32, only picks steal victims
+  t_rng ^= t_rng << 13U;
+  t_rng ^= t_rng >> 17U;
+  t_rng ^= t_rng << 5U;
+  return t_rng;
+}
+
+} // namespace
+
+Job *JobCounter::finish() noexcept {
+  // Not the last one, no one can be waiting to free the counter yet
+  uint32_t pending = m_pending.load(std::memory_order_relaxed);
+  while (pending > 1) {
+    if (m_pending.compare_exchange_weak(pending, pending - 1,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_relaxed)) {
+      return nullptr;
+    }
+  }
+
+  lock();
+  Job *ready = nullptr;
+  if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    ready = std::exchange(m_continuations, nullptr);
+  }
+  unlock();
+  return ready;
+}
+
+bool JobCounter::defer(Job *job) noexcept {
+  lock();
+  if (m_pending.load(std::memory_order_acquire) == 0) {
+    unlock();
+    return false;
+  }
+
+  job->next = m_continuations;
+  m_continuations = job;
+  unlock();
+  return true;
+}
+
+void JobCounter::sync() noexcept {
+  lock();
+  unlock();
+}
+
+void JobCounter::lock() noexcept {
+  while (m_lock.test_and_set(std::memory_order_acquire)) {
+    while (m_lock.test(std::memory_order_relaxed)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool JobSystem::init(uint32_t workerCount) {
+  shutdown();
+
+  if (workerCount == 0) {
+    workerCount = std::max(2U, std::thread::hardware_concurrency()) - 1U;
+  }
+
+  m_slots.reserve(size_t(workerCount) + 1);
+  for (uint32_t i = 0; i <= workerCount; ++i) {
+    m_slots.push_back(std::make_unique<Slot>());
+  }
+
+  t_system = this;
+  t_index = 0;
+
+  m_workers.reserve(workerCount);
+  for (uint32_t i = 1; i <= workerCount; ++i) {
+    m_workers.emplace_back(
+        [this, i](const std::stop_token &stop) { workerLoop(i, stop); });
+  }
+
+  return true;
+}
+
+void JobSystem::shutdown() noexcept {
+  if (m_slots.empty()) {
+    return;
+  }
+
+  for (std::jthread &worker : m_workers) {
+    worker.request_stop();
+  }
+  m_signal.fetch_add(1, std::memory_order_seq_cst);
+  m_signal.notify_all();
+  m_workers.clear(); // joins
+
+  // Nothing else runs now, finish leftovers so their counters complete.
+  // Released continuations land in slot 0 and are stolen back from there.
+  const JobSystem *prevSystem = std::exchange(t_system, this);
+  const uint32_t prevIndex = std::exchange(t_index, 0U);
+  while (Job *job = findWork(UINT32_MAX)) {
+    execute(job);
+  }
+
+  m_slots.clear();
+  m_inbox.clear();
+  m_inboxSize.store(0, std::memory_order_relaxed);
+
+  t_system = prevSystem == this ? nullptr : prevSystem;
+  t_index = prevSystem == this ? UINT32_MAX : prevIndex;
+}
+
+uint32_t JobSystem::threadIndex() const noexcept {
+  return t_system == this ? t_index : UINT32_MAX;
+}
+
+Job *JobSystem::allocate() {
+  const uint32_t index = threadIndex();
+  if (index < m_slots.size()) {
+    Slot &slot = *m_slots[index];
+    // A few probes, a slot still held by a slow job is skipped
+    for (uint32_t probe = 0; probe < 4; ++probe) {
+      Job &job = slot.pool[slot.poolCursor++ & (kPoolJobs - 1U)];
+      if (!job.inUse.load(std::memory_order_acquire)) {
+        job.inUse.store(true, std::memory_order_relaxed);
+        job.pooled = true;
+        return &job;
+      }
+    }
+  }
+
+  Job *job = new Job();
+  job->pooled = false;
+  return job;
+}
+
+void JobSystem::release(Job *job) noexcept {
+  if (job->pooled) {
+    job->inUse.store(false, std::memory_order_release);
+  } else {
+    delete job;
+  }
+}
+
+void JobSystem::submit(Job *job) {
+  const uint32_t index = threadIndex();
+  if (index < m_slots.size()) {
+    if (!m_slots[index]->deque.push(job)) {
+      execute(job); // deque full, no point queueing more
+      return;
+    }
+  } else {
+    std::lock_guard lock(m_inboxMutex);
+    m_inbox.push_back(job);
+    m_inboxSize.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  wake();
+}
+
+Job *JobSystem::findWork(uint32_t index) {
+  const auto count = static_cast<uint32_t>(m_slots.size());
+  if (index < count) {
+    if (Job *job = m_slots[index]->deque.pop(); job != nullptr) {
+      return job;
+    }
+  }
+
+  if (m_inboxSize.load(std::memory_order_relaxed) != 0) {
+    std::lock_guard lock(m_inboxMutex);
+    if (!m_inbox.empty()) {
+      Job *job = m_inbox.back();
+      m_inbox.pop_back();
+      m_inboxSize.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+
+  if (count == 0) {
+    return nullptr;
+  }
+
+  const uint32_t start = nextRandom() % count;
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint32_t victim = (start + i) % count;
+    if (victim == index) {
+      continue;
+    }
+    if (Job *job = m_slots[victim]->deque.steal(); job != nullptr) {
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::execute(Job *job) {
+  {
+    profiling::TraceScope trace(job->name);
+    job->invoke(*job);
+  }
+
+  JobCounter *counter = job->counter;
+  release(job);
+
+  if (counter != nullptr) {
+    Job *ready = counter->finish();
+    while (ready != nullptr) {
+      Job *next = ready->next;
+      submit(ready);
+      ready = next;
+    }
+  }
+}
+
+void JobSystem::wake() noexcept {
+  // Pairs with the sleeper count in workerLoop, see there
+  m_signal.fetch_add(1, std::memory_order_seq_cst);
+  if (m_sleepers.load(std::memory_order_seq_cst) != 0) {
+    m_signal.notify_one();
+  }
+}
+
+void JobSystem::wait(JobCounter &counter) {
+  const uint32_t index = threadIndex();
+  while (!counter.done()) {
+    if (Job *job = findWork(index); job != nullptr) {
+      execute(job);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  counter.sync();
+}
+
+void JobSystem::workerLoop(uint32_t index, const std::stop_token &stop) {
+  t_system = this;
+  t_index = index;
+  t_rng ^= index * 0x85ebca6bU;
+  profiling::TraceRecorder::instance().setThreadName("Job Worker " +
+                                                     std::to_string(index));
+
+  uint32_t idle = 0;
+  while (!stop.stop_requested()) {
+    if (Job *job = findWork(index); job != nullptr) {
+      execute(job);
+      idle = 0;
+      continue;
+    }
+
+    if (++idle < kIdleSpins) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Announce the sleep before the last look: a submit either sees the
+    // sleeper and notifies, or its signal bump is already visible here
+    m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+    const uint32_t seen = m_signal.load(std::memory_order_seq_cst);
+    if (Job *job = findWork(index); job != nullptr) {
+      m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+      execute(job);
+      idle = 0;
+      continue;
+    }
+    if (!stop.stop_requested()) {
+      m_signal.wait(seen, std::memory_order_seq_cst);
+    }
+    m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+    idle = 0;
+  }
+}
+
+} // namespace engine::jobs
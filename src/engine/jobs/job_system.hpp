@@ -0,0 +1,227 @@
+#pragma once
+
+#include "engine/jobs/work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace engine::jobs {
+
+struct Job;
+
+// Jobs still to finish. Doubles as the handle to wait on and as a
+// dependency: jobs queued behind a counter start once it reaches zero.
+// Must outlive every job that references it, wait() on it before it goes.
+class JobCounter {
+public:
+  JobCounter() = default;
+
+  JobCounter(const JobCounter &) = delete;
+  JobCounter &operator=(const JobCounter &) = delete;
+  JobCounter(JobCounter &&) = delete;
+  JobCounter &operator=(JobCounter &&) = delete;
+
+  [[nodiscard]] bool done() const noexcept {
+    return m_pending.load(std::memory_order_acquire) == 0;
+  }
+  [[nodiscard]] uint32_t pending() const noexcept {
+    return m_pending.load(std::memory_order_relaxed);
+  }
+
+private:
+  friend class JobSystem;
+
+  void add() noexcept { m_pending.fetch_add(1, std::memory_order_relaxed); }
+  // Jobs that were waiting on this counter if it just reached zero
+  Job *finish() noexcept;
+  // Queues job behind this counter, false when it is already done
+  bool defer(Job *job) noexcept;
+  // Waits out a finish() still touching the counter after done()
+  void sync() noexcept;
+
+  void lock() noexcept;
+  void unlock() noexcept { m_lock.clear(std::memory_order_release); }
+
+  std::atomic<uint32_t> m_pending{0};
+  std::atomic_flag m_lock;
+  Job *m_continuations = nullptr; // guarded by m_lock
+};
+
+// One queued call. The callable lives inline, jobs come from a per-thread
+// pool so scheduling does not touch the heap.
+struct alignas(64) Job {
+  static constexpr size_t kStorageBytes = 64;
+
+  alignas(std::max_align_t) std::array<std::byte, kStorageBytes> storage{};
+  void (*invoke)(Job &) = nullptr; // runs and destroys the callable
+  const char *name = "Job";
+  JobCounter *counter = nullptr; // non-owning
+  Job *next = nullptr;           // continuation chain
+  std::atomic<bool> inUse{false};
+  bool pooled = true;
+};
+
+// Fixed pool of workers sized to the hardware, each with a Chase-Lev deque.
+// Idle workers steal from the others and sleep when nothing is queued. The
+// thread that calls init() owns slot 0: its jobs go to its own deque and it
+// runs jobs while it waits. Other threads may submit too, through a locked
+// inbox.
+class JobSystem {
+public:
+  static constexpr uint32_t kDequeCapacity = 4096;
+  static constexpr uint32_t kPoolJobs = 1024; // per thread, then heap
+  // parallelFor aims for this many ranges per thread
+  static constexpr uint32_t kRangesPerThread = 8;
+
+  JobSystem() = default;
+  ~JobSystem() noexcept { shutdown(); }
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+  JobSystem(JobSystem &&) = delete;
+  JobSystem &operator=(JobSystem &&) = delete;
+
+  // workerCount 0 leaves one hardware thread for the caller
+  bool init(uint32_t workerCount = 0);
+  // Runs what is still queued on the calling thread, then joins
+  void shutdown() noexcept;
+
+  // Workers plus the owning thread, 0 before init()
+  [[nodiscard]] uint32_t threadCount() const noexcept {
+    return static_cast<uint32_t>(m_slots.size());
+  }
+  // 0 on the owning thread, 1.. on workers, UINT32_MAX anywhere else
+  [[nodiscard]] uint32_t threadIndex() const noexcept;
+
+  // Without init() the job runs inline. With after, the job starts once
+  // after reaches zero. The name shows up in traces and must be a literal.
+  template <typename F>
+  void run(const char *name, F &&fn, JobCounter *counter = nullptr,
+           JobCounter *after = nullptr);
+
+  // Runs queued jobs on the calling thread until counter reaches zero
+  void wait(JobCounter &counter);
+
+  // fn(begin, end) over [0, count), blocking until every range is done.
+  // Ranges split in halves down to a grain of about count / (threads *
+  // kRangesPerThread), never below minGrain. The caller runs the first
+  // range, idle threads steal the far halves.
+  template <typename F>
+  void parallelFor(const char *name, uint32_t count, F &&fn,
+                   uint32_t minGrain = 1);
+
+private:
+  struct Slot {
+    WorkStealingDeque<Job> deque{kDequeCapacity};
+    std::unique_ptr<Job[]> pool = std::make_unique<Job[]>(kPoolJobs);
+    uint32_t poolCursor = 0; // owning thread only
+  };
+
+  template <typename F>
+  void runRange(const char *name, uint32_t begin, uint32_t end,
+                uint32_t grain, F &fn, JobCounter &counter);
+
+  Job *allocate();
+  static void release(Job *job) noexcept;
+  void submit(Job *job);
+  Job *findWork(uint32_t index);
+  void execute(Job *job);
+  void wake() noexcept;
+  void workerLoop(uint32_t index, const std::stop_token &stop);
+
+  std::vector<std::unique_ptr<Slot>> m_slots; // [0 owner, workers]
+  std::vector<std::jthread> m_workers;
+
+  std::mutex m_inboxMutex;
+  std::vector<Job *> m_inbox; // from threads without a slot
+  std::atomic<uint32_t> m_inboxSize{0};
+
+  // Bumped on every submit, idle workers wait on it
+  std::atomic<uint32_t> m_signal{0};
+  std::atomic<uint32_t> m_sleepers{0};
+};
+
+template <typename F>
+void JobSystem::run(const char *name, F &&fn, JobCounter *counter,
+                    JobCounter *after) {
+  using Fn = std::decay_t<F>;
+  static_assert(sizeof(Fn) <= Job::kStorageBytes,
+                "Job capture too large, capture a pointer instead");
+  static_assert(alignof(Fn) <= alignof(std::max_align_t));
+
+  if (m_slots.empty()) {
+    // Nothing runs concurrently, so after has already finished
+    Fn call(std::forward<F>(fn));
+    call();
+    return;
+  }
+
+  Job *job = allocate();
+  ::new (job->storage.data()) Fn(std::forward<F>(fn));
+  job->invoke = [](Job &self) {
+    Fn *call = std::launder(reinterpret_cast<Fn *>(self.storage.data()));
+    (*call)();
+    call->~Fn();
+  };
+  job->name = name;
+  job->counter = counter;
+  job->next = nullptr;
+
+  if (counter != nullptr) {
+    counter->add();
+  }
+  if (after != nullptr && after->defer(job)) {
+    return;
+  }
+  submit(job);
+}
+
+template <typename F>
+void JobSystem::runRange(const char *name, uint32_t begin, uint32_t end,
+                         uint32_t grain, F &fn, JobCounter &counter) {
+  // Hand off the far half, keep splitting the near one
+  while (end - begin > grain) {
+    const uint32_t mid = begin + (end - begin) / 2U;
+    run(
+        name,
+        [this, name, mid, end, grain, &fn, &counter] {
+          runRange(name, mid, end, grain, fn, counter);
+        },
+        &counter);
+    end = mid;
+  }
+  fn(begin, end);
+}
+
+template <typename F>
+void JobSystem::parallelFor(const char *name, uint32_t count, F &&fn,
+                            uint32_t minGrain) {
+  if (count == 0) {
+    return;
+  }
+
+  const uint32_t threads = std::max(threadCount(), 1U);
+  const uint32_t grain =
+      std::max({minGrain, 1U, count / (threads * kRangesPerThread)});
+  if (threads == 1 || count <= grain) {
+    fn(0U, count);
+    return;
+  }
+
+  JobCounter counter;
+  runRange(name, 0U, count, grain, fn, counter);
+  wait(counter);
+}
+
+} // namespace engine::jobs
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+namespace engine::jobs {
+
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models"). The owning thread pushes and pops at the bottom, any
+// thread steals from the top. Fixed capacity: push() fails when full and
+// the caller runs the item itself.
+template <typename T> class WorkStealingDeque {
+public:
+  explicit WorkStealingDeque(uint32_t capacity)
+      : m_items(std::make_unique<std::atomic<T *>[]>(std::bit_ceil(capacity))),
+        m_mask(int64_t(std::bit_ceil(capacity)) - 1) {}
+
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+  WorkStealingDeque(WorkStealingDeque &&) = delete;
+  WorkStealingDeque &operator=(WorkStealingDeque &&) = delete;
+
+  // Owner only
+  bool push(T *item) noexcept {
+    const int64_t b = m_bottom.load(std::memory_order_relaxed);
+    const int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t > m_mask) {
+      return false;
+    }
+
+    m_items[b & m_mask].store(item, std::memory_order_relaxed);
+    // Publishes the item, and whatever it points to, to thieves
+    m_bottom.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only, newest first
+  T *pop() noexcept {
+    const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T *item = m_items[b & m_mask].load(std::memory_order_relaxed);
+    if (t == b) {
+      // Last item, race the thieves for it
+      if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread, oldest first. nullptr when empty or on a lost race.
+  T *steal() noexcept {
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+
+    T *item = m_items[t & m_mask].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return m_bottom.load(std::memory_order_relaxed) <=
+           m_top.load(std::memory_order_relaxed);
+  }
+
+private:
+  alignas(64) std::atomic<int64_t> m_top{0};
+  alignas(64) std::atomic<int64_t> m_bottom{0};
+  std::unique_ptr<std::atomic<T *>[]> m_items;
+  int64_t m_mask;
+};
+
+} // namespace engine::jobs
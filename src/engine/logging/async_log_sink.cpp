@@ -0,0 +1,237 @@
+#include "engine/logging/async_log_sink.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace log {
+
+namespace {
+
+// Writer's nap when the ring is empty, bounds how stale the console gets
+constexpr auto kIdleSleep = std::chrono::milliseconds(2);
+
+class InFlight {
+public:
+  explicit InFlight(std::atomic<uint32_t> &count) noexcept : m_count(count) {
+    m_count.fetch_add(1, std::memory_order_seq_cst);
+  }
+  ~InFlight() noexcept { m_count.fetch_sub(1, std::memory_order_release); }
+
+  InFlight(const InFlight &) = delete;
+  InFlight &operator=(const InFlight &) = delete;
+  InFlight(InFlight &&) = delete;
+  InFlight &operator=(InFlight &&) = delete;
+
+private:
+  std::atomic<uint32_t> &m_count;
+};
+
+} // namespace
+
+AsyncLogSink::AsyncLogSink(std::vector<spdlog::sink_ptr> sinks,
+                           uint32_t capacity, Overflow overflow)
+    : m_sinks(std::move(sinks)), m_overflow(overflow) {
+  const uint64_t size = std::bit_ceil(std::max<uint64_t>(capacity, 2));
+  m_slots = std::make_unique<Slot[]>(size);
+  m_mask = size - 1;
+  for (uint64_t i = 0; i < size; ++i) {
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  m_running.store(true, std::memory_order_release);
+  m_writer = std::jthread(
+      [this](const std::stop_token &stop) { writerLoop(stop); });
+}
+
+void AsyncLogSink::stop() noexcept {
+  if (!m_running.exchange(false, std::memory_order_seq_cst)) {
+    return;
+  }
+
+  // Producers that saw m_running just before it flipped finish their push
+  // while the writer still runs, a blocking one may need it to free a slot
+  while (m_inFlight.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+
+  // The writer drains the ring once more on its way out
+  m_writer.request_stop();
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+}
+
+bool AsyncLogSink::tryPush(const spdlog::details::log_msg &msg) noexcept {
+  // Vyukov bounded queue: a slot is free for position pos when its
+  // sequence equals pos, and readable when it equals pos + 1
+  uint64_t pos = m_tail.load(std::memory_order_relaxed);
+  Slot *slot = nullptr;
+  for (;;) {
+    slot = &m_slots[pos & m_mask];
+    const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<int64_t>(seq - pos);
+    if (diff == 0) {
+      if (m_tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false; // full
+    } else {
+      pos = m_tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->time = msg.time;
+  slot->source = msg.source;
+  slot->threadId = msg.thread_id;
+  slot->level = msg.level;
+  slot->nameLength =
+      static_cast<uint16_t>(std::min(msg.logger_name.size(), kMaxName));
+  slot->textLength =
+      static_cast<uint16_t>(std::min(msg.payload.size(), kMaxText));
+  if (slot->nameLength != 0) {
+    std::memcpy(slot->name.data(), msg.logger_name.data(), slot->nameLength);
+  }
+  if (slot->textLength != 0) {
+    std::memcpy(slot->text.data(), msg.payload.data(), slot->textLength);
+  }
+
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool AsyncLogSink::enqueue(const spdlog::details::log_msg &msg) noexcept {
+  if (tryPush(msg)) {
+    return true;
+  }
+
+  if (m_overflow == Overflow::Drop) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  const InFlight blocked(m_blocked);
+  while (!tryPush(msg)) {
+    if (!m_running.load(std::memory_order_acquire)) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+void AsyncLogSink::sink_it_(const spdlog::details::log_msg &msg) {
+  {
+    // Announced before the check, so stop() either sees this producer or
+    // the producer sees the flag down
+    const InFlight inFlight(m_inFlight);
+    if (m_running.load(std::memory_order_seq_cst) && enqueue(msg)) {
+      return;
+    }
+  }
+
+  writeDirect(msg);
+}
+
+void AsyncLogSink::flush_() {
+  const uint64_t target = m_tail.load(std::memory_order_acquire);
+  while (m_running.load(std::memory_order_acquire) &&
+         m_head.load(std::memory_order_acquire) < target) {
+    std::this_thread::yield();
+  }
+
+  for (const spdlog::sink_ptr &out : m_sinks) {
+    out->flush();
+  }
+}
+
+void AsyncLogSink::writeDirect(const spdlog::details::log_msg &msg) {
+  for (const spdlog::sink_ptr &out : m_sinks) {
+    if (out->should_log(msg.level)) {
+      out->log(msg);
+    }
+  }
+
+  // Was flush_on(warn) on every logger, now off the caller's thread
+  if (msg.level >= spdlog::level::warn) {
+    for (const spdlog::sink_ptr &out : m_sinks) {
+      out->flush();
+    }
+  }
+}
+
+bool AsyncLogSink::writeOne() {
+  const uint64_t head = m_head.load(std::memory_order_relaxed);
+  Slot &slot = m_slots[head & m_mask];
+  if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+    return false;
+  }
+
+  spdlog::details::log_msg msg(
+      slot.time, slot.source,
+      spdlog::string_view_t(slot.name.data(), slot.nameLength), slot.level,
+      spdlog::string_view_t(slot.text.data(), slot.textLength));
+  msg.thread_id = slot.threadId;
+
+  try {
+    writeDirect(msg);
+  } catch (...) {
+    // A failing sink must not take the writer down
+  }
+
+  slot.sequence.store(head + m_mask + 1, std::memory_order_release);
+  m_head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogSink::writerLoop(const std::stop_token &stop) {
+  for (;;) {
+    bool wrote = false;
+    while (writeOne()) {
+      wrote = true;
+    }
+
+    const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_droppedReported) {
+      const std::string text = std::to_string(dropped - m_droppedReported) +
+                               " log messages dropped, ring full";
+      m_droppedReported = dropped;
+      try {
+        writeDirect(spdlog::details::log_msg(spdlog::source_loc{}, "Log",
+                                             spdlog::level::warn, text));
+      } catch (...) {
+      }
+    }
+
+    if (stop.stop_requested()) {
+      // Producers may still have landed something after the last drain
+      while (writeOne()) {
+      }
+      return;
+    }
+
+    if (wrote) {
+      continue;
+    }
+    if (m_blocked.load(std::memory_order_relaxed) != 0) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(kIdleSleep);
+    }
+  }
+}
+
+} // namespace log
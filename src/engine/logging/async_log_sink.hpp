@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace log {
+
+enum class Overflow : uint8_t {
+  Drop, // count and discard, the caller never waits
+  Block // spin until the writer frees a slot
+};
+
+// Front sink for every logger. Callers copy the formatted message into a
+// bounded lock-free MPSC ring and return; one writer thread hands the
+// records to the real sinks and flushes after warnings.
+class AsyncLogSink final
+    : public spdlog::sinks::base_sink<spdlog::details::null_mutex> {
+public:
+  // Longer messages are truncated
+  static constexpr size_t kMaxText = 384;
+  static constexpr size_t kMaxName = 48;
+
+  AsyncLogSink(std::vector<spdlog::sink_ptr> sinks, uint32_t capacity,
+               Overflow overflow);
+  ~AsyncLogSink() override { stop(); }
+
+  AsyncLogSink(const AsyncLogSink &) = delete;
+  AsyncLogSink &operator=(const AsyncLogSink &) = delete;
+  AsyncLogSink(AsyncLogSink &&) = delete;
+  AsyncLogSink &operator=(AsyncLogSink &&) = delete;
+
+  // Writes what is queued and joins the writer. Later messages go straight
+  // to the real sinks on the calling thread.
+  void stop() noexcept;
+
+  [[nodiscard]] uint64_t dropped() const noexcept {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+protected:
+  void sink_it_(const spdlog::details::log_msg &msg) override;
+  // Blocks until everything queued before the call is written
+  void flush_() override;
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    spdlog::log_clock::time_point time;
+    spdlog::source_loc source;
+    size_t threadId = 0;
+    spdlog::level::level_enum level = spdlog::level::info;
+    uint16_t nameLength = 0;
+    uint16_t textLength = 0;
+    std::array<char, kMaxName> name{};
+    std::array<char, kMaxText> text{};
+  };
+
+  bool tryPush(const spdlog::details::log_msg &msg) noexcept;
+  // Queued or dropped per m_overflow, false once stopped while blocking
+  bool enqueue(const spdlog::details::log_msg &msg) noexcept;
+  // Writer thread only
+  bool writeOne();
+  void writeDirect(const spdlog::details::log_msg &msg);
+  void writerLoop(const std::stop_token &stop);
+
+  std::vector<spdlog::sink_ptr> m_sinks;
+  std::unique_ptr<Slot[]> m_slots;
+  uint64_t m_mask = 0;
+  Overflow m_overflow = Overflow::Drop;
+
+  alignas(64) std::atomic<uint64_t> m_tail{0}; // next slot to claim
+  alignas(64) std::atomic<uint64_t> m_head{0}; // next slot to write
+  std::atomic<uint64_t> m_dropped{0};
+  uint64_t m_droppedReported = 0; // writer thread only
+  std::atomic<bool> m_running{false};
+  // Producers between their m_running check and the end of their push,
+  // stop() waits for them before the writer's last drain
+  std::atomic<uint32_t> m_inFlight{0};
+  // Producers spinning on a full ring under Overflow::Block, the writer
+  // does not nap while any are waiting
+  std::atomic<uint32_t> m_blocked{0};
+
+  std::jthread m_writer;
+};
+
+} // namespace log
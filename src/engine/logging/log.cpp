@@ -1,6 +1,8 @@
 #include "engine/logging/log.hpp"
 
-#include <glm/detail/type_quat.hpp>
+#include "engine/logging/async_log_sink.hpp"
+
+#include <cstdint>
 #include <memory>
 #include <spdlog/common.h>
 #include <spdlog/logger.h>
@@ -9,6 +11,7 @@
 #include <spdlog/spdlog.h>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace log {
 
@@ -18,25 +21,30 @@ static constexpr const char *kPattern =
 
 static std::shared_ptr<spdlog::logger> quark;
 
-static std::shared_ptr<spdlog::sinks::stdout_color_sink_mt> g_consoleSink;
-static std::shared_ptr<spdlog::sinks::rotating_file_sink_mt> g_fileSink;
+// Every logger writes into the one ring, the writer owns the real sinks
+static std::shared_ptr<AsyncLogSink> g_asyncSink;
 
-void init() {
+void init(const Config &config) {
   if (quark) {
     return;
   }
 
-  g_consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-  g_fileSink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+  auto consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+  auto fileSink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
       "quark.log",
       10 * 1024 * 1024, // 10 MB
       3                 // keep 3 old logs
   );
 
-  quark = std::make_shared<spdlog::logger>(
-      "Quark", spdlog::sinks_init_list{g_consoleSink, g_fileSink});
+  // Formatting of the final line happens on the writer thread
+  consoleSink->set_pattern(kPattern);
+  fileSink->set_pattern(kPattern);
+
+  g_asyncSink = std::make_shared<AsyncLogSink>(
+      std::vector<spdlog::sink_ptr>{consoleSink, fileSink}, config.capacity,
+      config.overflow);
 
-  quark->set_pattern(kPattern);
+  quark = std::make_shared<spdlog::logger>("Quark", g_asyncSink);
 
 #ifndef NDEBUG
   quark->set_level(spdlog::level::trace);
@@ -44,8 +52,6 @@ void init() {
   quark->set_level(spdlog::level::info);
 #endif
 
-  quark->flush_on(spdlog::level::warn);
-
   spdlog::register_logger(quark);
   spdlog::set_default_logger(quark);
 }
@@ -56,8 +62,10 @@ void shutdown() {
     quark.reset();
   }
 
-  g_consoleSink.reset();
-  g_fileSink.reset();
+  if (g_asyncSink) {
+    g_asyncSink->stop();
+    g_asyncSink.reset();
+  }
   spdlog::drop_all();
 }
 
@@ -72,15 +80,19 @@ std::shared_ptr<spdlog::logger> get(std::string_view name) {
     return existing;
   }
 
-  auto logger = std::make_shared<spdlog::logger>(
-      std::string{name}, spdlog::sinks_init_list{g_consoleSink, g_fileSink});
-
-  logger->set_pattern(kPattern);
+  auto logger =
+      std::make_shared<spdlog::logger>(std::string{name}, g_asyncSink);
   logger->set_level(quark->level());
-  logger->flush_on(spdlog::level::warn);
 
   spdlog::register_logger(logger);
   return logger;
 }
 
+uint64_t dropped() { return g_asyncSink ? g_asyncSink->dropped() : 0; }
+
+void reportSuppressed(spdlog::logger &logger, const spdlog::source_loc &loc,
+                      spdlog::level::level_enum level, uint32_t count) {
+  logger.log(loc, level, "{} similar messages suppressed", count);
+}
+
 } // namespace log
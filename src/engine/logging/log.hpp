@@ -1,12 +1,23 @@
 #pragma once
 
+#include "engine/logging/async_log_sink.hpp"
+#include "engine/logging/rate_limit.hpp"
+
+#include <cstdint>
 #include <memory>
+#include <spdlog/common.h>
 #include <spdlog/logger.h>
 #include <string_view>
 
 namespace log {
 
-void init();
+struct Config {
+  Overflow overflow = Overflow::Drop;
+  uint32_t capacity = 4096; // messages, rounded up to a power of two
+};
+
+void init(const Config &config = {});
+// Drains the ring and joins the writer
 void shutdown();
 
 std::shared_ptr<spdlog::logger> &engine();
@@ -16,6 +27,12 @@ std::shared_ptr<spdlog::logger> get(std::string_view name);
 inline std::shared_ptr<spdlog::logger> render() { return get("Render"); }
 inline std::shared_ptr<spdlog::logger> backend() { return get("Backend"); }
 
+// Messages lost to a full ring under Overflow::Drop
+uint64_t dropped();
+
+void reportSuppressed(spdlog::logger &logger, const spdlog::source_loc &loc,
+                      spdlog::level::level_enum level, uint32_t count);
+
 } // namespace log
 
 // #ifndef LOG_TU_LOGGER
@@ -23,41 +40,120 @@ inline std::shared_ptr<spdlog::logger> backend() { return get("Backend"); }
 // #endif
 
 #define DEFINE_TU_LOGGER(name)                                                 \
-  static inline std::shared_ptr<spdlog::logger> ThisLogger() {                 \
-    static auto lg = ::log::get(name);                                         \
+  static inline const std::shared_ptr<spdlog::logger> &ThisLogger() {          \
+    static const auto lg = ::log::get(name);                                   \
     return lg;                                                                 \
   }                                                                            \
   static_assert(true)
 
+// Calls below this level compile away. Override per target with
+// -DQUARK_LOG_ACTIVE_LEVEL=SPDLOG_LEVEL_WARN etc.
+#ifndef QUARK_LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define QUARK_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#else
+#define QUARK_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+#endif
+
+// Level check first so filtered calls never format, then the call site's
+// rate limit. The formatted text is queued, the caller never touches I/O.
+#define QUARK_LOG_AT(logger, lvl, ...)                                         \
+  do {                                                                         \
+    const auto &quarkLogger_ = (logger);                                       \
+    if (quarkLogger_->should_log(lvl)) {                                       \
+      static ::log::RateLimit quarkLimit_;                                     \
+      uint32_t quarkSuppressed_ = 0;                                           \
+      if (quarkLimit_.allow(quarkSuppressed_)) {                               \
+        const spdlog::source_loc quarkLoc_{__FILE__, __LINE__,                 \
+                                           SPDLOG_FUNCTION};                   \
+        if (quarkSuppressed_ != 0) {                                           \
+          ::log::reportSuppressed(*quarkLogger_, quarkLoc_, lvl,               \
+                                  quarkSuppressed_);                           \
+        }                                                                      \
+        quarkLogger_->log(quarkLoc_, lvl, __VA_ARGS__);                        \
+      }                                                                        \
+    }                                                                          \
+  } while (false)
+
+#define QUARK_LOG_STRIPPED(...)                                                \
+  do {                                                                         \
+  } while (false)
+
 // Default (Engine) logger
-#define LOG_TRACE(...) ::log::engine()->trace(__VA_ARGS__)
-#define LOG_DEBUG(...) ::log::engine()->debug(__VA_ARGS__)
-#define LOG_INFO(...) ::log::engine()->info(__VA_ARGS__)
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(...)                                                         \
+  QUARK_LOG_AT(::log::engine(), spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)                                                         \
+  QUARK_LOG_AT(::log::engine(), spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(...)                                                          \
+  QUARK_LOG_AT(::log::engine(), spdlog::level::info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
 #define LOG_WARN(...)                                                          \
-  ::log::engine()->warn(                                                       \
-      spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, __VA_ARGS__)
+  QUARK_LOG_AT(::log::engine(), spdlog::level::warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
 #define LOG_ERROR(...)                                                         \
-  ::log::engine()->error(                                                      \
-      spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, __VA_ARGS__)
+  QUARK_LOG_AT(::log::engine(), spdlog::level::err, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
 #define LOG_CRIT(...)                                                          \
-  ::log::engine()->critical(                                                   \
-      spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, __VA_ARGS__)
+  QUARK_LOG_AT(::log::engine(), spdlog::level::critical, __VA_ARGS__)
 
 // Logger-explicit
-#define LOGT(...) (LOG_TU_LOGGER())->trace(__VA_ARGS__)
-#define LOGD(...) (LOG_TU_LOGGER())->debug(__VA_ARGS__)
-#define LOGI(...) (LOG_TU_LOGGER())->info(__VA_ARGS__)
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOGT(...)                                                              \
+  QUARK_LOG_AT(LOG_TU_LOGGER(), spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOGT(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOGD(...)                                                              \
+  QUARK_LOG_AT(LOG_TU_LOGGER(), spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOGD(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOGI(...)                                                              \
+  QUARK_LOG_AT(LOG_TU_LOGGER(), spdlog::level::info, __VA_ARGS__)
+#else
+#define LOGI(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
+
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
 #define LOGW(...)                                                              \
-  (LOG_TU_LOGGER())                                                            \
-      ->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION},           \
-            spdlog::level::warn, __VA_ARGS__)
+  QUARK_LOG_AT(LOG_TU_LOGGER(), spdlog::level::warn, __VA_ARGS__)
+#else
+#define LOGW(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
 
+#if QUARK_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
 #define LOGE(...)                                                              \
-  (LOG_TU_LOGGER())                                                            \
-      ->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION},           \
-            spdlog::level::err, __VA_ARGS__)
+  QUARK_LOG_AT(LOG_TU_LOGGER(), spdlog::level::err, __VA_ARGS__)
+#else
+#define LOGE(...) QUARK_LOG_STRIPPED(__VA_ARGS__)
+#endif
 
 #define LOGC(...)                                                              \
-  (LOG_TU_LOGGER())                                                            \
-      ->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION},           \
-            spdlog::level::critical, __VA_ARGS__)
+  QUARK_LOG_AT(LOG_TU_LOGGER(), spdlog::level::critical, __VA_ARGS__)
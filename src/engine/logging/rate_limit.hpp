@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace log {
+
+// One per call site. Lets kBurst messages through per window and counts
+// the rest, so a warning inside a frame loop cannot flood the ring.
+class RateLimit {
+public:
+  static constexpr uint32_t kBurst = 16;
+  static constexpr int64_t kWindowNs = 1'000'000'000;
+
+  // On true, suppressed holds how many calls were swallowed since the last
+  // one that got through
+  bool allow(uint32_t &suppressed) noexcept {
+    const int64_t now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+
+    int64_t start = m_windowStart.load(std::memory_order_relaxed);
+    if (now - start >= kWindowNs &&
+        m_windowStart.compare_exchange_strong(start, now,
+                                              std::memory_order_relaxed)) {
+      m_count.store(0, std::memory_order_relaxed);
+    }
+
+    if (m_count.fetch_add(1, std::memory_order_relaxed) < kBurst) {
+      suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+      return true;
+    }
+
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+private:
+  std::atomic<int64_t> m_windowStart{0};
+  std::atomic<uint32_t> m_count{0};
+  std::atomic<uint32_t> m_suppressed{0};
+};
+
+} // namespace log
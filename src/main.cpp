@@ -1,6 +1,10 @@
 #include "backend/presentation/vk_presenter.hpp"
+#include "backend/profiling/alloc_tracker.hpp"
+#include "backend/profiling/trace_recorder.hpp"
 #include "engine/app/app.hpp"
+#include "engine/app/cube_grid.hpp"
 #include "engine/assets/gltf/gltf_asset.hpp"
+#include "engine/assets/package/scene_package.hpp"
 #include "engine/camera/camera.hpp"
 #include "engine/geometry/transform.hpp"
 #include "engine/logging/log.hpp"
@@ -8,14 +12,17 @@
 #include "render/renderer.hpp"
 #include "render/resources/material_system.hpp"
 #include "render/resources/mesh_store.hpp"
+#include "render/util/scope_exit.hpp"
 
-#include <GLFW/glfw3.h>
-#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <iostream>
+#include <string_view>
+#include <system_error>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -37,40 +44,46 @@ private:
   bool m_ok;
 };
 
-static void pushCubeGrid(std::vector<DrawItem> &out, MeshHandle mesh,
-                         uint32_t material, uint32_t cubeCount, float spacing,
-                         float t) {
-  const uint32_t gridW = uint32_t(std::ceil(std::sqrt(double(cubeCount))));
-  const uint32_t gridH = (cubeCount + gridW - 1) / gridW;
-
-  out.reserve(out.size() + cubeCount);
-
-  for (uint32_t i = 0; i < cubeCount; ++i) {
-    const uint32_t x = i % gridW;
-    const uint32_t z = i / gridW;
-
-    const float fx = (float(x) - float(gridW - 1) * 0.5F) * spacing;
-    const float fz = (float(z) - float(gridH - 1) * 0.5F) * spacing;
-
-    const float r = (t * 0.7F) + (float(i) * 0.001F);
-
-    DrawItem item{};
-    item.mesh = mesh;
-    item.material = material;
-    item.model = engine::makeModel({fx, 0.0F, fz}, {0.0F, r, 0.0F});
-
-    out.push_back(item);
-  }
-}
-
-int main() {
+int main(int argc, char **argv) {
   log::init();
+  // Declared before the app so its teardown messages are written too
+  const auto logShutdown = makeScopeExit([]() noexcept { log::shutdown(); });
   LOG_INFO("Engine starting...");
 
   EngineApp app;
   AppConfig cfg{};
   cfg.title = "Hello Window";
 
+  // --headless [--frames N]: offscreen, no window, 600 frames by default
+  // --trace FILE: Chrome trace JSON of the whole run
+  // --alloc-stacks / --alloc-strict: print stacks for, or abort on, heap
+  // allocations in no-alloc scopes (QUARK_ALLOC_TRACKING debug builds)
+  std::filesystem::path tracePath;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg == "--headless") {
+      cfg.headless = true;
+      if (cfg.maxFrames == 0) {
+        cfg.maxFrames = 600;
+      }
+    } else if (arg == "--frames" && i + 1 < argc) {
+      cfg.maxFrames =
+          static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (arg == "--alloc-stacks") {
+      profiling::AllocTracker::setCaptureStacks(true);
+    } else if (arg == "--alloc-strict") {
+      profiling::AllocTracker::setFailOnAlloc(true);
+    }
+  }
+
+  profiling::TraceRecorder &trace = profiling::TraceRecorder::instance();
+  trace.setThreadName("Main");
+  if (!tracePath.empty()) {
+    trace.start();
+  }
+
   if (!app.init(cfg)) {
     std::cerr << "App init failed\n";
     return 1;
@@ -83,6 +96,7 @@ int main() {
   engine::assets::GltfLoadOptions opt{};
   opt.flipTexcoordV = true;
   opt.axis.yUpToZUp = true;
+  opt.jobs = &app.jobs();
 
   engine::assets::GltfAsset tree;
   MeshHandle cube{};
@@ -97,8 +111,26 @@ int main() {
     }
 
     cube = app.meshes().cube();
-    engine::assets::loadGltf(app.renderer(), "assets/tree.glb", tree, opt);
+    // quark_cook output, used while it is newer than the glTF
+    std::error_code cookedError;
+    std::error_code sourceError;
+    const auto cookedTime =
+        std::filesystem::last_write_time("assets/tree.qpkg", cookedError);
+    const auto sourceTime =
+        std::filesystem::last_write_time("assets/tree.glb", sourceError);
+    bool loaded = false;
+    if (!cookedError && (sourceError || cookedTime >= sourceTime)) {
+      loaded = engine::assets::loadScenePackage(app.renderer(),
+                                                "assets/tree.qpkg", tree);
+      if (!loaded) {
+        engine::assets::releaseGltf(app.renderer(), tree);
+      }
+    }
+    if (!loaded) {
+      engine::assets::loadGltf(app.renderer(), "assets/tree.glb", tree, opt);
+    }
 
+    app.renderer().setTextureCompression(engine::TextureFormat::BC7);
     texture = app.renderer().createTextureFromFile("assets/terry.jpg", true);
     material = app.renderer().createMaterialFromTexture(texture);
   }
@@ -109,12 +141,13 @@ int main() {
   draw.reserve(tree.drawItems.size() + 2);
   // draw.reserve(2);
 
+  float t = 0.0F;
   app.run([&](float dt) {
     controller.update(dt);
     app.renderer().setCameraUBO(
         camera.makeUbo(app.presenter().swapchainExtent()));
 
-    const float t = (float)glfwGetTime();
+    t += dt;
     draw.clear();
 
     DrawItem cubeA{};
@@ -136,5 +169,12 @@ int main() {
     (void)app.renderer().drawFrame(app.presenter(), draw);
   });
 
+  if (!tracePath.empty()) {
+    trace.stop();
+    if (!trace.writeChromeJson(tracePath)) {
+      return 1;
+    }
+  }
+
   return 0;
 }
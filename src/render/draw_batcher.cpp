@@ -0,0 +1,102 @@
+#include "render/draw_batcher.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+
+namespace {
+
+// Worst case std::align padding per container
+constexpr size_t kAlignSlack = alignof(std::max_align_t);
+
+uint64_t groupKey(MeshHandle mesh, uint32_t material) noexcept {
+  return (static_cast<uint64_t>(material) << 32U) | mesh.id;
+}
+
+size_t slotOf(uint64_t key, size_t mask) noexcept {
+  // Fibonacci hashing, the top bits mix best
+  return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32U) & mask;
+}
+
+} // namespace
+
+size_t DrawBatcher::slotCountFor(size_t itemCount) noexcept {
+  return std::bit_ceil(std::max(itemCount, kMinItems) * 2U);
+}
+
+size_t DrawBatcher::bytesFor(size_t itemCount) noexcept {
+  const size_t items = std::max(itemCount, kMinItems);
+  return (slotCountFor(itemCount) * sizeof(Slot)) +
+         (items * (sizeof(Group) + sizeof(uint32_t) +
+                   (2U * sizeof(glm::mat4)) + sizeof(Batch))) +
+         (6U * kAlignSlack);
+}
+
+void DrawBatcher::begin(size_t itemCount) {
+  const size_t items = std::max(itemCount, kMinItems);
+
+  m_slots.assign(slotCountFor(itemCount), Slot{});
+  m_groups.clear();
+  m_groups.reserve(items);
+  m_itemGroups.clear();
+  m_itemGroups.reserve(items);
+  m_models.clear();
+  m_models.reserve(items);
+  m_sortedModels.clear();
+  m_sortedModels.reserve(items);
+  m_sorted.clear();
+  m_sorted.reserve(items);
+}
+
+void DrawBatcher::add(MeshHandle mesh, uint32_t material,
+                      const glm::mat4 &model) {
+  const uint32_t group = findGroup(mesh, material);
+  ++m_groups[group].count;
+  m_itemGroups.push_back(group);
+  m_models.push_back(model);
+}
+
+uint32_t DrawBatcher::findGroup(MeshHandle mesh, uint32_t material) {
+  if (m_slots.empty()) {
+    m_slots.assign(slotCountFor(0), Slot{});
+  }
+
+  const uint64_t key = groupKey(mesh, material);
+  const size_t mask = m_slots.size() - 1;
+  for (size_t i = slotOf(key, mask);; i = (i + 1) & mask) {
+    Slot &slot = m_slots[i];
+    if (slot.group != UINT32_MAX && slot.key == key) {
+      return slot.group;
+    }
+    if (slot.group != UINT32_MAX) {
+      continue;
+    }
+
+    const auto group = static_cast<uint32_t>(m_groups.size());
+    m_groups.push_back(Group{.mesh = mesh, .material = material});
+    slot.key = key;
+    slot.group = group;
+
+    // More items than begin() was told about
+    if (m_groups.size() * 2U > m_slots.size()) {
+      rehash(m_slots.size() * 2U);
+    }
+    return group;
+  }
+}
+
+void DrawBatcher::rehash(size_t slotCount) {
+  m_slots.assign(slotCount, Slot{});
+  const size_t mask = slotCount - 1;
+  for (uint32_t group = 0; group < m_groups.size(); ++group) {
+    const uint64_t key =
+        groupKey(m_groups[group].mesh, m_groups[group].material);
+    size_t i = slotOf(key, mask);
+    while (m_slots[i].group != UINT32_MAX) {
+      i = (i + 1) & mask;
+    }
+    m_slots[i] = Slot{.key = key, .group = group};
+  }
+}
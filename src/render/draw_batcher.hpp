@@ -0,0 +1,108 @@
+#pragma once
+
+#include "render/resources/mesh_store.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// Groups a frame's draw items into one instanced batch per mesh and material.
+// Touches no GPU state, so it can be measured on its own.
+class DrawBatcher {
+public:
+  struct Batch {
+    uint64_t sortKey = 0;
+    uint32_t pipeline = 0;
+    MeshHandle mesh{};
+    uint32_t material = 0;
+    std::span<const glm::mat4> models;
+  };
+
+  // Containers come from resource, usually the frame arena
+  explicit DrawBatcher(std::pmr::memory_resource *resource =
+                           std::pmr::get_default_resource())
+      : m_slots(resource), m_groups(resource), m_itemGroups(resource),
+        m_models(resource), m_sortedModels(resource), m_sorted(resource) {}
+
+  // Everything begin(itemCount) takes from the resource. With that much
+  // free up front, adding up to itemCount items and sorting never grows.
+  [[nodiscard]] static size_t bytesFor(size_t itemCount) noexcept;
+
+  // Drops the previous frame's batches and sizes for itemCount items
+  void begin(size_t itemCount);
+  void add(MeshHandle mesh, uint32_t material, const glm::mat4 &model);
+
+  // Batches in bind order. pipelineFor(material) returns the pipeline id.
+  template <class PipelineFor>
+  [[nodiscard]] std::span<const Batch> sort(PipelineFor &&pipelineFor) {
+    // Counting sort: each group's models end up contiguous, in add order
+    uint32_t offset = 0;
+    for (Group &group : m_groups) {
+      group.offset = offset;
+      offset += group.count;
+      group.count = 0;
+    }
+    m_sortedModels.resize(m_models.size());
+    for (size_t i = 0; i < m_models.size(); ++i) {
+      Group &group = m_groups[m_itemGroups[i]];
+      m_sortedModels[group.offset + group.count++] = m_models[i];
+    }
+
+    m_sorted.clear();
+    for (const Group &group : m_groups) {
+      const uint32_t pipeline = pipelineFor(group.material);
+      m_sorted.push_back(Batch{
+          .sortKey = sortKey(pipeline, group.material, group.mesh),
+          .pipeline = pipeline,
+          .mesh = group.mesh,
+          .material = group.material,
+          .models = std::span<const glm::mat4>(
+              m_sortedModels.data() + group.offset, group.count)});
+    }
+    std::sort(m_sorted.begin(), m_sorted.end(),
+              [](const Batch &a, const Batch &b) {
+                return a.sortKey < b.sortKey;
+              });
+    return m_sorted;
+  }
+
+  // Pipeline first so each variant binds once per frame, then material and
+  // mesh to keep descriptor and vertex buffer binds together
+  [[nodiscard]] static constexpr uint64_t
+  sortKey(uint32_t pipeline, uint32_t material, MeshHandle mesh) noexcept {
+    return (static_cast<uint64_t>(pipeline & 0xFFFFU) << 48) |
+           (static_cast<uint64_t>(material & 0xFFFFFFU) << 24) |
+           static_cast<uint64_t>(mesh.id & 0xFFFFFFU);
+  }
+
+private:
+  // Open addressing from (material, mesh) to a group, kept under half full
+  struct Slot {
+    uint64_t key = 0;
+    uint32_t group = UINT32_MAX; // UINT32_MAX = empty
+  };
+
+  struct Group {
+    MeshHandle mesh;
+    uint32_t material = 0;
+    uint32_t count = 0;
+    uint32_t offset = 0; // into m_sortedModels, set by sort()
+  };
+
+  static constexpr size_t kMinItems = 8;
+
+  [[nodiscard]] static size_t slotCountFor(size_t itemCount) noexcept;
+  uint32_t findGroup(MeshHandle mesh, uint32_t material);
+  void rehash(size_t slotCount);
+
+  std::pmr::vector<Slot> m_slots;
+  std::pmr::vector<Group> m_groups;
+  std::pmr::vector<uint32_t> m_itemGroups; // per added item
+  std::pmr::vector<glm::mat4> m_models;    // add order
+  std::pmr::vector<glm::mat4> m_sortedModels;
+  std::pmr::vector<Batch> m_sorted;
+};
@@ -0,0 +1,156 @@
+#include "render/frame_arena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+LinearArena::LinearArena(size_t initialBytes,
+                         std::pmr::memory_resource *upstream)
+    : m_upstream(upstream) {
+  if (initialBytes != 0) {
+    pushBlock(initialBytes);
+  }
+}
+
+void LinearArena::pushBlock(size_t minBytes) {
+  // At least double, so a growing frame settles after a few blocks
+  const size_t size =
+      std::max({minBytes + sizeof(Block), m_capacity, kMinBlockBytes});
+  auto *block =
+      static_cast<Block *>(m_upstream->allocate(size, alignof(Block)));
+
+  if (m_blocks != nullptr) {
+    m_retired += size_t(m_cursor - blockBegin());
+  }
+
+  block->next = m_blocks;
+  block->size = size;
+  m_blocks = block;
+  m_cursor = blockBegin();
+  m_end = reinterpret_cast<std::byte *>(block) + size;
+  m_capacity += size;
+}
+
+void *LinearArena::do_allocate(size_t bytes, size_t alignment) {
+  if (m_blocks != nullptr) {
+    void *p = m_cursor;
+    size_t space = size_t(m_end - m_cursor);
+    if (std::align(alignment, bytes, p, space) != nullptr) {
+      m_cursor = static_cast<std::byte *>(p) + bytes;
+      return p;
+    }
+  }
+
+  pushBlock(bytes + alignment);
+
+  void *p = m_cursor;
+  size_t space = size_t(m_end - m_cursor);
+  std::align(alignment, bytes, p, space);
+  m_cursor = static_cast<std::byte *>(p) + bytes;
+  return p;
+}
+
+void LinearArena::reserve(size_t bytes) {
+  if (m_blocks == nullptr || size_t(m_end - m_cursor) < bytes) {
+    pushBlock(bytes);
+  }
+}
+
+size_t LinearArena::used() const noexcept {
+  if (m_blocks == nullptr) {
+    return 0;
+  }
+  return m_retired + size_t(m_cursor - blockBegin());
+}
+
+void LinearArena::reset() {
+  m_highWater = std::max(m_highWater, used());
+
+  if (m_blocks != nullptr && m_blocks->next != nullptr) {
+    // Grew last time, replace the chain with one block that fits it all
+    const size_t total = m_capacity;
+    release();
+    pushBlock(total - sizeof(Block));
+    return;
+  }
+
+  m_retired = 0;
+  if (m_blocks != nullptr) {
+    m_cursor = blockBegin();
+  }
+}
+
+void LinearArena::release() noexcept {
+  while (m_blocks != nullptr) {
+    Block *next = m_blocks->next;
+    m_upstream->deallocate(m_blocks, m_blocks->size, alignof(Block));
+    m_blocks = next;
+  }
+
+  m_cursor = nullptr;
+  m_end = nullptr;
+  m_capacity = 0;
+  m_retired = 0;
+}
+
+bool FrameArenas::init(uint32_t framesInFlight, uint32_t threadCount,
+                       size_t renderBytes) {
+  if (framesInFlight == 0) {
+    std::cerr << "[FrameArenas] framesInFlight must be > 0\n";
+    return false;
+  }
+
+  shutdown();
+
+  // Without a JobSystem only the render thread allocates
+  m_threadCount = std::max(threadCount, 1U);
+  m_frames.resize(framesInFlight);
+  for (std::vector<LinearArena> &frame : m_frames) {
+    frame.reserve(m_threadCount);
+    frame.emplace_back(renderBytes);
+    for (uint32_t i = 1; i < m_threadCount; ++i) {
+      frame.emplace_back();
+    }
+  }
+
+  return true;
+}
+
+void FrameArenas::shutdown() noexcept {
+  m_frames.clear();
+  m_threadCount = 0;
+  m_current = 0;
+}
+
+void FrameArenas::beginFrame(uint32_t frameIndex) {
+  m_current = frameIndex;
+  for (LinearArena &arena : m_frames[frameIndex]) {
+    arena.reset();
+  }
+}
+
+size_t FrameArenas::usedBytes() const noexcept {
+  size_t bytes = 0;
+  if (m_current < m_frames.size()) {
+    for (const LinearArena &arena : m_frames[m_current]) {
+      bytes += arena.used();
+    }
+  }
+  return bytes;
+}
+
+size_t FrameArenas::highWaterBytes() const noexcept {
+  size_t bytes = 0;
+  for (const std::vector<LinearArena> &frame : m_frames) {
+    size_t sum = 0;
+    for (const LinearArena &arena : frame) {
+      sum += arena.highWater();
+    }
+    bytes = std::max(bytes, sum);
+  }
+  return bytes;
+}
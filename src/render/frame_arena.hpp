@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Bump allocator for data that dies at a known point. deallocate() is a
+// no-op, reset() rewinds everything at once. Outgrowing the first block
+// chains more blocks from upstream, the next reset() merges them into one
+// so steady state runs out of a single block.
+class LinearArena final : public std::pmr::memory_resource {
+public:
+  explicit LinearArena(size_t initialBytes = 0,
+                       std::pmr::memory_resource *upstream =
+                           std::pmr::new_delete_resource());
+  ~LinearArena() noexcept override { release(); }
+
+  LinearArena(const LinearArena &) = delete;
+  LinearArena &operator=(const LinearArena &) = delete;
+
+  LinearArena(LinearArena &&other) noexcept { *this = std::move(other); }
+  LinearArena &operator=(LinearArena &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    release();
+
+    m_upstream = other.m_upstream;
+    m_blocks = std::exchange(other.m_blocks, nullptr);
+    m_cursor = std::exchange(other.m_cursor, nullptr);
+    m_end = std::exchange(other.m_end, nullptr);
+    m_capacity = std::exchange(other.m_capacity, 0U);
+    m_retired = std::exchange(other.m_retired, 0U);
+    m_highWater = std::exchange(other.m_highWater, 0U);
+
+    return *this;
+  }
+
+  // Invalidates everything allocated since the last reset
+  void reset();
+  // Makes the next bytes of allocations come from the current block, so
+  // they can run where upstream must not be called
+  void reserve(size_t bytes);
+  // Returns all blocks to upstream
+  void release() noexcept;
+
+  // Bytes handed out since the last reset, alignment padding included
+  [[nodiscard]] size_t used() const noexcept;
+  [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+  // Largest used() seen at any reset
+  [[nodiscard]] size_t highWater() const noexcept {
+    return std::max(m_highWater, used());
+  }
+
+private:
+  struct Block {
+    Block *next; // older blocks
+    size_t size; // including this header
+  };
+
+  static constexpr size_t kMinBlockBytes = 64ULL * 1024ULL;
+
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *, size_t, size_t) override {}
+  [[nodiscard]] bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  void pushBlock(size_t minBytes);
+  [[nodiscard]] std::byte *blockBegin() const noexcept {
+    return reinterpret_cast<std::byte *>(m_blocks + 1);
+  }
+
+  std::pmr::memory_resource *m_upstream = nullptr; // non-owning
+  Block *m_blocks = nullptr;                       // owning, newest first
+  std::byte *m_cursor = nullptr;
+  std::byte *m_end = nullptr;
+  size_t m_capacity = 0; // all blocks
+  size_t m_retired = 0;  // used bytes in blocks behind the newest
+  size_t m_highWater = 0;
+};
+
+// Per frame in flight, one arena for each JobSystem thread, rewound once
+// the frame's fence has signaled. The render thread owns the JobSystem, so
+// its arena is slot 0. Containers built on these must not outlive the
+// frame that allocated them.
+class FrameArenas {
+public:
+  FrameArenas() = default;
+  ~FrameArenas() noexcept { shutdown(); }
+
+  FrameArenas(const FrameArenas &) = delete;
+  FrameArenas &operator=(const FrameArenas &) = delete;
+
+  FrameArenas(FrameArenas &&other) noexcept { *this = std::move(other); }
+  FrameArenas &operator=(FrameArenas &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    shutdown();
+
+    m_frames = std::move(other.m_frames);
+    m_threadCount = std::exchange(other.m_threadCount, 0U);
+    m_current = std::exchange(other.m_current, 0U);
+
+    return *this;
+  }
+
+  // threadCount is JobSystem::threadCount(). Worker arenas start empty and
+  // grow on first use.
+  bool init(uint32_t framesInFlight, uint32_t threadCount,
+            size_t renderBytes);
+  void shutdown() noexcept;
+
+  // After the frame's fence wait
+  void beginFrame(uint32_t frameIndex);
+
+  [[nodiscard]] LinearArena &render() noexcept {
+    return m_frames[m_current][0];
+  }
+  // Arena of the calling job thread, index is JobSystem::threadIndex()
+  [[nodiscard]] LinearArena &worker(uint32_t index) noexcept {
+    return m_frames[m_current][index];
+  }
+  [[nodiscard]] uint32_t threadCount() const noexcept { return m_threadCount; }
+
+  // Current frame, all of its arenas
+  [[nodiscard]] size_t usedBytes() const noexcept;
+  // Largest single frame across every slot
+  [[nodiscard]] size_t highWaterBytes() const noexcept;
+
+private:
+  std::vector<std::vector<LinearArena>> m_frames; // [frame][thread index]
+  uint32_t m_threadCount = 0;
+  uint32_t m_current = 0;
+};
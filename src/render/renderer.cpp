@@ -2,29 +2,36 @@
 
 #include "backend/core/vk_backend_ctx.hpp"
 #include "backend/presentation/vk_presenter.hpp"
+#include "backend/profiling/alloc_tracker.hpp"
 #include "backend/profiling/cpu_profiler.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "backend/profiling/profiling_logger.hpp"
+#include "backend/profiling/trace_recorder.hpp"
 #include "backend/profiling/vk_gpu_profiler.hpp"
 #include "engine/geometry/transform.hpp"
 #include "engine/logging/log.hpp"
 #include "engine/mesh/mesh_data.hpp"
+#include "render/draw_batcher.hpp"
+#include "render/frame_arena.hpp"
 #include "render/rendergraph/swapchain_targets.hpp"
 #include "render/resources/mesh_gpu.hpp"
 #include "render/resources/mesh_store.hpp"
 #include "render/scene/push_constants.hpp"
 #include "render/util/scope_exit.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <functional>
+#include <filesystem>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <glm/geometric.hpp>
 #include <span>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -39,28 +46,43 @@ static constexpr VkDeviceSize kUploadStaticBudgetPerFrame = 8ULL * kMiB;
 // 2 MiB
 static constexpr VkDeviceSize kUploadFrameBudgetPerFrame = 2ULL * kMiB;
 
+// Render thread's transient data, grows to the high-water mark on demand
+static constexpr size_t kFrameArenaBytes = 1ULL * kMiB;
+
 static constexpr uint32_t kRequestedMaxInstancesPerFrame = 16U * 1024U;
 static constexpr uint32_t kRequestedMaxMaterials = 1024U;
 
-struct BatchKey {
-  MeshHandle mesh;
-  uint32_t material;
-
-  bool operator==(const BatchKey &other) const noexcept {
-    return mesh.id == other.mesh.id && material == other.material;
+static PipelineKey pipelineKeyFor(uint32_t materialFlags) {
+  PipelineKey key;
+  if ((materialFlags & MaterialGPU::kFlagAlphaMask) != 0) {
+    key.features |= PipelineKey::kAlphaTest;
   }
-};
-
-struct BatchKeyHash {
-  size_t operator()(const BatchKey &key) const noexcept {
-    size_t h1 = std::hash<uint32_t>{}(key.mesh.id);
-    size_t h2 = std::hash<uint32_t>{}(key.material);
-    return h1 ^ (h2 + 0x9e3779b97f4a7c15ULL + (h1 << 6) + (h1 >> 2));
+  if ((materialFlags & MaterialGPU::kFlagDoubleSided) != 0) {
+    key.features |= PipelineKey::kDoubleSided;
   }
-};
+  return key;
+}
+
+// On-screen diameter in pixels of the instance's bounding sphere. Used as the
+// texel-density estimate for streaming, assuming the texture spans the mesh.
+static float projectedDiameterPixels(const glm::mat4 &model,
+                                     float boundsRadius,
+                                     const CameraUBO &camera,
+                                     float viewportHeight) {
+  const float scale = std::max({glm::length(glm::vec3(model[0])),
+                                glm::length(glm::vec3(model[1])),
+                                glm::length(glm::vec3(model[2]))});
+  const glm::vec4 viewPos = camera.view * model[3];
+  const float depth = std::max(-viewPos.z, 1e-3F);
+
+  // proj[1][1] = 1 / tan(fovY / 2), sign depends on the y flip
+  return (boundsRadius * scale / depth) * std::abs(camera.proj[1][1]) *
+         viewportHeight;
+}
 
 bool Renderer::init(VkBackendCtx &ctx, VkPresenter &presenter,
-                    uint32_t framesInFlight, const std::string &vertSpvPath,
+                    engine::jobs::JobSystem &jobs, uint32_t framesInFlight,
+                    const std::string &vertSpvPath,
                     const std::string &fragSpvPath) {
   if (ctx.device() == VK_NULL_HANDLE ||
       ctx.physicalDevice() == VK_NULL_HANDLE ||
@@ -111,9 +133,16 @@ bool Renderer::init(VkBackendCtx &ctx, VkPresenter &presenter,
     return false;
   }
 
+  // Shared by every pipeline, saved on shutdown
+  if (!m_pipelineCache.init(device, m_ctx->physicalDevice())) {
+    LOGE("Failed to initialize pipeline cache");
+    shutdown();
+    return false;
+  }
+
   // Create main pass
   if (!m_mainPass.init(*m_ctx, presenter, m_targets, m_interface, m_vertPath,
-                       m_fragPath)) {
+                       m_fragPath, jobs, m_pipelineCache.cache())) {
     LOGE("Failed to initialize main pass");
     shutdown();
     return false;
@@ -154,8 +183,8 @@ bool Renderer::init(VkBackendCtx &ctx, VkPresenter &presenter,
     return false;
   }
 
-  if (!m_resources.init(*m_ctx, m_uploads.statik(), m_interface, m_scene,
-                        &m_uploadProfiler)) {
+  if (!m_resources.init(*m_ctx, m_uploads.statik(), jobs, m_interface,
+                        m_scene, &m_uploadProfiler)) {
     LOGE("Failed to initialize resources store");
     shutdown();
     return false;
@@ -192,6 +221,13 @@ bool Renderer::init(VkBackendCtx &ctx, VkPresenter &presenter,
     return false;
   }
 
+  if (!m_frameArenas.init(m_framesInFlight, jobs.threadCount(),
+                           kFrameArenaBytes)) {
+    LOGE("Failed to initialize frame arenas");
+    shutdown();
+    return false;
+  }
+
   return true;
 }
 
@@ -208,6 +244,7 @@ void Renderer::shutdown() noexcept {
 
   // Commands-dependents
   m_frames.shutdown();
+  m_frameArenas.shutdown();
   m_resources.shutdown();
   m_uploads.shutdown();
   m_commands.shutdown();
@@ -216,6 +253,8 @@ void Renderer::shutdown() noexcept {
 
   // Swapchain-dependents
   m_mainPass.shutdown();
+  m_pipelineFlagsRevision = kNoRevision;
+  m_pipelineCache.shutdown();
   m_interface.shutdown();
   m_targets.shutdown();
 
@@ -276,6 +315,7 @@ void Renderer::recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
 
   m_gpuProfiler.beginFrameCmd(cmd, frameIndex);
   m_gpuProfiler.markFrameBegin(cmd, frameIndex);
+  m_gpuProfiler.beginScope(cmd, frameIndex, "Frame");
 
   std::array<VkClearValue, 2> clears{};
   clears[0].color = {{0.05F, 0.05F, 0.08F, 1.0F}};
@@ -286,8 +326,10 @@ void Renderer::recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
   VkImageView scView = presenter.colorViews()[imageIndex];
   VkImageView depthView = targets.depthViews()[imageIndex];
 
+  // Contents are cleared, so the previous layout can be discarded. Holds
+  // for swapchain and headless offscreen images alike.
   transitionImage(
-      cmd, scImg, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+      cmd, scImg, VK_IMAGE_LAYOUT_UNDEFINED,
       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 0,
       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
@@ -317,10 +359,8 @@ void Renderer::recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
   renderingInfo.pDepthAttachment = &depthAttach;
 
   m_gpuProfiler.markMainPassBegin(cmd, frameIndex);
+  m_gpuProfiler.beginScope(cmd, frameIndex, "MainPass");
   vkCmdBeginRendering(cmd, &renderingInfo);
-  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    m_mainPass.pipeline());
-  m_cpuProfiler.incPipelineBinds(1);
 
   // Viewport / scissor
   VkViewport viewport{};
@@ -340,35 +380,50 @@ void Renderer::recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
   m_scene.bind(cmd, m_interface, m_frames.currentFrameIndex());
   m_cpuProfiler.incDescriptorBinds(1);
 
-  // TODO: sort by mesh, material and stream directly into the uploader
-  // without building vectors per batch
-  std::unordered_map<BatchKey, std::vector<glm::mat4>, BatchKeyHash> batches;
-  batches.reserve(items.size());
+  DrawBatcher batches(&m_frameArenas.render());
+  batches.begin(items.size());
+
+  const float viewportHeight = static_cast<float>(extent.height);
 
   for (const DrawItem &item : items) {
-    if (m_resources.meshes().get(item.mesh) == nullptr) {
+    const MeshGpu *mesh = m_resources.meshes().get(item.mesh);
+    if (mesh == nullptr) {
       continue;
     }
 
     uint32_t mat = m_resources.materials().resolveMaterial(item.material);
-    BatchKey key{.mesh = item.mesh, .material = mat};
-    batches[key].push_back(item.model);
+    batches.add(item.mesh, mat, item.model);
+
+    // Streaming feedback, applied next frame
+    m_resources.materials().requestTextureDensity(
+        mat, projectedDiameterPixels(item.model, mesh->boundsRadius,
+                                     m_cameraUbo, viewportHeight));
   }
 
-  uint32_t cursor = 0; // mat4 units within frame slice
+  const auto sorted = batches.sort([this](uint32_t material) {
+    return m_mainPass.pipelineId(
+        pipelineKeyFor(m_resources.materials().materialFlags(material)));
+  });
 
-  for (auto &item : batches) {
-    const BatchKey &key = item.first;
-    std::vector<glm::mat4> &models = item.second;
-    std::span<const glm::mat4> modelsSpan(models.data(), models.size());
+  uint32_t cursor = 0; // mat4 units within frame slice
+  VkPipeline boundPipeline = VK_NULL_HANDLE;
 
-    const MeshGpu *mesh = m_resources.meshes().get(key.mesh);
+  for (const DrawBatcher::Batch &batch : sorted) {
+    const MeshGpu *mesh = m_resources.meshes().get(batch.mesh);
     if (mesh == nullptr) {
       continue;
     }
 
+    // Variants still compiling draw with the fallback
+    const VkPipeline pipeline = m_mainPass.pipeline(batch.pipeline);
+    if (pipeline != boundPipeline) {
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+      m_cpuProfiler.incPipelineBinds(1);
+      boundPipeline = pipeline;
+    }
+
     auto instanceUpload =
-        m_scene.uploadInstances(frameIndex, cursor, modelsSpan);
+        m_scene.uploadInstances(frameIndex, cursor, batch.models);
 
     if (!instanceUpload) {
       continue;
@@ -378,12 +433,12 @@ void Renderer::recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
     m_cpuProfiler.addInstances(instanceCount);
 
     m_resources.materials().bindMaterial(cmd, m_interface.pipelineLayout(), 1,
-                                         key.material);
+                                         batch.material);
     m_cpuProfiler.incDescriptorBinds(1);
 
     DrawPushConstants pushConstants{};
     pushConstants.baseInstance = instanceUpload.baseInstance;
-    pushConstants.materialId = key.material;
+    pushConstants.materialId = batch.material;
 
     vkCmdPushConstants(cmd, m_interface.pipelineLayout(),
                        VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstants),
@@ -418,14 +473,16 @@ void Renderer::recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
   }
 
   vkCmdEndRendering(cmd);
+  m_gpuProfiler.endScope(cmd, frameIndex);
   m_gpuProfiler.markMainPassEnd(cmd, frameIndex);
 
   transitionImage(
       cmd, scImg, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-      VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0,
+      presenter.presentLayout(), VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0,
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
 
+  m_gpuProfiler.endScope(cmd, frameIndex);
   m_gpuProfiler.markFrameEnd(cmd, frameIndex);
   vkEndCommandBuffer(cmd);
 }
@@ -441,12 +498,15 @@ bool Renderer::drawFrame(VkPresenter &presenter, MeshHandle mesh) {
 bool Renderer::drawFrame(VkPresenter &presenter,
                          std::span<const DrawItem> items) {
   auto endGuard = makeScopeExit([&] {
+    m_cpuProfiler.setFrameArena(m_frameArenas.usedBytes(),
+                                m_frameArenas.highWaterBytes());
     m_cpuProfiler.endFrame();
     m_uploadProfiler.endFrame();
     m_profileReporter.logPerFrame(m_cpuProfiler, m_gpuProfiler,
                                   m_uploadProfiler);
   });
 
+  profiling::TraceRecorder::instance().markFrame();
   CpuProfiler::Scope frameScope(m_cpuProfiler, CpuProfiler::Stat::FrameTotal);
 
   if (m_ctx->device() == VK_NULL_HANDLE) {
@@ -471,12 +531,25 @@ bool Renderer::drawFrame(VkPresenter &presenter,
   }
 
   const uint32_t frameIndex = m_frames.currentFrameIndex();
+  // The fence wait above retired everything this slot allocated
+  m_frameArenas.beginFrame(frameIndex);
 
   if (!m_uploads.beginFrame(frameIndex)) {
     LOGE("Failed to begin uploads for frame {}", frameIndex);
     return false;
   }
 
+  // Residency changes go through the static lane, which is flushed before
+  // this frame's submit
+  {
+    profiling::TraceScope trace("Residency");
+    m_resources.meshes().beginFrame();
+    m_resources.materials().processTextureLoads();
+    m_resources.materials().updateStreaming();
+    requestPipelineVariants();
+    m_mainPass.collectPipelines();
+  }
+
   {
     CpuProfiler::Scope s(m_cpuProfiler, CpuProfiler::Stat::UpdatePerFrameUBO);
     (void)m_scene.update(frameIndex, m_cameraUbo);
@@ -487,11 +560,17 @@ bool Renderer::drawFrame(VkPresenter &presenter,
 
   {
     CpuProfiler::Scope s(m_cpuProfiler, CpuProfiler::Stat::RecordCmd);
+    // Grow the arena for the batcher before allocations are off limits
+    m_frameArenas.render().reserve(DrawBatcher::bytesFor(items.size()));
+    profiling::NoAllocScope noAlloc("RecordCmd");
     recordFrame(cmd, presenter, m_targets, imageIndex, items);
   }
 
-  if (!m_uploads.flushAll(false)) {
-    LOGW("Failed to flush");
+  {
+    profiling::TraceScope trace("FlushUploads");
+    if (!m_uploads.flushAll(false)) {
+      LOGW("Failed to flush");
+    }
   }
 
   FrameStatus sub = m_frames.submit(
@@ -506,6 +585,7 @@ bool Renderer::drawFrame(VkPresenter &presenter,
                        imageIndex, &m_cpuProfiler);
 
   m_gpuProfiler.onFrameSubmitted();
+  // Consumers read last(), its sequence tells a new readback from a repeat
   (void)m_gpuProfiler.tryCollect(frameIndex);
 
   // TODO: handle SUBOPTIMAL recreate, i.e when convienent instead of now
@@ -547,12 +627,28 @@ bool Renderer::recreateSwapchainDependent(VkPresenter &presenter,
     return false;
   }
 
+  // A re-initialized main pass has lost its variants
+  m_pipelineFlagsRevision = kNoRevision;
+
   const uint32_t imageCount = presenter.imageCount();
   LOGI("Swapchain-dependent resources recreated (images={})", imageCount);
 
   return m_frames.onSwapchainRecreated(imageCount);
 }
 
+void Renderer::requestPipelineVariants() {
+  const MaterialSystem &materials = m_resources.materials();
+  if (materials.materialFlagsRevision() == m_pipelineFlagsRevision) {
+    return;
+  }
+  m_pipelineFlagsRevision = materials.materialFlagsRevision();
+
+  // Known keys are lookups, new ones queue their compile
+  for (const uint32_t flags : materials.materialFlags()) {
+    (void)m_mainPass.requestPipeline(pipelineKeyFor(flags));
+  }
+}
+
 MeshHandle Renderer::createMesh(const engine::Vertex *vertices,
                                 uint32_t vertexCount, const uint32_t *indices,
                                 uint32_t indexCount) {
@@ -564,15 +660,52 @@ MeshHandle Renderer::createMesh(const engine::MeshData &mesh) {
   return m_resources.meshes().createMesh(mesh);
 }
 
+MeshHandle Renderer::acquireMesh(const engine::MeshData &mesh) {
+  return m_resources.meshes().acquireMesh(mesh);
+}
+
+MeshHandle Renderer::acquireMesh(const engine::Vertex *vertices,
+                                 uint32_t vertexCount, const uint32_t *indices,
+                                 uint32_t indexCount, uint64_t hash) {
+  return m_resources.meshes().acquireMesh(vertices, vertexCount, indices,
+                                          indexCount, hash);
+}
+
+void Renderer::releaseMesh(MeshHandle handle) {
+  m_resources.meshes().releaseMesh(handle);
+}
+
 const MeshGpu *Renderer::get(MeshHandle handle) const {
   return m_resources.meshes().get(handle);
 }
 
+bool Renderer::writeVmaStatsJson(const std::filesystem::path &path) const {
+  if (m_ctx == nullptr) {
+    LOGE("writeVmaStatsJson called before init");
+    return false;
+  }
+
+  return profiling::writeVmaStatsJson(m_ctx->allocator(), path);
+}
+
 TextureHandle Renderer::createTextureFromFile(const std::string &path,
                                               bool flipY) {
   return m_resources.materials().createTextureFromFile(path, flipY);
 }
 
+TextureHandle Renderer::loadTextureAsync(const std::string &path,
+                                         bool flipY) {
+  return m_resources.materials().loadTextureAsync(path, flipY);
+}
+
+TextureHandle Renderer::acquireTexture(const std::string &path, bool flipY) {
+  return m_resources.materials().acquireTexture(path, flipY);
+}
+
+void Renderer::releaseTexture(TextureHandle texture) {
+  m_resources.materials().releaseTexture(texture);
+}
+
 uint32_t Renderer::createMaterialFromTexture(TextureHandle handle) {
   return m_resources.materials().createMaterialFromTexture(handle);
 }
@@ -586,6 +719,14 @@ bool Renderer::createTextureFromImage(const engine::ImageData &img,
   return m_resources.materials().createTextureFromImage(img, outTex);
 }
 
+void Renderer::setTextureStreamingBudget(VkDeviceSize bytes) {
+  m_resources.materials().setTextureStreamingBudget(bytes);
+}
+
+bool Renderer::setTextureCompression(engine::TextureFormat format) {
+  return m_resources.materials().setTextureCompression(format);
+}
+
 void Renderer::setActiveMaterial(uint32_t materialIndex) {
   m_resources.materials().setActiveMaterial(materialIndex);
 }
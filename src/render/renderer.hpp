@@ -2,6 +2,7 @@
 
 #include "backend/frame/vk_commands.hpp"
 #include "backend/frame/vk_frame_manager.hpp"
+#include "backend/graphics/vk_pipeline_cache.hpp"
 #include "backend/presentation/vk_presenter.hpp"
 
 #include "backend/profiling/cpu_profiler.hpp"
@@ -9,6 +10,7 @@
 #include "backend/profiling/upload_profiler.hpp"
 #include "backend/profiling/vk_gpu_profiler.hpp"
 
+#include "render/frame_arena.hpp"
 #include "render/rendergraph/main_pass.hpp"
 #include "render/rendergraph/swapchain_targets.hpp"
 
@@ -21,9 +23,12 @@
 #include "render/upload/upload_manager.hpp"
 
 #include "backend/gpu/descriptors/vk_shader_interface.hpp"
+#include "engine/assets/texture_format.hpp"
 #include "engine/camera/camera_ubo.hpp"
+#include "engine/jobs/job_system.hpp"
 
 #include <cstdint>
+#include <filesystem>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <span>
@@ -66,10 +71,14 @@ public:
 
     m_targets = std::move(other.m_targets);
     m_interface = std::move(other.m_interface);
+    m_pipelineCache = std::move(other.m_pipelineCache);
     m_mainPass = std::move(other.m_mainPass);
+    m_pipelineFlagsRevision =
+        std::exchange(other.m_pipelineFlagsRevision, kNoRevision);
 
     m_commands = std::move(other.m_commands);
     m_frames = std::move(other.m_frames);
+    m_frameArenas = std::move(other.m_frameArenas);
     m_scene = std::move(other.m_scene);
 
     m_resources = std::move(other.m_resources);
@@ -87,7 +96,10 @@ public:
     return *this;
   }
 
-  bool init(VkBackendCtx &ctx, VkPresenter &presenter, uint32_t framesInFlight,
+  // jobs decodes textures and compiles pipelines, it must outlive
+  // shutdown()
+  bool init(VkBackendCtx &ctx, VkPresenter &presenter,
+            engine::jobs::JobSystem &jobs, uint32_t framesInFlight,
             const std::string &vertSpvPath, const std::string &fragSpvPath);
   void shutdown() noexcept;
 
@@ -105,24 +117,55 @@ public:
   MeshHandle createMesh(const engine::Vertex *vertices, uint32_t vertexCount,
                         const uint32_t *indices, uint32_t indexCount);
   MeshHandle createMesh(const engine::MeshData &mesh);
+  // Content-deduplicated and refcounted, see MeshStore
+  MeshHandle acquireMesh(const engine::MeshData &mesh);
+  MeshHandle acquireMesh(const engine::Vertex *vertices, uint32_t vertexCount,
+                         const uint32_t *indices, uint32_t indexCount,
+                         uint64_t hash);
+  void releaseMesh(MeshHandle handle);
   [[nodiscard]] const MeshGpu *get(MeshHandle handle) const;
 
   // Materials
   TextureHandle createTextureFromFile(const std::string &path, bool flipY);
+  // Decoded off-thread, sampled as the default texture until uploaded
+  TextureHandle loadTextureAsync(const std::string &path, bool flipY);
+  // Path and content deduplicated and refcounted, see MaterialSystem
+  TextureHandle acquireTexture(const std::string &path, bool flipY);
+  void releaseTexture(TextureHandle texture);
   bool createTextureFromImage(const engine::ImageData &img,
                               VkTexture2D &outTex);
 
   uint32_t createMaterialFromTexture(TextureHandle textureHandle);
   uint32_t createMaterialFromBaseColorFactor(const glm::vec4 &factor);
   void setActiveMaterial(uint32_t materialIndex);
+  void setTextureStreamingBudget(VkDeviceSize bytes);
+  bool setTextureCompression(engine::TextureFormat format);
   bool updateMaterialGPU(uint32_t materialId, const MaterialGPU &gpu);
 
   bool beginUpload(uint32_t frameIndex);
   bool endUpload(bool wait);
 
+  // Stats of the last finished frame
+  [[nodiscard]] const CpuProfiler &cpuProfiler() const noexcept {
+    return m_cpuProfiler;
+  }
+  [[nodiscard]] const VkGpuProfiler &gpuProfiler() const noexcept {
+    return m_gpuProfiler;
+  }
+  [[nodiscard]] const UploadProfiler &uploadProfiler() const noexcept {
+    return m_uploadProfiler;
+  }
+
+  // VMA's detailed heap and allocation dump, per-tag totals live in
+  // profiling::MemoryTracker
+  bool writeVmaStatsJson(const std::filesystem::path &path) const;
+
   // TODO: make PImpl
 private:
   bool createDefaultMaterial() noexcept;
+  // Registers a main pass variant per material flag set, so recording only
+  // looks pipeline ids up
+  void requestPipelineVariants();
 
   void recordFrame(VkCommandBuffer cmd, VkPresenter &presenter,
                    const SwapchainTargets &targets, uint32_t imageIndex,
@@ -143,11 +186,16 @@ private:
 
   SwapchainTargets m_targets;
   VkShaderInterface m_interface;
+  VkPipelineCacheStore m_pipelineCache;
   MainPass m_mainPass;
+  // Material flags revision the variants were last requested for
+  static constexpr uint64_t kNoRevision = UINT64_MAX;
+  uint64_t m_pipelineFlagsRevision = kNoRevision;
 
   VkCommands m_commands;
   UploadManager m_uploads;
   VkFrameManager m_frames;
+  FrameArenas m_frameArenas;
   SceneData m_scene;
 
   ResourceStore m_resources;
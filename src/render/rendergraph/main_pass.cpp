@@ -7,8 +7,12 @@ bool MainPass::init(VkBackendCtx &ctx, VkPresenter &presenter,
                     const SwapchainTargets &targets,
                     const VkShaderInterface &interface,
                     const std::string &vertSpvPath,
-                    const std::string &fragSpvPath) {
+                    const std::string &fragSpvPath,
+                    engine::jobs::JobSystem &jobs,
+                    VkPipelineCache pipelineCache) {
   shutdown();
+  m_pipelineCache = pipelineCache;
+  m_jobs = &jobs;
 
   const VkFormat colorFmt = presenter.colorFormat();
   const VkFormat depthFmt = targets.depthFormat();
@@ -17,8 +21,14 @@ bool MainPass::init(VkBackendCtx &ctx, VkPresenter &presenter,
     return false;
   }
 
-  if (!rebuild(ctx, colorFmt, depthFmt, interface.pipelineLayout(), vertSpvPath,
-               fragSpvPath)) {
+  if (!m_pipelines.init(ctx.device(), interface.pipelineLayout(), vertSpvPath,
+                        fragSpvPath, jobs, m_pipelineCache)) {
+    std::cerr << "[MainPass] pipeline library init failed\n";
+    shutdown();
+    return false;
+  }
+
+  if (!rebuild(colorFmt, depthFmt)) {
     shutdown();
     return false;
   }
@@ -28,7 +38,7 @@ bool MainPass::init(VkBackendCtx &ctx, VkPresenter &presenter,
 }
 
 void MainPass::shutdown() noexcept {
-  m_pipeline.shutdown();
+  m_pipelines.shutdown();
   m_lastColorFormat = VK_FORMAT_UNDEFINED;
   m_lastDepthFormat = VK_FORMAT_UNDEFINED;
   m_initialized = false;
@@ -40,7 +50,12 @@ bool MainPass::recreateIfNeeded(VkBackendCtx &ctx, VkPresenter &presenter,
                                 const std::string &vertSpvPath,
                                 const std::string &fragSpvPath) {
   if (!m_initialized) {
-    return init(ctx, presenter, targets, interface, vertSpvPath, fragSpvPath);
+    if (m_jobs == nullptr) {
+      std::cerr << "[MainPass] recreate before init\n";
+      return false;
+    }
+    return init(ctx, presenter, targets, interface, vertSpvPath, fragSpvPath,
+                *m_jobs, m_pipelineCache);
   }
 
   const VkFormat newColorFmt = presenter.colorFormat();
@@ -59,21 +74,12 @@ bool MainPass::recreateIfNeeded(VkBackendCtx &ctx, VkPresenter &presenter,
     return true;
   }
 
-  return rebuild(ctx, newColorFmt, newDepthFmt, interface.pipelineLayout(),
-                 vertSpvPath, fragSpvPath);
+  return rebuild(newColorFmt, newDepthFmt);
 }
 
-bool MainPass::rebuild(VkBackendCtx &ctx, VkFormat colorFormat,
-                       VkFormat depthFormat, VkPipelineLayout layout,
-                       const std::string &vertSpvPath,
-                       const std::string &fragSpvPath) {
-
-  VkDevice device = ctx.device();
-
-  m_pipeline.shutdown();
-
-  if (!m_pipeline.init(device, colorFormat, depthFormat, layout, vertSpvPath,
-                       fragSpvPath)) {
+bool MainPass::rebuild(VkFormat colorFormat, VkFormat depthFormat) {
+  // Shaders stay loaded, only the target formats change
+  if (!m_pipelines.setTargetFormats(colorFormat, depthFormat)) {
     std::cerr << "[MainPass] graphics pipeline init failed\n";
     shutdown();
     return false;
@@ -2,13 +2,14 @@
 
 #include "backend/core/vk_backend_ctx.hpp"
 #include "backend/gpu/descriptors/vk_shader_interface.hpp"
-#include "backend/graphics/vk_pipeline.hpp"
+#include "backend/graphics/vk_pipeline_library.hpp"
 #include "backend/presentation/vk_presenter.hpp"
+#include "engine/jobs/job_system.hpp"
 #include "render/rendergraph/swapchain_targets.hpp"
 
 #include <vulkan/vulkan_core.h>
 
-/// Owns the primary scene and graphics pipeline
+/// Owns the primary scene and its pipeline permutations
 class MainPass {
 public:
   MainPass() = default;
@@ -20,9 +21,12 @@ public:
   MainPass(MainPass &&) noexcept = default;
   MainPass &operator=(MainPass &&) noexcept = default;
 
+  // Variants compile on jobs, which must outlive shutdown()
   bool init(VkBackendCtx &ctx, VkPresenter &presenter,
             const SwapchainTargets &targets, const VkShaderInterface &interface,
-            const std::string &vertSpvPath, const std::string &fragSpvPath);
+            const std::string &vertSpvPath, const std::string &fragSpvPath,
+            engine::jobs::JobSystem &jobs,
+            VkPipelineCache pipelineCache = VK_NULL_HANDLE);
   void shutdown() noexcept;
 
   bool recreateIfNeeded(VkBackendCtx &ctx, VkPresenter &presenter,
@@ -31,18 +35,30 @@ public:
                         const std::string &vertSpvPath,
                         const std::string &fragSpvPath);
 
-  [[nodiscard]] VkPipeline pipeline() const { return m_pipeline.pipeline(); }
+  // Fallback pipeline, used by variants that are still compiling
+  [[nodiscard]] VkPipeline pipeline() const { return m_pipelines.fallback(); }
+  [[nodiscard]] VkPipeline pipeline(uint32_t id) const {
+    return m_pipelines.pipeline(id);
+  }
+  // Registers key, its variant compiles in the background. Allocates the
+  // first time a key is seen, so call it outside of recording.
+  uint32_t requestPipeline(PipelineKey key) { return m_pipelines.request(key); }
+  // Stable id of a requested key, the fallback's for unknown keys
+  [[nodiscard]] uint32_t pipelineId(PipelineKey key) const noexcept {
+    return m_pipelines.find(key);
+  }
+  void collectPipelines() { m_pipelines.collect(); }
 
   [[nodiscard]] VkFormat colorFormat() const { return m_lastColorFormat; }
   [[nodiscard]] VkFormat depthFormat() const { return m_lastDepthFormat; }
 
 private:
-  /// Recreate pipeline if color format or depth format changes
-  bool rebuild(VkBackendCtx &ctx, VkFormat colorFormat, VkFormat depthFormat,
-               VkPipelineLayout layout, const std::string &vertSpvPath,
-               const std::string &fragSpvPath);
+  /// Recreate pipelines if color format or depth format changes
+  bool rebuild(VkFormat colorFormat, VkFormat depthFormat);
 
-  VkGraphicsPipeline m_pipeline;
+  VkPipelineLibrary m_pipelines;
+  VkPipelineCache m_pipelineCache = VK_NULL_HANDLE; // non-owning
+  engine::jobs::JobSystem *m_jobs = nullptr;        // non-owning
 
   VkFormat m_lastColorFormat = VK_FORMAT_UNDEFINED;
   VkFormat m_lastDepthFormat = VK_FORMAT_UNDEFINED;
@@ -7,6 +7,10 @@
 struct MaterialGPU {
   static constexpr uint32_t kNoTexture = 0xFFFFFFFFU;
 
+  // flags.x bits, they also select the pipeline variant
+  static constexpr uint32_t kFlagAlphaMask = 1U << 0;
+  static constexpr uint32_t kFlagDoubleSided = 1U << 1;
+
   glm::vec4 baseColorFactor{1.0F}; // rgba
   glm::vec4 emissiveFactor{0.0F};  // rgb, w unused
 
@@ -20,7 +24,7 @@ struct MaterialGPU {
   // x=emissive, y/z/w reserved
   glm::uvec4 tex1{kNoTexture, kNoTexture, kNoTexture, kNoTexture};
 
-  // flags (alpha mode, double-sided, etc.)
+  // x=kFlag* bits, y/z/w reserved
   glm::uvec4 flags{0U, 0U, 0U, 0U};
 };
 
@@ -1,17 +1,37 @@
 #include "render/resources/material_system.hpp"
 
+#include "backend/gpu/textures/vk_texture_utils.hpp"
 #include "backend/gpu/upload/vk_upload_context.hpp"
 #include "backend/profiling/upload_profiler.hpp"
-#include "engine/assets/stb_image/stb_image_loader.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/texture_format.hpp"
+#include "engine/logging/log.hpp"
 #include "render/resources/material_gpu.hpp"
+#include "render/resources/texture_loader.hpp"
+#include "render/resources/texture_streamer.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Render.Materials");
+#define LOG_TU_LOGGER() ThisLogger()
+
 namespace {
 
+// Each change recreates one texture, keep the per-frame work bounded
+constexpr uint32_t kMaxStreamChangesPerFrame = 8;
+
+// Clamped to the device limit, 8x is where the quality gain flattens out
+constexpr float kRequestedMaxAnisotropy = 8.0F;
+
 uint32_t clampMateriaCapacity(VkPhysicalDevice physicalDevice,
                               uint32_t requested) noexcept {
   VkPhysicalDeviceProperties props{};
@@ -26,26 +46,62 @@ uint32_t clampMateriaCapacity(VkPhysicalDevice physicalDevice,
   return std::min(requested, maxSampled);
 }
 
+VkFormat toVkFormat(engine::TextureFormat format, bool srgb) noexcept {
+  switch (format) {
+  case engine::TextureFormat::RGBA8:
+    return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+  case engine::TextureFormat::BC1:
+    return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+  case engine::TextureFormat::BC3:
+    return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+  case engine::TextureFormat::BC5:
+    return VK_FORMAT_BC5_UNORM_BLOCK;
+  case engine::TextureFormat::BC7:
+    return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+  }
+
+  return VK_FORMAT_UNDEFINED;
+}
+
 } // namespace
 
 bool MaterialSystem::init(VkBackendCtx &ctx, VkUploadContext &upload,
+                          engine::jobs::JobSystem &jobs,
                           VkDescriptorSetLayout materialSetLayout,
                           uint32_t materialCapacity, UploadProfiler *profiler) {
   shutdown();
 
   m_uploaderProfiler = profiler;
+  m_framesInFlight = upload.framesInflight();
+  // Streaming gets half of the static lane, finishing loads a quarter
+  m_loadBytesPerFrame = upload.perFrameBytes() / 4;
+  m_physicalDevice = ctx.physicalDevice();
+  m_bcSupported = ctx.enabledFeatures().textureCompressionBC == VK_TRUE;
+
+  // Leave the other half of the lane for regular static uploads. Larger
+  // promotions are streamed from what the lane has left each frame.
+  m_streamBytesPerFrame = upload.perFrameBytes() / 2;
+  m_streamer.setUploadBytesPerFrame(m_streamBytesPerFrame);
 
   VkDevice device = ctx.device();
   VmaAllocator allocator = ctx.allocator();
 
   if (!m_textureUploader.init(allocator, device, &upload, m_uploaderProfiler)) {
-    std::cerr << "[MaterialSystem] Failed to init texture uploader\n";
+    LOGE("Failed to init texture uploader");
     shutdown();
     return false;
   }
 
+  VkPhysicalDeviceProperties props{};
+  vkGetPhysicalDeviceProperties(ctx.physicalDevice(), &props);
+  m_textureUploader.setMaxAnisotropy(
+      ctx.enabledFeatures().samplerAnisotropy == VK_TRUE
+          ? std::min(kRequestedMaxAnisotropy,
+                     props.limits.maxSamplerAnisotropy)
+          : 1.0F);
+
   if (!m_materialUploader.init(&upload, m_uploaderProfiler)) {
-    std::cerr << "[MaterialSystem] Failed to init material uploader\n";
+    LOGE("Failed to init material uploader");
     shutdown();
     return false;
   }
@@ -54,13 +110,21 @@ bool MaterialSystem::init(VkBackendCtx &ctx, VkUploadContext &upload,
       clampMateriaCapacity(ctx.physicalDevice(), materialCapacity);
 
   if (cappedCapacity == 0) {
-    std::cerr << "[MaterialSystem] Material capacity invalid after clamp\n";
+    LOGE("Material capacity invalid after clamp");
     shutdown();
     return false;
   }
 
   if (!m_materialSets.init(device, materialSetLayout, materialCapacity)) {
-    std::cerr << "[MaterialSystem] Failed to init material sets\n";
+    LOGE("Failed to init material sets");
+    shutdown();
+    return false;
+  }
+
+  m_jobs = &jobs;
+  m_textureLoader = std::make_unique<TextureLoader>();
+  if (!m_textureLoader->init(jobs)) {
+    LOGE("Failed to init texture loader");
     shutdown();
     return false;
   }
@@ -69,7 +133,31 @@ bool MaterialSystem::init(VkBackendCtx &ctx, VkUploadContext &upload,
 }
 
 void MaterialSystem::shutdown() noexcept {
+  m_textureLoader.reset(); // waits for running decodes
+  m_jobs = nullptr;
+  m_loadResults.clear();
+  m_loadBytesPerFrame = 0;
+
+  releaseRetired(/*all=*/true);
   m_materialSets.shutdown();
+  m_materialTextures.clear();
+  m_materialFlags.clear();
+  ++m_materialFlagsRevision;
+
+  m_textureRecords.clear();
+  m_textureByKey.clear();
+  m_textureByHash.clear();
+
+  for (PendingResidency &pending : m_pendingResidency) {
+    pending.next.shutdown();
+  }
+  m_pendingResidency.clear();
+  m_streamBytesPerFrame = 0;
+
+  m_streamer.reset();
+  m_streamChanges.clear();
+  m_streamFrame = 0;
+  m_framesInFlight = 0;
 
   // Textures
   for (auto &texture : m_textures) {
@@ -86,25 +174,44 @@ void MaterialSystem::shutdown() noexcept {
   m_defaultMaterial = UINT32_MAX;
   m_activeMaterial = UINT32_MAX;
 
+  m_physicalDevice = VK_NULL_HANDLE;
+  m_bcSupported = false;
+  m_textureCompression = engine::TextureFormat::RGBA8;
+
   m_uploaderProfiler = nullptr;
 }
 
+bool MaterialSystem::setTextureCompression(engine::TextureFormat format) {
+  // Color textures are sampled as sRGB
+  if (format == engine::TextureFormat::RGBA8 ||
+      (m_bcSupported &&
+       vkSupportsSampledFormat(m_physicalDevice, toVkFormat(format, true)))) {
+    m_textureCompression = format;
+    return true;
+  }
+
+  LOGW("{} textures unsupported on this device, keeping RGBA8",
+       engine::textureFormatName(format));
+  m_textureCompression = engine::TextureFormat::RGBA8;
+  return false;
+}
+
 bool MaterialSystem::createDefaultMaterial() noexcept {
   VkTexture2D tex;
 
   static constexpr std::array<std::uint8_t, 4> kWhiteRGBA8{255, 255, 255, 255};
 
   if (!m_textureUploader.uploadRGBA8(kWhiteRGBA8.data(), 1, 1, tex)) {
-    std::cerr << "[MaterialSystem] Failed to create default white texture\n";
+    LOGE("Failed to create default white texture");
     return false;
   }
 
-  m_textures.push_back(std::move(tex));
-  m_whiteTexture = TextureHandle{static_cast<uint32_t>(m_textures.size() - 1)};
+  m_whiteTexture = TextureHandle{addTextureSlot()};
+  m_textures[m_whiteTexture.id] = std::move(tex);
 
   m_defaultMaterial = createMaterialFromTexture(m_whiteTexture);
   if (m_defaultMaterial == UINT32_MAX) {
-    std::cerr << "[MaterialSystem] Failed to create default material\n";
+    LOGE("Failed to create default material");
     return false;
   }
 
@@ -112,61 +219,314 @@ bool MaterialSystem::createDefaultMaterial() noexcept {
   return true;
 }
 
+bool MaterialSystem::canSample(const engine::MipChain &chain) const {
+  if (!engine::isBlockCompressed(chain.format)) {
+    return true;
+  }
+
+  return m_bcSupported &&
+         vkSupportsSampledFormat(m_physicalDevice,
+                                 toVkFormat(chain.format, chain.srgb));
+}
+
+bool MaterialSystem::uploadChainLevels(const engine::MipChain &chain,
+                                       uint32_t firstLevel, uint32_t count,
+                                       VkTexture2D &tex) {
+  std::array<const uint8_t *, VkUploadContext::kMaxMipLevels> levels{};
+  if (count > levels.size()) {
+    LOGE("Too many mip levels: {}", count);
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    levels[i] = chain.levelData(firstLevel + i);
+  }
+
+  return m_textureUploader.uploadMips(std::span(levels.data(), count), 0, tex);
+}
+
+bool MaterialSystem::createTextureFromChain(engine::MipChain &&chain,
+                                            uint32_t texture) {
+  // Only the tail is resident up front, the streamer promotes the rest
+  const uint32_t tailBase = TextureStreamer::tailBase(chain);
+  const engine::MipLevel &base = chain.levels[tailBase];
+
+  VkTexture2D tex;
+  if (!m_textureUploader.create(base.width, base.height,
+                                chain.levelCount() - tailBase,
+                                toVkFormat(chain.format, chain.srgb), tex)) {
+    LOGE("Failed to create texture");
+    return false;
+  }
+
+  // The whole tail goes in one copy
+  if (!uploadChainLevels(chain, tailBase, chain.levelCount() - tailBase,
+                         tex)) {
+    LOGE("Failed to upload texture mip tail");
+    tex.shutdown();
+    return false;
+  }
+
+  m_textures[texture] = std::move(tex);
+
+  if (tailBase > 0) {
+    m_streamer.track(texture, std::move(chain), tailBase);
+  }
+
+  return true;
+}
+
 TextureHandle MaterialSystem::createTextureFromFile(const std::string &path,
                                                     bool flipY) {
-  engine::ImageData img;
-  if (!engine::assets::loadImageRGBA8(path, img, flipY)) {
-    std::cerr << "[MaterialSystem] Failed to load image: " << path << "\n";
+  engine::MipChain chain;
+  if (!TextureLoader::decode(path, flipY, m_textureCompression,
+                             m_jobs, chain)) {
+    LOGE("Failed to load texture: {}", path);
     return {};
   }
 
-  VkTexture2D tex;
-  if (!m_textureUploader.uploadRGBA8(img.pixels.data(), img.width, img.height,
-                                     tex)) {
-    std::cerr << "[MaterialSystem] Failed to create texture from file\n";
+  if (!canSample(chain)) {
+    LOGE("{} unsupported on this device: {}",
+         engine::textureFormatName(chain.format), path);
+    return {};
+  }
+
+  const TextureHandle handle{addTextureSlot()};
+
+  if (!createTextureFromChain(std::move(chain), handle.id)) {
+    m_textures.pop_back();
+    m_textureRecords.pop_back();
     return {};
   }
 
-  m_textures.push_back(std::move(tex));
-  return TextureHandle{static_cast<uint32_t>(m_textures.size() - 1)};
+  return handle;
+}
+
+TextureHandle MaterialSystem::loadTextureAsync(const std::string &path,
+                                               bool flipY) {
+  if (!m_textureLoader) {
+    LOGE("Texture loader not initialized");
+    return {};
+  }
+
+  const TextureHandle handle{addTextureSlot()};
+
+  TextureLoadRequest request;
+  request.texture = handle.id;
+  request.path = path;
+  request.flipY = flipY;
+  request.compression = m_textureCompression;
+  m_textureLoader->submit(std::move(request));
+
+  return handle;
+}
+
+TextureHandle MaterialSystem::acquireTexture(const std::string &path,
+                                             bool flipY) {
+  if (!m_textureLoader) {
+    LOGE("Texture loader not initialized");
+    return {};
+  }
+
+  std::string key = path;
+  key += flipY ? "|flip" : "|noflip";
+
+  if (auto it = m_textureByKey.find(key); it != m_textureByKey.end()) {
+    ++m_textureRecords[it->second].refs;
+    return TextureHandle{it->second};
+  }
+
+  const TextureHandle handle{addTextureSlot()};
+  m_textureRecords[handle.id].key = key;
+  m_textureByKey.emplace(std::move(key), handle.id);
+
+  TextureLoadRequest request;
+  request.texture = handle.id;
+  request.path = path;
+  request.flipY = flipY;
+  request.compression = m_textureCompression;
+  request.hashContent = true;
+  m_textureLoader->submit(std::move(request));
+
+  return handle;
+}
+
+void MaterialSystem::releaseTexture(TextureHandle texture) {
+  if (texture.id >= m_textureRecords.size() ||
+      texture.id == m_whiteTexture.id ||
+      m_textureRecords[texture.id].refs == 0) {
+    LOGW("releaseTexture on an invalid handle");
+    return;
+  }
+
+  TextureRecord &record = m_textureRecords[texture.id];
+  if (--record.refs > 0) {
+    return;
+  }
+
+  if (auto it = m_textureByKey.find(record.key);
+      it != m_textureByKey.end() && it->second == texture.id) {
+    m_textureByKey.erase(it);
+  }
+  if (auto it = m_textureByHash.find(record.contentHash);
+      it != m_textureByHash.end() && it->second == texture.id) {
+    m_textureByHash.erase(it);
+  }
+  record.key.clear();
+
+  if (record.alias != UINT32_MAX) {
+    // Materials were moved to the alias target when the load finished
+    releaseTexture(TextureHandle{std::exchange(record.alias, UINT32_MAX)});
+    return;
+  }
+
+  // Slots are not reused, the handle stays dead. The slot is reset since a
+  // moved-from VkTexture2D keeps its view and sampler.
+  cancelStreamedResidency(texture.id);
+  m_streamer.untrack(texture.id);
+  VkTexture2D released = std::exchange(m_textures[texture.id], {});
+  if (!moveTextureMaterials(texture.id, m_whiteTexture.id,
+                            std::move(released))) {
+    LOGW("Out of material sets, materials of texture {} keep sampling it",
+         texture.id);
+    m_textures[texture.id] = std::move(released);
+  }
+}
+
+void MaterialSystem::processTextureLoads() {
+  if (!m_textureLoader) {
+    return; // not initialized or moved from
+  }
+
+  m_textureLoader->drain(m_loadResults);
+
+  VkDeviceSize budget = m_loadBytesPerFrame;
+  uint32_t finalized = 0;
+  size_t done = 0;
+
+  for (; done < m_loadResults.size(); ++done) {
+    TextureLoadResult &result = m_loadResults[done];
+    if (m_textureRecords[result.texture].refs == 0) {
+      continue; // released while loading
+    }
+
+    if (!result.chain.valid() || !canSample(result.chain)) {
+      LOGW("Failed to load texture: {}, keeping default texture",
+           result.path);
+      // Holders keep the default, the next acquire of the path retries
+      TextureRecord &record = m_textureRecords[result.texture];
+      if (auto it = m_textureByKey.find(record.key);
+          it != m_textureByKey.end() && it->second == result.texture) {
+        m_textureByKey.erase(it);
+      }
+      record.key.clear();
+      continue;
+    }
+
+    // Another path decoded to the same texels, share its image
+    if (auto it = m_textureByHash.find(result.contentHash);
+        result.contentHash != 0 && it != m_textureByHash.end() &&
+        moveTextureMaterials(result.texture, it->second, {})) {
+      m_textureRecords[result.texture].alias = it->second;
+      ++m_textureRecords[it->second].refs;
+      continue;
+    }
+
+    // Always take at least one so a large tail cannot stall the queue
+    const VkDeviceSize bytes =
+        result.chain.bytesFrom(TextureStreamer::tailBase(result.chain));
+    if (finalized > 0 && bytes > budget) {
+      break;
+    }
+    budget -= std::min(bytes, budget);
+
+    if (!createTextureFromChain(std::move(result.chain), result.texture)) {
+      continue;
+    }
+
+    if (result.contentHash != 0 &&
+        m_textureByHash.try_emplace(result.contentHash, result.texture)
+            .second) {
+      m_textureRecords[result.texture].contentHash = result.contentHash;
+    }
+
+    ++finalized;
+    rebindTextureMaterials(result.texture);
+  }
+
+  m_loadResults.erase(m_loadResults.begin(),
+                      m_loadResults.begin() + static_cast<ptrdiff_t>(done));
+}
+
+bool MaterialSystem::textureReady(TextureHandle texture) const noexcept {
+  const uint32_t id = resolveTexture(texture.id);
+  return id < m_textures.size() && m_textures[id].valid();
+}
+
+uint32_t MaterialSystem::addTextureSlot() {
+  m_textures.emplace_back();
+  m_textureRecords.emplace_back();
+  return static_cast<uint32_t>(m_textures.size() - 1);
+}
+
+uint32_t MaterialSystem::resolveTexture(uint32_t texture) const noexcept {
+  // Alias targets are never aliases themselves
+  if (texture < m_textureRecords.size() &&
+      m_textureRecords[texture].alias != UINT32_MAX) {
+    return m_textureRecords[texture].alias;
+  }
+
+  return texture;
 }
 
 bool MaterialSystem::createTextureFromImage(const engine::ImageData &img,
                                             VkTexture2D &outTex) {
   if (!img.valid()) {
-    std::cerr << "[MaterialSystem] createTextureFromImage invalid image\n";
+    LOGE("createTextureFromImage invalid image");
     return false;
   }
 
   const size_t expected = size_t(img.width) * img.height * 4ULL;
   if (img.pixels.size() != expected) {
-    std::cerr << "[MaterialSystem] Image byte size mismatch: have="
-              << img.pixels.size() << " expected=" << expected << "\n";
+    LOGE("Image byte size mismatch: have={} expected={}", img.pixels.size(),
+         expected);
     return false;
   }
 
   return m_textureUploader.uploadRGBA8(img.pixels.data(), img.width, img.height,
-                                       outTex);
+                                       outTex, /*generateMips=*/true);
 }
 
 uint32_t
 MaterialSystem::createMaterialFromTexture(TextureHandle textureHandle) {
-  if (textureHandle.id >= m_textures.size() ||
-      !m_textures[textureHandle.id].valid()) {
-    std::cerr << "[MaterialSystem] Invalid texture handle\n";
+  textureHandle.id = resolveTexture(textureHandle.id);
+  if (textureHandle.id >= m_textures.size()) {
+    LOGE("Invalid texture handle");
     return UINT32_MAX;
   }
 
-  const uint32_t id =
-      m_materialSets.allocateForTexture(m_textures[textureHandle.id]);
+  // Textures still loading sample white until processTextureLoads()
+  const VkTexture2D *texture = &m_textures[textureHandle.id];
+  if (!texture->valid() && m_whiteTexture.id < m_textures.size()) {
+    texture = &m_textures[m_whiteTexture.id];
+  }
+
+  if (!texture->valid()) {
+    LOGE("Invalid texture handle");
+    return UINT32_MAX;
+  }
+
+  const uint32_t id = m_materialSets.allocateForTexture(*texture);
   if (id == UINT32_MAX) {
     return UINT32_MAX;
   }
 
+  setMaterialTexture(id, textureHandle);
+
   MaterialGPU gpu;
 
   if (!writeMaterialGPU(id, gpu)) {
-    std::cerr << "[MaterialSystem] Failed to write material GPU table\n";
+    LOGE("Failed to write material GPU table");
     return UINT32_MAX;
   }
 
@@ -178,7 +538,7 @@ MaterialSystem::createMaterialFromBaseColorFactor(const glm::vec4 &factor) {
   if (m_whiteTexture.id == UINT32_MAX ||
       m_whiteTexture.id >= m_textures.size() ||
       !m_textures[m_whiteTexture.id].valid()) {
-    std::cerr << "[MaterialSystem] White texture not available\n";
+    LOGE("White texture not available");
     return UINT32_MAX;
   }
 
@@ -188,11 +548,13 @@ MaterialSystem::createMaterialFromBaseColorFactor(const glm::vec4 &factor) {
     return UINT32_MAX;
   }
 
+  setMaterialTexture(id, m_whiteTexture);
+
   MaterialGPU gpu{};
   gpu.baseColorFactor = factor;
 
   if (!writeMaterialGPU(id, gpu)) {
-    std::cerr << "[MaterialSystem] Failed to write material GPU table\n";
+    LOGE("Failed to write material GPU table");
     return UINT32_MAX;
   }
 
@@ -231,15 +593,23 @@ void MaterialSystem::bindMaterialTable(VkBuffer materialTableBuffer,
 bool MaterialSystem::writeMaterialGPU(uint32_t materialId,
                                       const MaterialGPU &gpu) {
   if (m_materialTable == VK_NULL_HANDLE) {
-    std::cerr << "[MaterialSystem] Material table not bound\n";
+    LOGE("Material table not bound");
     return false;
   }
 
   if (materialId == UINT32_MAX || materialId >= m_materialTableCapacity) {
-    std::cerr << "[MaterialSystem] Material id out of range\n";
+    LOGE("Material id out of range");
     return false;
   }
 
+  if (materialId >= m_materialFlags.size()) {
+    m_materialFlags.resize(size_t(materialId) + 1, 0U);
+  }
+  if (m_materialFlags[materialId] != gpu.flags.x) {
+    m_materialFlags[materialId] = gpu.flags.x;
+    ++m_materialFlagsRevision;
+  }
+
   const VkDeviceSize dstOffset = VkDeviceSize(materialId) * sizeof(MaterialGPU);
   return m_materialUploader.uploadOne(m_materialTable, dstOffset, gpu);
 }
@@ -248,3 +618,266 @@ bool MaterialSystem::updateMaterialGPU(uint32_t materialId,
                                        const MaterialGPU &gpu) {
   return writeMaterialGPU(materialId, gpu);
 }
+
+void MaterialSystem::setMaterialTexture(uint32_t materialId,
+                                        TextureHandle texture) {
+  if (materialId >= m_materialTextures.size()) {
+    m_materialTextures.resize(size_t(materialId) + 1, UINT32_MAX);
+  }
+
+  m_materialTextures[materialId] = texture.id;
+}
+
+void MaterialSystem::requestTextureDensity(uint32_t materialId,
+                                           float screenPixels) noexcept {
+  if (materialId >= m_materialTextures.size()) {
+    return;
+  }
+
+  m_streamer.request(m_materialTextures[materialId], screenPixels);
+}
+
+void MaterialSystem::updateStreaming() {
+  ++m_streamFrame;
+  releaseRetired(/*all=*/false);
+  finishStreamedResidency();
+
+  m_streamer.plan(m_streamChanges, kMaxStreamChangesPerFrame);
+
+  for (const TextureResidencyChange &change : m_streamChanges) {
+    if (applyResidency(change)) {
+      m_streamer.commit(change);
+    }
+  }
+}
+
+bool MaterialSystem::applyResidency(const TextureResidencyChange &change) {
+  const engine::MipChain *chain = m_streamer.chain(change.texture);
+  if (chain == nullptr || change.texture >= m_textures.size()) {
+    return false;
+  }
+
+  const engine::MipLevel &top = chain->levels[change.newBase];
+  const uint32_t levelCount = chain->levelCount() - change.newBase;
+
+  VkTexture2D next;
+  if (!m_textureUploader.create(top.width, top.height, levelCount,
+                                toVkFormat(chain->format, chain->srgb),
+                                next)) {
+    return false;
+  }
+
+  if (change.newBase < change.oldBase) {
+    const VkDeviceSize bytes =
+        chain->bytesFrom(change.newBase) - chain->bytesFrom(change.oldBase);
+    if (bytes > m_streamBytesPerFrame) {
+      // Committed by finishStreamedResidency() once every chunk is recorded
+      (void)streamResidency(change, std::move(next));
+      return false;
+    }
+
+    // Finer levels come from the CPU chain, the rest from the current image
+    if (!uploadChainLevels(*chain, change.newBase,
+                           change.oldBase - change.newBase, next)) {
+      retire(std::move(next), {});
+      return false;
+    }
+  }
+
+  return finishResidency(change, next);
+}
+
+bool MaterialSystem::streamResidency(const TextureResidencyChange &change,
+                                     VkTexture2D &&next) {
+  const engine::MipChain *chain = m_streamer.chain(change.texture);
+
+  std::array<const uint8_t *, VkUploadContext::kMaxMipLevels> levels{};
+  const uint32_t count = change.oldBase - change.newBase;
+  for (uint32_t i = 0; i < count; ++i) {
+    levels[i] = chain->levelData(change.newBase + i);
+  }
+
+  // The chain stays with the streamer, which skips the texture meanwhile
+  const VkStreamHandle stream =
+      m_textureUploader.streamMips(std::span(levels.data(), count), 0, next);
+  if (stream.id == UINT32_MAX) {
+    next.shutdown();
+    return false;
+  }
+
+  m_streamer.setBusy(change.texture, true);
+
+  PendingResidency pending{};
+  pending.change = change;
+  pending.next = std::exchange(next, {});
+  pending.stream = stream;
+  m_pendingResidency.push_back(std::move(pending));
+  return true;
+}
+
+void MaterialSystem::finishStreamedResidency() {
+  for (size_t i = 0; i < m_pendingResidency.size();) {
+    PendingResidency &pending = m_pendingResidency[i];
+    if (!m_textureUploader.streamDone(pending.stream)) {
+      ++i;
+      continue;
+    }
+
+    m_streamer.setBusy(pending.change.texture, false);
+    if (finishResidency(pending.change, pending.next)) {
+      m_streamer.commit(pending.change);
+    }
+
+    if (i + 1 != m_pendingResidency.size()) {
+      pending = std::move(m_pendingResidency.back());
+    }
+    m_pendingResidency.pop_back();
+  }
+}
+
+void MaterialSystem::cancelStreamedResidency(uint32_t texture) noexcept {
+  for (size_t i = 0; i < m_pendingResidency.size(); ++i) {
+    PendingResidency &pending = m_pendingResidency[i];
+    if (pending.change.texture != texture) {
+      continue;
+    }
+
+    // Chunks already recorded may still be in flight
+    m_textureUploader.cancelStream(pending.stream);
+    m_streamer.setBusy(texture, false);
+    retire(std::exchange(pending.next, {}), {});
+
+    if (i + 1 != m_pendingResidency.size()) {
+      pending = std::move(m_pendingResidency.back());
+    }
+    m_pendingResidency.pop_back();
+    return;
+  }
+}
+
+bool MaterialSystem::finishResidency(const TextureResidencyChange &change,
+                                     VkTexture2D &next) {
+  const engine::MipChain *chain = m_streamer.chain(change.texture);
+  VkTexture2D &current = m_textures[change.texture];
+
+  std::vector<uint32_t> materials;
+  std::vector<VkDescriptorSet> sets;
+  if (chain == nullptr ||
+      !allocateTextureSets(change.texture, next, materials, sets)) {
+    retire(std::exchange(next, {}), {});
+    return false;
+  }
+
+  const uint32_t levelCount = chain->levelCount() - change.newBase;
+  if (change.newBase < change.oldBase) {
+    m_textureUploader.copyMips(current, 0, next,
+                               change.oldBase - change.newBase,
+                               chain->levelCount() - change.oldBase);
+  } else {
+    m_textureUploader.copyMips(current, change.newBase - change.oldBase, next,
+                               0, levelCount);
+  }
+
+  for (size_t i = 0; i < materials.size(); ++i) {
+    sets[i] = m_materialSets.exchange(materials[i], sets[i]);
+  }
+
+  retire(std::exchange(current, {}), std::move(sets));
+  current = std::exchange(next, {});
+  return true;
+}
+
+bool MaterialSystem::allocateTextureSets(uint32_t texture,
+                                         const VkTexture2D &tex,
+                                         std::vector<uint32_t> &materials,
+                                         std::vector<VkDescriptorSet> &sets) {
+  // Allocate every replacement set up front so the swap is all-or-nothing
+  for (uint32_t mat = 0; mat < m_materialTextures.size(); ++mat) {
+    if (m_materialTextures[mat] != texture) {
+      continue;
+    }
+
+    VkDescriptorSet set = m_materialSets.allocateSet(tex);
+    if (set == VK_NULL_HANDLE) {
+      for (VkDescriptorSet allocated : sets) {
+        m_materialSets.release(allocated);
+      }
+
+      materials.clear();
+      sets.clear();
+      return false;
+    }
+
+    materials.push_back(mat);
+    sets.push_back(set);
+  }
+
+  return true;
+}
+
+void MaterialSystem::rebindTextureMaterials(uint32_t texture) {
+  std::vector<uint32_t> materials;
+  std::vector<VkDescriptorSet> sets;
+  if (!allocateTextureSets(texture, m_textures[texture], materials, sets)) {
+    LOGW("Out of material sets, texture {} keeps the default texture",
+         texture);
+    return;
+  }
+
+  for (size_t i = 0; i < materials.size(); ++i) {
+    sets[i] = m_materialSets.exchange(materials[i], sets[i]);
+  }
+
+  // The old sets point at the white texture, which stays alive
+  retire(VkTexture2D{}, std::move(sets));
+}
+
+bool MaterialSystem::moveTextureMaterials(uint32_t from, uint32_t to,
+                                          VkTexture2D &&old) {
+  std::vector<uint32_t> materials;
+  std::vector<VkDescriptorSet> sets;
+  if (!allocateTextureSets(from, m_textures[to], materials, sets)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < materials.size(); ++i) {
+    sets[i] = m_materialSets.exchange(materials[i], sets[i]);
+    m_materialTextures[materials[i]] = to;
+  }
+
+  retire(std::move(old), std::move(sets));
+  return true;
+}
+
+void MaterialSystem::retire(VkTexture2D &&texture,
+                            std::vector<VkDescriptorSet> &&sets) {
+  RetiredTexture retired{};
+  retired.texture = std::move(texture);
+  retired.sets = std::move(sets);
+  // Frames already submitted may still reference it
+  retired.releaseFrame = m_streamFrame + m_framesInFlight + 1;
+
+  m_retired.push_back(std::move(retired));
+}
+
+void MaterialSystem::releaseRetired(bool all) noexcept {
+  size_t i = 0;
+  while (i < m_retired.size()) {
+    RetiredTexture &retired = m_retired[i];
+    if (!all && retired.releaseFrame > m_streamFrame) {
+      ++i;
+      continue;
+    }
+
+    for (VkDescriptorSet set : retired.sets) {
+      m_materialSets.release(set);
+    }
+
+    retired.texture.shutdown();
+
+    if (i + 1 != m_retired.size()) {
+      retired = std::move(m_retired.back());
+    }
+    m_retired.pop_back();
+  }
+}
@@ -7,10 +7,20 @@
 #include "backend/gpu/upload/vk_texture_uploader.hpp"
 #include "backend/gpu/upload/vk_upload_context.hpp"
 #include "engine/assets/image_data.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/texture_format.hpp"
+#include "engine/jobs/job_system.hpp"
 #include "render/resources/material_gpu.hpp"
+#include "render/resources/texture_loader.hpp"
+#include "render/resources/texture_streamer.hpp"
 
 #include <cstdint>
 #include <glm/ext/vector_float4.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 class UploadProfiler;
@@ -21,15 +31,48 @@ struct TextureHandle {
 
 class MaterialSystem {
 public:
+  // Texture decodes run on jobs, which must outlive shutdown()
   bool init(VkBackendCtx &ctx, VkUploadContext &upload,
+            engine::jobs::JobSystem &jobs,
             VkDescriptorSetLayout materialSetLayout, uint32_t materialCapacity,
             UploadProfiler *profiler = nullptr);
   void shutdown() noexcept;
 
+  // Streamed: only the mip tail is uploaded here, finer levels follow the
+  // footprints passed to requestTextureDensity(). .ktx2 files are mapped
+  // and uploaded as stored (flipY is ignored), other images go through
+  // stb_image and setTextureCompression().
   TextureHandle createTextureFromFile(const std::string &path, bool flipY);
+  // Same, but decoded on worker threads. The handle is usable right away;
+  // materials sample the default texture until processTextureLoads()
+  // uploads it.
+  TextureHandle loadTextureAsync(const std::string &path, bool flipY);
+  // Cached loadTextureAsync(): the same path and flip share one handle, and
+  // files that decode to identical content share one GPU texture. Each
+  // acquire takes a reference.
+  TextureHandle acquireTexture(const std::string &path, bool flipY);
+  // Drops a reference taken by any of the create/load/acquire calls. At
+  // zero the texture is destroyed once out of flight and materials still
+  // using it fall back to the default texture.
+  void releaseTexture(TextureHandle texture);
+  // Uploads finished loads within the per-frame budget; call once per frame
+  // after the upload context has begun the frame
+  void processTextureLoads();
+  [[nodiscard]] bool textureReady(TextureHandle texture) const noexcept;
+  [[nodiscard]] uint32_t textureLoadsInFlight() const noexcept {
+    return (m_textureLoader ? m_textureLoader->inFlight() : 0U) +
+           static_cast<uint32_t>(m_loadResults.size());
+  }
   bool createTextureFromImage(const engine::ImageData &img,
                               VkTexture2D &outTex);
 
+  // Block compress textures created by createTextureFromFile from now on.
+  // Keeps RGBA8 and returns false when the device cannot sample format.
+  bool setTextureCompression(engine::TextureFormat format);
+  [[nodiscard]] engine::TextureFormat textureCompression() const noexcept {
+    return m_textureCompression;
+  }
+
   uint32_t createMaterialFromTexture(TextureHandle textureHandle);
   uint32_t createMaterialFromBaseColorFactor(const glm::vec4 &factor);
 
@@ -43,11 +86,36 @@ public:
                          uint32_t maxMaterialsInTable) noexcept;
 
   bool updateMaterialGPU(uint32_t materialId, const MaterialGPU &gpu);
+  // MaterialGPU::kFlag* bits last written for the material
+  [[nodiscard]] uint32_t materialFlags(uint32_t materialId) const noexcept {
+    return materialId < m_materialFlags.size() ? m_materialFlags[materialId]
+                                               : 0U;
+  }
+  // Flags of every material id, unwritten ids read 0
+  [[nodiscard]] std::span<const uint32_t> materialFlags() const noexcept {
+    return m_materialFlags;
+  }
+  // Bumped whenever a material's flags change
+  [[nodiscard]] uint64_t materialFlagsRevision() const noexcept {
+    return m_materialFlagsRevision;
+  }
 
   bool createDefaultMaterial() noexcept;
 
   [[nodiscard]] uint32_t resolveMaterial(uint32_t overrideMaterial) const;
 
+  // Texture streaming
+  void requestTextureDensity(uint32_t materialId, float screenPixels) noexcept;
+  // Records residency changes into the upload context; call once per frame
+  // after the upload context has begun the frame
+  void updateStreaming();
+  void setTextureStreamingBudget(VkDeviceSize bytes) noexcept {
+    m_streamer.setBudget(bytes);
+  }
+  [[nodiscard]] TextureStreamingStats streamingStats() const noexcept {
+    return m_streamer.stats();
+  }
+
   bool rebind(VkBackendCtx &ctx, VkUploadContext &upload) {
     const bool okTex = m_textureUploader.init(ctx.allocator(), ctx.device(),
                                               &upload, m_uploaderProfiler);
@@ -57,13 +125,77 @@ public:
   }
 
 private:
+  struct TextureRecord {
+    uint32_t refs = 1;
+    uint64_t contentHash = 0;    // 0 until a hashed load finishes
+    uint32_t alias = UINT32_MAX; // texture sharing the same content
+    std::string key;             // path cache key, empty if uncached
+  };
+
+  // Promotion whose new levels are streamed over several frames
+  struct PendingResidency {
+    TextureResidencyChange change;
+    VkTexture2D next;
+    VkStreamHandle stream;
+  };
+
+  struct RetiredTexture {
+    VkTexture2D texture;
+    std::vector<VkDescriptorSet> sets;
+    uint64_t releaseFrame = 0;
+  };
+
+  [[nodiscard]] bool canSample(const engine::MipChain &chain) const;
+  bool createTextureFromChain(engine::MipChain &&chain, uint32_t texture);
+  uint32_t addTextureSlot();
+  [[nodiscard]] uint32_t resolveTexture(uint32_t texture) const noexcept;
+  bool uploadChainLevels(const engine::MipChain &chain, uint32_t firstLevel,
+                         uint32_t count, VkTexture2D &tex);
+
   bool writeMaterialGPU(uint32_t materialId, const MaterialGPU &gpu);
+  void setMaterialTexture(uint32_t materialId, TextureHandle texture);
+
+  bool allocateTextureSets(uint32_t texture, const VkTexture2D &tex,
+                           std::vector<uint32_t> &materials,
+                           std::vector<VkDescriptorSet> &sets);
+  void rebindTextureMaterials(uint32_t texture);
+  bool moveTextureMaterials(uint32_t from, uint32_t to, VkTexture2D &&old);
+  bool applyResidency(const TextureResidencyChange &change);
+  bool streamResidency(const TextureResidencyChange &change,
+                       VkTexture2D &&next);
+  bool finishResidency(const TextureResidencyChange &change,
+                       VkTexture2D &next);
+  void finishStreamedResidency();
+  void cancelStreamedResidency(uint32_t texture) noexcept;
+  void retire(VkTexture2D &&texture, std::vector<VkDescriptorSet> &&sets);
+  void releaseRetired(bool all) noexcept;
 
   VkTextureUploader m_textureUploader;
   VkMaterialUploader m_materialUploader;
 
   std::vector<VkTexture2D> m_textures;
   VkMaterialSets m_materialSets;
+  std::vector<uint32_t> m_materialTextures; // material id -> texture id
+  std::vector<uint32_t> m_materialFlags;    // material id -> flags.x
+  uint64_t m_materialFlagsRevision = 0;
+
+  std::vector<TextureRecord> m_textureRecords; // per texture
+  std::unordered_map<std::string, uint32_t> m_textureByKey;
+  std::unordered_map<uint64_t, uint32_t> m_textureByHash;
+
+  // Heap allocated, workers hold its address and MaterialSystem moves
+  std::unique_ptr<TextureLoader> m_textureLoader;
+  engine::jobs::JobSystem *m_jobs = nullptr; // non-owning, sync encodes
+  std::vector<TextureLoadResult> m_loadResults; // drained, not uploaded yet
+  VkDeviceSize m_loadBytesPerFrame = 0;
+
+  TextureStreamer m_streamer;
+  std::vector<TextureResidencyChange> m_streamChanges;
+  std::vector<PendingResidency> m_pendingResidency;
+  VkDeviceSize m_streamBytesPerFrame = 0;
+  std::vector<RetiredTexture> m_retired;
+  uint64_t m_streamFrame = 0;
+  uint32_t m_framesInFlight = 0;
 
   VkBuffer m_materialTable = VK_NULL_HANDLE; // non-owning
   uint32_t m_materialTableCapacity = 0;
@@ -73,5 +205,9 @@ private:
 
   uint32_t m_activeMaterial = UINT32_MAX;
 
+  VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE; // non-owning
+  bool m_bcSupported = false;
+  engine::TextureFormat m_textureCompression = engine::TextureFormat::RGBA8;
+
   UploadProfiler *m_uploaderProfiler = nullptr; // non-owning
 };
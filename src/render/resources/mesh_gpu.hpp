@@ -10,12 +10,14 @@ struct MeshGpu {
   uint32_t vertexCount = 0;
   uint32_t indexCount = 0;
   VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+  float boundsRadius = 0.0F; // object space, centered on the origin
 
   void shutdown() noexcept {
     vertex.shutdown();
     index.shutdown();
     vertexCount = 0;
     indexCount = 0;
+    boundsRadius = 0.0F;
     // TODO: make index type dynamically choose between UINT16 and UINT32,
     // and maybe UINT8
     indexType = VK_INDEX_TYPE_UINT32;
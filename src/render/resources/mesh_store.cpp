@@ -2,17 +2,28 @@
 
 #include "backend/gpu/upload/vk_upload_context.hpp"
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/assets/hash/xxhash64.hpp"
+#include "engine/logging/log.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/vector_float3.hpp>
+#include <utility>
+
+DEFINE_TU_LOGGER("Render.Meshes");
+#define LOG_TU_LOGGER() ThisLogger()
 
 bool MeshStore::init(VkBackendCtx &ctx, VkUploadContext &upload,
                      UploadProfiler *profiler) {
   shutdown();
 
   m_uploaderProfiler = profiler;
+  m_framesInFlight = upload.framesInflight();
 
   if (!m_uploader.init(ctx.allocator(), &upload, m_uploaderProfiler)) {
-    std::cerr << "[MeshStore] Failed to init uploader\n";
+    LOGE("Failed to init uploader");
     shutdown();
     return false;
   }
@@ -21,11 +32,21 @@ bool MeshStore::init(VkBackendCtx &ctx, VkUploadContext &upload,
 }
 
 void MeshStore::shutdown() noexcept {
+  releaseRetired(/*all=*/true);
+
   for (auto &mesh : m_meshes) {
     mesh.shutdown();
   }
 
   m_meshes.clear();
+  m_refs.clear();
+  m_streaming.clear();
+  m_streams.clear();
+  m_hashes.clear();
+  m_meshByHash.clear();
+  m_frame = 0;
+  m_framesInFlight = 0;
+
   m_uploader.shutdown();
   m_uploaderProfiler = nullptr;
 }
@@ -36,25 +57,37 @@ MeshHandle MeshStore::createMesh(const engine::Vertex *vertices,
   MeshGpu gpu{};
 
   if (vertices == nullptr || vertexCount == 0) {
-    std::cerr << "[Renderer] createMesh vertices or vertex count are 0\n";
+    LOGE("createMesh vertices or vertex count are 0");
     return {};
   }
 
+  MeshStreams streams{};
+
   const VkDeviceSize vbSize =
       VkDeviceSize(sizeof(engine::Vertex)) * vertexCount;
-  if (!m_uploader.uploadToDeviceLocalBuffer(
-          vertices, vbSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, gpu.vertex)) {
-    std::cerr << "[MeshStore] vertex upload failed\n";
+  if (!m_uploader.uploadToDeviceLocalBuffer(vertices, vbSize,
+                                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                            gpu.vertex, &streams.vertex)) {
+    LOGE("vertex upload failed");
     return {};
   }
 
   gpu.vertexCount = vertexCount;
 
+  float maxDistSq = 0.0F;
+  for (uint32_t i = 0; i < vertexCount; ++i) {
+    const glm::vec3 &p = vertices[i].pos;
+    maxDistSq = std::max(maxDistSq, (p.x * p.x) + (p.y * p.y) + (p.z * p.z));
+  }
+  gpu.boundsRadius = std::sqrt(maxDistSq);
+
   if (indices != nullptr && indexCount > 0) {
     const VkDeviceSize ibSize = VkDeviceSize(sizeof(uint32_t)) * indexCount;
     if (!m_uploader.uploadToDeviceLocalBuffer(
-            indices, ibSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, gpu.index)) {
-      std::cerr << "[MeshStore] indice upload failed\n";
+            indices, ibSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, gpu.index,
+            &streams.index)) {
+      LOGE("indice upload failed");
+      m_uploader.cancelStream(streams.vertex);
       gpu.shutdown();
       return {};
     }
@@ -65,7 +98,19 @@ MeshHandle MeshStore::createMesh(const engine::Vertex *vertices,
   }
 
   m_meshes.push_back(std::move(gpu));
-  return MeshHandle{static_cast<uint32_t>(m_meshes.size() - 1)};
+  m_refs.push_back(1);
+  m_hashes.push_back(0);
+
+  const auto id = static_cast<uint32_t>(m_meshes.size() - 1);
+  const bool streaming =
+      streams.vertex.id != UINT32_MAX || streams.index.id != UINT32_MAX;
+  m_streaming.push_back(streaming ? 1 : 0);
+  if (streaming) {
+    streams.mesh = id;
+    m_streams.push_back(streams);
+  }
+
+  return MeshHandle{id};
 }
 
 MeshHandle MeshStore::createMesh(const engine::MeshData &mesh) {
@@ -75,8 +120,126 @@ MeshHandle MeshStore::createMesh(const engine::MeshData &mesh) {
                     static_cast<std::uint32_t>(mesh.indices.size()));
 }
 
+MeshHandle MeshStore::acquireMesh(const engine::MeshData &mesh) {
+  const auto vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+  const auto indexCount = static_cast<uint32_t>(mesh.indices.size());
+  const uint32_t *indices =
+      mesh.indices.empty() ? nullptr : mesh.indices.data();
+  return acquireMesh(
+      mesh.vertices.data(), vertexCount, indices, indexCount,
+      contentHash(mesh.vertices.data(), vertexCount, indices, indexCount));
+}
+
+MeshHandle MeshStore::acquireMesh(const engine::Vertex *vertices,
+                                  uint32_t vertexCount,
+                                  const uint32_t *indices, uint32_t indexCount,
+                                  uint64_t hash) {
+  if (auto it = m_meshByHash.find(hash); it != m_meshByHash.end()) {
+    const MeshGpu &cached = m_meshes[it->second];
+    if (cached.vertexCount == vertexCount && cached.indexCount == indexCount) {
+      ++m_refs[it->second];
+      return MeshHandle{it->second};
+    }
+  }
+
+  const MeshHandle handle =
+      createMesh(vertices, vertexCount, indices, indexCount);
+  if (handle.id == UINT32_MAX) {
+    return handle;
+  }
+
+  m_hashes[handle.id] = hash;
+  m_meshByHash[hash] = handle.id;
+  return handle;
+}
+
+uint64_t MeshStore::contentHash(const engine::Vertex *vertices,
+                                size_t vertexCount, const uint32_t *indices,
+                                size_t indexCount) noexcept {
+  uint64_t hash =
+      engine::assets::xxhash64(vertices, vertexCount * sizeof(engine::Vertex));
+  hash = engine::assets::xxhash64(indices, indexCount * sizeof(uint32_t), hash);
+  // 0 marks meshes outside the cache
+  return hash != 0 ? hash : 1;
+}
+
+void MeshStore::releaseMesh(MeshHandle handle) {
+  if (handle.id >= m_meshes.size() || m_refs[handle.id] == 0) {
+    LOGW("releaseMesh on a dead handle");
+    return;
+  }
+
+  if (--m_refs[handle.id] > 0) {
+    return;
+  }
+
+  if (const uint64_t hash = m_hashes[handle.id]; hash != 0) {
+    if (auto it = m_meshByHash.find(hash);
+        it != m_meshByHash.end() && it->second == handle.id) {
+      m_meshByHash.erase(it);
+    }
+    m_hashes[handle.id] = 0;
+  }
+
+  // Slots are not reused, stale handles resolve to nullptr
+  cancelStreams(handle.id);
+  RetiredMesh retired{};
+  retired.mesh = std::move(m_meshes[handle.id]);
+  retired.releaseFrame = m_frame + m_framesInFlight + 1;
+  m_retired.push_back(std::move(retired));
+}
+
+void MeshStore::beginFrame() noexcept {
+  ++m_frame;
+  releaseRetired(/*all=*/false);
+
+  // Chunks recorded up to last frame's flush are ordered before this
+  // frame's draws
+  std::erase_if(m_streams, [this](const MeshStreams &streams) {
+    const bool done = (streams.vertex.id == UINT32_MAX ||
+                       m_uploader.streamDone(streams.vertex)) &&
+                      (streams.index.id == UINT32_MAX ||
+                       m_uploader.streamDone(streams.index));
+    if (done) {
+      m_streaming[streams.mesh] = 0;
+    }
+    return done;
+  });
+}
+
+void MeshStore::cancelStreams(uint32_t mesh) noexcept {
+  std::erase_if(m_streams, [&](const MeshStreams &streams) {
+    if (streams.mesh != mesh) {
+      return false;
+    }
+
+    m_uploader.cancelStream(streams.vertex);
+    m_uploader.cancelStream(streams.index);
+    return true;
+  });
+}
+
+void MeshStore::releaseRetired(bool all) noexcept {
+  size_t i = 0;
+  while (i < m_retired.size()) {
+    RetiredMesh &retired = m_retired[i];
+    if (!all && retired.releaseFrame > m_frame) {
+      ++i;
+      continue;
+    }
+
+    retired.mesh.shutdown();
+
+    if (i + 1 != m_retired.size()) {
+      retired = std::move(m_retired.back());
+    }
+    m_retired.pop_back();
+  }
+}
+
 const MeshGpu *MeshStore::get(MeshHandle handle) const {
-  if (handle.id >= m_meshes.size()) {
+  if (handle.id >= m_meshes.size() || m_refs[handle.id] == 0 ||
+      m_streaming[handle.id] != 0) {
     return nullptr;
   }
 
@@ -7,7 +7,9 @@
 #include "engine/mesh/vertex.hpp"
 #include "render/resources/mesh_gpu.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 class UploadProfiler;
@@ -22,10 +24,30 @@ public:
             UploadProfiler *profiler);
   void shutdown() noexcept;
 
+  // Buffers larger than the staging slice are streamed over the next
+  // frames; get() returns nullptr until they are complete.
   MeshHandle createMesh(const engine::Vertex *vertices, uint32_t vertexCount,
                         const uint32_t *indices, uint32_t indexCount);
   MeshHandle createMesh(const engine::MeshData &mesh);
 
+  // Deduplicated by an xxHash64 of the vertex and index data: identical
+  // meshes share one handle and GPU copy. Each acquire takes a reference.
+  MeshHandle acquireMesh(const engine::MeshData &mesh);
+  // Same with the contentHash() computed ahead, e.g. by the cooker
+  MeshHandle acquireMesh(const engine::Vertex *vertices, uint32_t vertexCount,
+                         const uint32_t *indices, uint32_t indexCount,
+                         uint64_t hash);
+  [[nodiscard]] static uint64_t contentHash(const engine::Vertex *vertices,
+                                            size_t vertexCount,
+                                            const uint32_t *indices,
+                                            size_t indexCount) noexcept;
+  // Drops a reference taken by create/acquire; the buffers are destroyed
+  // once no frame in flight can use them
+  void releaseMesh(MeshHandle handle);
+  // Destroys released meshes that are out of flight and publishes streamed
+  // ones; call once per frame
+  void beginFrame() noexcept;
+
   [[nodiscard]] const MeshGpu *get(MeshHandle handle) const;
 
   bool rebind(VkBackendCtx &ctx, VkUploadContext &upload) {
@@ -33,7 +55,30 @@ public:
   }
 
 private:
+  struct MeshStreams {
+    uint32_t mesh = UINT32_MAX;
+    VkStreamHandle vertex;
+    VkStreamHandle index;
+  };
+
+  struct RetiredMesh {
+    MeshGpu mesh;
+    uint64_t releaseFrame = 0;
+  };
+
+  void releaseRetired(bool all) noexcept;
+  void cancelStreams(uint32_t mesh) noexcept;
+
   std::vector<MeshGpu> m_meshes;
+  std::vector<uint32_t> m_refs;                        // per mesh
+  std::vector<uint64_t> m_hashes;                      // 0 = not deduplicated
+  std::vector<uint8_t> m_streaming;                    // 1 = not drawable yet
+  std::vector<MeshStreams> m_streams;
+  std::unordered_map<uint64_t, uint32_t> m_meshByHash; // hash -> mesh id
+  std::vector<RetiredMesh> m_retired;
+  uint64_t m_frame = 0;
+  uint32_t m_framesInFlight = 0;
+
   VkBufferUploader m_uploader;                  // non-owning
   UploadProfiler *m_uploaderProfiler = nullptr; // non-owning
 };
@@ -4,11 +4,13 @@
 #include "backend/gpu/descriptors/vk_shader_interface.hpp"
 #include "backend/gpu/upload/vk_upload_context.hpp"
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/jobs/job_system.hpp"
 #include "render/scene/scene_data.hpp"
 
 #include <iostream>
 
 bool ResourceStore::init(VkBackendCtx &ctx, VkUploadContext &upload,
+                         engine::jobs::JobSystem &jobs,
                          const VkShaderInterface &interface, SceneData &data,
                          UploadProfiler *profiler) {
   shutdown();
@@ -19,7 +21,7 @@ bool ResourceStore::init(VkBackendCtx &ctx, VkUploadContext &upload,
     return false;
   }
 
-  if (!m_materials.init(ctx, upload, interface.setLayoutMaterial(),
+  if (!m_materials.init(ctx, upload, jobs, interface.setLayoutMaterial(),
                         data.materialCapacity(), profiler)) {
     std::cerr << "[ResourceStore] MaterialSystem init failed\n";
     shutdown();
@@ -4,6 +4,7 @@
 #include "backend/gpu/descriptors/vk_shader_interface.hpp"
 #include "backend/gpu/upload/vk_upload_context.hpp"
 #include "backend/profiling/upload_profiler.hpp"
+#include "engine/jobs/job_system.hpp"
 #include "render/resources/material_system.hpp"
 #include "render/resources/mesh_store.hpp"
 #include "render/scene/scene_data.hpp"
@@ -13,8 +14,8 @@ class VkCommands;
 class ResourceStore {
 public:
   bool init(VkBackendCtx &ctx, VkUploadContext &uploader,
-            const VkShaderInterface &interface, SceneData &data,
-            UploadProfiler *profiler);
+            engine::jobs::JobSystem &jobs, const VkShaderInterface &interface,
+            SceneData &data, UploadProfiler *profiler);
   void shutdown() noexcept;
 
   MeshStore &meshes() { return m_meshes; }
@@ -0,0 +1,140 @@
+#include "render/resources/texture_loader.hpp"
+
+#include "backend/profiling/memory_tracker.hpp"
+#include "engine/assets/bcn/bc_encoder.hpp"
+#include "engine/assets/hash/xxhash64.hpp"
+#include "engine/assets/image_data.hpp"
+#include "engine/assets/ktx2/ktx2_loader.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/stb_image/stb_image_loader.hpp"
+#include "engine/assets/texture_format.hpp"
+#include "engine/jobs/job_system.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool TextureLoader::init(engine::jobs::JobSystem &jobs) {
+  shutdown();
+
+  m_jobs = &jobs;
+  m_stopping.store(false, std::memory_order_relaxed);
+  return true;
+}
+
+void TextureLoader::shutdown() noexcept {
+  if (m_jobs != nullptr) {
+    // Jobs that have not started skip their request
+    m_stopping.store(true, std::memory_order_relaxed);
+    m_jobs->wait(m_decodes);
+    m_jobs = nullptr;
+  }
+
+  m_requests.clear();
+  m_results.clear();
+  m_inFlight.store(0, std::memory_order_relaxed);
+}
+
+void TextureLoader::submit(TextureLoadRequest &&request) {
+  m_inFlight.fetch_add(1, std::memory_order_relaxed);
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_requests.push_back(std::move(request));
+  }
+  m_jobs->run("DecodeTexture", [this] { decodeNext(); }, &m_decodes);
+}
+
+void TextureLoader::drain(std::vector<TextureLoadResult> &out) {
+  std::lock_guard lock(m_mutex);
+  if (m_results.empty()) {
+    return;
+  }
+
+  m_inFlight.fetch_sub(static_cast<uint32_t>(m_results.size()),
+                       std::memory_order_relaxed);
+  for (TextureLoadResult &result : m_results) {
+    out.push_back(std::move(result));
+  }
+  m_results.clear();
+}
+
+void TextureLoader::decodeNext() {
+  if (m_stopping.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  TextureLoadRequest request;
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_requests.empty()) {
+      return;
+    }
+    request = std::move(m_requests.front());
+    m_requests.pop_front();
+  }
+
+  TextureLoadResult result;
+  result.texture = request.texture;
+  result.path = std::move(request.path);
+  // Loads already run in parallel, keep the encoder on this thread
+  if (!decode(result.path, request.flipY, request.compression,
+              /*encodeJobs=*/nullptr, result.chain)) {
+    result.chain = {};
+  } else if (request.hashContent) {
+    result.contentHash = hashChain(result.chain);
+  }
+  result.memory = profiling::TrackedBytes(profiling::MemoryTag::CpuAsset,
+                                          result.chain.pixels.size());
+
+  std::lock_guard lock(m_mutex);
+  m_results.push_back(std::move(result));
+}
+
+bool TextureLoader::decode(const std::string &path, bool flipY,
+                           engine::TextureFormat compression,
+                           engine::jobs::JobSystem *encodeJobs,
+                           engine::MipChain &out) {
+  if (path.ends_with(".ktx2")) {
+    return engine::assets::loadKtx2(path, out);
+  }
+
+  engine::ImageData img;
+  if (!engine::assets::loadImageRGBA8(path, img, flipY)) {
+    return false;
+  }
+
+  if (!engine::assets::buildMipChainRGBA8(img, out)) {
+    return false;
+  }
+
+  if (compression != engine::TextureFormat::RGBA8) {
+    engine::MipChain compressed;
+    if (engine::assets::compressMipChain(out, compression, compressed,
+                                         encodeJobs)) {
+      out = std::move(compressed);
+    } else {
+      std::cerr << "[TextureLoader] Failed to compress " << path
+                << ", keeping RGBA8\n";
+    }
+  }
+
+  return true;
+}
+
+uint64_t TextureLoader::hashChain(const engine::MipChain &chain) {
+  const std::array<uint8_t, 2> format = {
+      static_cast<uint8_t>(chain.format), static_cast<uint8_t>(chain.srgb)};
+
+  uint64_t hash = engine::assets::xxhash64(format.data(), format.size());
+  for (uint32_t level = 0; level < chain.levelCount(); ++level) {
+    hash = engine::assets::xxhash64(chain.levelData(level),
+                                    chain.levels[level].size, hash);
+  }
+
+  return hash;
+}
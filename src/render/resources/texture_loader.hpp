@@ -0,0 +1,82 @@
+#pragma once
+
+#include "backend/profiling/memory_tracker.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+#include "engine/assets/texture_format.hpp"
+#include "engine/jobs/job_system.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TextureLoadRequest {
+  uint32_t texture = UINT32_MAX;
+  std::string path;
+  bool flipY = true;
+  engine::TextureFormat compression = engine::TextureFormat::RGBA8;
+  bool hashContent = false;
+};
+
+struct TextureLoadResult {
+  uint32_t texture = UINT32_MAX;
+  std::string path;
+  engine::MipChain chain;   // invalid when decoding failed
+  uint64_t contentHash = 0; // when requested, 0 otherwise
+  profiling::TrackedBytes memory; // decoded pixels, until dropped
+};
+
+// Decodes texture files into mip chains as jobs on the engine's JobSystem,
+// one job per request. Requests and results are plain queues, the owner
+// drains results on its own thread and does all GPU work there.
+class TextureLoader {
+public:
+  TextureLoader() = default;
+  ~TextureLoader() noexcept { shutdown(); }
+
+  TextureLoader(const TextureLoader &) = delete;
+  TextureLoader &operator=(const TextureLoader &) = delete;
+  TextureLoader(TextureLoader &&) = delete;
+  TextureLoader &operator=(TextureLoader &&) = delete;
+
+  // jobs must outlive the loader, or at least its shutdown()
+  bool init(engine::jobs::JobSystem &jobs);
+  // Waits for running decodes, queued requests and undrained results are
+  // dropped
+  void shutdown() noexcept;
+
+  void submit(TextureLoadRequest &&request);
+  // Appends finished results to out without blocking
+  void drain(std::vector<TextureLoadResult> &out);
+
+  // Submitted and not drained yet
+  [[nodiscard]] uint32_t inFlight() const noexcept {
+    return m_inFlight.load(std::memory_order_relaxed);
+  }
+
+  // .ktx2 files are mapped as stored, anything else goes through stb_image,
+  // mip generation and the optional BCn encode, split over encodeJobs when
+  // set. Safe on any thread.
+  static bool decode(const std::string &path, bool flipY,
+                     engine::TextureFormat compression,
+                     engine::jobs::JobSystem *encodeJobs,
+                     engine::MipChain &out);
+
+  // xxHash64 of the format and every level as uploaded
+  [[nodiscard]] static uint64_t hashChain(const engine::MipChain &chain);
+
+private:
+  // Job body, takes the oldest request
+  void decodeNext();
+
+  engine::jobs::JobSystem *m_jobs = nullptr; // non-owning
+  engine::jobs::JobCounter m_decodes;
+  std::atomic<bool> m_stopping{false};
+
+  std::mutex m_mutex;
+  std::deque<TextureLoadRequest> m_requests;
+  std::vector<TextureLoadResult> m_results;
+  std::atomic<uint32_t> m_inFlight{0};
+};
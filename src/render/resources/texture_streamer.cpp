@@ -0,0 +1,227 @@
+#include "render/resources/texture_streamer.hpp"
+
+#include "backend/profiling/memory_tracker.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+void TextureStreamer::reset() noexcept {
+  m_lookup.clear();
+  m_entries.clear();
+  m_promotions.clear();
+  m_residentBytes = 0;
+  m_promotionCount = 0;
+  m_evictionCount = 0;
+}
+
+uint32_t TextureStreamer::tailBase(const engine::MipChain &chain) {
+  for (uint32_t level = 0; level < chain.levelCount(); ++level) {
+    const engine::MipLevel &mip = chain.levels[level];
+    if (std::max(mip.width, mip.height) <= kTailDim) {
+      return level;
+    }
+  }
+
+  return chain.levelCount() == 0 ? 0 : chain.levelCount() - 1;
+}
+
+void TextureStreamer::track(uint32_t texture, engine::MipChain &&chain,
+                            uint32_t tailBase) {
+  if (texture >= m_lookup.size()) {
+    m_lookup.resize(size_t(texture) + 1, UINT32_MAX);
+  }
+
+  Entry entry{};
+  entry.texture = texture;
+  entry.chain = std::move(chain);
+  entry.tailBase = tailBase;
+  entry.residentBase = tailBase;
+  entry.memory = profiling::TrackedBytes(profiling::MemoryTag::CpuAsset,
+                                         entry.chain.pixels.size());
+
+  m_residentBytes += entry.chain.bytesFrom(tailBase);
+
+  m_lookup[texture] = static_cast<uint32_t>(m_entries.size());
+  m_entries.push_back(std::move(entry));
+}
+
+void TextureStreamer::untrack(uint32_t texture) noexcept {
+  if (texture >= m_lookup.size() || m_lookup[texture] == UINT32_MAX) {
+    return;
+  }
+
+  const uint32_t index = m_lookup[texture];
+  m_residentBytes -= m_entries[index].chain.bytesFrom(
+      m_entries[index].residentBase);
+  m_lookup[texture] = UINT32_MAX;
+
+  if (index + 1 != m_entries.size()) {
+    m_entries[index] = std::move(m_entries.back());
+    m_lookup[m_entries[index].texture] = index;
+  }
+  m_entries.pop_back();
+}
+
+void TextureStreamer::setBusy(uint32_t texture, bool busy) noexcept {
+  if (Entry *entry = find(texture); entry != nullptr) {
+    entry->busy = busy;
+  }
+}
+
+TextureStreamer::Entry *TextureStreamer::find(uint32_t texture) noexcept {
+  if (texture >= m_lookup.size() || m_lookup[texture] == UINT32_MAX) {
+    return nullptr;
+  }
+
+  return &m_entries[m_lookup[texture]];
+}
+
+const TextureStreamer::Entry *
+TextureStreamer::find(uint32_t texture) const noexcept {
+  if (texture >= m_lookup.size() || m_lookup[texture] == UINT32_MAX) {
+    return nullptr;
+  }
+
+  return &m_entries[m_lookup[texture]];
+}
+
+const engine::MipChain *
+TextureStreamer::chain(uint32_t texture) const noexcept {
+  const Entry *entry = find(texture);
+  return entry != nullptr ? &entry->chain : nullptr;
+}
+
+void TextureStreamer::request(uint32_t texture, float screenPixels) noexcept {
+  Entry *entry = find(texture);
+  if (entry == nullptr) {
+    return;
+  }
+
+  entry->requestedPixels = std::max(entry->requestedPixels, screenPixels);
+}
+
+uint32_t TextureStreamer::wantedBase(const Entry &entry,
+                                     float screenPixels) noexcept {
+  const engine::MipLevel &top = entry.chain.levels[0];
+  const float texels = static_cast<float>(std::max(top.width, top.height));
+  const float pixels = std::max(screenPixels, 1.0F);
+
+  // One texel per pixel: level n has texels / 2^n along its largest side
+  const float level = std::floor(std::log2(texels / pixels));
+  if (level <= 0.0F) {
+    return 0;
+  }
+
+  return std::min(static_cast<uint32_t>(level), entry.tailBase);
+}
+
+void TextureStreamer::plan(std::vector<TextureResidencyChange> &out,
+                           uint32_t maxChanges) {
+  out.clear();
+  m_promotions.clear();
+
+  VkDeviceSize projected = m_residentBytes;
+
+  for (uint32_t i = 0; i < m_entries.size(); ++i) {
+    Entry &entry = m_entries[i];
+    if (entry.busy) {
+      entry.requestedPixels = 0.0F;
+      continue;
+    }
+
+    uint32_t wanted = entry.residentBase;
+    if (entry.requestedPixels > 0.0F) {
+      wanted = wantedBase(entry, entry.requestedPixels);
+      entry.lastPixels = entry.requestedPixels;
+      entry.idleFrames = 0;
+    } else if (++entry.idleFrames > kIdleFrames) {
+      wanted = entry.tailBase;
+    }
+
+    entry.requestedPixels = 0.0F;
+
+    if (wanted > entry.residentBase) {
+      if (out.size() < maxChanges) {
+        out.push_back(TextureResidencyChange{.texture = entry.texture,
+                                             .oldBase = entry.residentBase,
+                                             .newBase = wanted});
+        projected -= entry.chain.bytesFrom(entry.residentBase) -
+                     entry.chain.bytesFrom(wanted);
+      }
+    } else if (wanted < entry.residentBase) {
+      m_promotions.push_back(Promotion{.entry = i, .wantedBase = wanted});
+    }
+  }
+
+  // Largest residency deficit first, then largest on screen
+  std::sort(m_promotions.begin(), m_promotions.end(),
+            [this](const Promotion &a, const Promotion &b) {
+              const Entry &ea = m_entries[a.entry];
+              const Entry &eb = m_entries[b.entry];
+              const uint32_t da = ea.residentBase - a.wantedBase;
+              const uint32_t db = eb.residentBase - b.wantedBase;
+              if (da != db) {
+                return da > db;
+              }
+
+              return ea.lastPixels > eb.lastPixels;
+            });
+
+  VkDeviceSize uploadBytes = 0;
+  for (const Promotion &promotion : m_promotions) {
+    if (out.size() >= maxChanges) {
+      break;
+    }
+
+    const Entry &entry = m_entries[promotion.entry];
+    const uint32_t newBase = entry.residentBase - 1;
+    const VkDeviceSize cost = entry.chain.levels[newBase].size;
+
+    if (projected + cost > m_budgetBytes ||
+        (uploadBytes > 0 && uploadBytes + cost > m_uploadBytesPerFrame)) {
+      continue;
+    }
+
+    out.push_back(TextureResidencyChange{.texture = entry.texture,
+                                         .oldBase = entry.residentBase,
+                                         .newBase = newBase});
+    projected += cost;
+    uploadBytes += cost;
+
+    if (uploadBytes >= m_uploadBytesPerFrame) {
+      break;
+    }
+  }
+}
+
+void TextureStreamer::commit(const TextureResidencyChange &change) noexcept {
+  Entry *entry = find(change.texture);
+  if (entry == nullptr || entry->residentBase != change.oldBase) {
+    return;
+  }
+
+  m_residentBytes -= entry->chain.bytesFrom(change.oldBase);
+  m_residentBytes += entry->chain.bytesFrom(change.newBase);
+  entry->residentBase = change.newBase;
+
+  if (change.newBase < change.oldBase) {
+    ++m_promotionCount;
+  } else {
+    ++m_evictionCount;
+  }
+}
+
+TextureStreamingStats TextureStreamer::stats() const noexcept {
+  TextureStreamingStats out{};
+  out.streamedTextures = static_cast<uint32_t>(m_entries.size());
+  out.residentBytes = m_residentBytes;
+  out.budgetBytes = m_budgetBytes;
+  out.promotions = m_promotionCount;
+  out.evictions = m_evictionCount;
+  return out;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "backend/profiling/memory_tracker.hpp"
+#include "engine/assets/mips/mip_chain.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+// oldBase/newBase are levels of the CPU mip chain: the GPU image holds
+// levels [base, levelCount) with chain level base as its mip 0.
+struct TextureResidencyChange {
+  uint32_t texture = UINT32_MAX;
+  uint32_t oldBase = 0;
+  uint32_t newBase = 0;
+};
+
+struct TextureStreamingStats {
+  uint32_t streamedTextures = 0;
+  VkDeviceSize residentBytes = 0;
+  VkDeviceSize budgetBytes = 0;
+  uint64_t promotions = 0;
+  uint64_t evictions = 0;
+};
+
+// Decides which mip levels of streamed textures are resident. The owner
+// feeds on-screen footprints with request(), calls plan() once per frame and
+// commit() for each change it applied on the GPU.
+class TextureStreamer {
+public:
+  // Levels whose largest side is at or below this are always resident
+  static constexpr uint32_t kTailDim = 128;
+  // Frames without a request before a texture falls back to its tail
+  static constexpr uint32_t kIdleFrames = 120;
+
+  void reset() noexcept;
+
+  void setBudget(VkDeviceSize bytes) noexcept { m_budgetBytes = bytes; }
+  void setUploadBytesPerFrame(VkDeviceSize bytes) noexcept {
+    m_uploadBytesPerFrame = bytes;
+  }
+
+  // First chain level that fits in kTailDim
+  [[nodiscard]] static uint32_t tailBase(const engine::MipChain &chain);
+
+  // The texture must already hold levels [tailBase, levelCount)
+  void track(uint32_t texture, engine::MipChain &&chain, uint32_t tailBase);
+  // Forget a texture that is being destroyed
+  void untrack(uint32_t texture) noexcept;
+  // Busy textures are skipped by plan(), set while a change spans frames
+  void setBusy(uint32_t texture, bool busy) noexcept;
+
+  [[nodiscard]] const engine::MipChain *chain(uint32_t texture) const noexcept;
+
+  // Keeps the largest footprint seen this frame. screenPixels is the
+  // on-screen size of the surface the texture is mapped across.
+  void request(uint32_t texture, float screenPixels) noexcept;
+
+  // Consumes this frame's requests. Evictions are emitted before promotions
+  // so the freed budget is available; promotions step one level at a time.
+  // A level above the per-frame upload budget is only planned alone, the
+  // owner streams it over several frames.
+  void plan(std::vector<TextureResidencyChange> &out, uint32_t maxChanges);
+
+  void commit(const TextureResidencyChange &change) noexcept;
+
+  [[nodiscard]] TextureStreamingStats stats() const noexcept;
+
+private:
+  struct Entry {
+    uint32_t texture = UINT32_MAX;
+    engine::MipChain chain;
+    uint32_t tailBase = 0;
+    uint32_t residentBase = 0;
+    float requestedPixels = 0.0F;
+    float lastPixels = 0.0F;
+    uint32_t idleFrames = 0;
+    bool busy = false;
+    profiling::TrackedBytes memory; // chain.pixels
+  };
+
+  struct Promotion {
+    uint32_t entry = 0;
+    uint32_t wantedBase = 0;
+  };
+
+  [[nodiscard]] Entry *find(uint32_t texture) noexcept;
+  [[nodiscard]] const Entry *find(uint32_t texture) const noexcept;
+  [[nodiscard]] static uint32_t wantedBase(const Entry &entry,
+                                           float screenPixels) noexcept;
+
+  std::vector<uint32_t> m_lookup; // texture id -> entry index
+  std::vector<Entry> m_entries;
+  std::vector<Promotion> m_promotions; // scratch for plan()
+
+  VkDeviceSize m_budgetBytes = 256ULL * 1024ULL * 1024ULL;
+  VkDeviceSize m_uploadBytesPerFrame = 4ULL * 1024ULL * 1024ULL;
+  VkDeviceSize m_residentBytes = 0;
+
+  uint64_t m_promotionCount = 0;
+  uint64_t m_evictionCount = 0;
+};
@@ -3,16 +3,20 @@
 #include "backend/core/vk_backend_ctx.hpp"
 #include "backend/gpu/buffers/vk_buffer.hpp"
 #include "backend/gpu/descriptors/vk_shader_interface.hpp"
+#include "backend/profiling/memory_tracker.hpp"
 #include "backend/profiling/upload_profiler.hpp"
 #include "engine/camera/camera_ubo.hpp"
 #include "render/resources/material_gpu.hpp"
+#include "engine/logging/log.hpp"
 
 #include <cstdint>
 #include <glm/ext/matrix_float4x4.hpp>
-#include <iostream>
 #include <sys/types.h>
 #include <vulkan/vulkan_core.h>
 
+DEFINE_TU_LOGGER("Render.Scene");
+#define LOG_TU_LOGGER() ThisLogger()
+
 bool SceneData::init(VkBackendCtx &ctx, uint32_t framesInFlight,
                      const VkShaderInterface &interface,
                      uint32_t requestedMaxInstancesPerFrame,
@@ -22,17 +26,17 @@ bool SceneData::init(VkBackendCtx &ctx, uint32_t framesInFlight,
   m_profiler = profiler;
 
   if (framesInFlight == 0) {
-    std::cerr << "[SceneData] framesInFlight must be greater than 0\n";
+    LOGE("framesInFlight must be greater than 0");
     return false;
   }
 
   if (requestedMaxInstancesPerFrame == 0) {
-    std::cerr << "[SceneData] requestedMaxInstancesPerFrame must be > 0\n";
+    LOGE("requestedMaxInstancesPerFrame must be > 0");
     return false;
   }
 
   if (requestedMaxMaterials == 0) {
-    std::cerr << "[SceneData] requestedMaxMaterials must be > 0\n";
+    LOGE("requestedMaxMaterials must be > 0");
     return false;
   }
 
@@ -72,7 +76,7 @@ bool SceneData::queryDeviceLimits(VkPhysicalDevice physicalDevice) {
 
   m_maxStorageBufferRange = props.limits.maxStorageBufferRange;
   if (m_maxStorageBufferRange == 0) {
-    std::cerr << "[SceneData] maxStorageBufferRange is 0\n";
+    LOGE("maxStorageBufferRange is 0");
     return false;
   }
 
@@ -82,7 +86,7 @@ bool SceneData::queryDeviceLimits(VkPhysicalDevice physicalDevice) {
 bool SceneData::initCameraBuffers(VmaAllocator allocator,
                                   uint32_t framesInFlight) {
   if (!m_cameraBufs.init(allocator, framesInFlight, sizeof(CameraUBO))) {
-    std::cerr << "[SceneData] Failed to init camera UBO buffers\n";
+    LOGE("Failed to init camera UBO buffers");
     return false;
   }
 
@@ -105,7 +109,7 @@ bool SceneData::initInstanceBuffer(VmaAllocator allocator,
   }
 
   if (m_maxInstancesPerFrame == 0 || wantedStride == 0) {
-    std::cerr << "[SceneData] maxStorageBufferRange too small for instances\n";
+    LOGE("maxStorageBufferRange too small for instances");
     return false;
   }
 
@@ -118,8 +122,9 @@ bool SceneData::initInstanceBuffer(VmaAllocator allocator,
       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 
   if (!m_instanceBuf.init(allocator, totalBytes, usage,
-                          VkBufferObj::MemUsage::GpuOnly, /*mapped*/ false)) {
-    std::cerr << "[SceneData] Failed to create instance SSBO\n";
+                          VkBufferObj::MemUsage::GpuOnly, /*mapped*/ false,
+                          profiling::MemoryTag::Instance)) {
+    LOGE("Failed to create instance SSBO");
     return false;
   }
 
@@ -145,7 +150,7 @@ bool SceneData::initMaterialBuffer(VmaAllocator allocator,
   }
 
   if (m_materialCapacity == 0 || m_materialTableBytes == 0) {
-    std::cerr << "[SceneData] maxStorageBufferRange too small for materials\n";
+    LOGE("maxStorageBufferRange too small for materials");
     return false;
   }
 
@@ -153,8 +158,9 @@ bool SceneData::initMaterialBuffer(VmaAllocator allocator,
       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 
   if (!m_materialBuf.init(allocator, m_materialTableBytes, matUsage,
-                          VkBufferObj::MemUsage::GpuOnly, /*mapped*/ false)) {
-    std::cerr << "[SceneData] Failed to create instance SSBO\n";
+                          VkBufferObj::MemUsage::GpuOnly, /*mapped*/ false,
+                          profiling::MemoryTag::Material)) {
+    LOGE("Failed to create instance SSBO");
     return false;
   }
 
@@ -171,7 +177,7 @@ bool SceneData::initDescriptorSets(VkDevice device,
   if (!m_sets.init(device, interface.setLayoutScene(), m_cameraBufs,
                    m_instanceBuf.handle(), m_instanceFrameStride,
                    m_materialBuf.handle(), m_materialTableBytes)) {
-    std::cerr << "[SceneData] Failed to init scene descriptor sets\n";
+    LOGE("Failed to init scene descriptor sets");
     return false;
   }
   return true;
@@ -199,7 +205,7 @@ bool SceneData::update(uint32_t frameIndex, const CameraUBO &camera) {
   }
 
   if (!m_cameraBufs.update(frameIndex, &camera, sizeof(CameraUBO))) {
-    std::cerr << "[PerFrameData] Failed to update camera UBO\n";
+    LOGE("Failed to update camera UBO");
     return false;
   }
 
@@ -1,7 +1,10 @@
 #include "render/upload/upload_manager.hpp"
+#include "engine/logging/log.hpp"
 
 #include <cstdint>
-#include <iostream>
+
+DEFINE_TU_LOGGER("Render.Upload");
+#define LOG_TU_LOGGER() ThisLogger()
 
 bool UploadManager::init(VkBackendCtx &ctx, uint32_t framesInFlight,
                          VkDeviceSize staticBudgetPerFrame,
@@ -9,7 +12,7 @@ bool UploadManager::init(VkBackendCtx &ctx, uint32_t framesInFlight,
                          UploadProfiler *profiler) {
   if (framesInFlight == 0 || staticBudgetPerFrame == 0 ||
       frameBudgetPerFrame == 0) {
-    std::cerr << "[UploadManager] init invalid args\n";
+    LOGE("init invalid args");
     return false;
   }
 
@@ -19,13 +22,13 @@ bool UploadManager::init(VkBackendCtx &ctx, uint32_t framesInFlight,
   m_framesInFlight = framesInFlight;
 
   if (!m_static.init(ctx, m_framesInFlight, staticBudgetPerFrame, profiler)) {
-    std::cerr << "[Renderer] Failed to init static upload context\n";
+    LOGE("Failed to init static upload context");
     shutdown();
     return false;
   }
 
   if (!m_frame.init(ctx, m_framesInFlight, frameBudgetPerFrame, profiler)) {
-    std::cerr << "[Renderer] Failed to init frame upload context\n";
+    LOGE("Failed to init frame upload context");
     shutdown();
     return false;
   }
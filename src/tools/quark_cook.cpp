@@ -0,0 +1,95 @@
+#include "engine/assets/gltf/gltf_cpu_loader.hpp"
+#include "engine/assets/gltf/gltf_types.hpp"
+#include "engine/assets/package/scene_package.hpp"
+#include "engine/jobs/job_system.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Offline step: decodes a glTF once and writes the engine-ready package
+// loadScenePackage() maps at runtime. The axis and texcoord options are
+// baked in, so cook with the ones the game loads the glTF with.
+
+namespace {
+
+struct Options {
+  std::filesystem::path input;
+  std::filesystem::path output; // input with .qpkg when empty
+  engine::assets::GltfLoadOptions gltf;
+};
+
+void printUsage() {
+  std::cerr << "usage: quark_cook SCENE.glb|SCENE.gltf [--out PATH] "
+               "[--keep-v] [--y-up] [--flip-z]\n";
+}
+
+bool parseArgs(int argc, char **argv, Options &out) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    if (arg == "--out" && hasValue) {
+      out.output = argv[++i];
+    } else if (arg == "--keep-v") {
+      out.gltf.flipTexcoordV = false;
+    } else if (arg == "--y-up") {
+      out.gltf.axis.yUpToZUp = false;
+    } else if (arg == "--flip-z") {
+      out.gltf.axis.flipAxisZ = true;
+    } else if (out.input.empty() && !arg.starts_with("--")) {
+      out.input = arg;
+    } else {
+      printUsage();
+      return false;
+    }
+  }
+
+  if (out.input.empty()) {
+    printUsage();
+    return false;
+  }
+  if (out.output.empty()) {
+    out.output = std::filesystem::path(out.input).replace_extension(".qpkg");
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opt{};
+  if (!parseArgs(argc, argv, opt)) {
+    return 1;
+  }
+
+  engine::jobs::JobSystem jobs;
+  jobs.init();
+  opt.gltf.jobs = &jobs;
+
+  engine::assets::GltfSceneCpu scene;
+  if (!engine::assets::loadGltfCpu(opt.input.string(), scene, opt.gltf)) {
+    std::cerr << "[Cook] Failed to load " << opt.input << "\n";
+    return 1;
+  }
+
+  if (!engine::assets::writeScenePackage(opt.output.string(), scene)) {
+    return 1;
+  }
+
+  size_t vertices = 0;
+  size_t indices = 0;
+  for (const engine::assets::GltfPrimitiveCpu &primitive : scene.primitives) {
+    vertices += primitive.mesh.vertices.size();
+    indices += primitive.mesh.indices.size();
+  }
+
+  std::cout << "[Cook] " << opt.input.string() << " -> "
+            << opt.output.string() << ": " << scene.primitives.size()
+            << " meshes, " << scene.materials.size() << " materials, "
+            << scene.nodes.size() << " nodes, " << vertices << " vertices, "
+            << indices << " indices\n";
+  return 0;
+}